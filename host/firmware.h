@@ -0,0 +1,35 @@
+#ifndef FIRMWARE_H
+#define FIRMWARE_H
+
+// Partes de projeto.c usadas pelo simulador (compilado com PROJETO_SEM_MAIN)
+#include "utils/flash_log.h"
+#include "utils/gravacao.h"
+#include "utils/maquina_estados.h"
+#include "utils/registro.h"
+
+void sistema_iniciar(void);
+void sistema_reiniciar(void);
+void sistema_passo(void);
+uint16_t resumo_sessao(void);
+
+extern MaquinaEstados fsm;
+extern RegistroPlantas registro;
+extern FlashLog historico;
+extern uint16_t indice_planta;
+extern int custo_total;
+
+// Gravação de entradas: o simulador usa os mesmos comandos do console
+bool cmd_gravar(int argc, char *argv[]);
+bool cmd_parar(int argc, char *argv[]);
+bool cmd_reproduzir(int argc, char *argv[]);
+bool cmd_trace(int argc, char *argv[]);
+
+// Modelo de classificação gravado na flash
+bool cmd_arvore(int argc, char *argv[]);
+
+extern GravacaoEntradas gravacao;
+extern bool relatar_reproducao;
+extern uint32_t reproducoes;
+extern uint32_t reproducoes_divergentes;
+
+#endif // FIRMWARE_H
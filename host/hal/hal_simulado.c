@@ -0,0 +1,271 @@
+#include "hal_simulado.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "ws2818b.pio.h"
+
+HalSimulado hal_sim;
+
+// Instâncias opacas: o firmware só compara e repassa os ponteiros
+static int instancia_i2c[2], instancia_pio[2];
+i2c_inst_t *i2c0 = (i2c_inst_t *)&instancia_i2c[0];
+i2c_inst_t *i2c1 = (i2c_inst_t *)&instancia_i2c[1];
+PIO pio0 = (PIO)&instancia_pio[0];
+PIO pio1 = (PIO)&instancia_pio[1];
+const pio_program_t ws2818b_program = {NULL, 0};
+
+/**********************************
+* CONTROLE DO SIMULADOR
+**********************************/
+
+/*
+* Volta os periféricos ao estado de boot, com a flash apagada. O relógio não
+* volta: como após um reset, o firmware só compara instantes entre si.
+*/
+void hal_sim_reiniciar(void) {
+    uint64_t tempo = hal_sim.tempo_us;
+    memset(&hal_sim, 0, offsetof(HalSimulado, flash));
+    hal_sim.tempo_us = tempo;
+    hal_sim_apagar_flash();
+    hal_sim_joystick(2047, 2047);
+}
+
+void hal_sim_apagar_flash(void) {
+    memset(hal_sim.flash, 0xFF, sizeof(hal_sim.flash));
+}
+
+/*
+* Pressiona e solta um botão: borda de descida entregue ao callback se a
+* interrupção estiver habilitada, como no GPIO real
+*/
+void hal_sim_pressionar(unsigned int gpio) {
+    if (gpio >= HAL_SIM_GPIOS) return;
+    hal_sim.gpio_nivel[gpio] = false;
+    if ((hal_sim.irq_habilitada & (1u << gpio)) && hal_sim.callback) {
+        hal_sim.callback(gpio, GPIO_IRQ_EDGE_FALL);
+    }
+    hal_sim.gpio_nivel[gpio] = true;
+}
+
+void hal_sim_joystick(uint16_t x, uint16_t y) {
+    hal_sim.adc[1] = x;
+    hal_sim.adc[0] = y;
+}
+
+/*
+* Coloca texto na fila de entrada da serial
+* @return false se não coube inteiro
+*/
+bool hal_sim_serial_enviar(const char *texto) {
+    size_t n = strlen(texto);
+    if (hal_sim.entrada_tamanho + n > HAL_SIM_TAM_ENTRADA) return false;
+    for (size_t i = 0; i < n; i++) {
+        uint16_t pos = (hal_sim.entrada_inicio + hal_sim.entrada_tamanho++) % HAL_SIM_TAM_ENTRADA;
+        hal_sim.entrada[pos] = texto[i];
+    }
+    return true;
+}
+
+/*
+* Pixel do último quadro do OLED (layout de páginas do SSD1306)
+*/
+bool hal_sim_oled_pixel(int x, int y) {
+    // Endereçamento vertical (ssd1306_config): 8 páginas por coluna
+    return (hal_sim.oled[x * 8 + y / 8] >> (y % 8)) & 1;
+}
+
+/**********************************
+* TEMPO
+**********************************/
+
+absolute_time_t get_absolute_time(void) { return hal_sim.tempo_us; }
+uint64_t time_us_64(void) { return hal_sim.tempo_us; }
+uint32_t time_us_32(void) { return (uint32_t)hal_sim.tempo_us; }
+void sleep_us(uint64_t us) { hal_sim.tempo_us += us; }
+void sleep_ms(uint32_t ms) { hal_sim.tempo_us += (uint64_t)ms * 1000; }
+absolute_time_t make_timeout_time_ms(uint32_t ms) { return hal_sim.tempo_us + (uint64_t)ms * 1000; }
+bool time_reached(absolute_time_t t) { return hal_sim.tempo_us >= t; }
+int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate) { return (int64_t)(ate - de); }
+
+void sleep_until(absolute_time_t t) {
+    if (t > hal_sim.tempo_us) hal_sim.tempo_us = t;
+}
+
+uint get_core_num(void) { return 0; }
+uint32_t clock_get_hz(enum clock_index clock) { return 125000000; }
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t estado) {}
+
+/**********************************
+* STDIO
+**********************************/
+
+bool stdio_init_all(void) { return true; }
+
+/*
+* Sem dados na fila, a espera inteira passa no relógio virtual
+*/
+int getchar_timeout_us(uint32_t timeout_us) {
+    if (hal_sim.entrada_tamanho == 0) {
+        hal_sim.tempo_us += timeout_us;
+        return PICO_ERROR_TIMEOUT;
+    }
+    char c = hal_sim.entrada[hal_sim.entrada_inicio];
+    hal_sim.entrada_inicio = (hal_sim.entrada_inicio + 1) % HAL_SIM_TAM_ENTRADA;
+    hal_sim.entrada_tamanho--;
+    return (unsigned char)c;
+}
+
+int putchar_raw(int c) {
+    hal_sim.tempo_us += HAL_SIM_US_BYTE_SERIAL;
+    hal_sim.bytes_saida++;
+    if (hal_sim.saida) hal_sim.saida(hal_sim.saida_ctx, (uint8_t)c);
+    return c;
+}
+
+/**********************************
+* GPIO E ADC
+**********************************/
+
+void gpio_init(uint gpio) {}
+void gpio_set_dir(uint gpio, bool saida) {}
+void gpio_set_function(uint gpio, gpio_function_t funcao) {}
+
+void gpio_put(uint gpio, bool valor) {
+    if (gpio < HAL_SIM_GPIOS) hal_sim.gpio_nivel[gpio] = valor;
+}
+
+bool gpio_get(uint gpio) {
+    return gpio < HAL_SIM_GPIOS && hal_sim.gpio_nivel[gpio];
+}
+
+void gpio_pull_up(uint gpio) {
+    gpio_put(gpio, true);
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitado) {
+    if (gpio >= HAL_SIM_GPIOS || !(eventos & GPIO_IRQ_EDGE_FALL)) return;
+    if (habilitado) hal_sim.irq_habilitada |= 1u << gpio;
+    else hal_sim.irq_habilitada &= ~(1u << gpio);
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitado, gpio_irq_callback_t callback) {
+    hal_sim.callback = callback;
+    gpio_set_irq_enabled(gpio, eventos, habilitado);
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) {}
+
+void adc_select_input(uint canal) {
+    hal_sim.canal_adc = canal % HAL_SIM_CANAIS_ADC;
+}
+
+uint16_t adc_read(void) {
+    hal_sim.tempo_us += 2; // 96 ciclos a 48 MHz
+    return hal_sim.adc[hal_sim.canal_adc];
+}
+
+/**********************************
+* I2C (OLED SSD1306)
+**********************************/
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    hal_sim.baud_i2c = baudrate;
+    return baudrate;
+}
+
+/*
+* Cada byte custa 9 bits no barramento. Uma escrita de dados (byte de
+* controle 0x40) com a tela inteira vira o quadro visível.
+*/
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco_i2c, const uint8_t *dados, size_t tamanho, bool nostop) {
+    uint32_t baud = hal_sim.baud_i2c ? hal_sim.baud_i2c : 100000;
+    hal_sim.tempo_us += (uint64_t)(tamanho + 1) * 9 * 1000000 / baud;
+    if (tamanho == HAL_SIM_OLED_BYTES + 1 && dados[0] == 0x40) {
+        memcpy(hal_sim.oled, &dados[1], HAL_SIM_OLED_BYTES);
+        hal_sim.quadros_oled++;
+    }
+    return (int)tamanho;
+}
+
+/*
+* Com hal_sim.erro_i2c, falha sem entregar o quadro: NACK do endereço logo
+* no primeiro byte ou timeout depois de esgotar o prazo
+*/
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t endereco_i2c, const uint8_t *dados, size_t tamanho, bool nostop,
+                         uint timeout_us) {
+    if (hal_sim.erro_i2c == PICO_ERROR_TIMEOUT) {
+        hal_sim.tempo_us += timeout_us;
+        return PICO_ERROR_TIMEOUT;
+    }
+    if (hal_sim.erro_i2c) {
+        uint32_t baud = hal_sim.baud_i2c ? hal_sim.baud_i2c : 100000;
+        hal_sim.tempo_us += 2 * 9 * 1000000 / baud;
+        return hal_sim.erro_i2c;
+    }
+    return i2c_write_blocking(i2c, endereco_i2c, dados, tamanho, nostop);
+}
+
+/**********************************
+* PIO (MATRIZ DE LEDS) E PWM
+**********************************/
+
+uint pio_add_program(PIO pio, const pio_program_t *programa) { return 0; }
+int pio_claim_unused_sm(PIO pio, bool obrigatorio) { return 0; }
+void ws2818b_program_init(PIO pio, uint sm, uint offset, uint pino, float frequencia) {}
+
+/*
+* Recebe os bytes na ordem do WS2812 (G, R, B por LED); o quadro completo
+* vai para hal_sim.leds em R, G, B
+*/
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t dado) {
+    static const uint8_t CANAL[3] = {1, 0, 2}; // G, R, B -> posição em R, G, B
+    static uint8_t quadro[HAL_SIM_LEDS][3];
+
+    hal_sim.tempo_us += HAL_SIM_US_BYTE_LED;
+    uint16_t n = hal_sim.bytes_pio++;
+    quadro[n / 3][CANAL[n % 3]] = (uint8_t)dado;
+    if (hal_sim.bytes_pio == HAL_SIM_LEDS * 3) {
+        memcpy(hal_sim.leds, quadro, sizeof(quadro));
+        hal_sim.quadros_leds++;
+        hal_sim.bytes_pio = 0;
+    }
+}
+
+uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+pwm_config pwm_get_default_config(void) { return (pwm_config){0, 1, 0xFFFF}; }
+void pwm_config_set_clkdiv(pwm_config *c, float divisor) {}
+void pwm_init(uint slice, pwm_config *c, bool iniciar) {}
+void pwm_set_wrap(uint slice, uint16_t wrap) {}
+
+void pwm_set_gpio_level(uint gpio, uint16_t nivel) {
+    if (gpio < HAL_SIM_GPIOS) hal_sim.pwm_nivel[gpio] = nivel;
+}
+
+/**********************************
+* FLASH
+**********************************/
+
+// Semântica NOR: programar só leva bits de 1 para 0
+void flash_range_program(uint32_t deslocamento, const uint8_t *dados, size_t tamanho) {
+    for (size_t i = 0; i < tamanho && deslocamento + i < PICO_FLASH_SIZE_BYTES; i++) {
+        hal_sim.flash[deslocamento + i] &= dados[i];
+    }
+    hal_sim.tempo_us += HAL_SIM_US_PAGINA_FLASH * ((tamanho + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE);
+    hal_sim.programacoes_flash++;
+}
+
+void flash_range_erase(uint32_t deslocamento, size_t tamanho) {
+    if (deslocamento + tamanho <= PICO_FLASH_SIZE_BYTES) {
+        memset(&hal_sim.flash[deslocamento], 0xFF, tamanho);
+    }
+    hal_sim.tempo_us += HAL_SIM_US_SETOR_FLASH * (tamanho / FLASH_SECTOR_SIZE);
+    hal_sim.apagamentos_flash++;
+}
@@ -0,0 +1,76 @@
+#ifndef HAL_SIMULADO_H
+#define HAL_SIMULADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Geometria simulada
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+#define HAL_SIM_GPIOS 30
+#define HAL_SIM_CANAIS_ADC 4
+#define HAL_SIM_OLED_BYTES (128 * 64 / 8)      // Páginas de 8 linhas, como no SSD1306
+#define HAL_SIM_LEDS 25
+#define HAL_SIM_TAM_ENTRADA 4096
+
+// Custos de tempo dos periféricos no relógio virtual
+#define HAL_SIM_US_PAGINA_FLASH 400            // Programação de 256 bytes
+#define HAL_SIM_US_SETOR_FLASH 45000           // Apagamento de 4 KB
+#define HAL_SIM_US_BYTE_LED 10                 // 8 bits a 800 kHz
+#define HAL_SIM_US_BYTE_SERIAL 1               // USB CDC, ~1 MB/s
+
+// Saída binária da serial (putchar_raw)
+typedef void (*hal_sim_saida_t)(void *ctx, uint8_t byte);
+
+// Estado completo do hardware simulado. Os periféricos gravam aqui o que o
+// hardware real mostraria; o simulador lê e injeta entradas diretamente.
+typedef struct {
+    // Relógio virtual: só avança com esperas e com o custo dos periféricos
+    uint64_t tempo_us;
+
+    // GPIO e interrupções de borda de descida
+    bool gpio_nivel[HAL_SIM_GPIOS];
+    uint32_t irq_habilitada;                   // Bit por GPIO
+    void (*callback)(unsigned int gpio, uint32_t eventos);
+
+    // ADC (joystick: canal 0 = Y, canal 1 = X)
+    uint16_t adc[HAL_SIM_CANAIS_ADC];
+    uint8_t canal_adc;
+
+    // OLED: último quadro completo enviado pelo I2C
+    uint8_t oled[HAL_SIM_OLED_BYTES];
+    uint32_t quadros_oled;
+    uint32_t baud_i2c;
+    int erro_i2c;                              // Se != 0, as escritas falham com esse código (teste)
+
+    // Matriz de LEDs: último quadro completo enviado pela PIO (R, G, B)
+    uint8_t leds[HAL_SIM_LEDS][3];
+    uint32_t quadros_leds;
+    uint16_t bytes_pio;                        // Bytes do quadro em andamento
+
+    // Buzzer (PWM)
+    uint16_t pwm_nivel[HAL_SIM_GPIOS];
+
+    // Serial: fila de entrada e destino dos bytes binários
+    char entrada[HAL_SIM_TAM_ENTRADA];
+    uint16_t entrada_inicio, entrada_tamanho;
+    hal_sim_saida_t saida;
+    void *saida_ctx;
+    uint32_t bytes_saida;
+
+    // Flash completa; o firmware a lê via XIP_BASE
+    uint32_t programacoes_flash, apagamentos_flash;
+    uint8_t flash[PICO_FLASH_SIZE_BYTES];
+} HalSimulado;
+
+extern HalSimulado hal_sim;
+
+// Controle pelo simulador
+void hal_sim_reiniciar(void);
+void hal_sim_apagar_flash(void);
+void hal_sim_pressionar(unsigned int gpio);
+void hal_sim_joystick(uint16_t x, uint16_t y);
+bool hal_sim_serial_enviar(const char *texto);
+bool hal_sim_oled_pixel(int x, int y);
+
+#endif // HAL_SIMULADO_H
@@ -0,0 +1,11 @@
+#ifndef HAL_HARDWARE_ADC_H
+#define HAL_HARDWARE_ADC_H
+
+#include "pico/stdlib.h"
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint canal);
+uint16_t adc_read(void);
+
+#endif // HAL_HARDWARE_ADC_H
@@ -0,0 +1,12 @@
+#ifndef HAL_HARDWARE_CLOCKS_H
+#define HAL_HARDWARE_CLOCKS_H
+
+#include "pico/stdlib.h"
+
+enum clock_index {
+    clk_sys = 5,
+};
+
+uint32_t clock_get_hz(enum clock_index clock);
+
+#endif // HAL_HARDWARE_CLOCKS_H
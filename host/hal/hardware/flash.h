@@ -0,0 +1,17 @@
+#ifndef HAL_HARDWARE_FLASH_H
+#define HAL_HARDWARE_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hal_simulado.h"
+
+#define FLASH_SECTOR_SIZE 4096u
+#define FLASH_PAGE_SIZE 256u
+
+// A "flash mapeada em memória" é o vetor do simulador
+#define XIP_BASE ((uintptr_t)hal_sim.flash)
+
+void flash_range_program(uint32_t deslocamento, const uint8_t *dados, size_t tamanho);
+void flash_range_erase(uint32_t deslocamento, size_t tamanho);
+
+#endif // HAL_HARDWARE_FLASH_H
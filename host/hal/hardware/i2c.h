@@ -0,0 +1,15 @@
+#ifndef HAL_HARDWARE_I2C_H
+#define HAL_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *i2c0;
+extern i2c_inst_t *i2c1;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco_i2c, const uint8_t *dados, size_t tamanho, bool nostop);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t endereco_i2c, const uint8_t *dados, size_t tamanho, bool nostop,
+                         uint timeout_us);
+
+#endif // HAL_HARDWARE_I2C_H
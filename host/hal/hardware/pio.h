@@ -0,0 +1,20 @@
+#ifndef HAL_HARDWARE_PIO_H
+#define HAL_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+extern PIO pio0;
+extern PIO pio1;
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+} pio_program_t;
+
+uint pio_add_program(PIO pio, const pio_program_t *programa);
+int pio_claim_unused_sm(PIO pio, bool obrigatorio);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t dado);
+
+#endif // HAL_HARDWARE_PIO_H
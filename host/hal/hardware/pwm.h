@@ -0,0 +1,17 @@
+#ifndef HAL_HARDWARE_PWM_H
+#define HAL_HARDWARE_PWM_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    uint32_t csr, div, top;
+} pwm_config;
+
+uint pwm_gpio_to_slice_num(uint gpio);
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv(pwm_config *c, float divisor);
+void pwm_init(uint slice, pwm_config *c, bool iniciar);
+void pwm_set_wrap(uint slice, uint16_t wrap);
+void pwm_set_gpio_level(uint gpio, uint16_t nivel);
+
+#endif // HAL_HARDWARE_PWM_H
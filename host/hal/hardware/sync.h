@@ -0,0 +1,9 @@
+#ifndef HAL_HARDWARE_SYNC_H
+#define HAL_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t estado);
+
+#endif // HAL_HARDWARE_SYNC_H
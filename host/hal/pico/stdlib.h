@@ -0,0 +1,67 @@
+// Pico SDK simulado (host/hal): só as partes usadas pelo firmware
+#ifndef HAL_PICO_STDLIB_H
+#define HAL_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+// Seções de memória do RP2040: no host, dados comuns
+#define __in_flash(grupo)
+
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+
+// Tempo (relógio virtual: esperar só avança o contador)
+absolute_time_t get_absolute_time(void);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t t);
+int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate);
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+// Stdio: printf vai para a saída do host; a entrada vem de hal_sim_serial_enviar
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+
+// GPIO
+typedef enum {
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+} gpio_function_t;
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t events);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool saida);
+void gpio_put(uint gpio, bool valor);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_function(uint gpio, gpio_function_t funcao);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitado, gpio_irq_callback_t callback);
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitado);
+
+uint get_core_num(void);
+
+#endif // HAL_PICO_STDLIB_H
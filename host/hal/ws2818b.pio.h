@@ -0,0 +1,10 @@
+// Substitui o cabeçalho gerado pelo pioasm a partir de lib/ws2818b.pio
+#ifndef HAL_WS2818B_PIO_H
+#define HAL_WS2818B_PIO_H
+
+#include "hardware/pio.h"
+
+extern const pio_program_t ws2818b_program;
+void ws2818b_program_init(PIO pio, uint sm, uint offset, uint pino, float frequencia);
+
+#endif // HAL_WS2818B_PIO_H
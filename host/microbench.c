@@ -0,0 +1,108 @@
+/*
+* Microbenchmarks das primitivas do firmware (utils/microbench) no host, sobre
+* o HAL simulado: I2C e PIO são stubs, então npWrite mede só o empacotamento.
+*
+* Uso: microbench [-a alvo_us] [-f prefixo]
+*      microbench -c base.txt atual.txt
+*
+* A primeira forma mede e imprime o CSV. A segunda compara duas capturas
+* (do host ou da serial do dispositivo, com o comando microbench): para cada
+* caso presente nas duas, ns por chamada antes e depois e a razão.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal/hal_simulado.h"
+#include "utils/microbench.h"
+
+#define MAX_CASOS 128
+
+typedef struct {
+    char caso[64];                      // "nome,entrada"
+    double ns;
+} Medicao;
+
+static uint64_t relogio_host_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+// Lê as linhas de dados de um despejo (as demais são ignoradas)
+static int ler_captura(const char *caminho, Medicao *m) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return -1;
+    }
+    char linha[256];
+    int n = 0;
+    bool dentro = false;
+    while (fgets(linha, sizeof(linha), f) && n < MAX_CASOS) {
+        if (strncmp(linha, "microbench v", 12) == 0) {
+            dentro = true;
+            n = 0;                      // Com vários despejos, vale o último
+            continue;
+        }
+        if (strncmp(linha, "fim microbench", 14) == 0) dentro = false;
+        char nome[32], entrada[32];
+        unsigned long iteracoes, total;
+        double ns;
+        if (dentro && sscanf(linha, "%31[^,],%31[^,],%lu,%lu,%lf", nome, entrada, &iteracoes, &total, &ns) == 5) {
+            snprintf(m[n].caso, sizeof(m[n].caso), "%s,%s", nome, entrada);
+            m[n++].ns = ns;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+static int comparar(const char *base, const char *atual) {
+    static Medicao antes[MAX_CASOS], depois[MAX_CASOS];
+    int na = ler_captura(base, antes), nd = ler_captura(atual, depois);
+    if (na < 0 || nd < 0) return 1;
+
+    printf("%-40s %12s %12s %8s\n", "caso", "base ns", "atual ns", "razao");
+    for (int i = 0; i < nd; i++) {
+        const Medicao *b = NULL;
+        for (int j = 0; j < na && !b; j++) {
+            if (strcmp(antes[j].caso, depois[i].caso) == 0) b = &antes[j];
+        }
+        if (!b) {
+            printf("%-40s %12s %12.2f %8s\n", depois[i].caso, "-", depois[i].ns, "novo");
+        } else {
+            printf("%-40s %12.2f %12.2f %7.2fx\n", depois[i].caso, b->ns, depois[i].ns,
+                   b->ns > 0 ? depois[i].ns / b->ns : 0);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t alvo = MICROBENCH_ALVO_US;
+    const char *filtro = NULL, *base = NULL;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "a:f:c:")) != -1) {
+        switch (opcao) {
+            case 'a': alvo = (uint32_t)atoi(optarg); break;
+            case 'f': filtro = optarg; break;
+            case 'c': base = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-a alvo_us] [-f prefixo] | -c base.txt atual.txt\n", argv[0]);
+                return 2;
+        }
+    }
+    if (base) {
+        if (optind >= argc) {
+            fprintf(stderr, "-c precisa da captura atual\n");
+            return 2;
+        }
+        return comparar(base, argv[optind]);
+    }
+
+    hal_sim_reiniciar();
+    return microbench_executar(filtro, alvo, relogio_host_us, "host", 0) ? 0 : 1;
+}
@@ -0,0 +1,346 @@
+/*
+* Simulador de host do firmware: projeto.c e as bibliotecas compilados sobre
+* um HAL simulado (hal/), com relógio virtual. Esperas não custam tempo real,
+* então uma sessão de vários segundos de uso roda em microssegundos.
+*
+* Uso: simulador [-n sessoes] [-m] [-g arquivo | -r arquivo]
+*
+* Cada sessão reinicia o estado da aplicação (como um boot, com o histórico
+* apagado) e percorre um roteiro que passa por todos os estados: calibração
+* e análise da amostra, navegação no menu, análise de uma folha e tratamento
+* de uma planta. Ao fim, confere estado, custo, histórico e saídas. Com -m,
+* mostra a tela do OLED, a matriz de LEDs e as métricas da última sessão.
+*
+* -g grava as entradas de uma sessão do roteiro (utils/gravacao) no formato
+* do comando "trace" do console, que pode ser colado no dispositivo.
+* -r reproduz n vezes, sem as esperas, uma gravação nesse formato (a captura
+* da serial do dispositivo serve: linhas que não são "trace" são ignoradas),
+* conferindo o estado final e medindo o tempo de CPU por fluxo.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal/hal_simulado.h"
+#include "firmware.h"
+#include "lib/flash_rp2040.h"
+#include "utils/classificador.h"
+#include "utils/hardware_config.h"
+
+#define CENTRO_ADC 2047
+#define MAX_PASSOS_REPRODUCAO 10000000
+
+typedef struct {
+    uint32_t passos;
+    uint32_t falhas;
+} Sessao;
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const char *estado_atual(void) {
+    return fsm.estados[fsm.atual].nome;
+}
+
+// Roda o loop principal até passar ms de tempo virtual
+static void esperar_ms(Sessao *s, uint32_t ms) {
+    uint64_t fim = hal_sim.tempo_us + (uint64_t)ms * 1000;
+    while (hal_sim.tempo_us < fim) {
+        sistema_passo();
+        s->passos++;
+    }
+}
+
+// Pressiona um botão respeitando o debounce de 200 ms do firmware
+static void botao(Sessao *s, unsigned int gpio) {
+    esperar_ms(s, 250);
+    hal_sim_pressionar(gpio);
+    esperar_ms(s, 1);
+}
+
+// Inclina o joystick por um passo do loop e volta ao centro
+static void mover(Sessao *s, uint16_t x, uint16_t y) {
+    hal_sim_joystick(x, y);
+    sistema_passo();
+    hal_sim_joystick(CENTRO_ADC, CENTRO_ADC);
+    esperar_ms(s, 100);
+    s->passos++;
+}
+
+static void conferir(Sessao *s, bool condicao, const char *descricao) {
+    if (!condicao) {
+        s->falhas++;
+        fprintf(stderr, "falha: %s (estado %s)\n", descricao, estado_atual());
+    }
+}
+
+static bool contar(void *ctx, uint8_t tipo, const void *dados, uint8_t tamanho) {
+    (*(uint32_t *)ctx)++;
+    return true;
+}
+
+// Apaga a região do histórico e reabre o log sobre ela
+static void apagar_historico(void) {
+    memset(&hal_sim.flash[FLASH_LOG_OFFSET], 0xFF, FLASH_LOG_SETORES * FLASH_SECTOR_SIZE);
+    flash_log_abrir(&historico, &FLASH_RP2040_LOG);
+}
+
+// Executa um comando do console com argumentos fixos
+static bool comando(bool (*cmd)(int, char **), const char *nome, const char *argumento) {
+    char *argv[] = {(char *)nome, (char *)argumento};
+    return cmd(argumento ? 2 : 1, argv);
+}
+
+/*
+* Uma sessão completa de uso
+* @param gravar Grava as entradas (comandos gravar e parar do console)
+*/
+static void executar_sessao(Sessao *s, bool gravar) {
+    apagar_historico();
+    if (gravar) {
+        comando(cmd_gravar, "gravar", NULL);
+        sistema_passo();   // O pedido reinicia a sessão no início do passo
+        s->passos++;
+    } else {
+        sistema_reiniciar();
+    }
+    uint32_t quadros_oled = hal_sim.quadros_oled;
+    conferir(s, strcmp(estado_atual(), "ESCANEAMENTO") == 0, "boot no escaneamento");
+
+    // Calibração: R/NIR, depois G/B, desativa e analisa
+    botao(s, BUTTON_B);
+    hal_sim_joystick(1000, 3500);
+    esperar_ms(s, 300);
+    botao(s, BUTTON_B);
+    hal_sim_joystick(3000, 800);
+    esperar_ms(s, 300);
+    hal_sim_joystick(CENTRO_ADC, CENTRO_ADC);
+    botao(s, BUTTON_B);
+    botao(s, BUTTON_A);
+    conferir(s, strcmp(estado_atual(), "ANALISAR_ESCANEAMENTO") == 0, "analise da amostra");
+    botao(s, BUTTON_A);
+
+    // Menu: três plantas à direita e uma fileira abaixo
+    botao(s, BUTTON_JOYSTICK);
+    conferir(s, strcmp(estado_atual(), "MENU") == 0, "entrada no menu");
+    for (int i = 0; i < 3; i++) mover(s, 4095, CENTRO_ADC);
+    mover(s, CENTRO_ADC, 0);
+    conferir(s, indice_planta == registro_posicao_em(&registro, 1, 3), "navegacao para fileira 1, coluna 3");
+
+    // Seleciona a segunda folha, analisa e volta ao menu
+    botao(s, BUTTON_B);
+    mover(s, 4095, CENTRO_ADC);
+    botao(s, BUTTON_B);
+    conferir(s, strcmp(estado_atual(), "ANALISAR") == 0, "analise da folha");
+    botao(s, BUTTON_A);
+    botao(s, BUTTON_A);
+
+    // Trata a planta
+    botao(s, BUTTON_A);
+    esperar_ms(s, 200);
+    conferir(s, strcmp(estado_atual(), "MENU") == 0, "retorno ao menu");
+    conferir(s, custo_total == 10, "custo de um tratamento");
+    conferir(s, registro_planta(&registro, indice_planta)->tratada, "planta tratada");
+
+    // O que está na flash, e não no buffer em RAM do log: passada a pausa
+    // sem análises o firmware grava a página parcial
+    esperar_ms(s, 2500);                 // Acima do HISTORICO_SINCRONIZAR_MS (2 s) do firmware
+    static FlashLog gravado;
+    uint32_t registros = 0;
+    flash_log_abrir(&gravado, &FLASH_RP2040_LOG);
+    flash_log_percorrer(&gravado, contar, &registros);
+    conferir(s, registros == 2, "duas analises gravadas na flash");
+    conferir(s, hal_sim.quadros_oled > quadros_oled, "OLED atualizado");
+
+    if (gravar) {
+        comando(cmd_parar, "parar", NULL);
+        sistema_passo();
+    }
+}
+
+/*
+* Grava a árvore embutida na flash pelo comando "arvore", como os comandos de
+* treinar_arvore -c, e confere que ela vale após um boot; apagada, o boot
+* volta às regras
+*/
+static void conferir_modelo_flash(Sessao *s) {
+    static uint8_t blob[sizeof(CabecalhoBlobArvore) + 64 * sizeof(NoArvore)];
+    const ModeloClassificador *m = &MODELO_ARVORE_REGRAS;
+    CabecalhoBlobArvore cabecalho = {BLOB_ARVORE_MAGICO, m->num_nos, m->profundidade, m->indices_usados};
+    size_t tamanho = sizeof(cabecalho) + m->num_nos * sizeof(NoArvore);
+    if (tamanho > sizeof(blob)) {
+        conferir(s, false, "arvore embutida cabe no blob de teste");
+        return;
+    }
+    memcpy(blob, &cabecalho, sizeof(cabecalho));
+    memcpy(blob + sizeof(cabecalho), m->nos, m->num_nos * sizeof(NoArvore));
+
+    bool ok = comando(cmd_arvore, "arvore", "limpar");
+    for (size_t i = 0; i < tamanho; i += 32) {
+        char hex[65];
+        size_t n = 0;
+        for (size_t j = i; j < i + 32 && j < tamanho; j++) n += (size_t)sprintf(hex + n, "%02x", blob[j]);
+        ok &= comando(cmd_arvore, "arvore", hex);
+    }
+    ok &= comando(cmd_arvore, "arvore", "gravar");
+    conferir(s, ok, "arvore gravada pelo console");
+
+    sistema_iniciar();
+    conferir(s, strcmp(classificador_modelo_ativo()->nome, "flash") == 0, "arvore da flash ativa no boot");
+    conferir(s, classificador_modelo_ativo()->num_nos == m->num_nos, "arvore da flash com os mesmos nos");
+
+    comando(cmd_arvore, "arvore", "limpar");
+    sistema_iniciar();
+    conferir(s, classificador_modelo_ativo() == &MODELO_REGRAS, "regras no boot sem arvore na flash");
+}
+
+/*
+* Grava uma sessão do roteiro no formato do despejo do comando "trace"
+*/
+static int gravar_arquivo(const char *caminho) {
+    Sessao s = {0};
+    executar_sessao(&s, true);
+    if (s.falhas) return 1;
+
+    FILE *f = fopen(caminho, "w");
+    if (!f) {
+        perror(caminho);
+        return 1;
+    }
+    fprintf(f, "trace limpar\n");
+    for (uint16_t i = 0; i < gravacao.tamanho; i += 32) {
+        fprintf(f, "trace ");
+        for (uint16_t j = i; j < i + 32 && j < gravacao.tamanho; j++) fprintf(f, "%02x", gravacao.dados[j]);
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    printf("%s: %u bytes, %u passos, %u ms\n", caminho, gravacao.tamanho, gravacao.passos, gravacao.tempo_ms);
+    return 0;
+}
+
+/*
+* Carrega os comandos "trace" de um arquivo pelo próprio handler do console
+*/
+static bool carregar_arquivo(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    char linha[256];
+    bool ok = true;
+    while (ok && fgets(linha, sizeof(linha), f)) {
+        char *argv[3];
+        int argc = 0;
+        for (char *t = strtok(linha, " \r\n"); t && argc < 3; t = strtok(NULL, " \r\n")) argv[argc++] = t;
+        if (argc >= 2 && strcmp(argv[0], "trace") == 0) ok = cmd_trace(argc, argv);
+    }
+    fclose(f);
+    return ok && gravacao_valida(&gravacao);
+}
+
+/*
+* Reproduz a gravação carregada n vezes, no modo rápido
+*/
+static int reproduzir(uint32_t vezes) {
+    relatar_reproducao = vezes == 1;
+    uint32_t passos = 0;
+    double inicio = agora_s();
+    for (uint32_t i = 0; i < vezes; i++) {
+        apagar_historico();
+        uint32_t concluidas = reproducoes;
+        comando(cmd_reproduzir, "reproduzir", "rapido");
+        for (uint32_t n = 0; reproducoes == concluidas && n < MAX_PASSOS_REPRODUCAO; n++) {
+            sistema_passo();
+            passos++;
+        }
+    }
+    double duracao = agora_s() - inicio;
+
+    printf("%u reproducoes de %u passos (%.1f s gravados) em %.3f s: %.1f us de CPU por fluxo, %u divergentes\n",
+           vezes, gravacao.passos, gravacao.tempo_ms / 1e3, duracao,
+           duracao * 1e6 / (vezes ? vezes : 1), reproducoes_divergentes);
+    return reproducoes_divergentes != 0 || passos != vezes * gravacao.passos;
+}
+
+static void mostrar_saidas(void) {
+    printf("OLED (%u quadros):\n", hal_sim.quadros_oled);
+    for (int y = 0; y < 64; y += 2) {
+        for (int x = 0; x < 128; x++) {
+            bool cima = hal_sim_oled_pixel(x, y), baixo = hal_sim_oled_pixel(x, y + 1);
+            putchar(cima && baixo ? '#' : cima ? '"' : baixo ? '.' : ' ');
+        }
+        putchar('\n');
+    }
+    printf("LEDs (%u quadros), linha de cima primeiro:\n", hal_sim.quadros_leds);
+    for (int linha = 4; linha >= 0; linha--) {
+        for (int coluna = 0; coluna < 5; coluna++) {
+            // Mesmo mapeamento serpentina de getIndex
+            int i = linha % 2 == 0 ? linha * 5 + (4 - coluna) : linha * 5 + coluna;
+            printf(" %02x%02x%02x", hal_sim.leds[i][0], hal_sim.leds[i][1], hal_sim.leds[i][2]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t sessoes = 1000;
+    bool mostrar = false;
+    const char *gravar = NULL, *reproduzir_de = NULL;
+    int opcao;
+    while ((opcao = getopt(argc, argv, "n:mg:r:")) != -1) {
+        switch (opcao) {
+            case 'n': sessoes = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'm': mostrar = true; break;
+            case 'g': gravar = optarg; break;
+            case 'r': reproduzir_de = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-n sessoes] [-m] [-g arquivo | -r arquivo]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    hal_sim_reiniciar();
+    sistema_iniciar();
+
+    if (gravar) return gravar_arquivo(gravar);
+    if (reproduzir_de) {
+        if (!carregar_arquivo(reproduzir_de)) {
+            fprintf(stderr, "%s: gravacao invalida\n", reproduzir_de);
+            return 1;
+        }
+        int resultado = reproduzir(sessoes);
+        if (mostrar) {
+            mostrar_saidas();
+            fsm_imprimir_metricas(&fsm);
+        }
+        return resultado;
+    }
+
+    Sessao total = {0};
+    uint64_t tempo_virtual = hal_sim.tempo_us;
+    double inicio = agora_s();
+    for (uint32_t i = 0; i < sessoes; i++) {
+        Sessao s = {0};
+        executar_sessao(&s, false);
+        total.passos += s.passos;
+        total.falhas += s.falhas;
+    }
+    double duracao = agora_s() - inicio;
+    tempo_virtual = hal_sim.tempo_us - tempo_virtual;
+    conferir_modelo_flash(&total);
+
+    if (mostrar) {
+        mostrar_saidas();
+        fsm_imprimir_metricas(&fsm);
+    }
+    printf("%u sessoes em %.3f s (%.0f sessoes/s): %.1f s de uso simulado por sessao, %u passos do loop (%.2f us/passo)\n",
+           sessoes, duracao, sessoes / duracao, tempo_virtual / 1e6 / (sessoes ? sessoes : 1),
+           total.passos, duracao * 1e6 / (total.passos ? total.passos : 1));
+    printf("%u falhas\n", total.falhas);
+    return total.falhas != 0;
+}
@@ -3,6 +3,7 @@
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"  // para clock_get_hz()
+#include "utils/rastreio.h"
 
 // Variáveis estáticas internas para controle do buzzer
 static uint buzzer_pin;            // Pino configurado para o buzzer
@@ -86,7 +87,7 @@ void buzzer_som_analise_concluida() {
 
 // Sons para diagnóstico
 void buzzer_infectada() {
-    
+    RASTREIO_ESCOPO(PONTO_BUZZER);
     buzzer_start(5000, 150);  
     sleep_ms(150);
     buzzer_start(2000, 150);  
@@ -98,6 +99,7 @@ void buzzer_infectada() {
 }
 
 void buzzer_saudavel() {
+    RASTREIO_ESCOPO(PONTO_BUZZER);
     // Confirmação melódica em Lá Maior (A4 + C#5 + E5)
     buzzer_start(440, 150);     // A4 por 150ms
     sleep_ms(150);
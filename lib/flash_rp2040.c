@@ -0,0 +1,51 @@
+#include "flash_rp2040.h"
+#include <string.h>
+#include "hardware/sync.h"
+
+_Static_assert(FLASH_LOG_TAM_SETOR == FLASH_SECTOR_SIZE, "setor do log difere do setor da flash");
+_Static_assert(FLASH_LOG_TAM_PAGINA == FLASH_PAGE_SIZE, "página do log difere da página da flash");
+
+static bool ler(void *ctx, uint32_t deslocamento, void *dados, uint32_t tamanho) {
+    memcpy(dados, (const void *)(uintptr_t)(XIP_BASE + FLASH_LOG_OFFSET + deslocamento), tamanho);
+    return true;
+}
+
+// Programar e apagar desligam o XIP: nenhuma interrupção pode executar
+// código da flash enquanto isso (as rotinas do SDK rodam da RAM)
+static bool programar(void *ctx, uint32_t deslocamento, const void *dados, uint32_t tamanho) {
+    uint32_t estado = save_and_disable_interrupts();
+    flash_range_program(FLASH_LOG_OFFSET + deslocamento, dados, tamanho);
+    restore_interrupts(estado);
+    return true;
+}
+
+static bool apagar(void *ctx, uint32_t deslocamento) {
+    uint32_t estado = save_and_disable_interrupts();
+    flash_range_erase(FLASH_LOG_OFFSET + deslocamento, FLASH_SECTOR_SIZE);
+    restore_interrupts(estado);
+    return true;
+}
+
+const uint8_t *flash_modelo_dados(void) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + FLASH_MODELO_OFFSET);
+}
+
+void flash_modelo_apagar(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    flash_range_erase(FLASH_MODELO_OFFSET, FLASH_MODELO_TAMANHO);
+    restore_interrupts(estado);
+}
+
+void flash_modelo_programar(uint32_t deslocamento, const uint8_t *pagina) {
+    uint32_t estado = save_and_disable_interrupts();
+    flash_range_program(FLASH_MODELO_OFFSET + deslocamento, pagina, FLASH_PAGE_SIZE);
+    restore_interrupts(estado);
+}
+
+const OperacoesFlash FLASH_RP2040_LOG = {
+    .ler = ler,
+    .programar = programar,
+    .apagar = apagar,
+    .ctx = NULL,
+    .num_setores = FLASH_LOG_SETORES,
+};
@@ -0,0 +1,28 @@
+#ifndef FLASH_RP2040_H
+#define FLASH_RP2040_H
+
+#include "hardware/flash.h"
+#include "utils/flash_log.h"
+
+// Região reservada no fim da flash para o histórico de análises (64 KB).
+#define FLASH_LOG_SETORES 16
+#define FLASH_LOG_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_LOG_SETORES * FLASH_SECTOR_SIZE)
+
+// Logo antes do histórico, o modelo de classificação carregado pelo console
+// (blob de tools/treinar_arvore, lido via XIP no boot). Dois setores cobrem
+// a maior árvore aceita pelo classificador. O firmware precisa caber antes
+// de FLASH_MODELO_OFFSET.
+#define FLASH_MODELO_SETORES 2
+#define FLASH_MODELO_TAMANHO (FLASH_MODELO_SETORES * FLASH_SECTOR_SIZE)
+#define FLASH_MODELO_OFFSET (FLASH_LOG_OFFSET - FLASH_MODELO_TAMANHO)
+
+// Operações do log sobre a flash interna (leitura via XIP)
+extern const OperacoesFlash FLASH_RP2040_LOG;
+
+// Região do modelo: conteúdo via XIP, apagamento inteiro e programação de
+// uma página (deslocamento relativo à região, alinhado a FLASH_PAGE_SIZE)
+const uint8_t *flash_modelo_dados(void);
+void flash_modelo_apagar(void);
+void flash_modelo_programar(uint32_t deslocamento, const uint8_t *pagina);
+
+#endif // FLASH_RP2040_H
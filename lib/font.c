@@ -0,0 +1,7 @@
+#include "font.h"
+#include "pico/stdlib.h"
+
+// Tabelas geradas por tools/gerar_fonte (lib/fontes/*.txt), fora da RAM:
+// __in_flash mantém os glifos na flash mesmo em builds que copiam .rodata
+#include "font_8x8.h"
+#include "font_5x7.h"
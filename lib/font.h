@@ -1,83 +1,124 @@
+#ifndef FONT_H
+#define FONT_H
 
-// Fontes para A-Z e 0-9. Os caracteres tem 8x8 pixels
+#include <stddef.h>
+#include <stdint.h>
 
+// Fontes do display em Latin-1, guardadas comprimidas na flash e lidas
+// direto pelo XIP (const, fora da RAM). Cada coluna de um glifo é um byte no
+// formato das páginas do SSD1306 (bit 0 = linha de cima), então o
+// desenho copia colunas sem converter bits.
+//
+// Cada fonte usa o formato que ocupa menos flash (tools/gerar_fonte calcula
+// os dois):
+//
+// FONT_COMPRESSED: cada glifo é um byte de cabeçalho seguido das colunas
+// entre a primeira e a última acesas; as vazias das bordas não são guardadas
+// e o espaço é só o cabeçalho. Glifos simétricos (A, H, O, T, 0, 8, +...)
+// guardam só a metade esquerda, com a coluna do meio, e o desenho espelha o
+// resto. Cabeçalho: bit 7 espelhado, bits 4-6 colunas vazias à esquerda,
+// bits 0-3 colunas do glifo. Para achar um glifo sem uma tabela por código,
+// blocks guarda o deslocamento do primeiro glifo de cada bloco de FONT_BLOCK
+// códigos e o resto do caminho pula cabeçalhos (no máximo FONT_BLOCK - 1).
+// Blocos sem nenhum glifo (controles C1, a maior parte dos símbolos
+// Latin-1) não ocupam bytes. Compensa em fontes com bordas vazias, como a
+// 8x8.
+//
+// FONT_CELLS: width colunas por glifo, sem cabeçalho, só dos códigos com
+// glifo. present marca esses códigos (bit i = código first + i) e rank conta
+// os glifos antes de cada palavra de 32 códigos. Na 5x7 quase todo glifo
+// ocupa as 5 colunas e o cabeçalho custaria mais do que as bordas poupam.
+//
+// As tabelas são geradas por tools/gerar_fonte a partir dos desenhos em
+// lib/fontes/*.txt.
 
-static uint8_t font[] = {
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Nothing
-0x3e, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3e, 0x00, //0
-0x00, 0x00, 0x42, 0x7f, 0x40, 0x00, 0x00, 0x00, //1
-0x30, 0x49, 0x49, 0x49, 0x49, 0x46, 0x00, 0x00, //2
-0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, //3
-0x3f, 0x20, 0x20, 0x78, 0x20, 0x20, 0x00, 0x00, //4
-0x4f, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00, //5
-0x3f, 0x48, 0x48, 0x48, 0x48, 0x48, 0x30, 0x00, //6
-0x01, 0x01, 0x01, 0x61, 0x31, 0x0d, 0x03, 0x00, //7
-0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, //8
-0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7f, 0x00, //9
-0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00, //A
-0x7f, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7f, 0x00, //B
-0x7e, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00, //C
-0x7f, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7e, 0x00, //D
-0x7f, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00, //E
-0x7f, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01, 0x00, //F
-0x7f, 0x41, 0x41, 0x41, 0x51, 0x51, 0x73, 0x00, //G
-0x7f, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7f, 0x00, //H
-0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, //I
-0x21, 0x41, 0x41, 0x3f, 0x01, 0x01, 0x01, 0x00, //J
-0x00, 0x7f, 0x08, 0x08, 0x14, 0x22, 0x41, 0x00, //K
-0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, //L
-0x7f, 0x02, 0x04, 0x08, 0x04, 0x02, 0x7f, 0x00, //M
-0x7f, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7f, 0x00, //N
-0x3e, 0x41, 0x41, 0x41, 0x41, 0x41, 0x3e, 0x00, //O
-0x7f, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, //P
-0x3e, 0x41, 0x41, 0x49, 0x51, 0x61, 0x7e, 0x00, //Q
-0x7f, 0x11, 0x11, 0x11, 0x31, 0x51, 0x0e, 0x00, //R
-0x46, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00, //S
-0x01, 0x01, 0x01, 0x7f, 0x01, 0x01, 0x01, 0x00, //T
-0x3f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x3f, 0x00, //U
-0x0f, 0x10, 0x20, 0x40, 0x20, 0x10, 0x0f, 0x00, //V
-0x7f, 0x20, 0x10, 0x08, 0x10, 0x20, 0x7f, 0x00, //W
-0x00, 0x41, 0x22, 0x14, 0x14, 0x22, 0x41, 0x00, //X
-0x01, 0x02, 0x04, 0x78, 0x04, 0x02, 0x01, 0x00, //Y
-0x41, 0x61, 0x59, 0x45, 0x43, 0x41, 0x00, 0x00, //Z
-0x00, 0x00, 0x64, 0x92, 0x92, 0xFC, 0x80, 0x00, //a
-0x00, 0x02, 0xFE, 0x88, 0x88, 0x88, 0x70, 0x00, //b
-0x00, 0x78, 0x84, 0x84, 0x84, 0x00, 0x00, 0x00, //c
-0x00, 0x70, 0x88, 0x88, 0x88, 0xFE, 0x80, 0x00, //d
-0x00, 0x7C, 0x92, 0x92, 0x92, 0x0C, 0x00, 0x00, //e
-0x00, 0x00, 0x08, 0xFE, 0x0A, 0x00, 0x00, 0x00, //f
-0x00, 0x0C, 0x92, 0x92, 0x92, 0x7C, 0x00, 0x00, //g
-0x00, 0x02, 0xFE, 0x10, 0x10, 0xF0, 0x00, 0x00, //h
-0x00, 0x00, 0x00, 0xFA, 0x00, 0x00, 0x00, 0x00, //i
-0x00, 0x40, 0x80, 0x80, 0x7A, 0x00, 0x00, 0x00, //j
-0x00, 0x00, 0xFC, 0x10, 0x30, 0xCC, 0x00, 0x00, //k
-0x00, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x00, 0x00, //l
-0x00, 0xF0, 0x08, 0x08, 0x38, 0x08, 0x08, 0xF0, //m
-0x00, 0x08, 0xF8, 0x08, 0xF8, 0x80, 0x00, 0x00, //n
-0x00, 0x00, 0x70, 0x88, 0x88, 0x70, 0x00, 0x00, //o
-0x00, 0x02, 0xFE, 0x12, 0x12, 0x0C, 0x00, 0x00, //p
-0x00, 0x00, 0x0C, 0x12, 0x12, 0xFE, 0x80, 0x00, //q
-0x00, 0x84, 0xFC, 0x82, 0x02, 0x02, 0x04, 0x00, //r
-0x00, 0x0C, 0x92, 0x92, 0x92, 0x64, 0x00, 0x00, //s
-0x00, 0x00, 0x04, 0xFE, 0x84, 0xC0, 0x00, 0x00, //t
-0x00, 0x00, 0xF8, 0x80, 0x80, 0xF8, 0x00, 0x00, //u
-0x00, 0x00, 0x78, 0x80, 0x80, 0x78, 0x00, 0x00, //v
-0x00, 0x78, 0x80, 0x80, 0xE0, 0x80, 0x80, 0x78, //w
-0x00, 0x84, 0x48, 0x30, 0x48, 0x84, 0x00, 0x00, //x
-0x00, 0x00, 0x4C, 0x90, 0x90, 0x7C, 0x00, 0x00, //y
-0x00, 0x00, 0xC4, 0xA4, 0x94, 0x8C, 0x00, 0x00, //z
-0x00, 0x00, 0x02, 0xB1, 0x09, 0x06, 0x00, 0x00, //?
-0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0x00, //!
-0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, //.
-0x00, 0x7E, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, //(
-0x00, 0x81, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, //)
-0x00, 0x00, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, //:
-0x00, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x00, // %
-0x00, 0x46, 0x26, 0x10, 0x08, 0x64, 0x62, 0x00, // /
-0x00, 0x10, 0x10, 0x10, 0x10, 0x54, 0x38, 0x10, // > -> seta pra direita
-0x00, 0x10, 0x38, 0x54, 0x10, 0x10, 0x10, 0x10, // < <- seta pra esquerda
-0x00, 0x00, 0x04, 0x02, 0x7F, 0x02, 0x04, 0x00, // |    seta pra cima
-0x00, 0x00, 0x10, 0x20, 0x7F, 0x20, 0x10, 0x00, // \    seta pra baixo
+#define FONT_BLOCK_SHIFT 2
+#define FONT_BLOCK (1u << FONT_BLOCK_SHIFT)
+#define FONT_BLOCK_EMPTY 0xFFFF         // Bloco sem glifos
+#define FONT_MIRRORED 0x80
+#define FONT_MISSING 0xF0               // Código sem glifo num bloco com outros: 1 byte, nenhuma coluna
+#define FONT_MAX_WIDTH 8
 
-};
+typedef enum {
+  FONT_COMPRESSED,
+  FONT_CELLS
+} font_format_t;
 
+typedef struct {
+  uint8_t width;                        // Colunas do desenho (até FONT_MAX_WIDTH)
+  uint8_t height;                       // Linhas (até 8: uma página do display)
+  uint8_t advance;                      // Avanço horizontal: largura + espaçamento
+  uint8_t first, last;                  // Faixa de códigos Latin-1 coberta
+  uint8_t fallback;                     // Desenhado no lugar dos códigos sem glifo
+  uint8_t format;                       // font_format_t
+  const uint16_t *blocks;               // FONT_COMPRESSED: deslocamento em glyphs do início de cada bloco
+  const uint32_t *present;              // FONT_CELLS: códigos com glifo, 32 por palavra
+  const uint8_t *rank;                  // FONT_CELLS: glifos antes de cada palavra de present
+  const uint8_t *glyphs;                // Glifos em ordem de código
+} font_t;
+
+extern const font_t font_8x8;           // Fonte original do projeto, 16 caracteres por linha
+extern const font_t font_5x7;           // Compacta, 21 caracteres por linha
+
+// Colunas guardadas de um glifo comprimido
+static inline uint8_t font_stored_columns(uint8_t header) {
+  uint8_t n = header & 0x0F;
+  return (header & FONT_MIRRORED) ? (uint8_t)((n + 1) >> 1) : n;
+}
+
+// @return NULL para código sem glifo
+static inline const uint8_t *font_locate(const font_t *font, uint8_t c) {
+  uint8_t i = c - font->first;
+  if (font->format == FONT_CELLS) {
+    uint32_t palavra = font->present[i >> 5];
+    uint32_t bit = 1u << (i & 31);
+    if (!(palavra & bit))
+      return NULL;
+    return font->glyphs + (font->rank[i >> 5] + __builtin_popcount(palavra & (bit - 1))) * font->width;
+  }
+  uint16_t bloco = font->blocks[i >> FONT_BLOCK_SHIFT];
+  if (bloco == FONT_BLOCK_EMPTY)
+    return NULL;
+  const uint8_t *g = font->glyphs + bloco;
+  for (i &= FONT_BLOCK - 1; i; --i)
+    g += 1 + font_stored_columns(*g);
+  return *g == FONT_MISSING ? NULL : g;
+}
+
+/*
+* Glifo de um código Latin-1
+* @return Ponteiro para o cabeçalho (FONT_COMPRESSED) ou a primeira coluna
+* (FONT_CELLS); códigos sem glifo dão o de font->fallback
+*/
+static inline const uint8_t *font_glyph(const font_t *font, uint8_t c) {
+  if (c >= font->first && c <= font->last) {
+    const uint8_t *g = font_locate(font, c);
+    if (g)
+      return g;
+  }
+  return font_locate(font, font->fallback);
+}
+
+/*
+* Próximo código de uma string UTF-8, limitado a Latin-1
+* @param str Avança para o caractere seguinte
+* @return Código Latin-1; fora dele, '?'. Bytes que não formam UTF-8 válido
+* são tomados como Latin-1, então strings já em Latin-1 também funcionam.
+*/
+static inline uint8_t font_next_code(const char **str) {
+  const uint8_t *s = (const uint8_t *)*str;
+  uint8_t c = *s++;
+  if (c >= 0xC0 && (*s & 0xC0) == 0x80) {
+    if (c < 0xC4) {
+      c = (uint8_t)((c << 6) | (*s++ & 0x3F));  // U+0080-U+00FF
+    } else {
+      while ((*s & 0xC0) == 0x80)
+        s++;
+      c = '?';
+    }
+  }
+  *str = (const char *)s;
+  return c;
+}
+
+#endif // FONT_H
@@ -0,0 +1,189 @@
+// Gerado por tools/gerar_fonte a partir de lib/fontes/8x8.txt; não editar.
+// 122 glifos 8x8, códigos 0x20-0xFC, comprimidos: 714 bytes de glifos + 112 de índice
+// (células fixas: 976 + 35)
+
+static const uint8_t font_8x8_glyphs[714] __in_flash("fontes") = {
+    0x00,                                                 // 0x20  
+    0x31, 0xBF,                                           // 0x21 !
+    0xA3, 0x03, 0x00,                                     // 0x22 "
+    0x87, 0x22, 0x7F, 0x22, 0x22,                         // 0x23 #
+    0x07, 0x24, 0x2A, 0x2A, 0x7F, 0x2A, 0x2A, 0x12,       // 0x24 $
+    0x16, 0x46, 0x26, 0x10, 0x08, 0x64, 0x62,             // 0x25 %
+    0x07, 0x22, 0x55, 0x49, 0x55, 0x22, 0x20, 0x50,       // 0x26 &
+    0x31, 0x03,                                           // 0x27 '
+    0x12, 0x7E, 0x81,                                     // 0x28 (
+    0x12, 0x81, 0x7E,                                     // 0x29 )
+    0x87, 0x22, 0x14, 0x08, 0x3E,                         // 0x2A *
+    0x87, 0x08, 0x08, 0x08, 0x3E,                         // 0x2B +
+    0x22, 0x80, 0x40,                                     // 0x2C ,
+    0x95, 0x08, 0x08, 0x08,                               // 0x2D -
+    0x31, 0x80,                                           // 0x2E .
+    0x16, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02,             // 0x2F /
+    0x87, 0x3E, 0x41, 0x41, 0x49,                         // 0x30 0
+    0x23, 0x42, 0x7F, 0x40,                               // 0x31 1
+    0x06, 0x30, 0x49, 0x49, 0x49, 0x49, 0x46,             // 0x32 2
+    0x07, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36,       // 0x33 3
+    0x06, 0x3F, 0x20, 0x20, 0x78, 0x20, 0x20,             // 0x34 4
+    0x06, 0x4F, 0x49, 0x49, 0x49, 0x49, 0x30,             // 0x35 5
+    0x07, 0x3F, 0x48, 0x48, 0x48, 0x48, 0x48, 0x30,       // 0x36 6
+    0x07, 0x01, 0x01, 0x01, 0x61, 0x31, 0x0D, 0x03,       // 0x37 7
+    0x87, 0x36, 0x49, 0x49, 0x49,                         // 0x38 8
+    0x07, 0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7F,       // 0x39 9
+    0x21, 0x42,                                           // 0x3A :
+    0x12, 0x80, 0x42,                                     // 0x3B ;
+    0x17, 0x10, 0x38, 0x54, 0x10, 0x10, 0x10, 0x10,       // 0x3C <
+    0x95, 0x14, 0x14, 0x14,                               // 0x3D =
+    0x17, 0x10, 0x10, 0x10, 0x10, 0x54, 0x38, 0x10,       // 0x3E >
+    0x24, 0x02, 0xB1, 0x09, 0x06,                         // 0x3F ?
+    0x07, 0x3E, 0x41, 0x5D, 0x55, 0x5D, 0x51, 0x4E,       // 0x40 @
+    0x87, 0x78, 0x14, 0x12, 0x11,                         // 0x41 A
+    0x87, 0x7F, 0x49, 0x49, 0x49,                         // 0x42 B
+    0x07, 0x7E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41,       // 0x43 C
+    0x07, 0x7F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7E,       // 0x44 D
+    0x07, 0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49,       // 0x45 E
+    0x07, 0x7F, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01,       // 0x46 F
+    0x07, 0x7F, 0x41, 0x41, 0x41, 0x51, 0x51, 0x73,       // 0x47 G
+    0x87, 0x7F, 0x08, 0x08, 0x08,                         // 0x48 H
+    0x31, 0x7F,                                           // 0x49 I
+    0x07, 0x21, 0x41, 0x41, 0x3F, 0x01, 0x01, 0x01,       // 0x4A J
+    0x16, 0x7F, 0x08, 0x08, 0x14, 0x22, 0x41,             // 0x4B K
+    0x07, 0x7F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,       // 0x4C L
+    0x87, 0x7F, 0x02, 0x04, 0x08,                         // 0x4D M
+    0x07, 0x7F, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7F,       // 0x4E N
+    0x87, 0x3E, 0x41, 0x41, 0x41,                         // 0x4F O
+    0x07, 0x7F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E,       // 0x50 P
+    0x07, 0x3E, 0x41, 0x41, 0x49, 0x51, 0x61, 0x7E,       // 0x51 Q
+    0x07, 0x7F, 0x11, 0x11, 0x11, 0x31, 0x51, 0x0E,       // 0x52 R
+    0x06, 0x46, 0x49, 0x49, 0x49, 0x49, 0x30,             // 0x53 S
+    0x87, 0x01, 0x01, 0x01, 0x7F,                         // 0x54 T
+    0x87, 0x3F, 0x40, 0x40, 0x40,                         // 0x55 U
+    0x87, 0x0F, 0x10, 0x20, 0x40,                         // 0x56 V
+    0x87, 0x7F, 0x20, 0x10, 0x08,                         // 0x57 W
+    0x96, 0x41, 0x22, 0x14,                               // 0x58 X
+    0x87, 0x01, 0x02, 0x04, 0x78,                         // 0x59 Y
+    0x06, 0x41, 0x61, 0x59, 0x45, 0x43, 0x41,             // 0x5A Z
+    0x13, 0xFF, 0x81, 0x81,                               // 0x5B [
+    0xA5, 0x10, 0x20, 0x7F,                               // 0x5C
+    0x13, 0x81, 0x81, 0xFF,                               // 0x5D ]
+    0x95, 0x04, 0x02, 0x01,                               // 0x5E ^
+    0x87, 0x80, 0x80, 0x80, 0x80,                         // 0x5F _
+    0x22, 0x01, 0x02,                                     // 0x60 `
+    0x25, 0x64, 0x92, 0x92, 0xFC, 0x80,                   // 0x61 a
+    0x16, 0x02, 0xFE, 0x88, 0x88, 0x88, 0x70,             // 0x62 b
+    0x14, 0x78, 0x84, 0x84, 0x84,                         // 0x63 c
+    0x16, 0x70, 0x88, 0x88, 0x88, 0xFE, 0x80,             // 0x64 d
+    0x15, 0x7C, 0x92, 0x92, 0x92, 0x0C,                   // 0x65 e
+    0x23, 0x08, 0xFE, 0x0A,                               // 0x66 f
+    0x15, 0x0C, 0x92, 0x92, 0x92, 0x7C,                   // 0x67 g
+    0x15, 0x02, 0xFE, 0x10, 0x10, 0xF0,                   // 0x68 h
+    0x31, 0xFA,                                           // 0x69 i
+    0x14, 0x40, 0x80, 0x80, 0x7A,                         // 0x6A j
+    0x24, 0xFC, 0x10, 0x30, 0xCC,                         // 0x6B k
+    0x31, 0xFE,                                           // 0x6C l
+    0x97, 0xF0, 0x08, 0x08, 0x38,                         // 0x6D m
+    0x15, 0x08, 0xF8, 0x08, 0xF8, 0x80,                   // 0x6E n
+    0xA4, 0x70, 0x88,                                     // 0x6F o
+    0x15, 0x02, 0xFE, 0x12, 0x12, 0x0C,                   // 0x70 p
+    0x25, 0x0C, 0x12, 0x12, 0xFE, 0x80,                   // 0x71 q
+    0x16, 0x84, 0xFC, 0x82, 0x02, 0x02, 0x04,             // 0x72 r
+    0x15, 0x0C, 0x92, 0x92, 0x92, 0x64,                   // 0x73 s
+    0x24, 0x04, 0xFE, 0x84, 0xC0,                         // 0x74 t
+    0xA4, 0xF8, 0x80,                                     // 0x75 u
+    0xA4, 0x78, 0x80,                                     // 0x76 v
+    0x97, 0x78, 0x80, 0x80, 0xE0,                         // 0x77 w
+    0x95, 0x84, 0x48, 0x30,                               // 0x78 x
+    0x24, 0x4C, 0x90, 0x90, 0x7C,                         // 0x79 y
+    0x24, 0xC4, 0xA4, 0x94, 0x8C,                         // 0x7A z
+    0x14, 0x08, 0x76, 0x81, 0x81,                         // 0x7B {
+    0xA5, 0x04, 0x02, 0x7F,                               // 0x7C |
+    0x14, 0x81, 0x81, 0x76, 0x08,                         // 0x7D }
+    0x07, 0x10, 0x08, 0x08, 0x10, 0x10, 0x10, 0x08,       // 0x7E ~
+    0xF0,                                                 // 0x7F
+    0x94, 0x02, 0x05,                                     // 0xB0
+    0xF0,                                                 // 0xB1
+    0xF0,                                                 // 0xB2
+    0xF0,                                                 // 0xB3
+    0x07, 0x70, 0x28, 0x25, 0x26, 0x24, 0x28, 0x70,       // 0xC0
+    0x07, 0x70, 0x28, 0x24, 0x26, 0x25, 0x28, 0x70,       // 0xC1
+    0x87, 0x70, 0x28, 0x26, 0x25,                         // 0xC2
+    0x07, 0x70, 0x2A, 0x25, 0x25, 0x26, 0x2A, 0x71,       // 0xC3
+    0xF0,                                                 // 0xC4
+    0xF0,                                                 // 0xC5
+    0xF0,                                                 // 0xC6
+    0x07, 0x7E, 0x41, 0xC1, 0xC1, 0x41, 0x41, 0x41,       // 0xC7
+    0xF0,                                                 // 0xC8
+    0x07, 0x7C, 0x54, 0x54, 0x56, 0x55, 0x54, 0x44,       // 0xC9
+    0x07, 0x7C, 0x54, 0x56, 0x55, 0x56, 0x54, 0x44,       // 0xCA
+    0xF0,                                                 // 0xCB
+    0xF0,                                                 // 0xCC
+    0x32, 0x7E, 0x01,                                     // 0xCD
+    0xF0,                                                 // 0xCE
+    0xF0,                                                 // 0xCF
+    0xF0,                                                 // 0xD0
+    0xF0,                                                 // 0xD1
+    0xF0,                                                 // 0xD2
+    0x07, 0x38, 0x44, 0x44, 0x46, 0x45, 0x44, 0x38,       // 0xD3
+    0x87, 0x38, 0x44, 0x46, 0x45,                         // 0xD4
+    0x07, 0x38, 0x46, 0x45, 0x45, 0x46, 0x46, 0x39,       // 0xD5
+    0xF0,                                                 // 0xD6
+    0xF0,                                                 // 0xD7
+    0xF0,                                                 // 0xD8
+    0xF0,                                                 // 0xD9
+    0x07, 0x3C, 0x40, 0x40, 0x42, 0x41, 0x40, 0x3C,       // 0xDA
+    0xF0,                                                 // 0xDB
+    0x87, 0x3C, 0x40, 0x42, 0x40,                         // 0xDC
+    0xF0,                                                 // 0xDD
+    0xF0,                                                 // 0xDE
+    0xF0,                                                 // 0xDF
+    0x15, 0x40, 0xA9, 0xAA, 0xA8, 0xF0,                   // 0xE0
+    0x15, 0x40, 0xA8, 0xAA, 0xA9, 0xF0,                   // 0xE1
+    0x15, 0x40, 0xAA, 0xA9, 0xA9, 0xF2,                   // 0xE2
+    0x16, 0x42, 0xA9, 0xA9, 0xAA, 0xF2, 0x01,             // 0xE3
+    0xF0,                                                 // 0xE4
+    0xF0,                                                 // 0xE5
+    0xF0,                                                 // 0xE6
+    0x14, 0x1C, 0xA2, 0xE2, 0x22,                         // 0xE7
+    0xF0,                                                 // 0xE8
+    0x15, 0x70, 0xA8, 0xAA, 0xA9, 0x10,                   // 0xE9
+    0x15, 0x70, 0xAA, 0xA9, 0xA9, 0x12,                   // 0xEA
+    0xF0,                                                 // 0xEB
+    0xF0,                                                 // 0xEC
+    0x32, 0xFA, 0x01,                                     // 0xED
+    0xF0,                                                 // 0xEE
+    0xF0,                                                 // 0xEF
+    0xF0,                                                 // 0xF0
+    0xF0,                                                 // 0xF1
+    0xF0,                                                 // 0xF2
+    0x24, 0x70, 0x8A, 0x89, 0x70,                         // 0xF3
+    0xA4, 0x72, 0x89,                                     // 0xF4
+    0x16, 0x02, 0x71, 0x89, 0x8A, 0x72, 0x01,             // 0xF5
+    0xF0,                                                 // 0xF6
+    0xF0,                                                 // 0xF7
+    0xF0,                                                 // 0xF8
+    0xF0,                                                 // 0xF9
+    0x24, 0xF8, 0x82, 0x81, 0xF8,                         // 0xFA
+    0xF0,                                                 // 0xFB
+    0xA4, 0xFA, 0x80,                                     // 0xFC
+};
+
+static const uint16_t font_8x8_blocks[56] __in_flash("fontes") = {
+    0, 11, 36, 52, 68, 92, 122, 140,
+    165, 191, 223, 245, 271, 302, 322, 342,
+    359, 380, 403, 421, 437, 462, 478, 497,
+    FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY,
+    FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, 515, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY, FONT_BLOCK_EMPTY,
+    521, 550, 561, 579, 585, 596, 611, 622,
+    630, 655, 663, 677, 683, 691, 703, 711,
+};
+
+const font_t font_8x8 __in_flash("fontes") = {
+    .width = 8,
+    .height = 8,
+    .advance = 8,
+    .first = 0x20,
+    .last = 0xFC,
+    .fallback = 0x3F,
+    .format = FONT_COMPRESSED,
+    .blocks = font_8x8_blocks,
+    .glyphs = font_8x8_glyphs,
+};
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include "hardware/clocks.h"
 #include "pico/stdlib.h"
+#include "utils/rastreio.h"
 
 
 // Buffer de pixels que formam a matriz.
@@ -62,6 +63,7 @@ void npClear() {
  * Escreve os dados do buffer nos LEDs.
  */
 void npWrite() {
+    RASTREIO_ESCOPO(PONTO_NEOPIXEL);
     // Escreve cada dado de 8-bits dos pixels em sequência no buffer da máquina PIO.
     for (uint i = 0; i < LED_COUNT; ++i) {
         pio_sm_put_blocking(np_pio, sm, leds[i].G);
@@ -13,6 +13,9 @@ typedef struct {
     uint8_t G, R, B; // Três valores de 8-bits compõem um pixel.
 } npLED_t;
 
+// Buffer de pixels enviado por npWrite (ordem da cadeia, ver getIndex)
+extern npLED_t leds[LED_COUNT];
+
 // Funções para controle dos LEDs
 void npInit(uint pin);
 void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b);
@@ -1,16 +1,73 @@
 #include "ssd1306.h"
-#include "font.h"
+#include "utils/formatacao.h"
+#include "utils/rastreio.h"
+#include <string.h>
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
-  ssd->width = width;
-  ssd->height = height;
-  ssd->pages = height / 8U;
+  // ram_buffer tem tamanho fixo: desenho e envio não podem passar dele
+  ssd->width = width < WIDTH ? width : WIDTH;
+  ssd->height = height < HEIGHT ? height : HEIGHT;
+  ssd->pages = ssd->height / 8U;
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  memset(ssd->ram_buffer, 0, sizeof(ssd->ram_buffer));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->font = &font_8x8;
+  ssd->stats_overlay = false;
+  ssd1306_reset_stats(ssd);
+}
+
+/*
+* Escreve uma transação com timeout proporcional ao tamanho e contabiliza
+* duração, bytes e erros (o SDK devolve PICO_ERROR_GENERIC em NACK)
+*/
+static int ssd1306_write(ssd1306_t *ssd, const uint8_t *data, size_t len) {
+  uint timeout = SSD1306_TIMEOUT_MIN_US + (uint)(len + 1) * SSD1306_TIMEOUT_US_PER_BYTE;
+  uint32_t start = time_us_32();
+  int ret = i2c_write_timeout_us(ssd->i2c_port, ssd->address, data, len, false, timeout);
+  uint32_t elapsed = time_us_32() - start;
+
+  ssd1306_stats_t *st = &ssd->stats;
+  st->transactions++;
+  st->busy_us += elapsed;
+  if (elapsed > st->max_us)
+    st->max_us = elapsed;
+  uint bin = elapsed ? 32 - __builtin_clz(elapsed) : 0;
+  st->histogram[bin < SSD1306_HIST_BINS ? bin : SSD1306_HIST_BINS - 1]++;
+
+  if (ret == (int)len) {
+    st->bytes += len;
+  } else {
+    if (ret == PICO_ERROR_TIMEOUT)
+      st->timeouts++;
+    else
+      st->nacks++;
+    st->last_error = ret;
+  }
+  return ret;
+}
+
+// Resumo de uma linha na fonte compacta: último e maior quadro, ocupação do
+// barramento e erros
+static void ssd1306_draw_overlay(ssd1306_t *ssd) {
+  const ssd1306_stats_t *st = &ssd->stats;
+  const font_t *font = ssd->font;
+  char line[24];
+  Texto t;
+  texto_iniciar(&t, line, sizeof(line));
+  texto_fixo(&t, (int32_t)(st->frame_us / 100), 1);
+  texto_car(&t, '/');
+  texto_fixo(&t, (int32_t)(st->frame_max_us / 100), 1);
+  texto_str(&t, "ms ");
+  texto_percentual(&t, ssd1306_bus_busy_permille(ssd) / 10);
+  texto_str(&t, " E");
+  texto_natural(&t, st->nacks + st->timeouts);
+  ssd1306_rect(ssd, ssd->height - 8, 0, ssd->width, 8, false, true);
+  ssd->font = &font_5x7;
+  ssd1306_draw_string(ssd, line, 0, ssd->height - 8);
+  ssd->font = font;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -43,29 +100,28 @@ void ssd1306_config(ssd1306_t *ssd) {
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
+  ssd->stats.commands++;
+  ssd1306_write(ssd, ssd->port_buffer, 2);
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
+  RASTREIO_ESCOPO(PONTO_OLED);
+  if (ssd->stats_overlay)
+    ssd1306_draw_overlay(ssd);
+  uint32_t start = time_us_32();
   ssd1306_command(ssd, SET_COL_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->width - 1);
   ssd1306_command(ssd, SET_PAGE_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  ssd1306_write(ssd, ssd->ram_buffer, ssd->bufsize);
+
+  ssd1306_stats_t *st = &ssd->stats;
+  st->frames++;
+  st->frame_us = time_us_32() - start;
+  if (st->frame_us > st->frame_max_us)
+    st->frame_max_us = st->frame_us;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
@@ -77,24 +133,11 @@ void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  // Byte 0 do buffer é o comando de dados; o resto são 8 pixels por byte
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
   for (uint8_t x = left; x < left + width; ++x) {
     ssd1306_pixel(ssd, x, top, value);
@@ -156,98 +199,121 @@ void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value
 // Função para desenhar um caractere
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
-  uint16_t index = 0;
+  const font_t *font = ssd->font;
+  if (x >= ssd->width)
+    return;
 
-  // Verifica as letras maiúsculas
-  if (c >= 'A' && c <= 'Z')
+  // Descomprime o glifo (lib/font.h) nas colunas da célula: as vazias à
+  // esquerda e à direita ficam zeradas e a metade espelhada é copiada
+  uint8_t cell[FONT_MAX_WIDTH] = {0};
+  const uint8_t *glyph = font_glyph(font, (uint8_t)c);
+  uint8_t i = 0;
+  if (font->format == FONT_CELLS)
   {
-    index = (c - 'A' + 11) * 8; // Para letras maiúsculas
+    for (; i < font->width; ++i)
+      cell[i] = glyph[i];
   }
-  // Verifica os números
-  else if (c >= '0' && c <= '9')
+  else
   {
-    index = (c - '0' + 1) * 8; // Para os números
+    uint8_t header = *glyph++;
+    uint8_t left = (header >> 4) & 0x07;
+    uint8_t columns = header & 0x0F;
+    if (columns > FONT_MAX_WIDTH - left)
+      columns = FONT_MAX_WIDTH - left;  // Só com tabela corrompida
+    uint8_t *dest = &cell[left];
+    for (uint8_t stored = font_stored_columns(header); i < stored; ++i)
+      dest[i] = glyph[i];
+    for (; i < columns; ++i)
+      dest[i] = dest[columns - 1 - i];
   }
-  // Verifica as letras minúsculas
-  else if (c >= 'a' && c <= 'z')
+
+  // Cada coluna é um byte no mesmo formato dos bytes do buffer: ocupa uma
+  // página inteira (y múltiplo de 8) ou se divide entre duas páginas
+  // vizinhas. A célula inteira (avanço x altura) é sobrescrita.
+  uint8_t advance = font->advance;
+  if (advance > ssd->width - x)
+    advance = ssd->width - x;
+  uint8_t pagina = y >> 3;
+  uint8_t deslocamento = y & 7;
+  uint8_t mascara = 0xFF >> (8 - font->height);
+  uint8_t *coluna = &ssd->ram_buffer[(x << 3) + 1 + pagina];
+  if (!deslocamento && mascara == 0xFF)
   {
-    index = (c - 'a' + 11 + 26) * 8; // Para letras minúsculas
+    if (pagina < ssd->pages)
+      for (i = 0; i < advance; ++i)
+        coluna[i << 3] = cell[i];
+    return;
   }
-  // Caso de caracteres especiais
-  else
+  uint8_t mascara_cima = ~(mascara << deslocamento);
+  uint8_t mascara_baixo = ~(mascara >> (8 - deslocamento));
+  if (pagina + 1 < ssd->pages)
   {
-    index = (11 + 26 + 26) * 8;
-
-    switch (c)
+    for (i = 0; i < advance; ++i, coluna += 8)
     {
-    case '?':
-      break;
-    case '!':
-      index += (1 * 8);
-      break;
-    case '.':
-      index += (2 * 8);
-      break;
-    case '(':
-      index += (3 * 8);
-      break;
-    case ')':
-      index += (4 * 8);
-      break;
-    case ':':
-      index += (5 * 8);
-      break;
-    case '/':
-      index += (6 * 8);
-      break;
-    case '%':
-      index += (7 * 8);
-      break;
-    case '>':
-      index += (8 * 8);
-      break;
-    case '<':
-      index += (9 * 8);
-      break;
-    case '|': // seta pra baixo
-      index += (10 * 8);
-      break;
-    case '\\':
-      index += (11 * 8);
-      break;
-    
-    default:
-      index = 0;  // Para qualquer caractere não reconhecido
-      break;
+      coluna[0] = (coluna[0] & mascara_cima) | (cell[i] << deslocamento);
+      coluna[1] = (coluna[1] & mascara_baixo) | (cell[i] >> (8 - deslocamento));
     }
   }
-  
-  for (uint8_t i = 0; i < 8; ++i)
+  else if (pagina < ssd->pages)
   {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
-    }
+    // Última página: a parte de baixo da célula sai da tela
+    for (i = 0; i < advance; ++i, coluna += 8)
+      coluna[0] = (coluna[0] & mascara_cima) | (cell[i] << deslocamento);
   }
 }
 
-// Função para desenhar uma string
+// Função para desenhar uma string (UTF-8), quebrando a linha na borda direita
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
 {
+  const font_t *font = ssd->font;
   while (*str)
   {
-    ssd1306_draw_char(ssd, *str++, x, y);
-    x += 8;
-    if (x + 8 >= ssd->width)
+    if (x + font->advance > ssd->width)
     {
       x = 0;
-      y += 8;
+      y += font->height;
     }
-    if (y + 8 >= ssd->height)
+    if (y + font->height > ssd->height)
     {
       break;
     }
+    ssd1306_draw_char(ssd, (char)font_next_code(&str), x, y);
+    x += font->advance;
   }
 }
 
+void ssd1306_set_font(ssd1306_t *ssd, const font_t *font) {
+  ssd->font = font;
+}
+
+// Largura em pixels de uma string UTF-8 numa linha só, com a fonte atual
+uint16_t ssd1306_text_width(const ssd1306_t *ssd, const char *str) {
+  uint16_t n = 0;
+  while (*str) {
+    font_next_code(&str);
+    n++;
+  }
+  return n * ssd->font->advance;
+}
+
+const ssd1306_stats_t *ssd1306_get_stats(const ssd1306_t *ssd) {
+  return &ssd->stats;
+}
+
+void ssd1306_reset_stats(ssd1306_t *ssd) {
+  memset(&ssd->stats, 0, sizeof(ssd->stats));
+  ssd->stats.since_us = time_us_64();
+}
+
+// Fração do tempo desde o início da janela gasta no barramento, em milésimos
+uint32_t ssd1306_bus_busy_permille(const ssd1306_t *ssd) {
+  uint64_t window = time_us_64() - ssd->stats.since_us;
+  if (window == 0)
+    return 0;
+  uint64_t permille = ssd->stats.busy_us * 1000 / window;
+  return permille > 1000 ? 1000 : (uint32_t)permille;
+}
+
+void ssd1306_set_stats_overlay(ssd1306_t *ssd, bool enabled) {
+  ssd->stats_overlay = enabled;
+}
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "font.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -14,6 +15,9 @@
 #define I2C_SCL 15
 #define endereco 0x3C
 
+// Framebuffer estático: byte de controle 0x40 + 8 pixels por byte
+#define SSD1306_BUFSIZE (WIDTH * HEIGHT / 8 + 1)
+
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -35,15 +39,38 @@ typedef enum {
   SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
+// Contabilidade do barramento I2C do display
+#define SSD1306_HIST_BINS 16            // Duração por transação: faixa k = [2^(k-1), 2^k) us
+#define SSD1306_TIMEOUT_MIN_US 2000     // Folga fixa do timeout de cada transação
+#define SSD1306_TIMEOUT_US_PER_BYTE 180 // 9 bits a 50 kHz: o dobro do pior caso a 100 kHz
+
+typedef struct {
+  uint32_t transactions;                // Comandos e escritas de dados
+  uint32_t commands;
+  uint32_t frames;                      // ssd1306_send_data completos
+  uint64_t bytes;                       // Bytes escritos com sucesso
+  uint64_t busy_us;                     // Tempo dentro de i2c_write_timeout_us
+  uint32_t nacks, timeouts;
+  int last_error;                       // Último código de erro do SDK (0 sem erro)
+  uint32_t max_us;                      // Transação mais longa
+  uint32_t frame_us, frame_max_us;      // Último e maior quadro (comandos + dados)
+  uint32_t histogram[SSD1306_HIST_BINS];
+  uint64_t since_us;                    // Início da janela (init ou reset)
+} ssd1306_stats_t;
+
 typedef struct {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  uint8_t ram_buffer[SSD1306_BUFSIZE]; // Telas de até WIDTH x HEIGHT
   size_t bufsize;
   uint8_t port_buffer[2];
+  const font_t *font;                   // Fonte do texto (font_8x8 após o init)
+  ssd1306_stats_t stats;
+  bool stats_overlay;                   // Desenha o resumo na última linha a cada quadro
 } ssd1306_t;
 
+// Dimensões acima de WIDTH x HEIGHT são limitadas ao framebuffer estático
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
@@ -58,4 +85,14 @@ void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
 
+// Texto: draw_char recebe um código Latin-1; draw_string e text_width, UTF-8
+void ssd1306_set_font(ssd1306_t *ssd, const font_t *font);
+uint16_t ssd1306_text_width(const ssd1306_t *ssd, const char *str);
+
+// Estatísticas do barramento
+const ssd1306_stats_t *ssd1306_get_stats(const ssd1306_t *ssd);
+void ssd1306_reset_stats(ssd1306_t *ssd);
+uint32_t ssd1306_bus_busy_permille(const ssd1306_t *ssd);
+void ssd1306_set_stats_overlay(ssd1306_t *ssd, bool enabled);
+
 #endif // SSD1306_H
\ No newline at end of file
@@ -2,14 +2,37 @@
 * INCLUDES E DEFINES
 **********************************/
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
+#include "hardware/clocks.h"
 #include "lib/ssd1306.h"
 #include "lib/neopixel.h"
 #include "lib/buzzer.h"
+#include "lib/flash_rp2040.h"
 #include "utils/hardware_config.h"
+#include "utils/maquina_estados.h"
+#include "utils/espectral.h"
+#include "utils/deteccao.h"
+#include "utils/classificador.h"
+#include "utils/filtro.h"
+#include "utils/plantas.h"
+#include "utils/registro.h"
+#include "utils/campo.h"
+#include "utils/flash_log.h"
+#include "utils/exportacao.h"
+#include "utils/console.h"
+#include "utils/crc.h"
+#include "utils/gravacao.h"
+#include "utils/epidemia.h"
+#include "utils/planejador.h"
+#include "utils/autoteste.h"
+#include "utils/rastreio.h"
+#include "utils/microbench.h"
+#include "utils/memoria.h"
+#include "utils/formatacao.h"
 
 // Configurações de display
 #define TAMANHO_FONTE 8       // Tamanho da fonte em pixels
@@ -17,51 +40,70 @@
 #define TEMPO_TROCA_MENSAGEM 3000 // Tempo de rotação das mensagens
 
 // Configurações do jogo
-#define NUM_PLANTAS 5          // Número total de plantas
-#define FOLHAS_POR_PLANTA 5    // Folhas por planta
+#define CAMPO_FILEIRAS 4       // Fileiras do talhão de demonstração
+#define CAMPO_COLUNAS 25       // Plantas por fileira
 #define CUSTO_POR_FUNGICIDA 10 // Custo em recursos do tratamento
+#define SEMENTE_CAMPO 2024     // Semente do talhão de demonstração (mesmo campo a cada boot)
+#define ORCAMENTO_FUNGICIDA 100 // Orçamento padrão do plano de tratamento
 
-/**********************************
-* TIPOS DE DADOS
-**********************************/
-// Estrutura para armazenar reflectâncias
+// Instrumentação
+#define INTERVALO_RELATORIO_FSM 30000 // Intervalo entre relatórios da FSM pela serial (ms)
 
-typedef struct {
-    float R;    // Reflectância no vermelho
-    float G;    // Reflectância no verde
-    float B;    // Reflectância no azul
-    float NIR;  // Reflectância no infravermelho
-} Reflectancia;
+// Histórico em flash
+#define HISTORICO_SINCRONIZAR_MS 2000 // Ociosidade após a última análise antes de gravar a página parcial
 
-// Estados do sistema de escaneamento
-typedef enum {
-    MODO_ESCANEAMENTO,
-    ANALISE
-} EstadoEscaneamento;
+// Exportação do histórico
+#define QUADROS_POR_LOTE 8            // Quadros enviados entre verificações do prazo
+
+// Gravação de entradas
+#define BYTES_POR_LINHA_TRACE 32      // Bytes por linha no despejo do comando "trace"
 
+// Simulação de propagação
+#define SIM_LARGURA 256               // Grade padrão do comando "simular"
+#define SIM_ALTURA 112
+#define SIM_CHANCE 26                 // Chance de transmissão por vizinho por dia (/256, ~10%)
+#define SIM_FOCOS 6                   // Focos iniciais sorteados
+#define SIM_MAX_PALAVRAS EPIDEMIA_PALAVRAS(256, 192) // Memória estática da grade (18 KB)
+#define SIM_TOPO_GRADE 8              // Primeira linha do OLED com a grade (acima, o cabeçalho)
+#define SIM_TAM_CURSOR 8              // Lado do cursor de tratamento, em pixels do OLED
+
+// Plano de tratamento
+#define PLANO_ITENS_PAGINA 4          // Plantas por página da lista no OLED
+
+/**********************************
+* TIPOS DE DADOS
+**********************************/
 // Estados principais da máquina de estados
 typedef enum {
     ESTADO_MENU,
     ESTADO_SELECIONAR_FOLHA,
     ESTADO_ANALISAR,
-    ESTADO_ESCANEAMENTO,
+    ESTADO_ESCANEAMENTO,           // Calibração/ajuste das reflectâncias
+    ESTADO_ANALISAR_ESCANEAMENTO,  // Resultado da análise dos valores calibrados
+    ESTADO_SIMULACAO,              // Propagação da infecção na grade (comando "simular")
+    ESTADO_PLANO,                  // Lista priorizada de tratamentos (comando "plano")
+    NUM_ESTADOS
 } Estado;
 
-// Estado de uma folha individual
-typedef struct {
-    Reflectancia reflectancia; // Valores espectrais
-    float ndvi, gndvi;         // Índices de vegetação
-    bool visivel;              // Infecção visível a olho nu
-    bool infectada;            // Status de infecção
-} EstadoFolha;
-
-// Estrutura completa de uma planta
-typedef struct {
-    int id;                    // Identificador único
-    EstadoFolha folhas[FOLHAS_POR_PLANTA]; // Array de folhas
-    bool infectada;            // Status geral de infecção
-    bool tratada;              // Status de tratamento
-} Planta;
+// Eventos que disparam transições
+typedef enum {
+    EVENTO_BOTAO_A,
+    EVENTO_BOTAO_B,
+    EVENTO_BOTAO_JOYSTICK,
+    EVENTO_SIMULAR,                // Postado pelo comando "simular" do console
+    EVENTO_PLANEJAR,               // Postado pelo comando "plano" do console
+    NUM_EVENTOS
+} Evento;
+
+// Pedidos do console à gravação de entradas, atendidos no início do passo
+// seguinte (gravar e reproduzir reiniciam a sessão)
+typedef enum {
+    PEDIDO_NENHUM,
+    PEDIDO_GRAVAR,
+    PEDIDO_REPRODUZIR,
+    PEDIDO_REPRODUZIR_RAPIDO,  // Sem as esperas do período dos estados
+    PEDIDO_PARAR
+} PedidoGravacao;
 
 /**********************************
 * VARIÁVEIS GLOBAIS
@@ -78,309 +120,1276 @@ int planta_cafe[5][5] = {
 // Controle do display OLED
 ssd1306_t display;
 
-// Estado do sistema de escaneamento
-EstadoEscaneamento estado_escaneamento = MODO_ESCANEAMENTO;
-
-// Valores ajustados do joystick para calibração
-Reflectancia valores_ajustados;
+// Máquina de estados principal
+MaquinaEstados fsm;
+
+// Plantas do sistema (pools estáticos do registro)
+RegistroPlantas registro;
+
+// Histórico de análises na flash
+FlashLog historico;
+bool historico_pendente = false;  // Análises ainda só no buffer em RAM do log
+uint32_t ultima_anexacao = 0;     // Momento da última análise registrada (ms)
+Exportacao exportacao;          // Envio binário do histórico pela serial
+Console console;                // Comandos recebidos pela serial
+ModeloClassificador modelo_console; // Cópia ajustável pelo comando "limiares"
+ModeloClassificador modelo_flash;   // Árvore gravada pelo comando "arvore" (aponta para a flash)
+bool tem_modelo_flash = false;
+const ModeloClassificador *modelo_boot = &MODELO_REGRAS; // Ativado a cada reinício da sessão
+uint8_t pagina_modelo[FLASH_PAGE_SIZE]; // Página em recebimento do comando "arvore"
+uint32_t recebido_modelo = 0;       // Bytes recebidos desde "arvore limpar"
+bool carregando_modelo = false;
+
+// Gravação e reprodução das entradas (comandos gravar/reproduzir/trace)
+GravacaoEntradas gravacao;
+PedidoGravacao pedido_gravacao = PEDIDO_NENHUM;
+bool reproducao_rapida = false;
+bool relatar_reproducao = true;     // O simulador desliga nos benchmarks
+uint32_t fim_passo_anterior = 0;    // Para a duração de cada passo gravado
+uint64_t inicio_reproducao_us = 0;
+uint32_t reproducoes = 0;           // Reproduções concluídas
+uint32_t reproducoes_divergentes = 0; // Estado final diferente do gravado
+
+// Simulação de propagação da infecção (estado SIMULACAO)
+uint32_t memoria_epidemia[SIM_MAX_PALAVRAS];
+Epidemia epidemia;
+bool epidemia_pronta = false;   // Grade configurada (senão, a padrão ao entrar)
+uint8_t cursor_x = 0;           // Cursor de tratamento, em blocos de SIM_TAM_CURSOR pixels
+uint8_t cursor_y = 0;
+uint32_t custo_simulacao = 0;   // Custo dos tratamentos simulados
+
+// Plano de tratamento (estado PLANO): ranking por benefício, atualizado a
+// cada análise e tratamento
+Planejador planejador;
+uint16_t plano[PLANEJADOR_MAX]; // Posições das plantas, em ordem de prioridade
+uint16_t tamanho_plano = 0;
+uint32_t protecao_plano = 0;    // Proteção esperada do plano (Q15)
+uint16_t item_plano = 0;        // Planta selecionada na lista
+int orcamento_fungicida = ORCAMENTO_FUNGICIDA;
+
+// Variáveis de controle da interface
+uint16_t indice_planta = 0;     // Posição (ordem de campo) da planta selecionada no menu
+int indice_folha = 0;           // Folha selecionada na análise
+int custo_total = 0;            // Custo acumulado em tratamentos
+bool atualizar_display = true;  // Flag para atualização do display
+uint32_t ultima_atualizacao = 0; // Última atualização periódica do display
+uint32_t ultimo_relatorio = 0;  // Último relatório da FSM pela serial
+
+// Calibração
+uint8_t etapa_calibracao = 2;   // 0: R/NIR, 1: G/B, 2: inativo
+bool atualizar_interface = true; // Flag para redesenho dos gráficos
+EstadoFolha amostra_calibracao; // Valores ajustados do joystick, com cache de índices
+FiltroReflectancia filtro_calibracao; // Suaviza as leituras do joystick
+bool veredito_calibracao = false;     // Diagnóstico parcial da amostra atual
 
 /**********************************
 * PROTÓTIPOS DE FUNÇÕES
 **********************************/
 
-// Testes
-void teste_deteccao();
-
-// Inicialização
+// Inicialização e loop principal
+void sistema_iniciar();
+void sistema_reiniciar();
+void sistema_passo();
 void display_init(ssd1306_t *display);
+void inicializar_campo();
+bool carregar_modelo_flash();
+void reiniciar_planejador();
+void atualizar_plano();
+uint16_t resumo_sessao();
+void registrar_analise(EstadoFolha *folha, uint16_t id_planta, uint8_t indice_folha, OrigemAnalise origem);
+
+// Serial: exportação e console
+void saida_serial(void *ctx, const uint8_t *dados, uint32_t tamanho);
+void aguardar_proximo_tick(uint32_t periodo_ms);
+bool cmd_ajuda(int argc, char *argv[]);
+bool cmd_plantas(int argc, char *argv[]);
+bool cmd_folhas(int argc, char *argv[]);
+bool cmd_amostra(int argc, char *argv[]);
+bool cmd_detectar(int argc, char *argv[]);
+bool cmd_limiares(int argc, char *argv[]);
+bool cmd_modelo(int argc, char *argv[]);
+bool cmd_stats(int argc, char *argv[]);
+bool cmd_campo(int argc, char *argv[]);
+bool cmd_exportar(int argc, char *argv[]);
+bool cmd_gravar(int argc, char *argv[]);
+bool cmd_parar(int argc, char *argv[]);
+bool cmd_reproduzir(int argc, char *argv[]);
+bool cmd_trace(int argc, char *argv[]);
+bool cmd_arvore(int argc, char *argv[]);
+bool cmd_simular(int argc, char *argv[]);
+bool cmd_plano(int argc, char *argv[]);
+bool cmd_autoteste(int argc, char *argv[]);
+bool cmd_rastreio(int argc, char *argv[]);
+bool cmd_microbench(int argc, char *argv[]);
+bool cmd_i2c(int argc, char *argv[]);
+bool cmd_memoria(int argc, char *argv[]);
+
+// Gravação de entradas
+void atender_pedido_gravacao();
+void encerrar_passo_gravacao();
 
 // Interface gráfica
 void escrever_linha(const char* texto, int linha, int coluna, bool centralizado);
-void exibir_menu_planta(int atual, int custo);
-void exibir_menu_folha(int num);
-void exibe_planta(Planta p, int folha);
-void exibir_grafico_display(Reflectancia r);
-void exibir_grafico_matriz(Reflectancia r);
+void exibir_menu_planta(const Planta *p, uint16_t posicao, int custo);
+void exibir_menu_folha(int atual, int total);
+void exibe_planta(const Planta *p, const FolhaCompacta *folhas, int folha);
+void exibir_grafico_display(const Reflectancia *r, const char *titulo);
+void exibir_grafico_matriz(const Reflectancia *r);
 void animacao_analise(int duracao_ms);
-void exibir_resultado_analise(bool resultado, float R, float G, float B, float NIR, float ndvi, float gndvi);
-void exibir_resultado_analise_folha(EstadoFolha folha);
-
-// Lógica do programa
-Planta gerar_planta(int id, int tipo);
-void tratar_planta(Planta *p);
-bool detectar_doenca(float R, float G, float B, float NIR);
-bool detectar_doenca_folha(EstadoFolha folha);
+void exibir_resultado_analise(bool resultado, const Reflectancia *r, const IndicesEspectrais *indices);
+void exibir_resultado_analise_folha(EstadoFolha *folha);
+void exibir_simulacao();
+void exibir_simulacao_matriz();
+void exibir_plano();
 
 // Controles
-void gerenciar_menu_principal(int *planta_atual, bool *atualiza_display);
-void gerenciar_selecao_folha(int *folha_atual, bool *atualiza_display);
-void simular_escaneamento();
+void gerenciar_menu_principal(uint16_t *planta_atual, bool *atualiza_display);
+void gerenciar_selecao_folha(int *folha_atual, int total, bool *atualiza_display);
+void ler_entradas_joystick();
+void postar_eventos_botoes();
+
+// Estados da FSM
+void menu_entrar();
+void menu_tick();
+void selecao_folha_entrar();
+void selecao_folha_tick();
+void analisar_entrar();
+void escaneamento_entrar();
+void escaneamento_tick();
+void analisar_escaneamento_entrar();
+void simulacao_entrar();
+void simulacao_tick();
+void plano_entrar();
+void plano_tick();
+
+// Ações de transição
+void acao_tratar_planta();
+void acao_abrir_folhas();
+void acao_voltar_menu();
+void acao_avancar_etapa();
+void acao_sair_escaneamento();
+void acao_concluir_escaneamento();
+void acao_tratar_bloco();
+void acao_avancar_dia();
+void acao_tratar_do_plano();
+void acao_abrir_planta_do_plano();
+
+/**********************************
+* TABELAS DA MÁQUINA DE ESTADOS
+**********************************/
+// Estados: nome, entrar, sair, tick, período do loop (ms)
+const DefEstado ESTADOS[NUM_ESTADOS] = {
+    [ESTADO_MENU]                  = {"MENU",                  menu_entrar,                  NULL, menu_tick,           100},
+    [ESTADO_SELECIONAR_FOLHA]      = {"SELECIONAR_FOLHA",      selecao_folha_entrar,         NULL, selecao_folha_tick,  100},
+    [ESTADO_ANALISAR]              = {"ANALISAR",              analisar_entrar,              NULL, NULL,                10},
+    [ESTADO_ESCANEAMENTO]          = {"ESCANEAMENTO",          escaneamento_entrar,          NULL, escaneamento_tick,   10},
+    [ESTADO_ANALISAR_ESCANEAMENTO] = {"ANALISAR_ESCANEAMENTO", analisar_escaneamento_entrar, NULL, NULL,                10},
+    [ESTADO_SIMULACAO]             = {"SIMULACAO",             simulacao_entrar,             NULL, simulacao_tick,      100},
+    [ESTADO_PLANO]                 = {"PLANO",                 plano_entrar,                 NULL, plano_tick,          100},
+};
+
+// Transições: origem, evento, destino, ação
+const Transicao TRANSICOES[] = {
+    {ESTADO_MENU,                  EVENTO_BOTAO_A,        FSM_INTERNA,                  acao_tratar_planta},
+    {ESTADO_MENU,                  EVENTO_BOTAO_B,        ESTADO_SELECIONAR_FOLHA,      acao_abrir_folhas},
+    {ESTADO_MENU,                  EVENTO_BOTAO_JOYSTICK, ESTADO_ESCANEAMENTO,          buzzer_som_selecao},
+    {ESTADO_SELECIONAR_FOLHA,      EVENTO_BOTAO_B,        ESTADO_ANALISAR,              NULL},
+    {ESTADO_SELECIONAR_FOLHA,      EVENTO_BOTAO_A,        ESTADO_MENU,                  acao_voltar_menu},
+    {ESTADO_ANALISAR,              EVENTO_BOTAO_A,        ESTADO_SELECIONAR_FOLHA,      buzzer_som_selecao},
+    {ESTADO_ESCANEAMENTO,          EVENTO_BOTAO_B,        FSM_INTERNA,                  acao_avancar_etapa},
+    {ESTADO_ESCANEAMENTO,          EVENTO_BOTAO_A,        ESTADO_ANALISAR_ESCANEAMENTO, NULL},
+    {ESTADO_ESCANEAMENTO,          EVENTO_BOTAO_JOYSTICK, ESTADO_MENU,                  acao_sair_escaneamento},
+    {ESTADO_ANALISAR_ESCANEAMENTO, EVENTO_BOTAO_A,        ESTADO_ESCANEAMENTO,          acao_concluir_escaneamento},
+    {ESTADO_MENU,                  EVENTO_SIMULAR,        ESTADO_SIMULACAO,             buzzer_som_selecao},
+    {ESTADO_ESCANEAMENTO,          EVENTO_SIMULAR,        ESTADO_SIMULACAO,             buzzer_som_selecao},
+    {ESTADO_SIMULACAO,             EVENTO_BOTAO_A,        FSM_INTERNA,                  acao_tratar_bloco},
+    {ESTADO_SIMULACAO,             EVENTO_BOTAO_B,        FSM_INTERNA,                  acao_avancar_dia},
+    {ESTADO_SIMULACAO,             EVENTO_BOTAO_JOYSTICK, ESTADO_MENU,                  buzzer_som_selecao},
+    {ESTADO_MENU,                  EVENTO_PLANEJAR,       ESTADO_PLANO,                 buzzer_som_selecao},
+    {ESTADO_ESCANEAMENTO,          EVENTO_PLANEJAR,       ESTADO_PLANO,                 buzzer_som_selecao},
+    {ESTADO_PLANO,                 EVENTO_BOTAO_A,        FSM_INTERNA,                  acao_tratar_do_plano},
+    {ESTADO_PLANO,                 EVENTO_BOTAO_B,        ESTADO_MENU,                  acao_abrir_planta_do_plano},
+    {ESTADO_PLANO,                 EVENTO_BOTAO_JOYSTICK, ESTADO_MENU,                  buzzer_som_selecao},
+};
+#define NUM_TRANSICOES (sizeof(TRANSICOES) / sizeof(TRANSICOES[0]))
+
+/**********************************
+* TABELA DO CONSOLE SERIAL
+**********************************/
+// Comandos: nome, uso, argumentos obrigatórios, handler
+const ComandoConsole COMANDOS[] = {
+    {"ajuda",    "",                          0, cmd_ajuda},
+    {"plantas",  "[fileira]",                 0, cmd_plantas},
+    {"folhas",   "<id>",                      1, cmd_folhas},
+    {"amostra",  "<R> <G> <B> <NIR>",         4, cmd_amostra},
+    {"detectar", "[id]",                      0, cmd_detectar},
+    {"limiares", "[ndvi|gndvi|r|g <valor>]",  0, cmd_limiares},
+    {"modelo",   "[nome]",                    0, cmd_modelo},
+    {"stats",    "",                          0, cmd_stats},
+    {"campo",    "<semente> [fileiras colunas visivel% latente% agrupamento%]", 1, cmd_campo},
+    {"exportar", "",                          0, cmd_exportar},
+    {"gravar",   "",                          0, cmd_gravar},
+    {"parar",    "",                          0, cmd_parar},
+    {"reproduzir", "[rapido]",                0, cmd_reproduzir},
+    {"trace",    "[limpar|<hex>]",            0, cmd_trace},
+    {"arvore",   "[limpar|<hex>|gravar]",     0, cmd_arvore},
+    {"simular",  "[campo [chance] | largura altura chance focos semente]", 0, cmd_simular},
+    {"plano",    "[orcamento]",               0, cmd_plano},
+    {"autoteste", "[passo]",                  0, cmd_autoteste},
+    {"rastreio", "[limpar|ligar|desligar]",   0, cmd_rastreio},
+    {"microbench", "[prefixo [alvo_us]]",     0, cmd_microbench},
+    {"i2c",      "[limpar|overlay]",          0, cmd_i2c},
+    {"memoria",  "",                          0, cmd_memoria},
+};
+#define NUM_COMANDOS (sizeof(COMANDOS) / sizeof(COMANDOS[0]))
 
 /**********************************
 * FUNÇÃO PRINCIPAL
 **********************************/
+// O simulador de host (host/) compila este arquivo sem main e chama
+// sistema_iniciar/sistema_passo diretamente
+#ifndef PROJETO_SEM_MAIN
 int main() {
+    sistema_iniciar();
+
+    //==================================================
+    // LOOP PRINCIPAL DO SISTEMA
+    //==================================================
+    while(true) {
+        sistema_passo();
+    }
+}
+#endif
+
+/*
+* Inicialização completa, como no boot: periféricos e estado da aplicação
+*/
+void sistema_iniciar() {
     //==================================================
     // INICIALIZAÇÃO DO SISTEMA
     //==================================================
+    memoria_pintar_pilhas();   // Marca d'água das pilhas (comando memoria)
     hardware_setup();          // Configura hardware (GPIO, ADC, etc)
+    rastreio_iniciar();        // Contador de ciclos e buffers de rastreamento
     display_init(&display);    // Inicializa display OLED
 
-    Planta plantas[NUM_PLANTAS]; // Array de plantas do sistema
-    Estado estado_atual = ESTADO_ESCANEAMENTO; // Estado inicial da máquina de estados
-    
-    // Variáveis de controle da interface
-    int indice_planta = 0;      // Planta selecionada no menu
-    int indice_folha = 0;       // Folha selecionada na análise
-    int custo_total = 0;        // Custo acumulado em tratamentos
-    bool atualizar_display = true; // Flag para atualização do display
-    
-    // Timers para atualizações periódicas
-    uint32_t ultima_atualizacao_menu = 0;
-    uint32_t ultima_atualizacao_folha = 0;
+    // Histórico persistente: reconstrói o índice a partir da flash. Fica fora
+    // de sistema_reiniciar: reabrir descartaria o que ainda está no buffer em RAM
+    if(!flash_log_abrir(&historico, &FLASH_RP2040_LOG)) {
+        printf("Historico: regiao de flash invalida\n");
+    }
+    carregar_modelo_flash();
 
+    sistema_reiniciar();
+}
+
+/*
+* Estado da aplicação: campo, histórico, console e máquina de estados.
+* Separado dos periféricos para que o simulador repita sessões sem
+* reinicializá-los (ssd1306_init zera o framebuffer e as estatísticas do I2C).
+* O histórico em flash também fica de fora: gravar e reproduzir não o tocam.
+*/
+void sistema_reiniciar() {
     //==================================================
     // CONFIGURAÇÃO INICIAL DAS PLANTAS
     //==================================================
-    plantas[0] = gerar_planta(0, 0); // Saudável
-    plantas[1] = gerar_planta(1, 0); // Saudável
-    plantas[2] = gerar_planta(2, 1); // Infectada visível
-    plantas[3] = gerar_planta(3, 2); // Infectada oculta
-    plantas[4] = gerar_planta(4, 2); // Infectada oculta
+    classificador_definir_modelo(modelo_boot); // Gera o campo e o plano
+    inicializar_campo();
+
+    // Interface e calibração nos valores de boot
+    indice_folha = 0;
+    custo_total = 0;
+    orcamento_fungicida = ORCAMENTO_FUNGICIDA;
+    atualizar_display = true;
+    ultima_atualizacao = 0;
+    etapa_calibracao = 2;
+    atualizar_interface = true;
+    memset(&amostra_calibracao, 0, sizeof(amostra_calibracao));
+    veredito_calibracao = false;
+    buttonA_flag = buttonB_flag = buttonJoyStick_flag = false;
+    epidemia_pronta = false;
+    cursor_x = cursor_y = 0;
+
+    exportacao.ativa = false;
+
+    console_iniciar(&console, COMANDOS, NUM_COMANDOS);
+
+    // Estado inicial: modo escaneamento
+    fsm_init(&fsm, ESTADOS, NUM_ESTADOS, TRANSICOES, NUM_TRANSICOES, ESTADO_ESCANEAMENTO);
+    ultimo_relatorio = to_ms_since_boot(get_absolute_time());
+}
 
-    //==================================================
-    // LOOP PRINCIPAL DO SISTEMA
-    //==================================================
-    while(true) {
-        //--------------------------------------------------
-        // ATUALIZAÇÃO DE ENTRADAS E TEMPO
-        //--------------------------------------------------
-        ler_joystick();                   // Lê valores do joystick
-        normalizar_joystick();            // Aplica deadzone e normaliza
-        uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
-        buzzer_update();                  // Atualiza estado do buzzer
-
-        //--------------------------------------------------
-        // MÁQUINA DE ESTADOS PRINCIPAL
-        //--------------------------------------------------
-        switch(estado_atual) {
-            //==============================================
-            // ESTADO: MENU PRINCIPAL
-            //==============================================
-            case ESTADO_MENU:
-                //---------- Controle de Navegação ---------
-                gerenciar_menu_principal(&indice_planta, &atualizar_display);
-
-                //---------- Tratamento do Botão A ---------
-                if(buttonA_flag) {
-                    configurar_interrupcoes_botoes(false, false, false);
-                    ssd1306_fill(&display, false);
-                    
-                    // Planta já tratada
-                    if(plantas[indice_planta].tratada) {
-                        // Feedback sonoro
-                        buzzer_som_analise_concluida();
-                        sleep_ms(100);
-                        buzzer_turn_off();
-                        sleep_ms(100);
-                        buzzer_som_analise_concluida();    
-                        sleep_ms(100);
-                        buzzer_turn_off();
-                        
-                        // Mensagem de status
-                        escrever_linha("TRATAMENTO JA", 2, 0, true);
-                        escrever_linha("REALIZADO", 3, 0, true);
-                        sleep_ms(1000);
-                    }
-                    // Planta não tratada
-                    else {
-                        // Animação de tratamento
-                        buzzer_som_analise_iniciada();
-                        sleep_ms(100);
-                        buzzer_turn_off();
-                        sleep_ms(100);
-                        buzzer_som_analise_iniciada();    
-                        sleep_ms(100);
-                        buzzer_turn_off();
-
-                        escrever_linha("TRATANDO PLANTA", 2, 0, true);
-                        escrever_linha("", 3, 0, true);
-                        sleep_ms(250);
-
-                        escrever_linha("TRATANDO PLANTA", 2, 0, true);
-                        escrever_linha(".", 3, 0, true);
-                        sleep_ms(250);
-
-                        escrever_linha("TRATANDO PLANTA", 2, 0, true);
-                        escrever_linha("..", 3, 0, true);
-                        sleep_ms(250);
-
-                        escrever_linha("TRATANDO PLANTA", 2, 0, true);
-                        escrever_linha("...", 3, 0, true);
-                        sleep_ms(250);
-
-                        buzzer_som_analise_concluida();
-                        sleep_ms(100);
-                        buzzer_turn_off();
-                        sleep_ms(100);
-                        buzzer_som_analise_concluida();    
-                        sleep_ms(100);
-                        buzzer_turn_off();
-                        
-                        // Atualiza custos
-                        custo_total += CUSTO_POR_FUNGICIDA;
-
-                        // Trata a planta
-                        tratar_planta(&plantas[indice_planta]);
+/*
+* Uma iteração do loop principal, incluindo a espera do período do estado
+*/
+void sistema_passo() {
+    RASTREIO_ESCOPO(PONTO_PASSO);
+    atender_pedido_gravacao();        // Início/fim de gravação ou reprodução
+
+    //--------------------------------------------------
+    // ATUALIZAÇÃO DE ENTRADAS E TEMPO
+    //--------------------------------------------------
+    ler_entradas_joystick();          // Lê valores do joystick (ou os gravados)
+    normalizar_joystick();            // Aplica deadzone e normaliza
+    buzzer_update();                  // Atualiza estado do buzzer
+    postar_eventos_botoes();          // Converte flags dos botões em eventos
+
+    //--------------------------------------------------
+    // MÁQUINA DE ESTADOS PRINCIPAL
+    //--------------------------------------------------
+    fsm_processar_eventos(&fsm);
+    fsm_tick(&fsm);
+
+    // Gravação adiada do histórico (fora dos handlers dos estados). A página
+    // parcial só é gravada depois de uma pausa nas análises: uma sequência
+    // delas ocupa uma página, e nada fica só na RAM até o próximo desligamento.
+    // Durante uma exportação a página em leitura não pode mudar.
+    uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
+    RASTREIO_INICIO(PONTO_HISTORICO);
+    flash_log_processar(&historico);
+    if(historico_pendente && tempo_atual - ultima_anexacao >= HISTORICO_SINCRONIZAR_MS &&
+       !exportacao_ativa(&exportacao)) {
+        flash_log_sincronizar(&historico);
+        historico_pendente = false;
+    }
+    RASTREIO_FIM(PONTO_HISTORICO);
+
+    //--------------------------------------------------
+    // INSTRUMENTAÇÃO
+    //--------------------------------------------------
+    // Texto no meio dos quadros binários corromperia a exportação
+    if(tempo_atual - ultimo_relatorio >= INTERVALO_RELATORIO_FSM && !exportacao_ativa(&exportacao)) {
+        fsm_imprimir_metricas(&fsm);
+        ultimo_relatorio = tempo_atual;
+    }
 
-                    }
-                    
-                    configurar_interrupcoes_botoes(true, true, true);
-                    buttonA_flag = false;
-                    atualizar_display = true;
-                }
+    if(!(reproducao_rapida && gravacao.modo == GRAVACAO_REPRODUZINDO)) {
+        aguardar_proximo_tick(fsm_periodo_atual(&fsm));
+    }
+    encerrar_passo_gravacao();
+}
 
-                //---------- Tratamento do Botão B ---------
-                if(buttonB_flag) {
-                    estado_atual = ESTADO_SELECIONAR_FOLHA;
-                    indice_folha = 0;
-                    configurar_interrupcoes_botoes(true, true, false);
-                    atualizar_display = true;
-                    buttonB_flag = false;
-                    buzzer_som_selecao();
-                    sleep_ms(100);
-                    continue;
-                }
 
-                //---------- Tratamento do Botão Joystick ---
-                if(buttonJoyStick_flag) {
-                    estado_atual = ESTADO_ESCANEAMENTO;
-                    buttonJoyStick_flag = false;
-                    buzzer_som_selecao();
-                }
+/**********************************
+* INICIALIZAÇÃO DO DISPLAY
+**********************************/
 
-                //---------- Atualização de Display ---------
-                if(atualizar_display || (tempo_atual - ultima_atualizacao_menu >= TEMPO_TROCA_MENSAGEM)) {
-                    exibe_planta(plantas[indice_planta], -1);
-                    exibir_menu_planta(indice_planta + 1, custo_total);
-                    atualizar_led_status(plantas[indice_planta].infectada, false);
-                    atualizar_display = false;
-                    ultima_atualizacao_menu = tempo_atual;
-                }
-                break;
-
-            //==============================================
-            // ESTADO: SELEÇÃO DE FOLHA
-            //==============================================
-            case ESTADO_SELECIONAR_FOLHA:
-                //---------- Controle de Navegação ---------
-                gerenciar_selecao_folha(&indice_folha, &atualizar_display);
-                
-                //---------- Tratamento do Botão B (Analisar) ---------
-                if(buttonB_flag) {
-                    estado_atual = ESTADO_ANALISAR;
-                    buttonB_flag = false;
-                }
-                
-                //---------- Tratamento do Botão A (Voltar) ---------
-                if(buttonA_flag) {
-                    estado_atual = ESTADO_MENU;
-                    configurar_interrupcoes_botoes(true, true, true);
-                    buttonA_flag = false;
-                    atualizar_display = true;
-                    buzzer_som_selecao();
-                    sleep_ms(100);
-                    continue;
-                }
-                
-                //---------- Atualização de Display ---------
-                if(atualizar_display || (tempo_atual - ultima_atualizacao_folha >= TEMPO_TROCA_MENSAGEM)) {
-                    exibe_planta(plantas[indice_planta], indice_folha + 1);
-                    exibir_menu_folha(indice_folha + 1);
-                    atualizar_led_status(plantas[indice_planta].infectada, false);
-                    atualizar_display = false;
-                    ultima_atualizacao_folha = tempo_atual;
-                }
-                break;
-
-            //==============================================
-            // ESTADO: ANÁLISE DE FOLHA
-            //==============================================
-            case ESTADO_ANALISAR:
-                //---------- Preparação para Análise ---------
-                configurar_interrupcoes_botoes(false, false, false); // Desativa interrupções
-                
-                //---------- Processo de Análise ---------
-                animacao_analise(500); // Animação de carregamento
-                bool resultado = detectar_doenca_folha(plantas[indice_planta].folhas[indice_folha]);
-                
-                //---------- Atualização de Estado ---------
-                if(resultado) {
-                    plantas[indice_planta].infectada = true; // Marca planta como infectada
-                }
-                sleep_ms(200);
-
-                //---------- Feedback Visual/Sonoro ---------
-                atualizar_led_status(resultado, false); // Atualiza LEDs
-                if(resultado)
-                    buzzer_infectada();
-                else
-                    buzzer_saudavel();
-                exibir_resultado_analise_folha(plantas[indice_planta].folhas[indice_folha]); // Mostra resultados
-                
-                //---------- Retorno ao Estado Anterior ---------
-                configurar_interrupcoes_botoes(true, true, false); // Reativa interrupções
-                buzzer_som_selecao();
-                estado_atual = ESTADO_SELECIONAR_FOLHA;
-                atualizar_display = true;
-                break;
-
-            //==============================================
-            // ESTADO: MODO ESCANEAMENTO
-            //==============================================
-            case ESTADO_ESCANEAMENTO:
-                //---------- Configuração Inicial ---------
-                atualizar_led_status(false, true); // Desliga LEDs indicativos
-                
-                //---------- Execução do Escaneamento ---------
-                simular_escaneamento(); // Processo completo de calibração
-                
-                //---------- Retorno ao Menu ---------
-                estado_atual = ESTADO_MENU;
-                atualizar_display = true;
-                buzzer_som_selecao();
-                break;
+void display_init(ssd1306_t *display) {
+    // Configuração I2C a 400kHz
+    i2c_init(I2C_PORT, 400 * 1000);
+    
+    // Configura pinos I2C
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA); // Ativa pull-ups internos
+    gpio_pull_up(I2C_SCL);
+
+    // Inicialização do controlador SSD1306
+    ssd1306_init(display, WIDTH, HEIGHT, false, endereco, I2C_PORT);
+    ssd1306_config(display);
+    ssd1306_send_data(display);
+
+    // Limpa a tela inicialmente
+    ssd1306_fill(display, false);
+    ssd1306_send_data(display);
+}
+
+/**********************************
+* INICIALIZAÇÃO DO CAMPO
+**********************************/
+
+/*
+* Registra o talhão de demonstração: CAMPO_FILEIRAS x CAMPO_COLUNAS plantas
+* com número variável de folhas. As cinco primeiras mantêm o cenário
+* original (2 saudáveis, 1 infectada visível, 2 infectadas ocultas).
+*/
+void inicializar_campo() {
+    static const uint8_t TIPOS_INICIAIS[5] = {
+        PERFIL_SAUDAVEL, PERFIL_SAUDAVEL, PERFIL_VISIVEL, PERFIL_LATENTE, PERFIL_LATENTE
+    };
+    Aleatorio rng;
+
+    aleatorio_semear(&rng, SEMENTE_CAMPO);
+    registro_limpar(&registro);
+    for(uint8_t fileira = 0; fileira < CAMPO_FILEIRAS; fileira++) {
+        for(uint16_t coluna = 0; coluna < CAMPO_COLUNAS; coluna++) {
+            uint16_t posicao = registro_total(&registro);
+            int tipo;
+            uint8_t num_folhas;
+            if(posicao < 5) {
+                tipo = TIPOS_INICIAIS[posicao];
+                num_folhas = FOLHAS_POR_PLANTA;
+            } else {
+                uint32_t sorteio = aleatorio_faixa(&rng, 100);
+                tipo = sorteio < 70 ? PERFIL_SAUDAVEL : (sorteio < 85 ? PERFIL_VISIVEL : PERFIL_LATENTE);
+                num_folhas = 3 + aleatorio_faixa(&rng, 6);
+            }
+
+            // Id no formato da etiqueta de campo: fileira * 1000 + coluna
+            uint16_t id = (fileira + 1) * 1000 + coluna + 1;
+            Planta *p = registro_adicionar(&registro, id, fileira, coluna, num_folhas);
+            if(p) {
+                gerar_planta(p, registro_folhas(&registro, p), tipo, &rng);
+            }
+        }
+    }
+    indice_planta = 0;
+    reiniciar_planejador();
+}
+
+/*
+* Reconstrói o ranking do plano de tratamento: depois de trocar o talhão
+* ou o modelo de classificação (as margens usam os limiares do modelo por
+* limiares ativo, ou os padrão)
+*/
+void reiniciar_planejador() {
+    const ModeloClassificador *ativo = classificador_modelo_ativo();
+    planejador_iniciar(&planejador, &registro,
+                       ativo->tipo == MODELO_LIMIARES ? &ativo->limiares : &LIMIARES_PADRAO);
+}
+
+/*
+* Acrescenta o resultado de uma análise ao histórico em flash.
+* Só copia para o buffer em RAM; a gravação acontece em flash_log_processar
+* (páginas cheias) ou, passado HISTORICO_SINCRONIZAR_MS sem novas análises,
+* em sistema_passo (a página parcial).
+* Durante uma reprodução nada é registrado: as análises repetidas não são do
+* usuário e só gastariam a flash.
+*/
+void registrar_analise(EstadoFolha *folha, uint16_t id_planta, uint8_t indice_folha, OrigemAnalise origem) {
+    if(gravacao.modo == GRAVACAO_REPRODUZINDO) return;
+    RegistroAnalise registro_analise = {
+        .folha = folha_compactar(folha),
+        .tempo_ms = to_ms_since_boot(get_absolute_time()),
+        .id_planta = id_planta,
+        .indice_folha = indice_folha,
+        .origem = origem,
+    };
+    flash_log_anexar(&historico, LOG_TIPO_ANALISE, &registro_analise, sizeof(registro_analise));
+    historico_pendente = true;
+    ultima_anexacao = registro_analise.tempo_ms;
+}
+
+/*
+* Escreve bytes na stdio (USB CDC e UART) sem tradução de \n para \r\n,
+* que corromperia os quadros binários
+*/
+void saida_serial(void *ctx, const uint8_t *dados, uint32_t tamanho) {
+    for(uint32_t i = 0; i < tamanho; i++) {
+        putchar_raw(dados[i]);
+    }
+}
+
+/*
+* Espera o período do estado atual usando o tempo ocioso para a serial: com
+* uma exportação em andamento, envia quadros; senão, atende o console assim
+* que cada caractere chega. Nada disso estende o período do loop.
+* @param periodo_ms Período do estado atual
+*/
+void aguardar_proximo_tick(uint32_t periodo_ms) {
+    RASTREIO_ESCOPO(PONTO_ESPERA);
+    absolute_time_t prazo = make_timeout_time_ms(periodo_ms);
+    do {
+        if(exportacao_ativa(&exportacao)) {
+            exportacao_continuar(&exportacao, QUADROS_POR_LOTE);
+            continue;
+        }
+        int64_t restante = absolute_time_diff_us(get_absolute_time(), prazo);
+        int c = getchar_timeout_us(restante > 0 ? (uint32_t)restante : 0);
+        if(c == PICO_ERROR_TIMEOUT) break;
+        console_receber(&console, (char)c);
+    } while(!time_reached(prazo));
+    sleep_until(prazo);
+}
+
+/**********************************
+* COMANDOS DO CONSOLE SERIAL
+**********************************/
+
+/*
+* Converte um inteiro decimal, conferindo a faixa
+* @return false se o texto não é um inteiro dentro de [minimo, maximo]
+*/
+static bool ler_inteiro(const char *texto, long minimo, long maximo, long *valor) {
+    char *fim;
+    long v = strtol(texto, &fim, 10);
+    if(fim == texto || *fim != '\0' || v < minimo || v > maximo) {
+        printf("valor invalido: %s\n", texto);
+        return false;
+    }
+    *valor = v;
+    return true;
+}
+
+/*
+* Converte um decimal como "0.35" ou "-0.1" para Q15, sem ponto flutuante
+* @return false se o texto não é um número entre -1 e 1 (a faixa dos índices)
+*/
+static bool ler_q15(const char *texto, q15_t *valor) {
+    const char *t = texto;
+    bool negativo = *t == '-';
+    if(*t == '-' || *t == '+') t++;
+
+    int32_t inteiro = 0, fracao = 0, escala = 1;
+    bool digitos = false;
+    while(*t >= '0' && *t <= '9' && inteiro <= 1) {
+        inteiro = inteiro * 10 + (*t++ - '0');
+        digitos = true;
+    }
+    if(*t == '.') {
+        t++;
+        while(*t >= '0' && *t <= '9') {
+            if(escala < 10000) {
+                fracao = fracao * 10 + (*t - '0');
+                escala *= 10;
+            }
+            t++;
+            digitos = true;
+        }
+    }
+    q15_t v = inteiro * Q15_UM + (fracao * Q15_UM + escala / 2) / escala;
+    if(*t != '\0' || !digitos || v > Q15_UM) {
+        printf("valor invalido: %s\n", texto);
+        return false;
+    }
+    *valor = negativo ? -v : v;
+    return true;
+}
+
+/*
+* Imprime " nome=valor" de um Q15 com 3 casas decimais, sem ponto flutuante
+*/
+static void imprimir_q15(const char *nome, q15_t valor) {
+    int32_t milesimos = (valor * 1000 + (valor >= 0 ? Q15_UM / 2 : -Q15_UM / 2)) / Q15_UM;
+    int32_t modulo = milesimos < 0 ? -milesimos : milesimos;
+    printf(" %s=%s%ld.%03ld", nome, milesimos < 0 ? "-" : "",
+           (long)(modulo / 1000), (long)(modulo % 1000));
+}
+
+/*
+* Imprime reflectâncias (escala do ADC), índices e resultado de uma folha
+*/
+static void imprimir_folha(EstadoFolha *folha) {
+    const Reflectancia *r = &folha->reflectancia;
+    const IndicesEspectrais *indices = folha_indices(folha, INDICES_DETECCAO);
+    printf("R=%u G=%u B=%u NIR=%u", r->R, r->G, r->B, r->NIR);
+    imprimir_q15("ndvi", indices->valor[INDICE_NDVI]);
+    imprimir_q15("gndvi", indices->valor[INDICE_GNDVI]);
+    printf(" infectada=%d\n", folha->infectada);
+}
+
+/*
+* Planta pelo id do argumento, com mensagem de erro se não existir
+*/
+static Planta *planta_do_argumento(const char *texto) {
+    long id;
+    if(!ler_inteiro(texto, 0, 0xFFFF, &id)) return NULL;
+    Planta *p = registro_buscar_id(&registro, (uint16_t)id);
+    if(!p) printf("planta %ld nao encontrada\n", id);
+    return p;
+}
+
+bool cmd_ajuda(int argc, char *argv[]) {
+    console_ajuda(&console);
+    return true;
+}
+
+/*
+* plantas [fileira]: uma linha por planta, em ordem de campo
+*/
+bool cmd_plantas(int argc, char *argv[]) {
+    long fileira = -1;
+    if(argc > 1 && !ler_inteiro(argv[1], 0, REGISTRO_MAX_FILEIRAS - 1, &fileira)) return false;
+
+    for(uint16_t i = 0; i < registro_total(&registro); i++) {
+        const Planta *p = registro_planta(&registro, i);
+        if(fileira >= 0 && p->fileira != fileira) continue;
+        printf("id=%u fileira=%u coluna=%u folhas=%u infectada=%d tratada=%d\n",
+               p->id, p->fileira, p->coluna, p->num_folhas, p->infectada, p->tratada);
+    }
+    return true;
+}
+
+/*
+* folhas <id>: valores gravados de cada folha de uma planta
+*/
+bool cmd_folhas(int argc, char *argv[]) {
+    Planta *p = planta_do_argumento(argv[1]);
+    if(!p) return false;
+
+    const FolhaCompacta *folhas = registro_folhas(&registro, p);
+    for(uint8_t i = 0; i < p->num_folhas; i++) {
+        EstadoFolha folha;
+        folha_descompactar(folhas[i], &folha);
+        printf("folha=%u ", i);
+        imprimir_folha(&folha);
+    }
+    return true;
+}
+
+/*
+* amostra <R> <G> <B> <NIR>: substitui a amostra do modo escaneamento
+* (escala do ADC) e mostra a previsão, como se ajustada pelo joystick
+*/
+bool cmd_amostra(int argc, char *argv[]) {
+    long valores[4];
+    for(int i = 0; i < 4; i++) {
+        if(!ler_inteiro(argv[i + 1], 0, LOTE_REFLECTANCIA_MAX, &valores[i])) return false;
+    }
+    Reflectancia r = {valores[0], valores[1], valores[2], valores[3]};
+
+    folha_definir_reflectancia(&amostra_calibracao, r);
+    filtro_reiniciar(&filtro_calibracao, r);
+    veredito_calibracao = detectar_doenca_folha(&amostra_calibracao);
+    amostra_calibracao.infectada = veredito_calibracao;
+    atualizar_interface = true;
+
+    imprimir_folha(&amostra_calibracao);
+    return true;
+}
+
+/*
+* detectar [id]: analisa todas as folhas de uma planta ou, sem id, a amostra
+* do modo escaneamento, gravando os resultados no histórico
+*/
+bool cmd_detectar(int argc, char *argv[]) {
+    if(argc < 2) {
+        amostra_calibracao.infectada = detectar_doenca_folha(&amostra_calibracao);
+        registrar_analise(&amostra_calibracao, 0, 0, ORIGEM_CALIBRACAO);
+        imprimir_folha(&amostra_calibracao);
+        return true;
+    }
+
+    Planta *p = planta_do_argumento(argv[1]);
+    if(!p) return false;
+
+    const FolhaCompacta *folhas = registro_folhas(&registro, p);
+    for(uint8_t i = 0; i < p->num_folhas; i++) {
+        EstadoFolha folha;
+        folha_descompactar(folhas[i], &folha);
+        folha.infectada = detectar_doenca_folha(&folha);
+        if(folha.infectada) {
+            p->infectada = true;
+        }
+        registrar_analise(&folha, p->id, i, ORIGEM_ANALISE);
+        printf("folha=%u ", i);
+        imprimir_folha(&folha);
+    }
+    planejador_atualizar(&planejador, registro_posicao(&registro, p));
+    atualizar_display = true;
+    return true;
+}
+
+/*
+* limiares [ndvi|gndvi|r|g <valor>]: mostra ou ajusta os limiares. O ajuste
+* ativa uma cópia em RAM do modelo por limiares; ndvi e gndvi em decimal,
+* r e g na escala do ADC.
+*/
+bool cmd_limiares(int argc, char *argv[]) {
+    if(argc >= 3) {
+        if(classificador_modelo_ativo() != &modelo_console) {
+            modelo_console = MODELO_REGRAS;
+            modelo_console.nome = "console";
+            const ModeloClassificador *ativo = classificador_modelo_ativo();
+            if(ativo->tipo == MODELO_LIMIARES) {
+                modelo_console.limiares = ativo->limiares;
+            }
+        }
+
+        ModeloClassificador ajustado = modelo_console;
+        LimiaresDeteccao *l = &ajustado.limiares;
+        long valor;
+        if(strcmp(argv[1], "ndvi") == 0) {
+            if(!ler_q15(argv[2], &l->ndvi)) return false;
+        } else if(strcmp(argv[1], "gndvi") == 0) {
+            if(!ler_q15(argv[2], &l->gndvi)) return false;
+        } else if(strcmp(argv[1], "r") == 0) {
+            if(!ler_inteiro(argv[2], 0, LOTE_REFLECTANCIA_MAX, &valor)) return false;
+            l->r_visivel = valor;
+        } else if(strcmp(argv[1], "g") == 0) {
+            if(!ler_inteiro(argv[2], 0, LOTE_REFLECTANCIA_MAX, &valor)) return false;
+            l->g_visivel = valor;
+        } else {
+            printf("limiar desconhecido: %s\n", argv[1]);
+            return false;
+        }
+
+        // Valida antes de trocar: o modelo ativo nunca fica inconsistente
+        if(!classificador_validar(&ajustado)) {
+            printf("limiares rejeitados pelo classificador\n");
+            return false;
+        }
+        modelo_console = ajustado;
+        classificador_definir_modelo(&modelo_console);
+        reiniciar_planejador();
+    }
+
+    const ModeloClassificador *ativo = classificador_modelo_ativo();
+    printf("modelo=%s", ativo->nome);
+    if(ativo->tipo == MODELO_LIMIARES) {
+        imprimir_q15("ndvi", ativo->limiares.ndvi);
+        imprimir_q15("gndvi", ativo->limiares.gndvi);
+        printf(" r=%u g=%u", ativo->limiares.r_visivel, ativo->limiares.g_visivel);
+    }
+    printf("\n");
+    return true;
+}
+
+/*
+* modelo [nome]: lista os modelos embutidos ou ativa um deles
+*/
+bool cmd_modelo(int argc, char *argv[]) {
+    if(argc >= 2) {
+        const ModeloClassificador *m = classificador_buscar(argv[1]);
+        if(!m && tem_modelo_flash && strcmp(argv[1], modelo_flash.nome) == 0) m = &modelo_flash;
+        if(!m || !classificador_definir_modelo(m)) {
+            printf("modelo invalido: %s\n", argv[1]);
+            return false;
+        }
+        reiniciar_planejador();
+    }
+    const ModeloClassificador *ativo = classificador_modelo_ativo();
+    for(uint8_t i = 0; i < NUM_MODELOS_EMBUTIDOS; i++) {
+        printf("%c %s\n", MODELOS_EMBUTIDOS[i] == ativo ? '*' : ' ', MODELOS_EMBUTIDOS[i]->nome);
+    }
+    if(tem_modelo_flash) {
+        printf("%c %s\n", ativo == &modelo_flash ? '*' : ' ', modelo_flash.nome);
+    }
+    if(ativo == &modelo_console) {
+        printf("* %s\n", ativo->nome);
+    }
+    return true;
+}
+
+/*
+* stats: campo, histórico, console e métricas da FSM
+*/
+bool cmd_stats(int argc, char *argv[]) {
+    uint16_t infectadas = 0, tratadas = 0;
+    for(uint16_t i = 0; i < registro_total(&registro); i++) {
+        const Planta *p = registro_planta(&registro, i);
+        infectadas += p->infectada;
+        tratadas += p->tratada;
+    }
+    printf("plantas=%u folhas=%u infectadas=%u tratadas=%u custo=%d\n",
+           registro_total(&registro), registro.num_folhas, infectadas, tratadas, custo_total);
+    printf("historico: paginas=%lu apagamentos=%lu\n",
+           (unsigned long)historico.programacoes, (unsigned long)historico.apagamentos);
+    printf("console: comandos=%lu erros=%lu\n",
+           (unsigned long)console.executados, (unsigned long)console.erros);
+    printf("plano: atualizacoes=%lu\n", (unsigned long)planejador.atualizacoes);
+    const ssd1306_stats_t *oled = ssd1306_get_stats(&display);
+    printf("oled: quadros=%lu ocupado=%lu.%lu%% erros=%lu\n", (unsigned long)oled->frames,
+           (unsigned long)(ssd1306_bus_busy_permille(&display) / 10),
+           (unsigned long)(ssd1306_bus_busy_permille(&display) % 10),
+           (unsigned long)(oled->nacks + oled->timeouts));
+    fsm_imprimir_metricas(&fsm);
+    return true;
+}
+
+/*
+* autoteste [passo]: confere índices, detecção, lote e árvore contra o
+* oráculo de utils/autoteste (tabela, fronteiras dos limiares e grade com o
+* passo dado; 0 pula a grade) e mostra o resumo. Não usa a interface.
+*/
+bool cmd_autoteste(int argc, char *argv[]) {
+    long passo = AUTOTESTE_PASSO_GRADE;
+    if(argc > 1 && !ler_inteiro(argv[1], 0, REFLECTANCIA_MAX, &passo)) return false;
+
+    ResultadoAutoteste res;
+    uint64_t inicio = time_us_64();
+    bool ok = autoteste_executar(&res, (uint16_t)passo);
+    uint64_t tempo = time_us_64() - inicio;
+
+    autoteste_relatorio(&res, tempo);
+    printf("ciclos por vetor (todas as verificacoes): %lu\n",
+           (unsigned long)(tempo * (clock_get_hz(clk_sys) / 1000000u) / res.vetores));
+    return ok;
+}
+
+/*
+* rastreio [limpar|ligar|desligar]: sem argumento, despeja os buffers de
+* rastreamento para o tools/decodificar_rastreio (ver utils/rastreio.h)
+*/
+bool cmd_rastreio(int argc, char *argv[]) {
+    if(argc < 2) {
+        rastreio_despejar();
+        return true;
+    }
+    if(strcmp(argv[1], "limpar") == 0) {
+        rastreio_limpar();
+    } else if(strcmp(argv[1], "ligar") == 0 || strcmp(argv[1], "desligar") == 0) {
+        rastreio_ativo = argv[1][0] == 'l';
+    } else {
+        printf("uso: rastreio [limpar|ligar|desligar]\n");
+        return false;
+    }
+    return true;
+}
+
+/*
+* microbench [prefixo [alvo_us]]: mede as primitivas de desenho, LEDs,
+* detecção e formatação com o timer de 1 us (ver utils/microbench.h). A saída
+* em CSV vai para o host/microbench -c, que compara duas capturas. Bloqueia
+* o loop por cerca de 1 s; a matriz de LEDs é restaurada no fim.
+*/
+bool cmd_microbench(int argc, char *argv[]) {
+    long alvo = MICROBENCH_ALVO_US;
+    if(argc > 2 && !ler_inteiro(argv[2], 100, 1000000, &alvo)) return false;
+    const char *filtro = argc > 1 && strcmp(argv[1], "*") != 0 ? argv[1] : NULL;
+    return microbench_executar(filtro, (uint32_t)alvo, time_us_64, "rp2040", clock_get_hz(clk_sys)) > 0;
+}
+
+/*
+* i2c [limpar|overlay]: contabilidade do barramento do OLED (transações,
+* bytes, ocupação, erros e histograma de duração por transação). limpar
+* reinicia a janela; overlay liga/desliga o resumo na última linha da tela.
+*/
+bool cmd_i2c(int argc, char *argv[]) {
+    if(argc > 1) {
+        if(strcmp(argv[1], "limpar") == 0) {
+            ssd1306_reset_stats(&display);
+        } else if(strcmp(argv[1], "overlay") == 0) {
+            ssd1306_set_stats_overlay(&display, !display.stats_overlay);
+            atualizar_display = true;
+            printf("overlay %s\n", display.stats_overlay ? "ligado" : "desligado");
+        } else {
+            printf("uso: i2c [limpar|overlay]\n");
+            return false;
+        }
+        return true;
+    }
+
+    const ssd1306_stats_t *st = ssd1306_get_stats(&display);
+    uint64_t janela = time_us_64() - st->since_us;
+    uint32_t permille = ssd1306_bus_busy_permille(&display);
+    printf("transacoes=%lu comandos=%lu quadros=%lu bytes=%lu\n", (unsigned long)st->transactions,
+           (unsigned long)st->commands, (unsigned long)st->frames, (unsigned long)st->bytes);
+    printf("ocupado=%lu ms em %lu ms (%lu.%lu%%)\n", (unsigned long)(st->busy_us / 1000),
+           (unsigned long)(janela / 1000), (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+    printf("quadro: ultimo=%lu us max=%lu us; transacao max=%lu us\n", (unsigned long)st->frame_us,
+           (unsigned long)st->frame_max_us, (unsigned long)st->max_us);
+    printf("erros: nacks=%lu timeouts=%lu ultimo=%d\n", (unsigned long)st->nacks,
+           (unsigned long)st->timeouts, st->last_error);
+    printf("duracao por transacao:\n");
+    for(int k = 0; k < SSD1306_HIST_BINS; k++) {
+        if(st->histogram[k] == 0) continue;
+        unsigned long de = k ? 1ul << (k - 1) : 0, ate = 1ul << k;
+        printf("  %6lu-%-6lu us %lu\n", de, ate, (unsigned long)st->histogram[k]);
+    }
+    return true;
+}
+
+/*
+* memoria: RAM estática, heap livre e pico de uso das pilhas dos dois
+* núcleos (ver utils/memoria.h; o uso por módulo sai no build)
+*/
+bool cmd_memoria(int argc, char *argv[]) {
+    memoria_relatorio();
+    return true;
+}
+
+/*
+* campo <semente> [fileiras colunas visivel% latente% agrupamento%]: troca o
+* talhão por um campo sintético (utils/campo). A mesma semente reproduz o
+* mesmo campo; os parâmetros omitidos vêm de CAMPO_PADRAO.
+*/
+bool cmd_campo(int argc, char *argv[]) {
+    ParametrosCampo par = CAMPO_PADRAO;
+    long v[6] = {0}; // v[0] sempre lido: o console exige a semente
+    static const long MAXIMOS[6] = {0x7FFFFFFF, REGISTRO_MAX_FILEIRAS, CAMPO_MAX_COLUNAS, 100, 100, 100};
+    for(int i = 1; i < argc && i <= 6; i++) {
+        if(!ler_inteiro(argv[i], i == 1 ? 0 : (i <= 3 ? 1 : 0), MAXIMOS[i - 1], &v[i - 1])) return false;
+    }
+    par.semente = (uint64_t)v[0];
+    if(argc > 2) par.fileiras = v[1];
+    if(argc > 3) par.colunas = v[2];
+    if(argc > 4) par.pct_visivel = v[3];
+    if(argc > 5) par.pct_latente = v[4];
+    if(argc > 6) par.agrupamento = v[5];
+
+    uint16_t total = campo_gerar(&registro, &par);
+    indice_planta = 0;
+    indice_folha = 0;
+    atualizar_display = true;
+    if(total == 0) {
+        printf("parametros invalidos\n");
+        inicializar_campo(); // O menu precisa de pelo menos uma planta
+        return false;
+    }
+    reiniciar_planejador();
+    printf("plantas=%u folhas=%u\n", total, registro.num_folhas);
+    return true;
+}
+
+/*
+* exportar: envia o histórico em quadros binários (utils/exportacao). A
+* resposta "ok" vem antes; o console fica parado até o quadro de fim.
+*/
+bool cmd_exportar(int argc, char *argv[]) {
+    exportacao_iniciar(&exportacao, &historico, saida_serial, NULL);
+    return true;
+}
+
+/*
+* gravar: reinicia a sessão e grava as entradas até "parar" (utils/gravacao).
+* Comandos do console durante a gravação não são gravados.
+*/
+bool cmd_gravar(int argc, char *argv[]) {
+    pedido_gravacao = PEDIDO_GRAVAR;
+    return true;
+}
+
+/*
+* parar: encerra a gravação (com o resumo do estado final) ou a reprodução
+*/
+bool cmd_parar(int argc, char *argv[]) {
+    if(gravacao.modo == GRAVACAO_PARADA) {
+        printf("nada em andamento\n");
+        return false;
+    }
+    pedido_gravacao = PEDIDO_PARAR;
+    return true;
+}
+
+/*
+* reproduzir [rapido]: reinicia a sessão e reproduz a gravação carregada;
+* "rapido" dispensa a espera do período dos estados. Ao final, compara o
+* estado com o resumo gravado e mostra o tempo gasto.
+*/
+bool cmd_reproduzir(int argc, char *argv[]) {
+    if(!gravacao_valida(&gravacao)) {
+        printf("nenhuma gravacao completa\n");
+        return false;
+    }
+    bool rapido = argc > 1 && strcmp(argv[1], "rapido") == 0;
+    pedido_gravacao = rapido ? PEDIDO_REPRODUZIR_RAPIDO : PEDIDO_REPRODUZIR;
+    return true;
+}
+
+// Valor de um dígito hexadecimal, ou -1
+static int valor_hex(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/*
+* Converte um argumento hexadecimal do console em bytes
+* @param bytes Pelo menos CONSOLE_TAM_LINHA / 2 bytes
+* @return Bytes lidos, ou -1 (com a mensagem de erro) se o texto não for hex
+*/
+static int ler_hex(const char *texto, uint8_t *bytes) {
+    int n = 0;
+    for(const char *c = texto; *c; c += 2) {
+        int alto = valor_hex(c[0]), baixo = c[1] ? valor_hex(c[1]) : -1;
+        if(alto < 0 || baixo < 0) {
+            printf("hex invalido: %s\n", texto);
+            return -1;
         }
+        bytes[n++] = (uint8_t)(alto << 4 | baixo);
+    }
+    return n;
+}
+
+/*
+* trace [limpar|<hex>]: sem argumentos, despeja a gravação como comandos
+* "trace" que, colados de volta no console (daqui ou do simulador de host),
+* recarregam os mesmos bytes; "limpar" descarta e <hex> acrescenta
+*/
+bool cmd_trace(int argc, char *argv[]) {
+    if(argc < 2) {
+        printf("trace limpar\n");
+        for(uint16_t i = 0; i < gravacao.tamanho; i++) {
+            if(i % BYTES_POR_LINHA_TRACE == 0) printf("trace ");
+            printf("%02x", gravacao.dados[i]);
+            if(i % BYTES_POR_LINHA_TRACE == BYTES_POR_LINHA_TRACE - 1 || i == gravacao.tamanho - 1) printf("\n");
+        }
+        return true;
+    }
+    if(gravacao.modo != GRAVACAO_PARADA) {
+        printf("gravacao ou reproducao em andamento\n");
+        return false;
+    }
+    if(strcmp(argv[1], "limpar") == 0) {
+        gravacao_limpar(&gravacao);
+        return true;
+    }
+
+    uint8_t bytes[CONSOLE_TAM_LINHA / 2];
+    int n = ler_hex(argv[1], bytes);
+    if(n < 0) return false;
+    if(!gravacao_acrescentar(&gravacao, bytes, (uint16_t)n)) {
+        printf("gravacao cheia\n");
+        return false;
+    }
+    return true;
+}
+
+/*
+* Monta modelo_flash a partir da região do modelo; sem blob válido, o boot
+* fica com MODELO_REGRAS
+* @return true se há um modelo válido na flash
+*/
+bool carregar_modelo_flash() {
+    tem_modelo_flash = classificador_de_blob(flash_modelo_dados(), FLASH_MODELO_TAMANHO, "flash", &modelo_flash);
+    modelo_boot = tem_modelo_flash ? &modelo_flash : &MODELO_REGRAS;
+    return tem_modelo_flash;
+}
+
+/*
+* arvore [limpar|<hex>|gravar]: grava na flash o blob de um modelo em árvore
+* (tools/treinar_arvore -c gera os comandos). "limpar" apaga a região, cada
+* <hex> acrescenta bytes (programados uma página por vez) e "gravar" fecha a
+* última página, valida o blob e o ativa; ele passa a valer a cada boot.
+* Sem argumentos, mostra o modelo gravado.
+*/
+bool cmd_arvore(int argc, char *argv[]) {
+    if(argc < 2) {
+        if(tem_modelo_flash) {
+            printf("flash: nos=%u profundidade=%u%s\n", modelo_flash.num_nos, modelo_flash.profundidade,
+                   classificador_modelo_ativo() == &modelo_flash ? " (ativo)" : "");
+        } else {
+            printf("flash: sem modelo\n");
+        }
+        return true;
+    }
+    if(gravacao.modo != GRAVACAO_PARADA) {
+        printf("gravacao ou reproducao em andamento\n");
+        return false;
+    }
+
+    if(strcmp(argv[1], "limpar") == 0) {
+        // O modelo ativo não pode apontar para a região que vai ser apagada
+        if(classificador_modelo_ativo() == &modelo_flash) {
+            classificador_definir_modelo(&MODELO_REGRAS);
+            reiniciar_planejador();
+        }
+        flash_modelo_apagar();
+        tem_modelo_flash = false;
+        modelo_boot = &MODELO_REGRAS;
+        recebido_modelo = 0;
+        carregando_modelo = true;
+        return true;
+    }
+    if(!carregando_modelo) {
+        printf("use arvore limpar antes\n");
+        return false;
+    }
+
+    if(strcmp(argv[1], "gravar") == 0) {
+        uint32_t resto = recebido_modelo % FLASH_PAGE_SIZE;
+        if(resto) {
+            memset(pagina_modelo + resto, 0xFF, FLASH_PAGE_SIZE - resto);
+            flash_modelo_programar(recebido_modelo - resto, pagina_modelo);
+        }
+        carregando_modelo = false;
+        if(!carregar_modelo_flash()) {
+            printf("modelo invalido (%lu bytes)\n", (unsigned long)recebido_modelo);
+            return false;
+        }
+        classificador_definir_modelo(&modelo_flash);
+        reiniciar_planejador();
+        printf("flash: nos=%u profundidade=%u\n", modelo_flash.num_nos, modelo_flash.profundidade);
+        return true;
+    }
+
+    uint8_t bytes[CONSOLE_TAM_LINHA / 2];
+    int n = ler_hex(argv[1], bytes);
+    if(n < 0) return false;
+    if(recebido_modelo + (uint32_t)n > FLASH_MODELO_TAMANHO) {
+        printf("modelo maior que a regiao (%u bytes)\n", FLASH_MODELO_TAMANHO);
+        carregando_modelo = false;
+        return false;
+    }
+    for(int i = 0; i < n; i++) {
+        pagina_modelo[recebido_modelo % FLASH_PAGE_SIZE] = bytes[i];
+        if(++recebido_modelo % FLASH_PAGE_SIZE == 0) {
+            flash_modelo_programar(recebido_modelo - FLASH_PAGE_SIZE, pagina_modelo);
+        }
+    }
+    return true;
+}
+
+/*
+* simular [campo [chance] | largura altura chance focos semente]: configura
+* a grade da simulação de propagação e abre o estado SIMULACAO (a partir do
+* menu ou da calibração). "campo" copia o talhão atual; senão, uma grade
+* com focos sorteados. A chance de transmissão por vizinho é em 1/256.
+*/
+bool cmd_simular(int argc, char *argv[]) {
+    bool do_campo = argc > 1 && strcmp(argv[1], "campo") == 0;
+    long v[5] = {SIM_LARGURA, SIM_ALTURA, SIM_CHANCE, SIM_FOCOS, SEMENTE_CAMPO};
+
+    if(do_campo) {
+        v[0] = 0;
+        for(uint16_t i = 0; i < registro_total(&registro); i++) {
+            const Planta *p = registro_planta(&registro, i);
+            if(p->coluna >= v[0]) v[0] = p->coluna + 1;
+        }
+        v[1] = registro.num_fileiras;
+        if(argc > 2 && !ler_inteiro(argv[2], 0, 255, &v[2])) return false;
+    } else {
+        static const long MAXIMOS[5] = {0xFFFF, 0xFFFF, 255, 0xFFFFF, 0x7FFFFFFF};
+        for(int i = 1; i < argc && i <= 5; i++) {
+            if(!ler_inteiro(argv[i], i <= 2 ? 1 : 0, MAXIMOS[i - 1], &v[i - 1])) return false;
+        }
+    }
+
+    if(!epidemia_iniciar(&epidemia, v[0], v[1], memoria_epidemia, SIM_MAX_PALAVRAS, v[2], (uint64_t)v[4])) {
+        printf("grade invalida ou grande demais (%lu palavras)\n", (unsigned long)SIM_MAX_PALAVRAS);
+        epidemia_pronta = false;
+        return false;
+    }
+    if(do_campo) {
+        epidemia_carregar_registro(&epidemia, &registro);
+    } else {
+        epidemia_semear(&epidemia, v[3]);
+    }
+    epidemia_pronta = true;
+    custo_simulacao = 0;
+    cursor_x = cursor_y = 0;
+    atualizar_display = true;
+
+    uint32_t infectadas, tratadas;
+    epidemia_contar_bloco(&epidemia, 0, 0, epidemia.largura, epidemia.altura, &infectadas, &tratadas);
+    printf("grade=%ux%u infectadas=%lu tratadas=%lu\n", epidemia.largura, epidemia.altura,
+           (unsigned long)infectadas, (unsigned long)tratadas);
+    fsm_postar(&fsm, EVENTO_SIMULAR);
+    return true;
+}
+
+// Valor Q15 em centésimos, arredondado
+static uint32_t centesimos_q15(uint32_t valor) {
+    return (uint32_t)(((uint64_t)valor * 100 + Q15_UM / 2) >> 15);
+}
 
-        sleep_ms(100); 
+/*
+* Recalcula a lista do plano com o orçamento que resta
+*/
+void atualizar_plano() {
+    int restante = orcamento_fungicida - custo_total;
+    tamanho_plano = planejador_plano(&planejador, restante > 0 ? restante : 0, CUSTO_POR_FUNGICIDA,
+                                     plano, PLANEJADOR_MAX, &protecao_plano);
+    if(item_plano >= tamanho_plano) {
+        item_plano = tamanho_plano ? tamanho_plano - 1 : 0;
     }
 }
 
+/*
+* plano [orcamento]: ajusta o orçamento total de fungicida, lista o plano de
+* tratamento (escolha gulosa das plantas de maior ganho, com as vizinhas já
+* escolhidas contando como tratadas, até o que resta do orçamento)
+* e abre o estado PLANO (a partir do menu ou da calibração)
+*/
+bool cmd_plano(int argc, char *argv[]) {
+    long orcamento;
+    if(argc > 1) {
+        if(!ler_inteiro(argv[1], 0, 0x7FFFFFFF, &orcamento)) return false;
+        orcamento_fungicida = orcamento;
+    }
+    atualizar_plano();
+
+    uint32_t protecao = centesimos_q15(protecao_plano);
+    printf("orcamento=%d gasto=%d plantas=%u protecao=%lu.%02lu\n", orcamento_fungicida, custo_total,
+           tamanho_plano, (unsigned long)(protecao / 100), (unsigned long)(protecao % 100));
+    for(uint16_t i = 0; i < tamanho_plano; i++) {
+        const Planta *p = registro_planta(&registro, plano[i]);
+        uint32_t ganho = centesimos_q15(planejador_ganho(&planejador, plano[i]));
+        printf("%u id=%u fileira=%u coluna=%u risco=%lu%% ganho=%lu.%02lu\n", i + 1, p->id,
+               p->fileira, p->coluna, (unsigned long)centesimos_q15(planejador_risco(&planejador, plano[i])),
+               (unsigned long)(ganho / 100), (unsigned long)(ganho % 100));
+    }
+    atualizar_display = true;
+    fsm_postar(&fsm, EVENTO_PLANEJAR);
+    return true;
+}
 
 /**********************************
-* INICIALIZAÇÃO DO DISPLAY
+* GRAVAÇÃO DE ENTRADAS
 **********************************/
 
-void display_init(ssd1306_t *display) {
-    // Configuração I2C a 400kHz
-    i2c_init(I2C_PORT, 400 * 1000);
-    
-    // Configura pinos I2C
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA); // Ativa pull-ups internos
-    gpio_pull_up(I2C_SCL);
+/*
+* Resumo do estado que as entradas determinam: estado da FSM, seleção,
+* calibração e plantas. A reprodução deve terminar com o mesmo resumo.
+*/
+uint16_t resumo_sessao() {
+    uint16_t infectadas = 0, tratadas = 0;
+    for(uint16_t i = 0; i < registro_total(&registro); i++) {
+        const Planta *p = registro_planta(&registro, i);
+        infectadas += p->infectada;
+        tratadas += p->tratada;
+    }
+    const Reflectancia *r = &amostra_calibracao.reflectancia;
+    const uint32_t valores[] = {
+        fsm_estado_atual(&fsm), fsm.total_transicoes, indice_planta, (uint32_t)indice_folha,
+        (uint32_t)custo_total, etapa_calibracao, r->R, r->G, r->B, r->NIR, infectadas, tratadas,
+    };
+    return crc16_ccitt(CRC16_INICIAL, valores, sizeof(valores));
+}
 
-    // Inicialização do controlador SSD1306
-    ssd1306_init(display, WIDTH, HEIGHT, false, endereco, I2C_PORT);
-    ssd1306_config(display);
-    ssd1306_send_data(display);
+/*
+* Atende, no início do passo, o pedido feito pelo console
+*/
+void atender_pedido_gravacao() {
+    PedidoGravacao pedido = pedido_gravacao;
+    if(pedido == PEDIDO_NENHUM) return;
+    pedido_gravacao = PEDIDO_NENHUM;
+
+    if(pedido == PEDIDO_PARAR) {
+        if(gravacao.modo == GRAVACAO_GRAVANDO) {
+            gravacao_finalizar(&gravacao, resumo_sessao());
+            printf("gravacao: passos=%lu tempo_ms=%lu bytes=%u resumo=%04x\n",
+                   (unsigned long)gravacao.passos, (unsigned long)gravacao.tempo_ms,
+                   gravacao.tamanho, gravacao.resumo);
+        } else if(gravacao.modo == GRAVACAO_REPRODUZINDO) {
+            gravacao.modo = GRAVACAO_PARADA;
+            printf("reproducao: interrompida no passo %lu\n", (unsigned long)gravacao.passos);
+        }
+        return;
+    }
 
-    // Limpa a tela inicialmente
-    ssd1306_fill(display, false);
-    ssd1306_send_data(display);
+    // Gravar e reproduzir partem do mesmo estado: o de boot
+    sistema_reiniciar();
+    if(pedido == PEDIDO_GRAVAR) {
+        gravacao_iniciar(&gravacao);
+    } else if(gravacao_reproduzir(&gravacao)) {
+        reproducao_rapida = pedido == PEDIDO_REPRODUZIR_RAPIDO;
+        inicio_reproducao_us = time_us_64();
+    }
+    fim_passo_anterior = to_ms_since_boot(get_absolute_time());
 }
 
+/*
+* Fecha o passo na gravação (com a duração medida) ou na reprodução, que ao
+* terminar confere o estado final com o resumo gravado
+*/
+void encerrar_passo_gravacao() {
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+
+    if(gravacao.modo == GRAVACAO_GRAVANDO) {
+        if(!gravacao_terminar_passo(&gravacao, agora - fim_passo_anterior)) {
+            gravacao_finalizar(&gravacao, resumo_sessao());
+            printf("gravacao: memoria cheia, encerrada com %lu passos\n", (unsigned long)gravacao.passos);
+        }
+    } else if(gravacao.modo == GRAVACAO_REPRODUZINDO) {
+        if(!gravacao_avancar_passo(&gravacao)) {
+            uint64_t duracao_us = time_us_64() - inicio_reproducao_us;
+            uint16_t resumo = resumo_sessao();
+            reproducoes++;
+            reproducoes_divergentes += resumo != gravacao.resumo;
+            if(relatar_reproducao) {
+                printf("reproducao: passos=%lu gravado_ms=%lu tempo_us=%llu resumo=%04x esperado=%04x %s\n",
+                       (unsigned long)gravacao.passos, (unsigned long)gravacao.tempo_ms,
+                       (unsigned long long)duracao_us, resumo, gravacao.resumo,
+                       resumo == gravacao.resumo ? "OK" : "DIVERGENTE");
+            }
+            reproducao_rapida = false;
+        }
+    }
+    fim_passo_anterior = agora;
+}
 
 /**********************************
 * IMPLEMENTAÇÃO DAS FUNÇÕES DE CONTROLE
@@ -388,129 +1397,84 @@ void display_init(ssd1306_t *display) {
 
 /*
 * Gerencia a navegação no menu principal de plantas
-* @param planta_atual Ponteiro para o índice da planta selecionada
+* Esquerda/direita percorrem a fileira em ordem de campo; cima/baixo trocam de
+* fileira mantendo a coluna mais próxima. Custo constante em qualquer tamanho.
+* @param planta_atual Ponteiro para a posição da planta selecionada
 * @param atualiza_display Ponteiro para flag de atualização do display
 */
 
-void gerenciar_menu_principal(int *planta_atual, bool *atualiza_display) {
+void gerenciar_menu_principal(uint16_t *planta_atual, bool *atualiza_display) {
     if(vrx_valor == DIREITA) {
-        *planta_atual = (*planta_atual + 1) % NUM_PLANTAS;  // Avança para próxima planta
-        *atualiza_display = true;                           // Força atualização
+        *planta_atual = registro_avancar(&registro, *planta_atual, 1);  // Avança para próxima planta
+        *atualiza_display = true;                                       // Força atualização
     }
     else if(vrx_valor == ESQUERDA) {
-        *planta_atual = (*planta_atual - 1 + NUM_PLANTAS) % NUM_PLANTAS; // Volta para planta anterior
-        *atualiza_display = true;                                        // Força atualização
+        *planta_atual = registro_avancar(&registro, *planta_atual, -1); // Volta para planta anterior
+        *atualiza_display = true;                                       // Força atualização
+    }
+    else if(vry_valor == CIMA) {
+        *planta_atual = registro_mover_fileira(&registro, *planta_atual, -1); // Fileira anterior
+        *atualiza_display = true;
+    }
+    else if(vry_valor == BAIXO) {
+        *planta_atual = registro_mover_fileira(&registro, *planta_atual, 1);  // Próxima fileira
+        *atualiza_display = true;
     }
 }
 
  /*
 * Gerencia a navegação na seleção de folhas
 * @param folha_atual Ponteiro para o índice da folha selecionada
+* @param total Número de folhas da planta
 * @param atualiza_display Ponteiro para flag de atualização do display
 */
-void gerenciar_selecao_folha(int *folha_atual, bool *atualiza_display) {
+void gerenciar_selecao_folha(int *folha_atual, int total, bool *atualiza_display) {
     
     if(vrx_valor == DIREITA) {
-        *folha_atual = (*folha_atual + 1) % FOLHAS_POR_PLANTA;  // Avança para próxima folha
-        *atualiza_display = true;                               // Força atualização
+        *folha_atual = (*folha_atual + 1) % total;          // Avança para próxima folha
+        *atualiza_display = true;                           // Força atualização
     }
     else if(vrx_valor == ESQUERDA) {
-        *folha_atual = (*folha_atual - 1 + FOLHAS_POR_PLANTA) % FOLHAS_POR_PLANTA; // Volta para folha anterior
-        *atualiza_display = true;                                                  // Força atualização
+        *folha_atual = (*folha_atual - 1 + total) % total;  // Volta para folha anterior
+        *atualiza_display = true;                           // Força atualização
     }
 }
 
-/**********************************
-* IMPLEMENTAÇÃO DA LÓGICA DAS PLANTAS
-**********************************/
 /*
-* Gera uma nova planta com características específicas
-* @param id Identificador único da planta
-* @param tipo Tipo de planta (0-Saudável, 1-Infectada visível, 2-Infectada oculta)
-* @return Estrutura Planta configurada
-*/
-Planta gerar_planta(int id, int tipo) {
-    Planta p;
-    p.id = id;
-    p.infectada = false;
-    p.tratada = false;
-
-    for (int i = 0; i < FOLHAS_POR_PLANTA; i++) {
-        float R, G, B, NIR;
-        bool doente = false;
-        bool visivel_doente = false;
-
-        // Configuração baseada no tipo de planta
-        switch (tipo) {
-            case 0: // Saudável
-                // Garante que os valores vão gerar um NDVI e GNDVI sempre acima do limiar saudável
-                R = (rand() % 10 + 30) / 100.0f;  // Mantém baixo para um NDVI alto
-                G = (rand() % 10 + 60) / 100.0f;  // Mantém alto para um GNDVI alto
-                B = (rand() % 20 + 40) / 100.0f;  
-                NIR = (rand() % 20 + 95) / 100.0f;  // Mantém bem alto para NDVI/GNDVI saudáveis
-                break;
-
-            case 1: // Visivelmente infectada
-                R = 0.70f + (rand() % 15) / 100.0f;
-                G = 0.40f + (rand() % 10) / 100.0f;
-                B = 0.30f + (rand() % 10) / 100.0f;
-                NIR = 0.60f + (rand() % 10) / 100.0f;
-                visivel_doente = true; // Marca infecção visível
-                doente = true;
-                break;
-
-            case 2: // Infectada sem sintomas visíveis
-                R = 0.50f + (rand() % 10) / 100.0f;
-                G = 0.55f + (rand() % 10) / 100.0f;
-                B = 0.45f + (rand() % 10) / 100.0f;
-                NIR = 0.70f + (rand() % 20) / 100.0f;
-                doente = true;
-                break;
-        }
-
-        // Verifica infecção com a função existente
-        doente = detectar_doenca(R, G, B, NIR);
-
-        // Calcula índices NDVI e GNDVI
-        float ndvi = (NIR - R) / (NIR + R + 0.001f);
-        float gndvi = (NIR - G) / (NIR + G + 0.001f);
-
-        // Configuração da folha
-        p.folhas[i] = (EstadoFolha) {
-            .reflectancia = {R, G, B, NIR},
-            .ndvi = ndvi,
-            .gndvi = gndvi,
-            .visivel = visivel_doente,
-            .infectada = doente
-        };
-
-        // Se houver uma folha visivelmente doente, a planta toda é marcada como infectada
-        if (visivel_doente) {
-            p.infectada = true;
-        }
-    }
-    return p;
+* Lê o joystick passando pela gravação de entradas: gravando, registra a
+* leitura; reproduzindo, a substitui pela gravada
+*/
+void ler_entradas_joystick() {
+    ler_joystick();
+    uint16_t x = vrx_valor, y = vry_valor;
+    gravacao_joystick(&gravacao, &x, &y);
+    vrx_valor = x;
+    vry_valor = y;
 }
 
-
-
- /*
-* Aplica tratamento fungicida na planta
-* @param p Ponteiro para a planta a ser tratada
+/*
+* Converte as flags dos botões (setadas nas interrupções) em eventos da FSM.
+* Na reprodução, os botões físicos são ignorados e valem os gravados.
 */
-void tratar_planta(Planta *p) {
-    for (int i = 0; i < FOLHAS_POR_PLANTA; i++) {
-        // Define valores saudáveis
-        p->folhas[i] = (EstadoFolha) {
-            .reflectancia = {0.40f, 0.70f, 0.50f, 0.95f}, // Valores de referência saudáveis
-            .ndvi = (0.95f - 0.40f) / (0.95f + 0.40f + 0.001f),
-            .gndvi = (0.95f - 0.70f) / (0.95f + 0.70f + 0.001f),
-            .visivel = false,
-            .infectada = false
-        };
+void postar_eventos_botoes() {
+    uint8_t botoes = 0;
+    if(buttonA_flag) {
+        buttonA_flag = false;
+        botoes |= GRAVACAO_BOTAO_A;
     }
-    p->infectada = false;
-    p->tratada = true;
+    if(buttonB_flag) {
+        buttonB_flag = false;
+        botoes |= GRAVACAO_BOTAO_B;
+    }
+    if(buttonJoyStick_flag) {
+        buttonJoyStick_flag = false;
+        botoes |= GRAVACAO_BOTAO_JOYSTICK;
+    }
+    gravacao_botoes(&gravacao, &botoes);
+
+    if(botoes & GRAVACAO_BOTAO_A) fsm_postar(&fsm, EVENTO_BOTAO_A);
+    if(botoes & GRAVACAO_BOTAO_B) fsm_postar(&fsm, EVENTO_BOTAO_B);
+    if(botoes & GRAVACAO_BOTAO_JOYSTICK) fsm_postar(&fsm, EVENTO_BOTAO_JOYSTICK);
 }
 
 /**********************************
@@ -520,11 +1484,14 @@ void tratar_planta(Planta *p) {
 /*
 * Renderiza a representação visual da planta na matriz de LEDs
 * @param p Planta a ser exibida
+* @param folhas Folhas da planta no pool do registro
 * @param folha Folha selecionada (-1 para nenhuma)
+* A matriz tem FOLHAS_POR_PLANTA posições de folha; plantas com mais folhas
+* são exibidas em páginas, a página da folha selecionada.
 */
 
 
-void exibe_planta(Planta p, int folha) {
+void exibe_planta(const Planta *p, const FolhaCompacta *folhas, int folha) {
     // Cores pré-definidas (const para otimização)
     static const uint8_t MARROM_VINHO[3] = {5, 0, 0};
     static const uint8_t VERDE_FRACO[3]  = {0, 100, 0};
@@ -532,24 +1499,27 @@ void exibe_planta(Planta p, int folha) {
     static const uint8_t LARANJA_FRACO[3] = {100, 100, 0};
     static const uint8_t LARANJA_FORTE[3] = {5, 5, 0};
 
+    // Primeira folha da página exibida
+    int pagina = folha > 0 ? (folha - 1) / FOLHAS_POR_PLANTA * FOLHAS_POR_PLANTA : 0;
+
     for(int y = 0; y < 5; y++) {      // Linhas lógicas (0-4)
         for(int x = 0; x < 5; x++) {  // Colunas lógicas (0-4)
             int valor = planta_cafe[y][x]; // Observacao: invertemos x e y aqui
             int index = getIndex(x, 4 - y); // Inverte a ordem das linhas
 
-            if(valor >= 1 && valor <= FOLHAS_POR_PLANTA) { 
-                int folha_atual = valor;
+            if(valor >= 1 && valor <= FOLHAS_POR_PLANTA && pagina + valor <= p->num_folhas) { 
+                int folha_atual = pagina + valor;
                 
                 // Seleção de cores baseada no estado
 
                 if(folha_atual == folha) { // Selecionada
-                    if(p.folhas[folha_atual-1].visivel) {
+                    if(folha_compacta_visivel(folhas[folha_atual-1])) {
                         npSetLED(index, LARANJA_FORTE[0], LARANJA_FORTE[1], LARANJA_FORTE[2]);
                     } else {
                         npSetLED(index, VERDE_FORTE[0], VERDE_FORTE[1], VERDE_FORTE[2]);
                     }
                 } else { // Não selecionada
-                    if(p.folhas[folha_atual-1].visivel) {
+                    if(folha_compacta_visivel(folhas[folha_atual-1])) {
                         npSetLED(index, LARANJA_FRACO[0], LARANJA_FRACO[1], LARANJA_FRACO[2]);
                     } else {
                         npSetLED(index, VERDE_FRACO[0], VERDE_FRACO[1], VERDE_FRACO[2]);
@@ -582,8 +1552,7 @@ void escrever_linha(const char* texto, int linha, int coluna, bool centralizado)
     int pos_y = linha * 10; // 10px por linha
     
     if(centralizado) {
-        int len = strlen(texto);
-        pos_x = (128 - (len * TAMANHO_FONTE)) / 2; // Cálculo do centro
+        pos_x = (128 - (int)ssd1306_text_width(&display, texto)) / 2; // Cálculo do centro (UTF-8)
     }
     
     ssd1306_draw_string(&display, texto, pos_x, pos_y);
@@ -595,28 +1564,41 @@ void escrever_linha(const char* texto, int linha, int coluna, bool centralizado)
 **********************************/
  /*
 * Exibe o menu principal de seleção de plantas
-* @param atual Índice da planta atual
+* @param p Planta atual
+* @param posicao Posição da planta em ordem de campo
 * @param custo Custo acumulado de tratamentos
 */
-void exibir_menu_planta(int atual, int custo) {
+void exibir_menu_planta(const Planta *p, uint16_t posicao, int custo) {
     static uint8_t mensagem_atual = 0;
     static uint32_t ultima_troca = 0;
     char buffer[30];
+    Texto t;
     
     // Limpa display
     ssd1306_fill(&display, false);
 
     // Cabeçalho fixo
     escrever_linha("<", 0, 0, false);
-    snprintf(buffer, sizeof(buffer), "%s %d/%d", 
-           "PLANTA:", atual, 5);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_natural(&t, posicao + 1);
+    texto_car(&t, '/');
+    texto_natural(&t, registro_total(&registro));
     escrever_linha(buffer, 0, 0, true); // Centralizado
     escrever_linha(">", 0, 15, false); 
+
+    // Posição no talhão
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "FIL ");
+    texto_natural(&t, p->fileira + 1);
+    texto_str(&t, " COL ");
+    texto_natural(&t, p->coluna + 1);
+    escrever_linha(buffer, 1, 0, true);
     
     // Custo
-    snprintf(buffer, sizeof(buffer), "%s %d.00", 
-           "CUSTO:", custo);
-    escrever_linha(buffer, 1, 0, true); // Centralizado
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "CUSTO: ");
+    texto_fixo(&t, custo * 100, 2);
+    escrever_linha(buffer, 2, 0, true); // Centralizado
 
     // Mensagens rotativas
     uint32_t agora = to_ms_since_boot(get_absolute_time());
@@ -628,20 +1610,20 @@ void exibir_menu_planta(int atual, int custo) {
     switch (mensagem_atual)
     {
     case 0:
-        escrever_linha("MOVA O", 3, 0, true);    
-        escrever_linha("JOYSTICK < >", 4, 0, true);       
+        escrever_linha("JOYSTICK < >", 4, 0, true);    
+        escrever_linha("FILEIRA ^ v", 5, 0, true);       
         break;
     case 1:
-        escrever_linha("APERTE B", 3, 0, true);    
-        escrever_linha("p/ SELECIONAR", 4, 0, true);  
+        escrever_linha("APERTE B", 4, 0, true);    
+        escrever_linha("p/ SELECIONAR", 5, 0, true);  
         break;
     case 2:
-        escrever_linha("APERTE A", 3, 0, true);    
-        escrever_linha("p/ TRATAR", 4, 0, true);
+        escrever_linha("APERTE A", 4, 0, true);    
+        escrever_linha("p/ TRATAR", 5, 0, true);
         break;
     case 3:
-        escrever_linha("APERTE JOY", 3, 0, true);    
-        escrever_linha("p/ ESCANEAR", 4, 0, true);
+        escrever_linha("APERTE JOY", 4, 0, true);    
+        escrever_linha("p/ ESCANEAR", 5, 0, true);
         break;
     }
 
@@ -651,19 +1633,24 @@ void exibir_menu_planta(int atual, int custo) {
  /*
 * Exibe o menu principal de seleção de folhas
 * @param atual Índice da folha atual
+* @param total Número de folhas da planta
 */
-void exibir_menu_folha(int atual) {
+void exibir_menu_folha(int atual, int total) {
     static uint8_t mensagem_atual = 0;
     static uint32_t ultima_troca = 0;
     char buffer[30];
+    Texto t;
     
     // Limpa display
     ssd1306_fill(&display, false);
 
     // Cabeçalho fixo
     escrever_linha("<", 0, 0, false);
-    snprintf(buffer, sizeof(buffer), "%s %d/%d", 
-           "FOLHA:", atual, 5);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "FOLHA: ");
+    texto_inteiro(&t, atual);
+    texto_car(&t, '/');
+    texto_inteiro(&t, total);
     escrever_linha(buffer, 0, 0, true);
     escrever_linha(">", 0, 15, false); 
     
@@ -694,116 +1681,446 @@ void exibir_menu_folha(int atual) {
 }
 
 /**********************************
-* IMPLEMENTAÇÃO DO SISTEMA DE ESCANEAMENTO
+* IMPLEMENTAÇÃO DOS ESTADOS
 **********************************/
 
-  /*
-* Controla o processo completo de calibração e escaneamento
-* Estados:
+//==============================================
+// ESTADO: MENU PRINCIPAL
+//==============================================
+void menu_entrar() {
+    configurar_interrupcoes_botoes(true, true, true);
+    atualizar_display = true;
+}
+
+void menu_tick() {
+    uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
+
+    //---------- Controle de Navegação ---------
+    gerenciar_menu_principal(&indice_planta, &atualizar_display);
+
+    //---------- Atualização de Display ---------
+    if(atualizar_display || (tempo_atual - ultima_atualizacao >= TEMPO_TROCA_MENSAGEM)) {
+        Planta *p = registro_planta(&registro, indice_planta);
+        exibe_planta(p, registro_folhas(&registro, p), -1);
+        exibir_menu_planta(p, indice_planta, custo_total);
+        atualizar_led_status(p->infectada, false);
+        atualizar_display = false;
+        ultima_atualizacao = tempo_atual;
+    }
+}
+
+/*
+* Botão A no menu: trata a planta selecionada (transição interna)
+*/
+void acao_tratar_planta() {
+    configurar_interrupcoes_botoes(false, false, false);
+    ssd1306_fill(&display, false);
+
+    Planta *p = registro_planta(&registro, indice_planta);
+
+    // Planta já tratada
+    if(p->tratada) {
+        // Feedback sonoro
+        buzzer_som_analise_concluida();
+        sleep_ms(100);
+        buzzer_turn_off();
+        sleep_ms(100);
+        buzzer_som_analise_concluida();
+        sleep_ms(100);
+        buzzer_turn_off();
+
+        // Mensagem de status
+        escrever_linha("TRATAMENTO JÁ", 2, 0, true);
+        escrever_linha("REALIZADO", 3, 0, true);
+        sleep_ms(1000);
+    }
+    // Planta não tratada
+    else {
+        // Animação de tratamento
+        buzzer_som_analise_iniciada();
+        sleep_ms(100);
+        buzzer_turn_off();
+        sleep_ms(100);
+        buzzer_som_analise_iniciada();
+        sleep_ms(100);
+        buzzer_turn_off();
+
+        escrever_linha("TRATANDO PLANTA", 2, 0, true);
+        escrever_linha("", 3, 0, true);
+        sleep_ms(250);
+
+        escrever_linha("TRATANDO PLANTA", 2, 0, true);
+        escrever_linha(".", 3, 0, true);
+        sleep_ms(250);
+
+        escrever_linha("TRATANDO PLANTA", 2, 0, true);
+        escrever_linha("..", 3, 0, true);
+        sleep_ms(250);
+
+        escrever_linha("TRATANDO PLANTA", 2, 0, true);
+        escrever_linha("...", 3, 0, true);
+        sleep_ms(250);
+
+        buzzer_som_analise_concluida();
+        sleep_ms(100);
+        buzzer_turn_off();
+        sleep_ms(100);
+        buzzer_som_analise_concluida();
+        sleep_ms(100);
+        buzzer_turn_off();
+
+        // Atualiza custos
+        custo_total += CUSTO_POR_FUNGICIDA;
+
+        // Trata a planta
+        tratar_planta(p, registro_folhas(&registro, p));
+        planejador_atualizar(&planejador, indice_planta);
+    }
+
+    configurar_interrupcoes_botoes(true, true, true);
+    buttonA_flag = false;
+    atualizar_display = true;
+}
+
+/*
+* Botão B no menu: abre a seleção de folhas da planta atual
+*/
+void acao_abrir_folhas() {
+    indice_folha = 0;
+    buzzer_som_selecao();
+    sleep_ms(100);
+}
+
+//==============================================
+// ESTADO: SELEÇÃO DE FOLHA
+//==============================================
+void selecao_folha_entrar() {
+    configurar_interrupcoes_botoes(true, true, false);
+    atualizar_display = true;
+}
+
+void selecao_folha_tick() {
+    uint32_t tempo_atual = to_ms_since_boot(get_absolute_time());
+
+    //---------- Controle de Navegação ---------
+    Planta *p = registro_planta(&registro, indice_planta);
+    gerenciar_selecao_folha(&indice_folha, p->num_folhas, &atualizar_display);
+
+    //---------- Atualização de Display ---------
+    if(atualizar_display || (tempo_atual - ultima_atualizacao >= TEMPO_TROCA_MENSAGEM)) {
+        exibe_planta(p, registro_folhas(&registro, p), indice_folha + 1);
+        exibir_menu_folha(indice_folha + 1, p->num_folhas);
+        atualizar_led_status(p->infectada, false);
+        atualizar_display = false;
+        ultima_atualizacao = tempo_atual;
+    }
+}
+
+/*
+* Botão A na seleção de folha: volta ao menu principal
+*/
+void acao_voltar_menu() {
+    buzzer_som_selecao();
+    sleep_ms(100);
+}
+
+//==============================================
+// ESTADO: ANÁLISE DE FOLHA
+//==============================================
+/*
+* Executa a análise da folha selecionada e exibe o resultado.
+* O estado permanece na tela de resultado até o botão A.
+*/
+void analisar_entrar() {
+    //---------- Preparação para Análise ---------
+    configurar_interrupcoes_botoes(false, false, false); // Desativa interrupções
+
+    //---------- Processo de Análise ---------
+    animacao_analise(500); // Animação de carregamento
+    EstadoFolha folha;
+    Planta *p = registro_planta(&registro, indice_planta);
+    folha_descompactar(registro_folhas(&registro, p)[indice_folha], &folha);
+    bool resultado = detectar_doenca_folha(&folha);
+
+    //---------- Atualização de Estado ---------
+    if(resultado) {
+        p->infectada = true; // Marca planta como infectada
+    }
+    folha.infectada = resultado;
+    registrar_analise(&folha, p->id, indice_folha, ORIGEM_ANALISE);
+    planejador_atualizar(&planejador, indice_planta);
+    sleep_ms(200);
+
+    //---------- Feedback Visual/Sonoro ---------
+    atualizar_led_status(resultado, false); // Atualiza LEDs
+    if(resultado)
+        buzzer_infectada();
+    else
+        buzzer_saudavel();
+    exibir_resultado_analise_folha(&folha); // Mostra resultados
+
+    // Aguarda confirmação do usuário (botão A)
+    configurar_interrupcoes_botoes(true, false, false);
+}
+
+//==============================================
+// ESTADO: MODO ESCANEAMENTO (CALIBRAÇÃO)
+//==============================================
+/*
+* Controla o processo de calibração:
 * - Etapa 0: Ajuste de Vermelho (R) e Infravermelho (NIR)
 * - Etapa 1: Ajuste de Verde (G) e Azul (B)
 * - Etapa 2: Modo inativo
 */
-void simular_escaneamento() {
-    uint8_t etapa_calibracao = 2; // Começa desativado
-    estado_escaneamento = MODO_ESCANEAMENTO;
+void escaneamento_entrar() {
+    configurar_interrupcoes_botoes(true, true, true);
+    atualizar_led_status(false, true); // Desliga LEDs indicativos
+    etapa_calibracao = 2;              // Começa desativado
+    filtro_iniciar(&filtro_calibracao, FILTRO_ALFA_SHIFT, FILTRO_PASSO);
+    filtro_reiniciar(&filtro_calibracao, amostra_calibracao.reflectancia);
+    veredito_calibracao = detectar_doenca_folha(&amostra_calibracao);
+    atualizar_interface = true;
+}
 
-    bool atualizar_interface = true;
+/*
+* As leituras passam pelo filtro; detecção e redesenho só acontecem quando o
+* valor filtrado muda mais que FILTRO_PASSO em alguma banda
+*/
+void escaneamento_tick() {
+    if(etapa_calibracao != 2) {
+        ler_entradas_joystick(); // Valores brutos (o loop principal normaliza)
+        Reflectancia r = filtro_valor(&filtro_calibracao);
+
+        // Calibração de R e NIR
+        if(etapa_calibracao == 0){
+            r.R = vry_valor;   // Leitura do ADC já está na escala de reflectância
+            r.NIR = vrx_valor;
+        }
+        // Calibração de G e B
+        else {
+            r.G = vry_valor;
+            r.B = vrx_valor;
+        }
 
-    while (true){
-        // Modo de ajuste de calibração
-        if(estado_escaneamento == MODO_ESCANEAMENTO){
+        if(filtro_atualizar(&filtro_calibracao, r)) {
+            folha_definir_reflectancia(&amostra_calibracao, filtro_valor(&filtro_calibracao));
+            veredito_calibracao = detectar_doenca_folha(&amostra_calibracao);
+            atualizar_interface = true;
+        }
+    }
 
-            ler_joystick();
-            buzzer_update();                  // Atualiza estado do buzzer
+    // Atualização em tempo real
+    if(atualizar_interface){
+        exibir_grafico_display(&amostra_calibracao.reflectancia,
+                               veredito_calibracao ? "PREV: INFECTADA" : "PREV: SAUDÁVEL");
+        exibir_grafico_matriz(&amostra_calibracao.reflectancia);
+        atualizar_interface = false;
+    }
+}
 
-            // Calibração de R e NIR            
-            if(etapa_calibracao == 0){
-                valores_ajustados.R = vry_valor / (float)ADC_MAX;
-                valores_ajustados.NIR = vrx_valor / (float)ADC_MAX;
-                atualizar_interface = true;
-            }
-            // Calibração de G e B
-            else if(etapa_calibracao == 1) {
-                valores_ajustados.G = vry_valor / (float)ADC_MAX;
-                valores_ajustados.B = vrx_valor / (float)ADC_MAX;
-                atualizar_interface = true;
-            }
-            
-            // Controle de etapas
-            if(buttonB_flag) {
-                etapa_calibracao = (etapa_calibracao + 1) % 3;
-                buttonB_flag = false;
-                buzzer_som_selecao();
-            }
-            
-            // Iniciar análise
-            if(buttonA_flag) {
-                estado_escaneamento = ANALISE;
-                configurar_interrupcoes_botoes(false, false, false);
-                buttonA_flag = false;
-            }
+/*
+* Botão B na calibração: avança a etapa
+*/
+void acao_avancar_etapa() {
+    etapa_calibracao = (etapa_calibracao + 1) % 3;
+    buzzer_som_selecao();
+}
 
-            // Atualização em tempo real
-            if(atualizar_interface){
-                exibir_grafico_display(valores_ajustados);
-                exibir_grafico_matriz(valores_ajustados);
-                atualizar_interface = false;
-            }
+/*
+* Botão do joystick na calibração: limpa as saídas e volta ao menu
+*/
+void acao_sair_escaneamento() {
+    npClear();
+    npWrite();
+    ssd1306_fill(&display, false);
+    ssd1306_send_data(&display);
+    buzzer_som_selecao();
+}
 
-        }
-        // Processamento da análise
-        else if(estado_escaneamento == ANALISE){
-
-            //teste_deteccao();
-                            
-            bool resultado = detectar_doenca(valores_ajustados.R,
-                                            valores_ajustados.G,
-                                            valores_ajustados.B,
-                                            valores_ajustados.NIR);
-            
-            // Cálculo de índices
-            float ndvi = (valores_ajustados.NIR - valores_ajustados.R) / (valores_ajustados.NIR + valores_ajustados.R + 0.001f);
-            float gndvi = (valores_ajustados.NIR - valores_ajustados.G) / (valores_ajustados.NIR + valores_ajustados.G + 0.001f);
-            
-            // Feedback ao usuário
-            animacao_analise(500);
-            sleep_ms(200);
-            atualizar_led_status(resultado, false);
-            if(resultado)
-                buzzer_infectada();
-            else
-                buzzer_saudavel();
-            exibir_resultado_analise(resultado,valores_ajustados.R,
-                                    valores_ajustados.G,
-                                    valores_ajustados.B,
-                                    valores_ajustados.NIR,
-                                    ndvi,
-                                    gndvi
-                                    );
-            buzzer_som_selecao();
-            atualizar_led_status(false, true);
+//==============================================
+// ESTADO: ANÁLISE DOS VALORES CALIBRADOS
+//==============================================
+void analisar_escaneamento_entrar() {
+    configurar_interrupcoes_botoes(false, false, false);
+
+    // Detecção e índices vêm do cache da amostra
+    bool resultado = detectar_doenca_folha(&amostra_calibracao);
+    amostra_calibracao.infectada = resultado;
+    registrar_analise(&amostra_calibracao, 0, 0, ORIGEM_CALIBRACAO);
+
+    // Feedback ao usuário
+    animacao_analise(500);
+    sleep_ms(200);
+    atualizar_led_status(resultado, false);
+    if(resultado)
+        buzzer_infectada();
+    else
+        buzzer_saudavel();
+    exibir_resultado_analise_folha(&amostra_calibracao);
+
+    // Aguarda confirmação do usuário (botão A)
+    configurar_interrupcoes_botoes(true, false, false);
+}
 
-            // Reset do sistema 
-            atualizar_interface = true;
-            estado_escaneamento = MODO_ESCANEAMENTO;
-            etapa_calibracao = 2;
-            configurar_interrupcoes_botoes(true, true, true);
-            
+/*
+* Botão A no resultado: retorna à calibração
+*/
+void acao_concluir_escaneamento() {
+    buzzer_som_selecao();
+    atualizar_led_status(false, true);
+}
+
+//==============================================
+// ESTADO: SIMULAÇÃO DE PROPAGAÇÃO
+//==============================================
+/*
+* Grade de plantas em que a infecção se espalha a cada dia (utils/epidemia).
+* Joystick move o cursor, B avança um dia, A trata as plantas sob o cursor
+* e o botão do joystick volta ao menu. Sem grade configurada pelo comando
+* "simular", usa a padrão.
+*/
+void simulacao_entrar() {
+    configurar_interrupcoes_botoes(true, true, true);
+    if(!epidemia_pronta) {
+        epidemia_iniciar(&epidemia, SIM_LARGURA, SIM_ALTURA, memoria_epidemia, SIM_MAX_PALAVRAS,
+                         SIM_CHANCE, SEMENTE_CAMPO);
+        epidemia_semear(&epidemia, SIM_FOCOS);
+        custo_simulacao = 0;
+        epidemia_pronta = true;
+    }
+    atualizar_led_status(false, true);
+    atualizar_display = true;
+}
+
+void simulacao_tick() {
+    //---------- Cursor ---------
+    const uint8_t colunas = WIDTH / SIM_TAM_CURSOR;
+    const uint8_t linhas = (HEIGHT - SIM_TOPO_GRADE) / SIM_TAM_CURSOR;
+    if(vrx_valor != MEIO) {
+        cursor_x = (cursor_x + colunas + vrx_valor) % colunas;
+        atualizar_display = true;
+    }
+    if(vry_valor != MEIO) {
+        cursor_y = (cursor_y + linhas - vry_valor) % linhas; // Cima diminui a linha
+        atualizar_display = true;
+    }
+
+    //---------- Atualização de Display ---------
+    if(atualizar_display) {
+        exibir_simulacao();
+        exibir_simulacao_matriz();
+        atualizar_display = false;
+    }
+}
+
+// Primeira célula da grade coberta por um pixel (ou LED) da visão reduzida
+static uint16_t celula_do_pixel(uint16_t pixel, uint16_t pixels, uint16_t celulas) {
+    return (uint32_t)pixel * celulas / pixels;
+}
+
+// Fim (exclusivo) do trecho de células coberto, com pelo menos uma célula
+static uint16_t fim_celulas_pixel(uint16_t pixel, uint16_t pixels, uint16_t celulas) {
+    uint16_t inicio = celula_do_pixel(pixel, pixels, celulas);
+    uint16_t fim = celula_do_pixel(pixel + 1, pixels, celulas);
+    return fim > inicio ? fim : inicio + 1;
+}
+
+/*
+* Botão A na simulação: trata as plantas sob o cursor
+*/
+void acao_tratar_bloco() {
+    const uint16_t altura_px = HEIGHT - SIM_TOPO_GRADE;
+    uint16_t px = cursor_x * SIM_TAM_CURSOR, py = cursor_y * SIM_TAM_CURSOR;
+    uint32_t tratadas = epidemia_tratar_bloco(&epidemia,
+        celula_do_pixel(px, WIDTH, epidemia.largura),
+        celula_do_pixel(py, altura_px, epidemia.altura),
+        fim_celulas_pixel(px + SIM_TAM_CURSOR - 1, WIDTH, epidemia.largura),
+        fim_celulas_pixel(py + SIM_TAM_CURSOR - 1, altura_px, epidemia.altura));
+    custo_simulacao += tratadas * CUSTO_POR_FUNGICIDA;
+    buzzer_som_selecao();
+    atualizar_display = true;
+}
+
+/*
+* Botão B na simulação: avança um dia
+*/
+void acao_avancar_dia() {
+    uint32_t novas = epidemia_avancar_dia(&epidemia);
+    printf("simulacao: dia=%lu novas=%lu\n", (unsigned long)epidemia.dia, (unsigned long)novas);
+    atualizar_display = true;
+}
+
+//==============================================
+// ESTADO: PLANO DE TRATAMENTO
+//==============================================
+/*
+* Lista paginada das plantas a tratar, em ordem de prioridade. Joystick ^ v
+* percorre a lista, < > troca de página; A trata a planta selecionada, B a
+* abre no menu e o botão do joystick volta ao menu.
+*/
+void plano_entrar() {
+    configurar_interrupcoes_botoes(true, true, true);
+    item_plano = 0;
+    atualizar_display = true;
+}
+
+void plano_tick() {
+    //---------- Controle de Navegação ---------
+    if(tamanho_plano > 0) {
+        if(vry_valor == BAIXO) {
+            item_plano = (item_plano + 1) % tamanho_plano;
+            atualizar_display = true;
+        }
+        else if(vry_valor == CIMA) {
+            item_plano = (item_plano + tamanho_plano - 1) % tamanho_plano;
+            atualizar_display = true;
+        }
+        else if(vrx_valor == DIREITA) {
+            item_plano = item_plano + PLANO_ITENS_PAGINA < tamanho_plano ? item_plano + PLANO_ITENS_PAGINA : tamanho_plano - 1;
+            atualizar_display = true;
         }
+        else if(vrx_valor == ESQUERDA) {
+            item_plano = item_plano >= PLANO_ITENS_PAGINA ? item_plano - PLANO_ITENS_PAGINA : 0;
+            atualizar_display = true;
+        }
+    }
 
-        // Saída do modo escaneamento
-        if(buttonJoyStick_flag){
+    //---------- Atualização de Display ---------
+    // O plano é refeito a cada redesenho: análises e tratamentos já
+    // atualizaram o ranking, a extração custa O(k log k)
+    if(atualizar_display) {
+        atualizar_plano();
+        exibir_plano();
+        if(tamanho_plano > 0) {
+            Planta *p = registro_planta(&registro, plano[item_plano]);
+            exibe_planta(p, registro_folhas(&registro, p), -1);
+            atualizar_led_status(p->infectada, false);
+        } else {
             npClear();
             npWrite();
-            ssd1306_fill(&display, false);
-            ssd1306_send_data(&display);
-            buttonJoyStick_flag = false;
-            configurar_interrupcoes_botoes(true, true, true);
-            break;
+            atualizar_led_status(false, true);
         }
+        atualizar_display = false;
     }
+}
+
+/*
+* Botão A no plano: trata a planta selecionada, como o botão A no menu
+*/
+void acao_tratar_do_plano() {
+    if(tamanho_plano == 0) return;
+    indice_planta = plano[item_plano];
+    acao_tratar_planta();
+}
 
+/*
+* Botão B no plano: volta ao menu com a planta selecionada
+*/
+void acao_abrir_planta_do_plano() {
+    if(tamanho_plano > 0) {
+        indice_planta = plano[item_plano];
+    }
+    buzzer_som_selecao();
 }
 
 /**********************************
@@ -820,14 +2137,14 @@ void simular_escaneamento() {
 * - Colunas 3-4: Infravermelho (NIR)
 */
 
-void exibir_grafico_matriz(Reflectancia r){
+void exibir_grafico_matriz(const Reflectancia *r){
    
    // Limpa todos os LEDs primeiro
    npClear();
 
    // Mapeamento das bandas espectrais para colunas
    const uint8_t colunas[5] = {0, 1, 2, 3, 4}; // R, G, B, NIR
-   float valores[5] = {r.R, r.G, r.B, r.NIR, r.NIR};
+   uint16_t valores[5] = {r->R, r->G, r->B, r->NIR, r->NIR};
    
    // Cores correspondentes para cada banda (R, G, B)
    const uint8_t cores[5][3] = {
@@ -841,7 +2158,8 @@ void exibir_grafico_matriz(Reflectancia r){
    // Para cada banda espectral
    for(int banda = 0; banda < 5; banda++) {
        // Calcula a altura da coluna (0-5 LEDs)
-       uint8_t altura = (uint8_t)(valores[banda] * 6);
+       uint32_t escala = (uint32_t)valores[banda] * 6 / REFLECTANCIA_MAX;
+       uint8_t altura = escala > 5 ? 5 : escala;
        
        // Determina a coluna atual
        uint8_t x = colunas[banda];
@@ -870,14 +2188,17 @@ void exibir_grafico_matriz(Reflectancia r){
 /*
 * Exibe gráfico de barras com valores de reflectância no display OLED
 * @param r Valores de reflectância a serem plotados
+* @param titulo Texto na linha superior (NULL para nenhum)
 * Cada banda ocupa 34 pixels de largura com 20px de área útil
 */
 
-void exibir_grafico_display(Reflectancia r) {
+void exibir_grafico_display(const Reflectancia *r, const char *titulo) {
     // Limpa a tela
     ssd1306_fill(&display, false);
-    
 
+    if (titulo) {
+        ssd1306_draw_string(&display, titulo, 0, 0);
+    }
     
     // Define a posição base para as barras (deixando espaço para o título)
     // Supondo que 'ssd.height' é a altura do display e 'TAMANHO_FONTE' é o tamanho da fonte (ex: 8)
@@ -889,20 +2210,21 @@ void exibir_grafico_display(Reflectancia r) {
     
     // Para cada banda, calcular e desenhar a barra, o valor (em porcentagem) e o rótulo
     for(uint8_t i = 0; i < 4; i++) {
-        float valor;
+        uint16_t valor;
         switch(i) {
-            case 0: valor = r.R; break;
-            case 1: valor = r.G; break;
-            case 2: valor = r.B; break;
-            case 3: valor = r.NIR; break;
+            case 0: valor = r->R; break;
+            case 1: valor = r->G; break;
+            case 2: valor = r->B; break;
+            case 3: valor = r->NIR; break;
         }
         
-        // Converte o valor (0.0 a 1.0) para porcentagem (0 a 100)
-        float porcentagem = (valor * 100);
+        // Converte o valor (0 a REFLECTANCIA_MAX) para porcentagem (0 a 100)
+        uint8_t porcentagem = reflectancia_percentual(valor);
         
-        // Define a escala: 40 pixels corresponde a valor 1.0 (ou 100%)
-        uint8_t escala = 40;
-        uint8_t altura = (uint8_t)(valor * escala);
+        // Define a escala: 30 pixels corresponde a valor 1.0 (ou 100%), deixando a linha do título livre
+        uint8_t escala = 30;
+        uint32_t altura_px = (uint32_t)valor * escala / REFLECTANCIA_MAX;
+        uint8_t altura = altura_px > 255 ? 255 : (uint8_t)altura_px;
         if (altura > y_base) {
             altura = y_base;
         }
@@ -915,7 +2237,9 @@ void exibir_grafico_display(Reflectancia r) {
         
         // Prepara o valor numérico (em porcentagem)
         char buffer[8];
-        snprintf(buffer, sizeof(buffer), "%.0f%%", porcentagem);
+        Texto t;
+        texto_iniciar(&t, buffer, sizeof(buffer));
+        texto_percentual(&t, porcentagem);
         
         // Exibe o valor numérico abaixo da barra
         ssd1306_draw_string(&display, buffer, colunas[i], y_base + 2);
@@ -928,6 +2252,120 @@ void exibir_grafico_display(Reflectancia r) {
     ssd1306_send_data(&display);
 }
 
+/*
+* Grade da simulação reduzida ao OLED: cabeçalho com dia, infectadas e custo;
+* abaixo, um pixel aceso por bloco com alguma infectada, blocos só tratados
+* em xadrez e o cursor de tratamento invertido
+*/
+void exibir_simulacao() {
+    const uint16_t altura_px = HEIGHT - SIM_TOPO_GRADE;
+    char buffer[20];
+    Texto t;
+    uint32_t infectadas, tratadas;
+    epidemia_contar_bloco(&epidemia, 0, 0, epidemia.largura, epidemia.altura, &infectadas, &tratadas);
+    uint32_t milesimos = (uint64_t)infectadas * 1000 / ((uint32_t)epidemia.largura * epidemia.altura);
+
+    ssd1306_fill(&display, false);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_car(&t, 'D');
+    texto_natural(&t, epidemia.dia);
+    texto_car(&t, ' ');
+    texto_fixo(&t, (int32_t)milesimos, 1);
+    texto_str(&t, "% $");
+    texto_natural(&t, custo_simulacao);
+    ssd1306_draw_string(&display, buffer, 0, 0);
+
+    for(uint16_t py = 0; py < altura_px; py++) {
+        uint16_t y0 = celula_do_pixel(py, altura_px, epidemia.altura);
+        uint16_t y1 = fim_celulas_pixel(py, altura_px, epidemia.altura);
+        bool borda_y = py / SIM_TAM_CURSOR == cursor_y;
+        for(uint16_t px = 0; px < WIDTH; px++) {
+            uint32_t inf, trat;
+            epidemia_contar_bloco(&epidemia, celula_do_pixel(px, WIDTH, epidemia.largura), y0,
+                                  fim_celulas_pixel(px, WIDTH, epidemia.largura), y1, &inf, &trat);
+            bool aceso = inf > 0 || (trat > 0 && ((px ^ py) & 1));
+
+            // Contorno do cursor, invertido para aparecer sobre qualquer fundo
+            if(borda_y && px / SIM_TAM_CURSOR == cursor_x &&
+               (px % SIM_TAM_CURSOR == 0 || px % SIM_TAM_CURSOR == SIM_TAM_CURSOR - 1 ||
+                py % SIM_TAM_CURSOR == 0 || py % SIM_TAM_CURSOR == SIM_TAM_CURSOR - 1)) {
+                aceso = !aceso;
+            }
+            ssd1306_pixel(&display, px, py + SIM_TOPO_GRADE, aceso);
+        }
+    }
+    ssd1306_send_data(&display);
+}
+
+/*
+* Grade da simulação reduzida à matriz 5x5: vermelho pela fração de
+* infectadas, azul pela de tratadas, verde fraco no restante
+*/
+void exibir_simulacao_matriz() {
+    npClear();
+    for(uint8_t linha = 0; linha < 5; linha++) {
+        uint16_t y0 = celula_do_pixel(linha, 5, epidemia.altura);
+        uint16_t y1 = fim_celulas_pixel(linha, 5, epidemia.altura);
+        for(uint8_t coluna = 0; coluna < 5; coluna++) {
+            uint16_t x0 = celula_do_pixel(coluna, 5, epidemia.largura);
+            uint16_t x1 = fim_celulas_pixel(coluna, 5, epidemia.largura);
+            uint32_t inf, trat;
+            epidemia_contar_bloco(&epidemia, x0, y0, x1, y1, &inf, &trat);
+            uint32_t total = (uint32_t)(x1 - x0) * (y1 - y0);
+            uint8_t r = inf * 40 / total;
+            uint8_t b = trat * 40 / total;
+            uint8_t g = (total - inf - trat) * 8 / total;
+            npSetLED(getIndex(coluna, 4 - linha), r, g, b); // Linha 0 da grade no topo
+        }
+    }
+    npWrite();
+}
+
+/*
+* Página do plano de tratamento: cabeçalho com página e orçamento restante,
+* uma linha por planta (ordem, fileira, coluna, risco) e a proteção esperada
+*/
+void exibir_plano() {
+    char buffer[24];
+    Texto t;
+    int restante = orcamento_fungicida - custo_total;
+    uint16_t paginas = (tamanho_plano + PLANO_ITENS_PAGINA - 1) / PLANO_ITENS_PAGINA;
+    uint16_t inicio = item_plano - item_plano % PLANO_ITENS_PAGINA;
+
+    ssd1306_fill(&display, false);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "PLANO ");
+    texto_natural(&t, paginas ? inicio / PLANO_ITENS_PAGINA + 1 : 0);
+    texto_car(&t, '/');
+    texto_natural(&t, paginas);
+    texto_str(&t, " $");
+    texto_natural(&t, restante > 0 ? restante : 0);
+    ssd1306_draw_string(&display, buffer, 0, 0);
+
+    if(tamanho_plano == 0) {
+        ssd1306_draw_string(&display, restante < CUSTO_POR_FUNGICIDA ? "SEM ORÇAMENTO" : "NADA A TRATAR", 0, 20);
+    }
+    for(uint16_t i = inicio; i < inicio + PLANO_ITENS_PAGINA && i < tamanho_plano; i++) {
+        const Planta *p = registro_planta(&registro, plano[i]);
+        texto_iniciar(&t, buffer, sizeof(buffer));
+        texto_car(&t, i == item_plano ? '>' : ' ');
+        texto_natural(&t, i + 1);
+        texto_str(&t, " F");
+        texto_natural(&t, p->fileira + 1);
+        texto_car(&t, 'C');
+        texto_natural(&t, p->coluna + 1);
+        texto_car(&t, ' ');
+        texto_percentual(&t, centesimos_q15(planejador_risco(&planejador, plano[i])));
+        ssd1306_draw_string(&display, buffer, 0, (1 + i - inicio) * 10);
+    }
+
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "PROTEÇÃO ");
+    texto_q15(&t, (q15_t)protecao_plano, 2);
+    ssd1306_draw_string(&display, buffer, 0, 54);
+    ssd1306_send_data(&display);
+}
+
 /**********************************
 * IMPLEMENTAÇÃO DE ANIMAÇÕES E RESULTADOS
 **********************************/
@@ -937,6 +2375,7 @@ void exibir_grafico_display(Reflectancia r) {
 * @param duracao_ms Tempo total da animação
 */
 void animacao_analise(int duracao_ms) {
+    RASTREIO_ESCOPO(PONTO_ANIMACAO);
     const int total_passos = 50; // Número de quadros da animação
     const int delay_por_passo = (duracao_ms) / total_passos;
     
@@ -980,182 +2419,56 @@ void animacao_analise(int duracao_ms) {
 /*
 * Exibe tela detalhada com resultados da análise
 * @param resultado Diagnóstico final
-* @param R,G,B,NIR Valores de reflectância
-* @param ndvi,gndvi Índices calculados
+* @param r Valores de reflectância
+* @param indices Índices calculados (NDVI e GNDVI válidos)
 */
-void exibir_resultado_analise(bool resultado, float R , float G, float B, float NIR, float ndvi, float gndvi ){
+void exibir_resultado_analise(bool resultado, const Reflectancia *r, const IndicesEspectrais *indices){
+    RASTREIO_ESCOPO(PONTO_TELA_RESULTADO);
     char buffer[24];
+    Texto t;
     ssd1306_fill(&display, false);
 
     // Linha 1 - Status principal centralizado
-    snprintf(buffer, sizeof(buffer), "%s", resultado ? "INFECTADA" : "SAUDAVEL");
-    escrever_linha(buffer, 0, 0, true); // Centralizado
+    escrever_linha(resultado ? "INFECTADA" : "SAUDÁVEL", 0, 0, true); // Centralizado
 
     // Linha 2 - Reflectância RGB
-    snprintf(buffer, sizeof(buffer), "R:%.0f%% G:%.0f%%", 
-             R * 100, 
-             G * 100);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "R:");
+    texto_percentual(&t, reflectancia_percentual(r->R));
+    texto_str(&t, " G:");
+    texto_percentual(&t, reflectancia_percentual(r->G));
     escrever_linha(buffer, 2, 0, false);
 
     // Linha 3 - Reflectância B e NIR
-    snprintf(buffer, sizeof(buffer), "B:%.0f%% NIR:%.0f%%", 
-             B * 100, 
-             NIR * 100);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "B:");
+    texto_percentual(&t, reflectancia_percentual(r->B));
+    texto_str(&t, " NIR:");
+    texto_percentual(&t, reflectancia_percentual(r->NIR));
     escrever_linha(buffer, 3, 0, false);
 
     // Linha 4 - Índices NDVI e GNDVI
-    snprintf(buffer, sizeof(buffer), "NDVI:%.2f", 
-             ndvi);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "NDVI:");
+    texto_q15(&t, indices->valor[INDICE_NDVI], 2);
     escrever_linha(buffer, 4, 0, false);
 
     // Linha 4 - Índices GNDVI
-    snprintf(buffer, sizeof(buffer), "GNDVI:%.2f",  
-             gndvi);
+    texto_iniciar(&t, buffer, sizeof(buffer));
+    texto_str(&t, "GNDVI:");
+    texto_q15(&t, indices->valor[INDICE_GNDVI], 2);
     escrever_linha(buffer, 5, 0, false);
 
     
     ssd1306_send_data(&display);
-
-    configurar_interrupcoes_botoes(true, false, false);
-
-    // Espera confirmação do usuário
-    while(!buttonA_flag) 
-        sleep_ms(10);
-    
-    buttonA_flag = false;
 }
 
 /*
 * Exibe tela detalhada com resultados da análise de uma folha
 */
 
-void exibir_resultado_analise_folha(EstadoFolha folha){
-    float R = folha.reflectancia.R;
-    float G = folha.reflectancia.G;
-    float B = folha.reflectancia.B;
-    float NIR = folha.reflectancia.NIR;
-    float ndvi =  folha.ndvi;
-    float gndvi = folha.gndvi;
-    bool resultado = detectar_doenca(R, G, B, NIR);
-    exibir_resultado_analise(resultado, R, G, B, NIR, ndvi, gndvi);
-}
-
-/**********************************
-* IMPLEMENTAÇÃO DA LÓGICA DE DETECÇÃO
-**********************************/
-
-/*
-* Implementa o algoritmo principal de detecção de doenças
-* @param R,G,B,NIR Valores de reflectância
-* @return true se detectada anomalia
-* 
-* Critérios:
-* 1. NDVI < 0.4
-* 2. GNDVI < 0.35
-* 3. Vermelho alto (R > 65%) com Verde baixo (G < 55%)
-*/
-bool detectar_doenca(float R, float G, float B, float NIR) {
-
-    // 1. Cálculo dos índices
-    float ndvi = (NIR - R) / (NIR + R + 0.001f);
-    float gndvi = (NIR - G) / (NIR + G + 0.001f);
-    
-    // 2. Limiares científicos
-    const float NDVI_SAUDAVEL = 0.4f;
-    const float GNDVI_SAUDAVEL = 0.35f;
-    const float ERRO = 0.2f;
-
-    // 3. Critérios de detecção
-    bool criterio_ndvi = ndvi < NDVI_SAUDAVEL;
-    bool criterio_gndvi = gndvi < GNDVI_SAUDAVEL;
-    bool criterio_visivel = (R > 0.65f) && (G < 0.55f);
-
-    // 4. Lógica de decisão
-    bool resultado = (criterio_ndvi && criterio_gndvi) || criterio_visivel;
-
-    /* 5. Simulação de erro
-    if((float)rand()/RAND_MAX < ERRO) {
-        return !resultado;
-    }
-    */
-    return resultado;
-}
-
-bool detectar_doenca_folha(EstadoFolha folha){
-    float R = folha.reflectancia.R;
-    float G = folha.reflectancia.G;
-    float B = folha.reflectancia.B;
-    float NIR = folha.reflectancia.NIR;
-    return detectar_doenca(R, G, B, NIR);
+void exibir_resultado_analise_folha(EstadoFolha *folha){
+    bool resultado = detectar_doenca_folha(folha);
+    exibir_resultado_analise(resultado, &folha->reflectancia,
+                             folha_indices(folha, INDICES_DETECCAO));
 }
-
-/*
-* Função de teste automatizado da detecção de doenças
-* Executa 10 casos de teste com valores pré-definidos
-*/
-void teste_deteccao() {
-    // Limpa flags de botão antes de iniciar
-    buttonA_flag = false;
-    
-    // Array de testes: {R, G, B, NIR, resultado_esperado}
-    float testes[10][5] = {
-        // Caso 1: Infectada (R alto, NIR baixo)
-        {0.70f, 0.50f, 0.30f, 0.60f, true},
-        
-        // Caso 2: Saudável (NIR alto)
-        {0.40f, 0.70f, 0.50f, 0.95f, false},
-        
-        // Caso 3: Infectada (NDVI abaixo do limiar)
-        {0.68f, 0.40f, 0.25f, 0.55f, true},
-        
-        // Caso 4: Saudável (NIR muito alto)
-        {0.50f, 0.60f, 0.40f, 1.20f, false},
-        
-        // Caso 5: Infectada (R extremo)
-        {0.80f, 0.45f, 0.20f, 0.65f, true},
-        
-        // Caso 6: Saudável (G alto)
-        {0.30f, 0.70f, 0.50f, 0.85f, false},
-        
-        // Caso 7: Infectada (ambos índices abaixo)
-        {0.60f, 0.30f, 0.35f, 0.55f, true},
-        
-        // Caso 8: Saudável (GNDVI limítrofe)
-        {0.40f, 0.58f, 0.35f, 1.0f, false},
-        
-        // Caso 9: Infectada (sintomas visíveis)
-        {0.72f, 0.50f, 0.40f, 0.58f, true},
-        
-        // Caso 10: Saudável (NIR alto)
-        {0.35f, 0.50f, 0.40f, 1.0f, false}
-    };
-
-    for(int i = 0; i < 10; i++) {
-        // Extrai parâmetros do teste
-        float R = testes[i][0];
-        float G = testes[i][1];
-        float B = testes[i][2];
-        float NIR = testes[i][3];
-        bool esperado = testes[i][4];
-
-        // Executa detecção
-        bool resultado = detectar_doenca(R, G, B, NIR);
-        
-        // Calcula índices para exibição
-        float ndvi = (NIR - R) / (NIR + R + 0.001f);
-        float gndvi = (NIR - G) / (NIR + G + 0.001f);
-
-        // Exibe resultado detalhado
-        exibir_resultado_analise(
-            resultado,
-            R, G, B, NIR,
-            ndvi, gndvi
-        );
-
-        // Feedback simples pelo serial
-        printf("Teste %d: %s (%s)\n", 
-              i+1, 
-              resultado == esperado ? "OK" : "FALHA",
-              resultado ? "Infectada" : "Saudavel");
-    }
-}
\ No newline at end of file
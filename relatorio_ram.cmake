@@ -0,0 +1,150 @@
+# Relatório de RAM por módulo a partir do mapa do linker (GNU ld), rodado
+# após cada build do firmware:
+#   cmake -DMAPA=projeto.elf.map [-DSAIDA=projeto.ram.txt] [-DRAM_TOTAL=262144] -P relatorio_ram.cmake
+#
+# Soma as seções de entrada que ocupam RAM por arquivo objeto: .data e
+# código em RAM (.time_critical), .bss/COMMON, os bancos SCRATCH (com as
+# pilhas) e a reserva mínima de heap do crt0. Os módulos do projeto (projeto.c, lib/ e
+# utils/) aparecem um a um; o resto do pico-sdk e as bibliotecas do
+# compilador, agrupados. No fim, o total estático e o que sobra da RAM
+# principal para heap e crescimento do registro de plantas.
+
+if(NOT MAPA OR NOT EXISTS "${MAPA}")
+    message(FATAL_ERROR "relatorio_ram: mapa do linker nao encontrado (${MAPA})")
+endif()
+if(NOT RAM_TOTAL)
+    math(EXPR RAM_TOTAL "256 * 1024")   # RP2040: RAM principal, sem SCRATCH_X/Y
+endif()
+
+# Só as linhas de seções de entrada e as continuações com endereço e tamanho
+file(STRINGS "${MAPA}" LINHAS REGEX "^ ([.][^ ]+|COMMON)( |$)|^ +0x[0-9a-fA-F]+ +0x[0-9a-fA-F]+ ")
+
+set(MODULOS "")
+set(pendente "")
+foreach(linha IN LISTS LINHAS)
+    set(secao "")
+    if(linha MATCHES "^ ([.][^ ]+|COMMON) +0x([0-9a-fA-F]+) +0x([0-9a-fA-F]+) +(.+)$")
+        set(secao "${CMAKE_MATCH_1}")
+        set(endereco "${CMAKE_MATCH_2}")
+        set(tamanho_hex "${CMAKE_MATCH_3}")
+        set(arquivo "${CMAKE_MATCH_4}")
+    elseif(linha MATCHES "^ ([.][^ ]+|COMMON)$")
+        # Nome longo: endereço, tamanho e arquivo vêm na linha seguinte
+        set(pendente "${CMAKE_MATCH_1}")
+        continue()
+    elseif(pendente AND linha MATCHES "^ +0x([0-9a-fA-F]+) +0x([0-9a-fA-F]+) +(.+)$")
+        set(secao "${pendente}")
+        set(endereco "${CMAKE_MATCH_1}")
+        set(tamanho_hex "${CMAKE_MATCH_2}")
+        set(arquivo "${CMAKE_MATCH_3}")
+    endif()
+    set(pendente "")
+    if(NOT secao)
+        continue()
+    endif()
+    string(STRIP "${arquivo}" arquivo)
+
+    # Categoria pela seção; seções descartadas ficam no endereço 0
+    if(secao MATCHES "^[.](data|time_critical|ram_vector_table)")
+        set(categoria DADOS)
+    elseif(secao MATCHES "^([.](bss|uninitialized_data|sbss)|COMMON)")
+        set(categoria BSS)
+    elseif(secao MATCHES "^[.](scratch_[xy]|stack)")
+        set(categoria SCRATCH)          # Bancos SCRATCH_X/Y: pilhas e o que o código põe lá
+    elseif(secao MATCHES "^[.]heap")
+        set(categoria RESERVA)          # Mínimo de heap do crt0 (PICO_HEAP_SIZE)
+    else()
+        continue()
+    endif()
+    math(EXPR tamanho "0x${tamanho_hex}")
+    math(EXPR endereco_num "0x${endereco}")
+    if(tamanho EQUAL 0 OR endereco_num EQUAL 0)
+        continue()
+    endif()
+
+    # Módulo: fonte do projeto pelo caminho relativo do objeto; o resto agrupado
+    if(arquivo MATCHES "([^/\\\\(]+)[(]")
+        set(modulo "${CMAKE_MATCH_1}")
+    elseif(arquivo MATCHES "pico[-_]sdk|/src/(rp2_common|common|rp2040|host)/")
+        set(modulo "pico-sdk")
+    elseif(arquivo MATCHES "(^|/)((lib|utils)/[^/]+|projeto[.]c)[.](obj|o)$")
+        set(modulo "${CMAKE_MATCH_2}")
+    else()
+        get_filename_component(modulo "${arquivo}" NAME)
+    endif()
+    string(MAKE_C_IDENTIFIER "${modulo}" chave)
+
+    if(NOT DEFINED TOTAL_${chave})
+        list(APPEND MODULOS "${chave}")
+        set(NOME_${chave} "${modulo}")
+        foreach(c DADOS BSS SCRATCH RESERVA TOTAL)
+            set(${c}_${chave} 0)
+        endforeach()
+    endif()
+    math(EXPR ${categoria}_${chave} "${${categoria}_${chave}} + ${tamanho}")
+    math(EXPR TOTAL_${chave} "${TOTAL_${chave}} + ${tamanho}")
+endforeach()
+
+if(NOT MODULOS)
+    message(FATAL_ERROR "relatorio_ram: nenhuma secao de RAM em ${MAPA}")
+endif()
+
+# Ordena pelo total (decrescente) com chaves de largura fixa
+set(ORDEM "")
+foreach(chave IN LISTS MODULOS)
+    string(LENGTH "${TOTAL_${chave}}" n)
+    math(EXPR zeros "10 - ${n}")
+    string(REPEAT "0" ${zeros} prefixo)
+    list(APPEND ORDEM "${prefixo}${TOTAL_${chave}}:${chave}")
+endforeach()
+list(SORT ORDEM ORDER DESCENDING)
+
+function(coluna texto largura saida)
+    string(LENGTH "${texto}" n)
+    if(n LESS largura)
+        math(EXPR falta "${largura} - ${n}")
+        string(REPEAT " " ${falta} espacos)
+        set(texto "${espacos}${texto}")
+    endif()
+    set(${saida} "${texto}" PARENT_SCOPE)
+endfunction()
+
+set(RELATORIO "modulo                              dados      bss  scratch     heap    total\n")
+foreach(c DADOS BSS SCRATCH RESERVA TOTAL)
+    set(SOMA_${c} 0)
+endforeach()
+foreach(item IN LISTS ORDEM)
+    string(REGEX REPLACE "^[0-9]+:" "" chave "${item}")
+    set(nome "${NOME_${chave}}")
+    string(LENGTH "${nome}" n)
+    if(n LESS 32)
+        math(EXPR falta "32 - ${n}")
+        string(REPEAT " " ${falta} espacos)
+        string(APPEND nome "${espacos}")
+    endif()
+    set(linha "${nome}")
+    foreach(c DADOS BSS SCRATCH RESERVA TOTAL)
+        coluna("${${c}_${chave}}" 9 valor)
+        string(APPEND linha "${valor}")
+        math(EXPR SOMA_${c} "${SOMA_${c}} + ${${c}_${chave}}")
+    endforeach()
+    string(APPEND RELATORIO "${linha}\n")
+endforeach()
+
+set(linha "total                           ")
+foreach(c DADOS BSS SCRATCH RESERVA TOTAL)
+    coluna("${SOMA_${c}}" 9 valor)
+    string(APPEND linha "${valor}")
+endforeach()
+string(APPEND RELATORIO "${linha}\n")
+
+# SCRATCH_X/Y ficam fora da RAM principal
+math(EXPR PRINCIPAL "${SOMA_DADOS} + ${SOMA_BSS} + ${SOMA_RESERVA}")
+math(EXPR LIVRE "${RAM_TOTAL} - ${PRINCIPAL}")
+math(EXPR PCT "${PRINCIPAL} * 100 / ${RAM_TOTAL}")
+string(APPEND RELATORIO "ram principal: ${PRINCIPAL} de ${RAM_TOTAL} bytes (${PCT}%), livre ${LIVRE} bytes\n")
+
+message("${RELATORIO}")
+if(SAIDA)
+    file(WRITE "${SAIDA}" "${RELATORIO}")
+endif()
@@ -0,0 +1,53 @@
+/*
+* Autoteste da detecção (utils/autoteste) no host: os mesmos vetores e
+* verificações do comando autoteste do firmware, sem interface.
+*
+* Uso: autoteste [-p passo_grade] [-r repeticoes]
+*
+* O padrão usa uma grade mais fina que a do firmware (passo 64, 64^3
+* vetores). Com -r, repete a execução e mostra o tempo médio. Sai com
+* código 1 se alguma verificação falhar ou se a detecção em ponto fixo
+* divergir da referência em ponto flutuante em algum vetor da grade: os
+* limiares em Q15 foram arredondados para reproduzi-la exatamente.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/autoteste.h"
+
+static uint64_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+int main(int argc, char **argv) {
+    uint32_t passo = 64, repeticoes = 1;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "p:r:")) != -1) {
+        switch (opcao) {
+            case 'p': passo = (uint32_t)atoi(optarg); break;
+            case 'r': repeticoes = (uint32_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "Uso: %s [-p passo_grade] [-r repeticoes]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (passo > REFLECTANCIA_MAX) passo = REFLECTANCIA_MAX;
+    if (repeticoes < 1) repeticoes = 1;
+
+    ResultadoAutoteste res;
+    bool ok = true;
+    uint64_t inicio = agora_us();
+    for (uint32_t i = 0; i < repeticoes; i++) {
+        ok &= autoteste_executar(&res, (uint16_t)passo);
+        ok &= res.divergencias_ref == 0;
+    }
+    uint64_t tempo = (agora_us() - inicio) / repeticoes;
+
+    autoteste_relatorio(&res, tempo);
+    if (res.divergencias_ref > 0) printf("Referencia em ponto flutuante: FALHA\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/*
+* Benchmark de vazão: detecção em lote (estrutura de arrays) contra
+* chamadas de detectar_doenca em laço.
+*
+* Uso: bench_deteccao_lote [num_folhas] [repeticoes]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "utils/deteccao.h"
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Gerador simples (LCG) apenas para preencher os vetores
+static uint32_t estado_lcg = 12345;
+static uint16_t aleatorio_reflectancia(void) {
+    estado_lcg = estado_lcg * 1664525u + 1013904223u;
+    return (uint16_t)((estado_lcg >> 16) % (REFLECTANCIA_MAX + 1));
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1000000;
+    int repeticoes = argc > 2 ? atoi(argv[2]) : 20;
+    uint32_t palavras = (n + 31) / 32;
+
+    uint16_t *R = malloc(n * sizeof(uint16_t));
+    uint16_t *G = malloc(n * sizeof(uint16_t));
+    uint16_t *B = malloc(n * sizeof(uint16_t));
+    uint16_t *NIR = malloc(n * sizeof(uint16_t));
+    uint32_t *mascara_lote = calloc(palavras, sizeof(uint32_t));
+    uint32_t *mascara_escalar = calloc(palavras, sizeof(uint32_t));
+    if (!R || !G || !B || !NIR || !mascara_lote || !mascara_escalar) {
+        fprintf(stderr, "memoria insuficiente\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        R[i] = aleatorio_reflectancia();
+        G[i] = aleatorio_reflectancia();
+        B[i] = aleatorio_reflectancia();
+        NIR[i] = aleatorio_reflectancia();
+    }
+
+    // Escalar: detectar_doenca folha a folha
+    double inicio = agora_s();
+    for (int k = 0; k < repeticoes; k++) {
+        for (uint32_t i = 0; i < n; i++) {
+            if (detectar_doenca(R[i], G[i], B[i], NIR[i]))
+                mascara_escalar[i / 32] |= 1u << (i % 32);
+            else
+                mascara_escalar[i / 32] &= ~(1u << (i % 32));
+        }
+    }
+    double tempo_escalar = agora_s() - inicio;
+
+    // Lote
+    inicio = agora_s();
+    for (int k = 0; k < repeticoes; k++) {
+        detectar_doenca_lote(R, G, B, NIR, n, NULL, mascara_lote);
+    }
+    double tempo_lote = agora_s() - inicio;
+
+    // Os dois caminhos precisam concordar bit a bit
+    uint32_t divergencias = 0, infectadas = 0;
+    for (uint32_t w = 0; w < palavras; w++) {
+        divergencias += __builtin_popcount(mascara_lote[w] ^ mascara_escalar[w]);
+        infectadas += __builtin_popcount(mascara_lote[w]);
+    }
+
+    double total = (double)n * repeticoes;
+    printf("folhas: %u x %d repeticoes, infectadas: %u, divergencias: %u\n",
+           n, repeticoes, infectadas, divergencias);
+    printf("escalar: %10.1f Mfolhas/s (%.2f ns/folha)\n",
+           total / tempo_escalar / 1e6, tempo_escalar / total * 1e9);
+    printf("lote:    %10.1f Mfolhas/s (%.2f ns/folha)\n",
+           total / tempo_lote / 1e6, tempo_lote / total * 1e9);
+    printf("ganho:   %10.1fx\n", tempo_escalar / tempo_lote);
+
+    free(R); free(G); free(B); free(NIR);
+    free(mascara_lote); free(mascara_escalar);
+    return divergencias != 0;
+}
@@ -0,0 +1,164 @@
+/*
+* Benchmark e verificação do histórico em flash (utils/flash_log) sobre uma
+* imagem em arquivo com semântica de flash NOR.
+*
+* Uso: bench_flash_log [imagem] [registros] [quedas]
+*
+* 1. Vazão: anexa registros de análise com flash_log_processar a cada um,
+*    como no loop principal do firmware.
+* 2. Reabertura: reconstrói o índice e confere que os registros lidos formam
+*    uma sequência contínua terminando no último anexado.
+* 3. Quedas de energia: interrompe uma programação em um byte aleatório,
+*    reabre o log (medindo o tempo de recuperação) e confere que nenhum
+*    registro sincronizado se perdeu e que não há lacunas nem corrompidos.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flash_arquivo.h"
+#include "utils/plantas.h"
+
+#define SETORES 16
+
+static double agora_us(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static RegistroAnalise registro_n(uint32_t n) {
+    RegistroAnalise r = {
+        .folha = 0x0123456789ABCDEFull ^ n,
+        .tempo_ms = n,   // Número de sequência usado na verificação
+        .id_planta = (uint16_t)(n % 1000),
+        .indice_folha = (uint8_t)(n % 5),
+        .origem = ORIGEM_ANALISE,
+    };
+    return r;
+}
+
+// Verificação da sequência lida
+typedef struct {
+    uint32_t total;
+    uint32_t primeiro, ultimo;
+    uint32_t lacunas, invalidos;
+} Conferencia;
+
+static bool conferir(void *ctx, uint8_t tipo, const void *dados, uint8_t tamanho) {
+    Conferencia *c = ctx;
+    RegistroAnalise r;
+    if (tipo != LOG_TIPO_ANALISE || tamanho != sizeof(r)) {
+        c->invalidos++;
+        return true;
+    }
+    memcpy(&r, dados, sizeof(r));
+    RegistroAnalise esperado = registro_n(r.tempo_ms);
+    if (memcmp(&r, &esperado, sizeof(r)) != 0) c->invalidos++;
+
+    if (c->total == 0) {
+        c->primeiro = r.tempo_ms;
+    } else if (r.tempo_ms != c->ultimo + 1) {
+        c->lacunas++;
+    }
+    c->ultimo = r.tempo_ms;
+    c->total++;
+    return true;
+}
+
+static Conferencia conferir_log(FlashLog *log) {
+    Conferencia c = {0};
+    flash_log_percorrer(log, conferir, &c);
+    return c;
+}
+
+int main(int argc, char **argv) {
+    const char *caminho = argc > 1 ? argv[1] : "flash_log.img";
+    uint32_t num_registros = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 200000;
+    uint32_t num_quedas = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 500;
+    int falhas = 0;
+
+    FlashArquivo flash;
+    if (!flash_arquivo_abrir(&flash, caminho, SETORES)) {
+        perror(caminho);
+        return 1;
+    }
+
+    //---------- 1. Vazão ----------
+    static FlashLog log;
+    flash_log_formatar(&log, &flash.ops);
+
+    double inicio = agora_us();
+    for (uint32_t n = 0; n < num_registros; n++) {
+        RegistroAnalise r = registro_n(n);
+        flash_log_anexar(&log, LOG_TIPO_ANALISE, &r, sizeof(r));
+        flash_log_processar(&log);
+    }
+    flash_log_sincronizar(&log);
+    double duracao = agora_us() - inicio;
+
+    printf("Vazao: %u registros de %zu bytes em %.1f ms (%.0f anexos/s)\n",
+           num_registros, sizeof(RegistroAnalise), duracao / 1e3, num_registros / (duracao / 1e6));
+    printf("       %u paginas programadas, %u setores apagados (%.1f registros/pagina)\n",
+           log.programacoes, log.apagamentos, (double)num_registros / log.programacoes);
+
+    //---------- 2. Reabertura ----------
+    static FlashLog reaberto;
+    inicio = agora_us();
+    flash_log_abrir(&reaberto, &flash.ops);
+    double tempo_abrir = agora_us() - inicio;
+
+    inicio = agora_us();
+    Conferencia c = conferir_log(&reaberto);
+    double tempo_percorrer = agora_us() - inicio;
+
+    bool ok = c.total > 0 && c.lacunas == 0 && c.invalidos == 0 && c.ultimo == num_registros - 1;
+    printf("Reabertura: indice em %.1f us, %u registros lidos (%u a %u) em %.1f us: %s\n",
+           tempo_abrir, c.total, c.primeiro, c.ultimo, tempo_percorrer, ok ? "OK" : "FALHA");
+    falhas += !ok;
+
+    //---------- 3. Quedas de energia ----------
+    srand(1234);
+    uint32_t proximo = c.ultimo + 1;
+    uint32_t violacoes = 0;
+    double pior_recuperacao = 0, soma_recuperacao = 0;
+    memcpy(&log, &reaberto, sizeof(log));
+
+    for (uint32_t q = 0; q < num_quedas; q++) {
+        // Tudo até aqui está gravado
+        flash_log_sincronizar(&log);
+        uint32_t duravel = proximo - 1;
+
+        // Arma a queda e anexa até alguma programação ser interrompida
+        flash.bytes_ate_falha = rand() % FLASH_LOG_TAM_PAGINA;
+        flash.falhou = false;
+        while (!flash.falhou) {
+            RegistroAnalise r = registro_n(proximo++);
+            flash_log_anexar(&log, LOG_TIPO_ANALISE, &r, sizeof(r));
+            flash_log_processar(&log);
+        }
+        flash.bytes_ate_falha = -1;
+        flash.falhou = false;
+
+        // "Reboot": o estado em RAM é perdido
+        inicio = agora_us();
+        flash_log_abrir(&log, &flash.ops);
+        double recuperacao = agora_us() - inicio;
+        soma_recuperacao += recuperacao;
+        if (recuperacao > pior_recuperacao) pior_recuperacao = recuperacao;
+
+        Conferencia depois = conferir_log(&log);
+        if (depois.lacunas || depois.invalidos || depois.total == 0 || depois.ultimo < duravel) {
+            violacoes++;
+        }
+        proximo = depois.ultimo + 1; // Registros só em RAM se perderam com a queda
+    }
+
+    printf("Quedas: %u simuladas, recuperacao media %.1f us (pior %.1f us), %u violacoes: %s\n",
+           num_quedas, soma_recuperacao / (num_quedas ? num_quedas : 1), pior_recuperacao,
+           violacoes, violacoes == 0 ? "OK" : "FALHA");
+    falhas += violacoes != 0;
+
+    flash_arquivo_fechar(&flash);
+    return falhas != 0;
+}
@@ -0,0 +1,140 @@
+/*
+* Benchmark do planejador de tratamentos (utils/planejador): atualização
+* incremental do heap a cada análise/tratamento contra o recálculo completo
+* do talhão inteiro.
+*
+* Uso: bench_planejador [-f fileiras] [-c colunas] [-e eventos] [-o orcamento] [-s semente]
+*
+* Compilado com um registro maior que o do firmware (ver CMakeLists.txt),
+* para talhões de milhares de plantas. Cada evento analisa (75%) ou trata
+* (25%) uma planta sorteada; depois de cada um, o plano incremental é
+* conferido contra o plano de referência (benefícios recalculados do zero e
+* escolha gulosa por busca em todo o talhão, tratando cada planta escolhida).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/campo.h"
+#include "utils/planejador.h"
+
+#define CUSTO 10
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static RegistroPlantas registro;
+static Planejador incremental, referencia;
+static uint16_t plano[PLANEJADOR_MAX], plano_ref[PLANEJADOR_MAX];
+
+// Plano de referência: recalcula tudo e, a cada passo, procura em todo o
+// talhão a planta de maior benefício, marca-a como tratada e atualiza os
+// vizinhos; no fim, desfaz as marcas
+static uint16_t plano_referencia(uint32_t orcamento) {
+    planejador_iniciar(&referencia, &registro, &LIMIARES_PADRAO);
+    uint16_t n = registro_total(&registro);
+
+    uint16_t k = 0;
+    while (k < orcamento / CUSTO) {
+        uint16_t melhor = 0;
+        for (uint16_t i = 1; i < n; i++) {
+            if (referencia.beneficio[i] > referencia.beneficio[melhor]) melhor = i;
+        }
+        if (referencia.beneficio[melhor] == 0) break;
+        plano_ref[k++] = melhor;
+        registro.plantas[melhor].tratada = true;
+        planejador_atualizar(&referencia, melhor);
+    }
+    for (uint16_t i = 0; i < k; i++) registro.plantas[plano_ref[i]].tratada = false;
+    return k;
+}
+
+// Análise de todas as folhas, como em cmd_detectar
+static void analisar(Planta *p) {
+    const FolhaCompacta *folhas = registro_folhas(&registro, p);
+    for (uint8_t i = 0; i < p->num_folhas; i++) {
+        EstadoFolha folha;
+        folha_descompactar(folhas[i], &folha);
+        if (detectar_doenca_folha(&folha)) p->infectada = true;
+    }
+}
+
+int main(int argc, char **argv) {
+    ParametrosCampo par = CAMPO_PADRAO;
+    par.fileiras = 64;
+    par.colunas = 256;
+    par.folhas_min = 3;
+    par.folhas_max = 4;
+    uint32_t eventos = 2000, orcamento = 1000;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "f:c:e:o:s:")) != -1) {
+        switch (opcao) {
+            case 'f': par.fileiras = (uint16_t)atoi(optarg); break;
+            case 'c': par.colunas = (uint16_t)atoi(optarg); break;
+            case 'e': eventos = (uint32_t)atoi(optarg); break;
+            case 'o': orcamento = (uint32_t)atoi(optarg); break;
+            case 's': par.semente = strtoull(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "Uso: %s [-f fileiras] [-c colunas] [-e eventos] [-o orcamento] [-s semente]\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+
+    uint16_t total = campo_gerar(&registro, &par);
+    if (total == 0) {
+        fprintf(stderr, "parametros invalidos\n");
+        return 2;
+    }
+    printf("Talhao: %u plantas, %u folhas (registro de ate %u plantas); orcamento %u (%u plantas)\n",
+           total, registro.num_folhas, REGISTRO_MAX_PLANTAS, orcamento, orcamento / CUSTO);
+
+    double inicio = agora_s();
+    planejador_iniciar(&incremental, &registro, &LIMIARES_PADRAO);
+    printf("Construcao: %.1f us\n", (agora_s() - inicio) * 1e6);
+
+    Aleatorio rng;
+    aleatorio_semear(&rng, par.semente);
+    double t_atualizar = 0, t_plano = 0, t_ref = 0, pior_inc = 0, pior_ref = 0;
+    uint32_t divergencias = 0, tratadas = 0;
+    uint16_t k = 0;
+
+    for (uint32_t e = 0; e < eventos; e++) {
+        uint16_t posicao = (uint16_t)aleatorio_faixa(&rng, total);
+        Planta *p = registro_planta(&registro, posicao);
+        if (aleatorio_faixa(&rng, 4) == 0) {
+            if (!p->tratada) tratadas++;
+            tratar_planta(p, registro_folhas(&registro, p));
+        } else {
+            analisar(p);
+        }
+
+        double t0 = agora_s();
+        planejador_atualizar(&incremental, posicao);
+        double t1 = agora_s();
+        k = planejador_plano(&incremental, orcamento, CUSTO, plano, PLANEJADOR_MAX, NULL);
+        double t2 = agora_s();
+        uint16_t k_ref = plano_referencia(orcamento);
+        double t3 = agora_s();
+
+        t_atualizar += t1 - t0;
+        t_plano += t2 - t1;
+        t_ref += t3 - t2;
+        if (t2 - t0 > pior_inc) pior_inc = t2 - t0;
+        if (t3 - t2 > pior_ref) pior_ref = t3 - t2;
+        if (k != k_ref || memcmp(plano, plano_ref, k * sizeof(plano[0])) != 0) divergencias++;
+    }
+
+    printf("%u eventos (%u tratamentos), plano final com %u plantas\n", eventos, tratadas, k);
+    printf("Incremental: %.2f us atualizacao + %.2f us plano por evento (pior %.1f us)\n",
+           t_atualizar * 1e6 / eventos, t_plano * 1e6 / eventos, pior_inc * 1e6);
+    printf("Recalculo com busca gulosa: %.2f us por evento (pior %.1f us), %.0fx mais lento\n",
+           t_ref * 1e6 / eventos, pior_ref * 1e6, t_ref / (t_atualizar + t_plano));
+    printf("Conferencia: %u divergencias: %s\n", divergencias, divergencias ? "FALHA" : "OK");
+    return divergencias != 0;
+}
@@ -0,0 +1,180 @@
+/*
+* Decodificador da exportação binária do histórico (utils/exportacao).
+*
+* Uso: decodificar_exportacao captura.bin > historico.csv
+*      decodificar_exportacao -g imagem.img captura.bin
+*
+* No primeiro modo, lê uma captura da serial, separa os quadros COBS, confere
+* CRC e sequência e escreve um CSV com uma linha por análise. Quadros
+* corrompidos são descartados e contados; o resumo vai para stderr.
+*
+* Com -g, gera uma captura a partir de uma imagem de flash com o histórico
+* (a de bench_flash_log, por exemplo), usando o mesmo código de exportação do
+* firmware, e estima o tempo de transferência na UART e na USB.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flash_arquivo.h"
+#include "utils/crc.h"
+#include "utils/exportacao.h"
+#include "utils/plantas.h"
+
+#define SETORES 16
+#define BAUD_UART 115200
+#define BYTES_S_USB 1000000.0   // Vazão típica da USB CDC full-speed
+
+typedef struct {
+    uint32_t quadros, corrompidos, perdidos, registros, outros;
+    uint32_t registros_anunciados;
+    bool inicio, fim;
+} Resumo;
+
+static void imprimir_analise(uint16_t sequencia, const uint8_t *dados) {
+    RegistroAnalise r;
+    EstadoFolha folha;
+    memcpy(&r, dados, sizeof(r));
+    folha_descompactar(r.folha, &folha);
+
+    const Reflectancia *refl = &folha.reflectancia;
+    printf("%u,%u,%u,%u,%s,%.2f,%.2f,%.2f,%.2f,%.3f,%.3f,%d,%d\n",
+           sequencia, r.tempo_ms, r.id_planta, r.indice_folha,
+           r.origem == ORIGEM_CALIBRACAO ? "calibracao" : "analise",
+           refl->R * 100.0 / REFLECTANCIA_MAX, refl->G * 100.0 / REFLECTANCIA_MAX,
+           refl->B * 100.0 / REFLECTANCIA_MAX, refl->NIR * 100.0 / REFLECTANCIA_MAX,
+           Q15_PARA_FLOAT(folha_compacta_ndvi(r.folha)), Q15_PARA_FLOAT(folha_compacta_gndvi(r.folha)),
+           folha_compacta_visivel(r.folha), folha_compacta_infectada(r.folha));
+}
+
+/*
+* Processa um quadro já separado pelo delimitador
+*/
+static void processar_quadro(Resumo *s, const uint8_t *codificado, size_t tamanho, uint16_t *esperada) {
+    uint8_t quadro[QUADRO_MAX_BRUTO];
+    if (tamanho == 0) return;
+    if (tamanho > QUADRO_MAX_COBS) {
+        s->corrompidos++;
+        return;
+    }
+    size_t n = cobs_decodificar(codificado, tamanho, quadro);
+    if (n < 5 || crc16_ccitt(CRC16_INICIAL, quadro, n - 2) != (quadro[n - 2] | quadro[n - 1] << 8)) {
+        s->corrompidos++;
+        return;
+    }
+
+    uint8_t tipo = quadro[0];
+    uint16_t sequencia = (uint16_t)(quadro[1] | quadro[2] << 8);
+    const uint8_t *carga = &quadro[3];
+    size_t tamanho_carga = n - 5;
+
+    if (tipo == QUADRO_INICIO) {
+        s->inicio = true;
+        if (tamanho_carga < 2 || carga[0] != EXPORTACAO_VERSAO || carga[1] != sizeof(RegistroAnalise)) {
+            fprintf(stderr, "Aviso: versao ou formato de registro diferente do esperado\n");
+        }
+    } else if (s->inicio && sequencia != *esperada) {
+        s->perdidos += (uint16_t)(sequencia - *esperada);
+    }
+    *esperada = (uint16_t)(sequencia + 1);
+    s->quadros++;
+
+    if (tipo == QUADRO_REGISTRO) {
+        if (tamanho_carga == 1 + sizeof(RegistroAnalise) && carga[0] == LOG_TIPO_ANALISE) {
+            imprimir_analise(sequencia, &carga[1]);
+            s->registros++;
+        } else {
+            s->outros++;
+        }
+    } else if (tipo == QUADRO_FIM && tamanho_carga >= 4) {
+        s->fim = true;
+        s->registros_anunciados = carga[0] | carga[1] << 8 | carga[2] << 16 | (uint32_t)carga[3] << 24;
+    }
+}
+
+static int decodificar(const char *caminho) {
+    FILE *f = fopen(caminho, "rb");
+    if (!f) {
+        perror(caminho);
+        return 1;
+    }
+
+    Resumo s = {0};
+    uint16_t esperada = 0;
+    uint8_t acumulado[QUADRO_MAX_COBS + 1];
+    size_t n = 0;
+    bool descartando = false;   // Quadro maior que o máximo: ignora até o delimitador
+    bool sincronizado = false;  // O que vem antes do primeiro 0x00 é texto do console
+
+    printf("sequencia,tempo_ms,id_planta,folha,origem,R,G,B,NIR,NDVI,GNDVI,visivel,infectada\n");
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == 0) {
+            if (!sincronizado) sincronizado = true;
+            else if (descartando) s.corrompidos++;
+            else processar_quadro(&s, acumulado, n, &esperada);
+            n = 0;
+            descartando = false;
+        } else if (n < sizeof(acumulado)) {
+            acumulado[n++] = (uint8_t)c;
+        } else {
+            descartando = true;
+        }
+    }
+    fclose(f);
+
+    fprintf(stderr, "%u quadros, %u analises, %u outros registros, %u corrompidos, %u perdidos\n",
+            s.quadros, s.registros, s.outros, s.corrompidos, s.perdidos);
+    if (!s.inicio || !s.fim) {
+        fprintf(stderr, "Captura incompleta (%s)\n", s.inicio ? "sem quadro de fim" : "sem quadro de inicio");
+    } else if (s.registros + s.outros != s.registros_anunciados) {
+        fprintf(stderr, "Dispositivo anunciou %u registros\n", s.registros_anunciados);
+    }
+    return s.corrompidos || s.perdidos || !s.inicio || !s.fim;
+}
+
+static void gravar_arquivo(void *ctx, const uint8_t *dados, uint32_t tamanho) {
+    fwrite(dados, 1, tamanho, (FILE *)ctx);
+}
+
+static int gerar(const char *imagem, const char *caminho) {
+    FlashArquivo flash;
+    static FlashLog log;
+    if (!flash_arquivo_abrir(&flash, imagem, SETORES)) {
+        perror(imagem);
+        return 1;
+    }
+    if (!flash_log_abrir(&log, &flash.ops)) {
+        fprintf(stderr, "%s: historico invalido\n", imagem);
+        return 1;
+    }
+    FILE *f = fopen(caminho, "wb");
+    if (!f) {
+        perror(caminho);
+        return 1;
+    }
+
+    static Exportacao e;
+    clock_t inicio = clock();
+    exportacao_iniciar(&e, &log, gravar_arquivo, f);
+    while (exportacao_continuar(&e, 64)) {
+    }
+    double duracao = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    long bytes = ftell(f);
+    fclose(f);
+    flash_arquivo_fechar(&flash);
+
+    printf("%u registros, %ld bytes (%.1f bytes/registro), codificados em %.1f ms\n",
+           e.registros, bytes, e.registros ? (double)bytes / e.registros : 0.0, duracao * 1e3);
+    printf("Transferencia estimada: UART %u baud %.1f s, USB CDC %.2f s\n",
+           BAUD_UART, bytes * 10.0 / BAUD_UART, bytes / BYTES_S_USB);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 4 && strcmp(argv[1], "-g") == 0) return gerar(argv[2], argv[3]);
+    if (argc == 2) return decodificar(argv[1]);
+    fprintf(stderr, "Uso: %s captura.bin > historico.csv\n"
+                    "     %s -g imagem.img captura.bin\n", argv[0], argv[0]);
+    return 2;
+}
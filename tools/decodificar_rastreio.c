@@ -0,0 +1,333 @@
+/*
+* Decodifica o despejo do comando rastreio (utils/rastreio): histogramas de
+* latência por trecho, tempo próprio de cada trecho no loop e linha do tempo.
+*
+* Uso: decodificar_rastreio [-l linha_do_tempo.json] [-t trechos] [captura.txt]
+*
+* Lê a captura da serial (ou a entrada padrão); linhas fora do despejo são
+* ignoradas e, com vários despejos, vale o último. Os eventos de cada núcleo
+* formam trechos aninhados (início/fim do mesmo ponto). A duração vem do
+* contador de ciclos (SysTick, 24 bits) com as voltas completas dadas pelo
+* timer de 1 MHz, então é exata em ciclos em qualquer comprimento; sem
+* ciclos (simulador), vem do timer.
+*
+* Saída: por ponto, contagem, tempo total e próprio (sem os trechos filhos),
+* fração do tempo de parede, percentis e histograma em potências de 2 de µs.
+* Com -t, os últimos trechos em ordem, indentados pelo aninhamento; com -l,
+* a linha do tempo no formato de eventos do Chrome (chrome://tracing, Perfetto).
+*/
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Formato de EventoRastreio.palavra (utils/rastreio.h)
+#define CICLOS(p) ((p) & 0xFFFFFFu)
+#define PONTO(p) (((p) >> 24) & 0x3F)
+#define NUCLEO(p) (((p) >> 30) & 1)
+#define FIM(p) ((p) >> 31)
+
+#define MAX_PONTOS 64
+#define MAX_NUCLEOS 2
+#define MAX_PROFUNDIDADE 32
+#define NUM_FAIXAS 22                  // < 1 us, [1, 2), [2, 4)... >= 2^20 us
+
+typedef struct {
+    uint32_t tempo_us;
+    uint32_t palavra;
+} Evento;
+
+typedef struct {
+    uint8_t ponto, nucleo, profundidade;
+    double inicio_us;                  // Relativo ao primeiro evento do núcleo
+    double duracao_us;
+} Trecho;
+
+typedef struct {
+    char nome[32];
+    double *duracoes;
+    uint32_t n, capacidade;
+    double total_us, proprio_us;
+    uint32_t faixas[NUM_FAIXAS];
+} Estatistica;
+
+typedef struct {
+    uint8_t ponto;
+    uint32_t tempo_us, ciclos;
+    double filhos_us;
+    double inicio_us;
+} Aberto;
+
+static unsigned long hz;
+static int com_ciclos;
+static Estatistica pontos[MAX_PONTOS];
+static Evento *eventos[MAX_NUCLEOS];
+static uint32_t num_eventos[MAX_NUCLEOS], cap_eventos[MAX_NUCLEOS];
+static unsigned long perdidos[MAX_NUCLEOS];
+static Trecho *trechos;
+static uint32_t num_trechos, cap_trechos;
+static uint32_t orfaos, incompletos;
+
+/**********************************
+* LEITURA
+**********************************/
+
+static void limpar_despejo(void) {
+    for (int n = 0; n < MAX_NUCLEOS; n++) {
+        num_eventos[n] = 0;
+        perdidos[n] = 0;
+    }
+    for (int p = 0; p < MAX_PONTOS; p++) pontos[p].nome[0] = '\0';
+}
+
+static bool ler_captura(FILE *f) {
+    char linha[256];
+    int nucleo = -1;
+    bool achou = false;
+    while (fgets(linha, sizeof(linha), f)) {
+        unsigned versao, n;
+        unsigned long a, b;
+        int id;
+        char nome[32];
+        if (sscanf(linha, "rastreio v%u hz=%lu eventos=%u ciclos=%d", &versao, &a, &n, &id) == 4) {
+            if (versao != 1) {
+                fprintf(stderr, "versao %u nao suportada\n", versao);
+                return false;
+            }
+            limpar_despejo();
+            hz = a;
+            com_ciclos = id && hz > 0;
+            nucleo = -1;
+            achou = true;
+        } else if (sscanf(linha, "ponto %d %31s", &id, nome) == 2 && id >= 0 && id < MAX_PONTOS) {
+            snprintf(pontos[id].nome, sizeof(pontos[id].nome), "%s", nome);
+        } else if (sscanf(linha, "nucleo %d escritos=%lu perdidos=%lu", &id, &a, &b) == 3 &&
+                   id >= 0 && id < MAX_NUCLEOS) {
+            nucleo = id;
+            perdidos[id] = b;
+        } else if (nucleo >= 0 && sscanf(linha, "ev %lx %lx", &a, &b) == 2) {
+            if (num_eventos[nucleo] == cap_eventos[nucleo]) {
+                cap_eventos[nucleo] = cap_eventos[nucleo] ? 2 * cap_eventos[nucleo] : 1024;
+                eventos[nucleo] = realloc(eventos[nucleo], cap_eventos[nucleo] * sizeof(Evento));
+            }
+            eventos[nucleo][num_eventos[nucleo]++] = (Evento){(uint32_t)a, (uint32_t)b};
+        } else if (strncmp(linha, "fim rastreio", 12) == 0) {
+            nucleo = -1;
+        }
+    }
+    return achou;
+}
+
+/**********************************
+* TRECHOS
+**********************************/
+
+/*
+* Duração entre dois eventos do mesmo núcleo: ciclos do SysTick (contador
+* decrescente de 24 bits) mais as voltas que o timer indica
+*/
+static double duracao_us(uint32_t t0, uint32_t c0, uint32_t t1, uint32_t c1) {
+    double pelo_timer = (double)(uint32_t)(t1 - t0);
+    if (!com_ciclos) return pelo_timer;
+    double ciclos = (double)((c0 - c1) & 0xFFFFFFu);
+    double voltas = round((pelo_timer * hz / 1e6 - ciclos) / 16777216.0);
+    return (ciclos + voltas * 16777216.0) * 1e6 / hz;
+}
+
+static void registrar(uint8_t ponto, uint8_t nucleo, uint8_t profundidade, double inicio, double duracao,
+                      double proprio) {
+    Estatistica *e = &pontos[ponto];
+    if (e->n == e->capacidade) {
+        e->capacidade = e->capacidade ? 2 * e->capacidade : 256;
+        e->duracoes = realloc(e->duracoes, e->capacidade * sizeof(double));
+    }
+    e->duracoes[e->n++] = duracao;
+    e->total_us += duracao;
+    e->proprio_us += proprio;
+    int faixa = duracao < 1 ? 0 : 1 + (int)floor(log2(duracao));
+    e->faixas[faixa < NUM_FAIXAS ? faixa : NUM_FAIXAS - 1]++;
+
+    if (num_trechos == cap_trechos) {
+        cap_trechos = cap_trechos ? 2 * cap_trechos : 1024;
+        trechos = realloc(trechos, cap_trechos * sizeof(Trecho));
+    }
+    trechos[num_trechos++] = (Trecho){ponto, nucleo, profundidade, inicio, duracao};
+}
+
+/*
+* Casa inícios e fins em uma pilha por núcleo. Um fim sem início (perdido na
+* sobrescrita do buffer) é ignorado; inícios sem fim abaixo de um fim que
+* casa são descartados.
+* @return Tempo de parede coberto pelos eventos do núcleo (us)
+*/
+static double montar_trechos(uint8_t nucleo) {
+    Aberto pilha[MAX_PROFUNDIDADE];
+    int topo = 0;
+    const Evento *ev = eventos[nucleo];
+    uint32_t n = num_eventos[nucleo];
+    if (n == 0) return 0;
+
+    double agora = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t p = ev[i].palavra;
+        if (i > 0) {
+            agora += duracao_us(ev[i - 1].tempo_us, CICLOS(ev[i - 1].palavra), ev[i].tempo_us, CICLOS(p));
+        }
+        if (!FIM(p)) {
+            if (topo == MAX_PROFUNDIDADE) {
+                incompletos++;
+                continue;
+            }
+            pilha[topo++] = (Aberto){PONTO(p), ev[i].tempo_us, CICLOS(p), 0, agora};
+            continue;
+        }
+
+        int k = topo - 1;
+        while (k >= 0 && pilha[k].ponto != PONTO(p)) k--;
+        if (k < 0) {
+            orfaos++;
+            continue;
+        }
+        incompletos += topo - 1 - k;
+        topo = k;
+        const Aberto *a = &pilha[k];
+        double d = duracao_us(a->tempo_us, a->ciclos, ev[i].tempo_us, CICLOS(p));
+        registrar(a->ponto, nucleo, (uint8_t)k, a->inicio_us, d, d - a->filhos_us);
+        if (k > 0) pilha[k - 1].filhos_us += d;
+    }
+    incompletos += topo;
+    return agora;
+}
+
+/**********************************
+* RELATÓRIO
+**********************************/
+
+static int comparar_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int comparar_trechos(const void *a, const void *b) {
+    const Trecho *x = a, *y = b;
+    if (x->nucleo != y->nucleo) return x->nucleo - y->nucleo;
+    if (x->inicio_us != y->inicio_us) return x->inicio_us < y->inicio_us ? -1 : 1;
+    return x->profundidade - y->profundidade;
+}
+
+static double percentil(const Estatistica *e, double p) {
+    size_t i = (size_t)(p * (e->n - 1) + 0.5);
+    return e->duracoes[i];
+}
+
+static void imprimir_histograma(const Estatistica *e) {
+    uint32_t maior = 0;
+    int primeira = NUM_FAIXAS, ultima = -1;
+    for (int f = 0; f < NUM_FAIXAS; f++) {
+        if (!e->faixas[f]) continue;
+        if (e->faixas[f] > maior) maior = e->faixas[f];
+        if (f < primeira) primeira = f;
+        ultima = f;
+    }
+    for (int f = primeira; f <= ultima; f++) {
+        char faixa[24];
+        if (f == 0) {
+            snprintf(faixa, sizeof(faixa), "< 1 us");
+        } else {
+            snprintf(faixa, sizeof(faixa), "%.0f-%.0f us", ldexp(1, f - 1), ldexp(1, f));
+        }
+        int barra = (int)((uint64_t)e->faixas[f] * 40 / maior);
+        printf("    %-18s %7u %.*s\n", faixa, e->faixas[f], barra,
+               "########################################");
+    }
+}
+
+static bool gravar_linha_do_tempo(const char *caminho) {
+    FILE *f = fopen(caminho, "w");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (uint32_t i = 0; i < num_trechos; i++) {
+        const Trecho *t = &trechos[i];
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                pontos[t->ponto].nome, t->nucleo, t->inicio_us, t->duracao_us,
+                i + 1 < num_trechos ? "," : "");
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ns\"}\n");
+    return fclose(f) == 0;
+}
+
+int main(int argc, char **argv) {
+    const char *saida_json = NULL;
+    uint32_t ultimos = 0;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "l:t:")) != -1) {
+        switch (opcao) {
+            case 'l': saida_json = optarg; break;
+            case 't': ultimos = (uint32_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "Uso: %s [-l linha_do_tempo.json] [-t trechos] [captura.txt]\n", argv[0]);
+                return 2;
+        }
+    }
+    FILE *f = optind < argc ? fopen(argv[optind], "r") : stdin;
+    if (!f) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (!ler_captura(f)) {
+        fprintf(stderr, "nenhum despejo de rastreio na captura\n");
+        return 1;
+    }
+
+    double parede = 0;
+    uint32_t total_eventos = 0;
+    for (uint8_t n = 0; n < MAX_NUCLEOS; n++) {
+        double janela = montar_trechos(n);
+        if (janela > parede) parede = janela;
+        total_eventos += num_eventos[n];
+    }
+    printf("%u eventos, %u trechos em %.3f ms (%s, %lu Hz); sobrescritos: %lu/%lu, sem par: %u fins, %u inicios\n",
+           total_eventos, num_trechos, parede / 1e3, com_ciclos ? "ciclos" : "timer", hz,
+           perdidos[0], perdidos[1], orfaos, incompletos);
+
+    printf("\n%-16s %7s %11s %11s %7s %10s %10s %10s %10s %10s\n", "ponto", "n", "total ms",
+           "proprio ms", "%", "min us", "p50 us", "p90 us", "p99 us", "max us");
+    for (int p = 0; p < MAX_PONTOS; p++) {
+        Estatistica *e = &pontos[p];
+        if (e->n == 0) continue;
+        qsort(e->duracoes, e->n, sizeof(double), comparar_double);
+        printf("%-16s %7u %11.3f %11.3f %6.1f%% %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+               e->nome[0] ? e->nome : "?", e->n, e->total_us / 1e3, e->proprio_us / 1e3,
+               parede > 0 ? 100 * e->proprio_us / parede : 0, e->duracoes[0], percentil(e, 0.5),
+               percentil(e, 0.9), percentil(e, 0.99), e->duracoes[e->n - 1]);
+    }
+
+    printf("\nHistogramas de latencia\n");
+    for (int p = 0; p < MAX_PONTOS; p++) {
+        if (pontos[p].n == 0) continue;
+        printf("  %s\n", pontos[p].nome[0] ? pontos[p].nome : "?");
+        imprimir_histograma(&pontos[p]);
+    }
+
+    qsort(trechos, num_trechos, sizeof(Trecho), comparar_trechos);
+    if (ultimos > 0) {
+        printf("\nLinha do tempo (ultimos %u trechos)\n", ultimos);
+        uint32_t inicio = num_trechos > ultimos ? num_trechos - ultimos : 0;
+        for (uint32_t i = inicio; i < num_trechos; i++) {
+            const Trecho *t = &trechos[i];
+            printf("  n%u %12.3f ms %*s%-16s %10.2f us\n", t->nucleo, t->inicio_us / 1e3,
+                   2 * t->profundidade, "", pontos[t->ponto].nome, t->duracao_us);
+        }
+    }
+    if (saida_json && gravar_linha_do_tempo(saida_json)) {
+        printf("\nLinha do tempo gravada em %s\n", saida_json);
+    }
+    return 0;
+}
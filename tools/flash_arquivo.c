@@ -0,0 +1,72 @@
+#include "flash_arquivo.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+static bool ler(void *ctx, uint32_t deslocamento, void *dados, uint32_t tamanho) {
+    FlashArquivo *f = ctx;
+    return pread(f->fd, dados, tamanho, deslocamento) == (ssize_t)tamanho;
+}
+
+static bool programar(void *ctx, uint32_t deslocamento, const void *dados, uint32_t tamanho) {
+    FlashArquivo *f = ctx;
+    if (f->falhou) return false;
+
+    uint8_t atual[FLASH_LOG_TAM_PAGINA];
+    if (tamanho > sizeof(atual) || !ler(f, deslocamento, atual, tamanho)) return false;
+
+    // Queda de energia simulada: só os primeiros bytes chegam à flash
+    uint32_t gravar = tamanho;
+    if (f->bytes_ate_falha >= 0 && (uint32_t)f->bytes_ate_falha < tamanho) {
+        gravar = (uint32_t)f->bytes_ate_falha;
+        f->falhou = true;
+    }
+
+    const uint8_t *novo = dados;
+    for (uint32_t i = 0; i < gravar; i++) {
+        atual[i] &= novo[i];
+    }
+    if (pwrite(f->fd, atual, tamanho, deslocamento) != (ssize_t)tamanho) return false;
+    return !f->falhou;
+}
+
+static bool apagar(void *ctx, uint32_t deslocamento) {
+    FlashArquivo *f = ctx;
+    if (f->falhou) return false;
+
+    uint8_t setor[FLASH_LOG_TAM_SETOR];
+    memset(setor, 0xFF, sizeof(setor));
+    return pwrite(f->fd, setor, sizeof(setor), deslocamento) == (ssize_t)sizeof(setor);
+}
+
+/*
+* Abre (ou cria, apagada) a imagem com num_setores setores
+*/
+bool flash_arquivo_abrir(FlashArquivo *f, const char *caminho, uint16_t num_setores) {
+    memset(f, 0, sizeof(*f));
+    f->fd = open(caminho, O_RDWR | O_CREAT, 0644);
+    if (f->fd < 0) return false;
+
+    off_t tamanho = (off_t)num_setores * FLASH_LOG_TAM_SETOR;
+    if (lseek(f->fd, 0, SEEK_END) < tamanho) {
+        f->ops.num_setores = num_setores;
+        for (uint16_t s = 0; s < num_setores; s++) {
+            apagar(f, (uint32_t)s * FLASH_LOG_TAM_SETOR);
+        }
+    }
+
+    f->bytes_ate_falha = -1;
+    f->ops = (OperacoesFlash){
+        .ler = ler,
+        .programar = programar,
+        .apagar = apagar,
+        .ctx = f,
+        .num_setores = num_setores,
+    };
+    return true;
+}
+
+void flash_arquivo_fechar(FlashArquivo *f) {
+    if (f->fd >= 0) close(f->fd);
+    f->fd = -1;
+}
@@ -0,0 +1,21 @@
+#ifndef FLASH_ARQUIVO_H
+#define FLASH_ARQUIVO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/flash_log.h"
+
+// Flash emulada em um arquivo de imagem, com a semântica de NOR: programar
+// só zera bits e apagar volta o setor a 0xFF. Permite simular uma queda de
+// energia no meio de uma programação.
+typedef struct {
+    int fd;
+    OperacoesFlash ops;
+    int32_t bytes_ate_falha;   // Bytes gravados antes da "queda" (-1 desativa)
+    bool falhou;
+} FlashArquivo;
+
+bool flash_arquivo_abrir(FlashArquivo *f, const char *caminho, uint16_t num_setores);
+void flash_arquivo_fechar(FlashArquivo *f);
+
+#endif // FLASH_ARQUIVO_H
@@ -0,0 +1,143 @@
+/*
+* Gerador de talhões sintéticos (utils/campo) para testes de carga e
+* demonstrações.
+*
+* Uso: gerar_campo [-s semente] [-f fileiras] [-c colunas] [-v %visivel]
+*                  [-l %latente] [-a %agrupamento] [-r ruido%] [-o folhas.csv]
+*
+* Resume o campo gerado: proporção real de cada perfil, agrupamento medido
+* (fração de vizinhos infectados de plantas infectadas, contra a taxa base),
+* acerto do classificador ativo contra a verdade de campo, vazão de geração
+* e uma impressão digital (FNV-1a de todas as folhas) que deve se repetir
+* para a mesma semente. Com -o, grava as folhas no formato de treinar_arvore
+* (R,G,B,NIR,rotulo; rotulo 1 = planta infectada, visível ou latente).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/campo.h"
+#include "utils/deteccao.h"
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t fnv1a(uint64_t h, const void *dados, size_t tamanho) {
+    const uint8_t *p = dados;
+    for (size_t i = 0; i < tamanho; i++) {
+        h = (h ^ p[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+int main(int argc, char **argv) {
+    ParametrosCampo par = CAMPO_PADRAO;
+    par.fileiras = 1000;
+    par.colunas = 1000;
+    const char *saida_csv = NULL;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "s:f:c:v:l:a:r:o:")) != -1) {
+        switch (opcao) {
+            case 's': par.semente = strtoull(optarg, NULL, 10); break;
+            case 'f': par.fileiras = (uint16_t)atoi(optarg); break;
+            case 'c': par.colunas = (uint16_t)atoi(optarg); break;
+            case 'v': par.pct_visivel = (uint8_t)atoi(optarg); break;
+            case 'l': par.pct_latente = (uint8_t)atoi(optarg); break;
+            case 'a': par.agrupamento = (uint8_t)atoi(optarg); break;
+            case 'r': par.ruido = REFLECTANCIA_PCT(atoi(optarg)); break;
+            case 'o': saida_csv = optarg; break;
+            default:
+                fprintf(stderr, "Uso: %s [-s semente] [-f fileiras] [-c colunas] [-v %%visivel] "
+                                "[-l %%latente] [-a %%agrupamento] [-r ruido%%] [-o folhas.csv]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    static GeradorCampo gerador;
+    if (!campo_iniciar(&gerador, &par)) {
+        fprintf(stderr, "Parametros invalidos (colunas ate %d, folhas ate %d, %%visivel + %%latente <= 100)\n",
+                CAMPO_MAX_COLUNAS, PLANTA_MAX_FOLHAS);
+        return 2;
+    }
+    FILE *csv = NULL;
+    if (saida_csv) {
+        csv = fopen(saida_csv, "w");
+        if (!csv) {
+            perror(saida_csv);
+            return 1;
+        }
+        fprintf(csv, "R,G,B,NIR,rotulo\n");
+    }
+
+    // Perfis de todo o campo, para medir o agrupamento depois
+    uint8_t *perfis = malloc((size_t)par.fileiras * par.colunas);
+    if (!perfis) {
+        fprintf(stderr, "memoria insuficiente\n");
+        return 1;
+    }
+
+    uint64_t contagem[NUM_PERFIS] = {0};
+    uint64_t folhas = 0, impressao = 0xCBF29CE484222325ull;
+    uint64_t detectadas[NUM_PERFIS] = {0}, folhas_perfil[NUM_PERFIS] = {0};
+    PlantaGerada p;
+
+    double inicio = agora_s();
+    while (campo_proxima_planta(&gerador, &p)) {
+        perfis[(size_t)p.fileira * par.colunas + p.coluna] = p.perfil;
+        contagem[p.perfil]++;
+        folhas += p.num_folhas;
+        folhas_perfil[p.perfil] += p.num_folhas;
+        impressao = fnv1a(impressao, p.folhas, p.num_folhas * sizeof(FolhaCompacta));
+        for (uint8_t i = 0; i < p.num_folhas; i++) {
+            detectadas[p.perfil] += folha_compacta_infectada(p.folhas[i]);
+        }
+        if (csv) {
+            for (uint8_t i = 0; i < p.num_folhas; i++) {
+                EstadoFolha f;
+                folha_descompactar(p.folhas[i], &f);
+                fprintf(csv, "%u,%u,%u,%u,%d\n", f.reflectancia.R, f.reflectancia.G,
+                        f.reflectancia.B, f.reflectancia.NIR, p.perfil != PERFIL_SAUDAVEL);
+            }
+        }
+    }
+    double duracao = agora_s() - inicio;
+    if (csv) fclose(csv);
+
+    // Agrupamento: entre os pares vizinhos (8-vizinhança) de plantas infectadas,
+    // fração também infectada. Sem agrupamento, fica perto da taxa base.
+    uint64_t pares = 0, pares_infectados = 0;
+    for (int32_t f = 0; f < par.fileiras; f++) {
+        for (int32_t c = 0; c < par.colunas; c++) {
+            if (perfis[(size_t)f * par.colunas + c] == PERFIL_SAUDAVEL) continue;
+            for (int32_t df = -1; df <= 1; df++) {
+                for (int32_t dc = -1; dc <= 1; dc++) {
+                    int32_t vf = f + df, vc = c + dc;
+                    if ((df == 0 && dc == 0) || vf < 0 || vc < 0 || vf >= par.fileiras || vc >= par.colunas) continue;
+                    pares++;
+                    pares_infectados += perfis[(size_t)vf * par.colunas + vc] != PERFIL_SAUDAVEL;
+                }
+            }
+        }
+    }
+    free(perfis);
+
+    uint64_t plantas = (uint64_t)par.fileiras * par.colunas;
+    printf("Campo %ux%u, semente %llu: %llu plantas, %llu folhas em %.1f ms (%.2f M plantas/s)\n",
+           par.fileiras, par.colunas, (unsigned long long)par.semente, (unsigned long long)plantas,
+           (unsigned long long)folhas, duracao * 1e3, plantas / duracao / 1e6);
+    const char *nomes[NUM_PERFIS] = {"saudavel", "visivel", "latente"};
+    for (int i = 0; i < NUM_PERFIS; i++) {
+        printf("  %-9s %5.1f%% das plantas, %5.1f%% das folhas detectadas como infectadas\n",
+               nomes[i], 100.0 * contagem[i] / plantas,
+               folhas_perfil[i] ? 100.0 * detectadas[i] / folhas_perfil[i] : 0.0);
+    }
+    printf("Agrupamento: %.1f%% dos vizinhos de infectadas estao infectados (taxa base %u%%)\n",
+           pares ? 100.0 * pares_infectados / pares : 0.0, par.pct_visivel + par.pct_latente);
+    printf("Impressao digital: %016llx\n", (unsigned long long)impressao);
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+* Gera a tabela comprimida de uma fonte do display (lib/font.h) a partir do
+* desenho em texto de lib/fontes/.
+*
+* Uso: gerar_fonte <fonte.txt> [-n nome] [-f comprimida|celulas] > lib/font_<nome>.h
+*
+* Entrada: linhas "largura N", "altura N", "avanco N" e "substituto 0xNN"
+* no cabeçalho; depois, para cada glifo, "glifo 0xNN [comentário]" seguido
+* de altura linhas com largura caracteres ('#' aceso, qualquer outro
+* apagado). Linhas em branco e comentários (#) só fora dos glifos.
+*
+* A tabela sai no formato de lib/font.h que ocupa menos flash, contando
+* glifos e índice: comprimido (FONT_COMPRESSED) ou células fixas
+* (FONT_CELLS); -f comprimida|celulas força um deles.
+*
+* O código C vai para a saída padrão; o resumo (glifos e bytes nos dois
+* formatos), para a de erro.
+*/
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lib/font.h"
+
+#define MAX_CODIGOS 256
+#define MAX_BYTES (MAX_CODIGOS * (1 + FONT_MAX_WIDTH))
+
+typedef struct {
+    bool presente;
+    uint8_t colunas[FONT_MAX_WIDTH];
+} Glifo;
+
+static Glifo glifos[MAX_CODIGOS];
+static unsigned largura, altura, avanco, substituto = '?';
+
+static int erro(const char *caminho, int linha, const char *msg) {
+    fprintf(stderr, "%s:%d: %s\n", caminho, linha, msg);
+    return 1;
+}
+
+// Remove o fim de linha e espaços à direita
+static void aparar(char *s) {
+    size_t n = strlen(s);
+    while (n && isspace((unsigned char)s[n - 1])) s[--n] = '\0';
+}
+
+static int ler_fonte(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return 1;
+    }
+    char linha[256];
+    int num = 0, codigo = -1;
+    unsigned linhas_glifo = 0;
+    while (fgets(linha, sizeof(linha), f)) {
+        num++;
+        aparar(linha);
+
+        // Dentro de um glifo toda linha é desenho, inclusive as que começam com '#'
+        if (codigo >= 0) {
+            if (strlen(linha) != largura) return erro(caminho, num, "linha do glifo fora da largura");
+            for (unsigned x = 0; x < largura && x < FONT_MAX_WIDTH; x++) {
+                if (linha[x] == '#') glifos[codigo].colunas[x] |= (uint8_t)(1u << linhas_glifo);
+            }
+            if (++linhas_glifo == altura) codigo = -1;
+            continue;
+        }
+        if (linha[0] == '\0' || linha[0] == '#') continue;
+
+        unsigned valor;
+        if (sscanf(linha, "largura %u", &valor) == 1) {
+            if (valor == 0 || valor > FONT_MAX_WIDTH) return erro(caminho, num, "largura fora de 1-8");
+            largura = valor;
+        } else if (sscanf(linha, "altura %u", &valor) == 1) {
+            if (valor == 0 || valor > 8) return erro(caminho, num, "altura fora de 1-8");
+            altura = valor;
+        } else if (sscanf(linha, "avanco %u", &valor) == 1) {
+            avanco = valor;
+        } else if (sscanf(linha, "substituto %x", &valor) == 1) {
+            substituto = valor;
+        } else if (sscanf(linha, "glifo %x", &valor) == 1) {
+            if (!largura || !altura) return erro(caminho, num, "glifo antes de largura e altura");
+            if (valor < 0x20 || valor >= MAX_CODIGOS) return erro(caminho, num, "codigo fora de 0x20-0xFF");
+            if (glifos[valor].presente) return erro(caminho, num, "glifo repetido");
+            glifos[valor].presente = true;
+            codigo = (int)valor;
+            linhas_glifo = 0;
+        } else {
+            return erro(caminho, num, "linha nao reconhecida");
+        }
+    }
+    fclose(f);
+    if (codigo >= 0) return erro(caminho, num, "glifo incompleto no fim do arquivo");
+    if (avanco < largura) avanco = largura;
+    if (substituto >= MAX_CODIGOS || !glifos[substituto].presente) return erro(caminho, num, "substituto sem glifo");
+    return 0;
+}
+
+/*
+* Comprime um glifo no formato de lib/font.h: cabeçalho e as colunas entre a
+* primeira e a última acesas, só a metade esquerda se o glifo for simétrico
+* @return Bytes escritos
+*/
+static unsigned comprimir(const Glifo *g, uint8_t *saida) {
+    if (!g->presente) {
+        saida[0] = FONT_MISSING;
+        return 1;
+    }
+    int inicio = -1, fim = -1;
+    for (unsigned x = 0; x < largura; x++) {
+        if (g->colunas[x]) {
+            if (inicio < 0) inicio = (int)x;
+            fim = (int)x;
+        }
+    }
+    if (inicio < 0) {
+        saida[0] = 0;
+        return 1;
+    }
+    unsigned n = (unsigned)(fim - inicio + 1);
+    bool simetrico = n > 1;
+    for (unsigned x = 0; x < n / 2; x++) {
+        if (g->colunas[inicio + x] != g->colunas[fim - x]) simetrico = false;
+    }
+    saida[0] = (uint8_t)((simetrico ? FONT_MIRRORED : 0) | inicio << 4 | n);
+    unsigned guardadas = font_stored_columns(saida[0]);
+    memcpy(saida + 1, &g->colunas[inicio], guardadas);
+    return 1 + guardadas;
+}
+
+// Índice com o deslocamento de cada bloco na ordem dos glifos comprimidos
+static void escrever_comprimida(const char *nome, const uint8_t *dados, const unsigned *inicio_codigo,
+                                const uint16_t *blocos, unsigned primeiro, unsigned ultimo,
+                                unsigned total, unsigned num_blocos) {
+    printf("static const uint8_t font_%s_glyphs[%u] __in_flash(\"fontes\") = {", nome, total);
+    for (unsigned c = primeiro; c <= ultimo; c++) {
+        const uint8_t *g = dados + inicio_codigo[c];
+        unsigned n = inicio_codigo[c + 1] - inicio_codigo[c];
+        if (n == 0) continue;
+        printf("\n    ");
+        for (unsigned i = 0; i < n; i++) printf("0x%02X,%s", g[i], i + 1 < n ? " " : "");
+        printf("%*s// 0x%02X", (int)(6 * (FONT_MAX_WIDTH + 1 - n)) + 1, "", c);
+        if (c < 0x7F && c != '\\') printf(" %c", c);  // Barra invertida no fim continuaria o comentário
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint16_t font_%s_blocks[%u] __in_flash(\"fontes\") = {", nome, num_blocos);
+    for (unsigned b = 0; b < num_blocos; b++) {
+        if (blocos[b] == FONT_BLOCK_EMPTY) printf("%sFONT_BLOCK_EMPTY,", b % 8 ? " " : "\n    ");
+        else printf("%s%u,", b % 8 ? " " : "\n    ", blocos[b]);
+    }
+    printf("\n};\n\n");
+}
+
+// Colunas inteiras dos códigos com glifo, mapa de presença e contagem por palavra
+static void escrever_celulas(const char *nome, unsigned primeiro, unsigned ultimo, unsigned presentes) {
+    printf("static const uint8_t font_%s_glyphs[%u] __in_flash(\"fontes\") = {", nome, presentes * largura);
+    for (unsigned c = primeiro; c <= ultimo; c++) {
+        if (!glifos[c].presente) continue;
+        printf("\n    ");
+        for (unsigned x = 0; x < largura; x++) printf("0x%02X,%s", glifos[c].colunas[x], x + 1 < largura ? " " : "");
+        printf("%*s// 0x%02X", (int)(6 * (FONT_MAX_WIDTH - largura)) + 1, "", c);
+        if (c < 0x7F && c != '\\') printf(" %c", c);
+    }
+    printf("\n};\n\n");
+
+    unsigned palavras = (ultimo - primeiro) / 32 + 1, antes = 0;
+    uint8_t contagem[MAX_CODIGOS / 32];
+    printf("static const uint32_t font_%s_present[%u] __in_flash(\"fontes\") = {\n   ", nome, palavras);
+    for (unsigned w = 0; w < palavras; w++) {
+        uint32_t palavra = 0;
+        contagem[w] = (uint8_t)antes;
+        for (unsigned b = 0; b < 32 && primeiro + w * 32 + b <= ultimo; b++) {
+            if (glifos[primeiro + w * 32 + b].presente) {
+                palavra |= 1u << b;
+                antes++;
+            }
+        }
+        printf(" 0x%08X,", palavra);
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint8_t font_%s_rank[%u] __in_flash(\"fontes\") = {\n   ", nome, palavras);
+    for (unsigned w = 0; w < palavras; w++) printf(" %u,", contagem[w]);
+    printf("\n};\n\n");
+}
+
+int main(int argc, char **argv) {
+    const char *caminho = NULL, *nome = "fonte", *formato = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) nome = argv[++i];
+        else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) formato = argv[++i];
+        else caminho = argv[i];
+    }
+    if (!caminho || (formato && strcmp(formato, "comprimida") != 0 && strcmp(formato, "celulas") != 0)) {
+        fprintf(stderr, "Uso: %s <fonte.txt> [-n nome] [-f comprimida|celulas]\n", argv[0]);
+        return 2;
+    }
+    if (ler_fonte(caminho)) return 1;
+
+    unsigned primeiro = MAX_CODIGOS, ultimo = 0, presentes = 0;
+    for (unsigned c = 0; c < MAX_CODIGOS; c++) {
+        if (!glifos[c].presente) continue;
+        if (c < primeiro) primeiro = c;
+        ultimo = c;
+        presentes++;
+    }
+
+    // Blocos de FONT_BLOCK códigos; os sem nenhum glifo não ocupam bytes
+    static uint8_t dados[MAX_BYTES];
+    static unsigned inicio_codigo[MAX_CODIGOS + 1];
+    static uint16_t blocos[MAX_CODIGOS / FONT_BLOCK];
+    unsigned num_blocos = (ultimo - primeiro) / FONT_BLOCK + 1;
+    unsigned total = 0, vazios = 0;
+    for (unsigned b = 0; b < num_blocos; b++) {
+        unsigned de = primeiro + b * FONT_BLOCK, ate = de + FONT_BLOCK;
+        if (ate > ultimo + 1) ate = ultimo + 1;
+        bool algum = false;
+        for (unsigned c = de; c < ate; c++) algum |= glifos[c].presente;
+        blocos[b] = algum ? (uint16_t)total : FONT_BLOCK_EMPTY;
+        vazios += !algum;
+        for (unsigned c = de; c < ate; c++) {
+            inicio_codigo[c] = total;
+            if (algum) total += comprimir(&glifos[c], dados + total);
+        }
+    }
+    inicio_codigo[ultimo + 1] = total;
+
+    // Bytes de cada formato, glifos + índice
+    unsigned indice_comprimida = num_blocos * 2;
+    unsigned palavras = (ultimo - primeiro) / 32 + 1;
+    unsigned glifos_celulas = presentes * largura, indice_celulas = palavras * 5;
+    bool celulas = formato ? strcmp(formato, "celulas") == 0
+                           : glifos_celulas + indice_celulas < total + indice_comprimida;
+    unsigned bytes_glifos = celulas ? glifos_celulas : total;
+    unsigned bytes_indice = celulas ? indice_celulas : indice_comprimida;
+
+    printf("// Gerado por tools/gerar_fonte a partir de %s; não editar.\n", caminho);
+    printf("// %u glifos %ux%u, códigos 0x%02X-0x%02X, %s: %u bytes de glifos + %u de índice\n",
+           presentes, largura, altura, primeiro, ultimo, celulas ? "células fixas" : "comprimidos",
+           bytes_glifos, bytes_indice);
+    printf("// (%s: %u + %u)\n\n", celulas ? "comprimidos" : "células fixas",
+           celulas ? total : glifos_celulas, celulas ? indice_comprimida : indice_celulas);
+
+    if (celulas) escrever_celulas(nome, primeiro, ultimo, presentes);
+    else escrever_comprimida(nome, dados, inicio_codigo, blocos, primeiro, ultimo, total, num_blocos);
+
+    printf("const font_t font_%s __in_flash(\"fontes\") = {\n", nome);
+    printf("    .width = %u,\n    .height = %u,\n    .advance = %u,\n", largura, altura, avanco);
+    printf("    .first = 0x%02X,\n    .last = 0x%02X,\n    .fallback = 0x%02X,\n", primeiro, ultimo, substituto);
+    if (celulas) {
+        printf("    .format = FONT_CELLS,\n");
+        printf("    .present = font_%s_present,\n    .rank = font_%s_rank,\n", nome, nome);
+    } else {
+        printf("    .format = FONT_COMPRESSED,\n    .blocks = font_%s_blocks,\n", nome);
+    }
+    printf("    .glyphs = font_%s_glyphs,\n};\n", nome);
+
+    fprintf(stderr, "%s: %u glifos, %s; comprimidos %u + %u de indice (%u blocos vazios), celulas %u + %u\n",
+            nome, presentes, celulas ? "celulas" : "comprimidos", total, indice_comprimida, vazios,
+            glifos_celulas, indice_celulas);
+    return 0;
+}
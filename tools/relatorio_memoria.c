@@ -0,0 +1,89 @@
+/*
+* Relatório de ocupação de memória dos registros de planta: compara o layout
+* original (floats), a forma de trabalho em ponto fixo (EstadoFolha) e o
+* registro de plantas com folhas compactas de 8 bytes, para 1k e 10k plantas,
+* contra os 264 KB de SRAM do RP2040. Também mede o erro de ida e volta da
+* compactação.
+*/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "utils/plantas.h"
+#include "utils/registro.h"
+
+#define SRAM_RP2040 (264u * 1024u)
+
+// Layout original, antes da migração para ponto fixo
+typedef struct {
+    struct { float R, G, B, NIR; } reflectancia;
+    float ndvi, gndvi;
+    bool visivel, infectada;
+} FolhaFloat;
+
+typedef struct {
+    int id;
+    FolhaFloat folhas[FOLHAS_POR_PLANTA];
+    bool infectada, tratada;
+} PlantaFloat;
+
+// Planta montada diretamente com a forma de trabalho
+typedef struct {
+    int id;
+    EstadoFolha folhas[FOLHAS_POR_PLANTA];
+    bool infectada, tratada;
+} PlantaTrabalho;
+
+static void linha(const char *nome, size_t folha, size_t planta) {
+    printf("%-28s %6zu %7zu", nome, folha, planta);
+    const unsigned quantidades[] = {1000, 10000};
+    for (int i = 0; i < 2; i++) {
+        size_t total = planta * quantidades[i];
+        printf("  %8.1f KB (%5.1f%%)", total / 1024.0, 100.0 * total / SRAM_RP2040);
+    }
+    printf("\n");
+}
+
+int main(void) {
+    printf("%-28s %6s %7s  %21s  %21s\n", "layout", "folha", "planta", "1k plantas", "10k plantas");
+    linha("original (float)", sizeof(FolhaFloat), sizeof(PlantaFloat));
+    linha("ponto fixo (EstadoFolha)", sizeof(EstadoFolha), sizeof(PlantaTrabalho));
+    // Registro: cabeçalho da planta + folhas no pool + duas entradas da tabela de ids
+    size_t planta_registro = sizeof(Planta) + FOLHAS_POR_PLANTA * sizeof(FolhaCompacta) +
+                             (REGISTRO_TAM_HASH / REGISTRO_MAX_PLANTAS) * sizeof(uint16_t);
+    linha("compacto (registro)", sizeof(FolhaCompacta), planta_registro);
+    printf("SRAM do RP2040: %u KB; cabem %u plantas compactas de %d folhas\n",
+           SRAM_RP2040 / 1024, SRAM_RP2040 / (unsigned)planta_registro, FOLHAS_POR_PLANTA);
+    printf("RegistroPlantas (%d plantas, %d folhas): %.1f KB estaticos\n\n",
+           REGISTRO_MAX_PLANTAS, REGISTRO_MAX_FOLHAS, sizeof(RegistroPlantas) / 1024.0);
+
+    // Ida e volta: reflectâncias exatas até 100%, índices com erro de quantização
+    uint32_t casos = 0, divergencias = 0;
+    q15_t pior_ndvi = 0, pior_gndvi = 0;
+    for (uint16_t R = 0; R <= REFLECTANCIA_MAX; R += 15) {
+        for (uint16_t G = 0; G <= REFLECTANCIA_MAX; G += 15) {
+            for (uint16_t NIR = 0; NIR <= REFLECTANCIA_MAX; NIR += 15) {
+                EstadoFolha folha = {0}, restaurada;
+                folha_definir_reflectancia(&folha, (Reflectancia){R, G, R / 2, NIR});
+                folha.infectada = detectar_doenca_folha(&folha);
+
+                FolhaCompacta c = folha_compactar(&folha);
+                folha_descompactar(c, &restaurada);
+
+                divergencias += restaurada.reflectancia.R != R || restaurada.reflectancia.G != G ||
+                                restaurada.reflectancia.NIR != NIR ||
+                                restaurada.infectada != folha.infectada ||
+                                detectar_doenca_folha(&restaurada) != folha.infectada;
+
+                q15_t e = abs(folha_compacta_ndvi(c) - folha.indices.valor[INDICE_NDVI]);
+                if (e > pior_ndvi) pior_ndvi = e;
+                e = abs(folha_compacta_gndvi(c) - folha.indices.valor[INDICE_GNDVI]);
+                if (e > pior_gndvi) pior_gndvi = e;
+                casos++;
+            }
+        }
+    }
+    printf("Ida e volta: %u divergencias em %u folhas\n", divergencias, casos);
+    printf("Erro maximo dos indices compactos: NDVI %.4f, GNDVI %.4f\n",
+           Q15_PARA_FLOAT(pior_ndvi), Q15_PARA_FLOAT(pior_gndvi));
+    return divergencias != 0;
+}
@@ -0,0 +1,358 @@
+/*
+* Robustez da detecção ao ruído do sensor (Monte Carlo): sorteia vetores de
+* reflectância, aplica perturbações de um modelo de ruído e mede com que
+* frequência o veredito de detectar_doenca (o mesmo código em ponto fixo do
+* firmware) troca em relação ao valor sem ruído.
+*
+* Uso: robustez_deteccao [-p pontos] [-n perturbacoes] [-m modelo] [-r ruido%]
+*                        [-t threads] [-s semente] [-e]
+*
+* Modelos de ruído (desvio padrão ruido% do fundo de escala):
+*   aditivo     ruído independente somado a cada banda
+*   ganho       erro de ganho independente por banda (proporcional ao valor)
+*   iluminacao  mesmo erro de ganho em todas as bandas (variação da luz)
+*
+* As trocas são agrupadas pela margem de decisão do ponto: a menor distância
+* de NDVI/GNDVI aos limiares e de R/G aos limiares de sintoma visível (em
+* fração do fundo de escala). Cada ponto tem a própria semente, então o
+* resultado não depende do número de threads nem da divisão do trabalho.
+*
+* O trabalho é dividido em faixas de pontos, uma por thread; quem termina a
+* sua rouba metade da faixa restante de outra (faixa em uma palavra atômica
+* de 64 bits, tomada e roubada por compare-and-swap). Com -e, repete com
+* 1, 2, 4... threads e mostra a aceleração.
+*/
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/aleatorio.h"
+#include "utils/deteccao.h"
+
+#define MAX_THREADS 256
+#define PONTOS_POR_LOTE 32             // Pontos tomados de cada vez da própria faixa
+#define NUM_FAIXAS 11                  // Margens de 0.01 em 0.01, a última aberta (>= 0.10)
+#define LARGURA_FAIXA Q15(0.01)
+#define NIR_MAX REFLECTANCIA_PCT(120)  // NIR acima de 100% é comum em folhas sadias
+
+typedef enum {
+    RUIDO_ADITIVO,
+    RUIDO_GANHO,
+    RUIDO_ILUMINACAO,
+    NUM_MODELOS_RUIDO
+} ModeloRuido;
+
+static const char *const NOMES_RUIDO[NUM_MODELOS_RUIDO] = {"aditivo", "ganho", "iluminacao"};
+
+typedef struct {
+    uint32_t pontos;
+    uint32_t perturbacoes;
+    ModeloRuido modelo;
+    uint16_t desvio;                   // Escala do ADC
+    uint64_t semente;
+} Configuracao;
+
+typedef struct {
+    uint64_t pontos[NUM_FAIXAS];
+    uint64_t classificacoes[NUM_FAIXAS];
+    uint64_t trocas[NUM_FAIXAS];
+} Resultados;
+
+// Uma por thread, em linhas de cache separadas
+typedef struct {
+    _Alignas(64) _Atomic uint64_t faixa;   // Pontos não tomados: início (32 bits altos), fim
+    Resultados resultados;
+    uint32_t roubos;
+    uint32_t id;
+} Trabalhador;
+
+static Configuracao config;
+static Trabalhador trabalhadores[MAX_THREADS];
+static uint32_t num_trabalhadores;
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**********************************
+* AVALIAÇÃO
+**********************************/
+
+static uint16_t saturar(int32_t valor) {
+    return valor < 0 ? 0 : (valor > LOTE_REFLECTANCIA_MAX ? LOTE_REFLECTANCIA_MAX : (uint16_t)valor);
+}
+
+static uint32_t distancia(int32_t a, int32_t b) {
+    return a > b ? (uint32_t)(a - b) : (uint32_t)(b - a);
+}
+
+// Menor distância do ponto a um limiar dos critérios, em Q15
+static uint32_t margem_decisao(const Reflectancia *r) {
+    const uint32_t escala = Q15_UM / REFLECTANCIA_MAX;   // 8: Q15 por unidade do ADC
+    uint32_t margem = distancia(calcular_ndvi(r), LIMIARES_PADRAO.ndvi);
+    uint32_t d = distancia(calcular_gndvi(r), LIMIARES_PADRAO.gndvi);
+    if (d < margem) margem = d;
+    d = distancia(r->R, LIMIARES_PADRAO.r_visivel) * escala;
+    if (d < margem) margem = d;
+    d = distancia(r->G, LIMIARES_PADRAO.g_visivel) * escala;
+    if (d < margem) margem = d;
+    return margem;
+}
+
+static Reflectancia perturbar(const Reflectancia *r, Aleatorio *rng) {
+    int32_t R = r->R, G = r->G, B = r->B, NIR = r->NIR;
+    switch (config.modelo) {
+        case RUIDO_ADITIVO:
+            R += aleatorio_gauss(rng, config.desvio);
+            G += aleatorio_gauss(rng, config.desvio);
+            B += aleatorio_gauss(rng, config.desvio);
+            NIR += aleatorio_gauss(rng, config.desvio);
+            break;
+        case RUIDO_GANHO:
+            R += R * aleatorio_gauss(rng, config.desvio) / REFLECTANCIA_MAX;
+            G += G * aleatorio_gauss(rng, config.desvio) / REFLECTANCIA_MAX;
+            B += B * aleatorio_gauss(rng, config.desvio) / REFLECTANCIA_MAX;
+            NIR += NIR * aleatorio_gauss(rng, config.desvio) / REFLECTANCIA_MAX;
+            break;
+        default: {
+            int32_t ganho = aleatorio_gauss(rng, config.desvio);
+            R += R * ganho / REFLECTANCIA_MAX;
+            G += G * ganho / REFLECTANCIA_MAX;
+            B += B * ganho / REFLECTANCIA_MAX;
+            NIR += NIR * ganho / REFLECTANCIA_MAX;
+            break;
+        }
+    }
+    return (Reflectancia){saturar(R), saturar(G), saturar(B), saturar(NIR)};
+}
+
+// Um ponto: vetor sorteado com semente própria e suas perturbações
+static void avaliar_ponto(uint32_t indice, Resultados *res) {
+    Aleatorio rng;
+    aleatorio_semear(&rng, (config.semente << 32) ^ indice);
+    Reflectancia base = {
+        (uint16_t)aleatorio_faixa(&rng, REFLECTANCIA_MAX + 1),
+        (uint16_t)aleatorio_faixa(&rng, REFLECTANCIA_MAX + 1),
+        (uint16_t)aleatorio_faixa(&rng, REFLECTANCIA_MAX + 1),
+        (uint16_t)aleatorio_faixa(&rng, NIR_MAX + 1),
+    };
+    bool veredito = detectar_doenca(base.R, base.G, base.B, base.NIR);
+
+    uint32_t faixa = margem_decisao(&base) / LARGURA_FAIXA;
+    if (faixa >= NUM_FAIXAS) faixa = NUM_FAIXAS - 1;
+
+    uint32_t trocas = 0;
+    for (uint32_t k = 0; k < config.perturbacoes; k++) {
+        Reflectancia r = perturbar(&base, &rng);
+        trocas += detectar_doenca(r.R, r.G, r.B, r.NIR) != veredito;
+    }
+    res->pontos[faixa]++;
+    res->classificacoes[faixa] += config.perturbacoes;
+    res->trocas[faixa] += trocas;
+}
+
+/**********************************
+* DIVISÃO DO TRABALHO
+**********************************/
+
+static inline uint64_t empacotar(uint32_t inicio, uint32_t fim) {
+    return ((uint64_t)inicio << 32) | fim;
+}
+
+// Dono: toma um lote do começo da própria faixa
+static bool tomar(Trabalhador *t, uint32_t *inicio, uint32_t *fim) {
+    uint64_t atual = atomic_load(&t->faixa);
+    for (;;) {
+        uint32_t i = (uint32_t)(atual >> 32), f = (uint32_t)atual;
+        if (i >= f) return false;
+        uint32_t n = f - i < PONTOS_POR_LOTE ? f - i : PONTOS_POR_LOTE;
+        if (atomic_compare_exchange_weak(&t->faixa, &atual, empacotar(i + n, f))) {
+            *inicio = i;
+            *fim = i + n;
+            return true;
+        }
+    }
+}
+
+// Ladrão: leva a metade final da faixa de outro
+static bool roubar(Trabalhador *vitima, uint32_t *inicio, uint32_t *fim) {
+    uint64_t atual = atomic_load(&vitima->faixa);
+    for (;;) {
+        uint32_t i = (uint32_t)(atual >> 32), f = (uint32_t)atual;
+        if (i >= f) return false;
+        uint32_t meio = i + (f - i) / 2;
+        if (atomic_compare_exchange_weak(&vitima->faixa, &atual, empacotar(i, meio))) {
+            *inicio = meio;
+            *fim = f;
+            return true;
+        }
+    }
+}
+
+static void *executar(void *arg) {
+    Trabalhador *eu = arg;
+    for (;;) {
+        uint32_t inicio, fim;
+        while (tomar(eu, &inicio, &fim)) {
+            for (uint32_t i = inicio; i < fim; i++) {
+                avaliar_ponto(i, &eu->resultados);
+            }
+        }
+
+        // Faixa vazia: rouba da próxima que ainda tiver trabalho. Trabalho
+        // já tomado é terminado por quem o tomou, então sem faixas a roubar
+        // não há mais nada a fazer.
+        bool roubou = false;
+        for (uint32_t k = 1; k < num_trabalhadores && !roubou; k++) {
+            Trabalhador *vitima = &trabalhadores[(eu->id + k) % num_trabalhadores];
+            if (roubar(vitima, &inicio, &fim)) {
+                atomic_store(&eu->faixa, empacotar(inicio, fim));
+                eu->roubos++;
+                roubou = true;
+            }
+        }
+        if (!roubou) return NULL;
+    }
+}
+
+/*
+* Avalia todos os pontos com n threads e soma os resultados
+* @return Tempo de parede em segundos
+*/
+static double rodar(uint32_t n, Resultados *total, uint32_t *roubos) {
+    pthread_t threads[MAX_THREADS];
+    num_trabalhadores = n;
+    for (uint32_t t = 0; t < n; t++) {
+        memset(&trabalhadores[t].resultados, 0, sizeof(Resultados));
+        trabalhadores[t].roubos = 0;
+        trabalhadores[t].id = t;
+        uint32_t inicio = (uint32_t)((uint64_t)config.pontos * t / n);
+        uint32_t fim = (uint32_t)((uint64_t)config.pontos * (t + 1) / n);
+        atomic_store(&trabalhadores[t].faixa, empacotar(inicio, fim));
+    }
+
+    double inicio = agora_s();
+    for (uint32_t t = 1; t < n; t++) {
+        pthread_create(&threads[t], NULL, executar, &trabalhadores[t]);
+    }
+    executar(&trabalhadores[0]);
+    for (uint32_t t = 1; t < n; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double duracao = agora_s() - inicio;
+
+    memset(total, 0, sizeof(*total));
+    *roubos = 0;
+    for (uint32_t t = 0; t < n; t++) {
+        for (int f = 0; f < NUM_FAIXAS; f++) {
+            total->pontos[f] += trabalhadores[t].resultados.pontos[f];
+            total->classificacoes[f] += trabalhadores[t].resultados.classificacoes[f];
+            total->trocas[f] += trabalhadores[t].resultados.trocas[f];
+        }
+        *roubos += trabalhadores[t].roubos;
+    }
+    return duracao;
+}
+
+/**********************************
+* RELATÓRIO
+**********************************/
+
+static void imprimir_resultados(const Resultados *r) {
+    uint64_t classificacoes = 0, trocas = 0;
+    int guarda = -1;
+    printf("margem       pontos      classificacoes  trocas        taxa\n");
+    for (int f = 0; f < NUM_FAIXAS; f++) {
+        double taxa = r->classificacoes[f] ? (double)r->trocas[f] / r->classificacoes[f] : 0;
+        if (f < NUM_FAIXAS - 1) {
+            printf("%.2f-%.2f    ", f * 0.01, (f + 1) * 0.01);
+        } else {
+            printf(">= %.2f      ", f * 0.01);
+        }
+        printf("%-11llu %-15llu %-13llu %.4f%%\n", (unsigned long long)r->pontos[f],
+               (unsigned long long)r->classificacoes[f], (unsigned long long)r->trocas[f], 100 * taxa);
+        if (taxa >= 0.01) guarda = f + 1;
+        classificacoes += r->classificacoes[f];
+        trocas += r->trocas[f];
+    }
+    printf("Taxa geral de troca: %.4f%% (%llu de %llu)\n", classificacoes ? 100.0 * trocas / classificacoes : 0,
+           (unsigned long long)trocas, (unsigned long long)classificacoes);
+    if (guarda < 0) {
+        printf("Taxa abaixo de 1%% em todas as margens\n");
+    } else if (guarda < NUM_FAIXAS) {
+        printf("Margem de guarda para taxa < 1%%: %.2f\n", guarda * 0.01);
+    } else {
+        printf("Taxa acima de 1%% mesmo com margem >= %.2f\n", (NUM_FAIXAS - 1) * 0.01);
+    }
+}
+
+int main(int argc, char **argv) {
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = nucleos > 0 ? (uint32_t)nucleos : 1;
+    uint32_t ruido_pct10 = 20;   // Décimos de %
+    bool escalabilidade = false;
+    config = (Configuracao){.pontos = 100000, .perturbacoes = 100, .modelo = RUIDO_ADITIVO, .semente = 1};
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "p:n:m:r:t:s:e")) != -1) {
+        switch (opcao) {
+            case 'p': config.pontos = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'n': config.perturbacoes = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'r': ruido_pct10 = (uint32_t)(atof(optarg) * 10 + 0.5); break;
+            case 't': threads = (uint32_t)atoi(optarg); break;
+            case 's': config.semente = strtoull(optarg, NULL, 10); break;
+            case 'e': escalabilidade = true; break;
+            case 'm':
+                for (config.modelo = 0; config.modelo < NUM_MODELOS_RUIDO; config.modelo++) {
+                    if (strcmp(optarg, NOMES_RUIDO[config.modelo]) == 0) break;
+                }
+                if (config.modelo < NUM_MODELOS_RUIDO) break;
+                fprintf(stderr, "modelo de ruido desconhecido: %s\n", optarg);
+                return 2;
+            default:
+                fprintf(stderr, "Uso: %s [-p pontos] [-n perturbacoes] [-m aditivo|ganho|iluminacao] "
+                                "[-r ruido%%] [-t threads] [-s semente] [-e]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    config.desvio = (uint16_t)((ruido_pct10 * REFLECTANCIA_MAX + 500) / 1000);
+
+    printf("Ruido %s, desvio %.1f%% (%u no ADC); %u pontos x %u perturbacoes = %.1f M classificacoes\n",
+           NOMES_RUIDO[config.modelo], ruido_pct10 / 10.0, config.desvio, config.pontos, config.perturbacoes,
+           (double)config.pontos * config.perturbacoes / 1e6);
+
+    Resultados total;
+    uint32_t roubos;
+    if (escalabilidade) {
+        double base = 0;
+        uint64_t trocas_base = 0;
+        printf("threads  tempo (s)  M classif/s  aceleracao  eficiencia  roubos  trocas\n");
+        for (uint32_t n = 1;; n = n * 2 < threads ? n * 2 : threads) {
+            double t = rodar(n, &total, &roubos);
+            uint64_t trocas = 0;
+            for (int f = 0; f < NUM_FAIXAS; f++) trocas += total.trocas[f];
+            if (n == 1) {
+                base = t;
+                trocas_base = trocas;
+            }
+            printf("%-8u %-10.3f %-12.1f %-11.2f %3.0f%%        %-7u %llu%s\n", n, t,
+                   (double)config.pontos * config.perturbacoes / t / 1e6, base / t, 100 * base / t / n, roubos,
+                   (unsigned long long)trocas, trocas == trocas_base ? "" : " (DIFERENTE)");
+            if (n == threads) break;
+        }
+        printf("(%ld nucleos disponiveis)\n", nucleos);
+    } else {
+        double t = rodar(threads, &total, &roubos);
+        printf("%u threads: %.3f s, %.1f M classificacoes/s, %u roubos\n", threads, t,
+               (double)config.pontos * config.perturbacoes / t / 1e6, roubos);
+    }
+    imprimir_resultados(&total);
+    return 0;
+}
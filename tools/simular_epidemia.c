@@ -0,0 +1,171 @@
+/*
+* Simulação da propagação da infecção (utils/epidemia) em grades grandes.
+*
+* Uso: simular_epidemia [-l largura] [-a altura] [-p chance/256] [-f focos]
+*                       [-d dias] [-s semente] [-v]
+*
+* Mostra a curva de infecção (novas e total por dia) e o tempo por dia.
+* Com -v, confere cada dia contra uma referência célula a célula:
+*   - novas infecções só em plantas suscetíveis com vizinho infectado;
+*   - infectadas continuam infectadas e tratadas nunca se infectam;
+*   - uma faixa tratada no meio da grade barra a propagação para o outro lado;
+*   - a taxa de infecção medida para cada número de vizinhos k bate com
+*     1 - (1 - p)^k (desvio em erros padrão).
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/epidemia.h"
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Vizinhos infectados de uma célula, direto da definição
+static int vizinhos_infectados(const Epidemia *e, int x, int y) {
+    int k = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if ((dx || dy) && x + dx >= 0 && y + dy >= 0 &&
+                epidemia_estado(e, x + dx, y + dy) == EPIDEMIA_INFECTADA) {
+                k++;
+            }
+        }
+    }
+    return k;
+}
+
+/*
+* Roda os dias conferindo contra a referência; retorna o número de violações
+*/
+static uint32_t verificar(Epidemia *e, uint32_t dias, uint16_t barreira) {
+    uint32_t violacoes = 0;
+    uint64_t expostas[9] = {0}, infectadas[9] = {0};
+    uint8_t *antes = malloc((size_t)e->largura * e->altura);
+    uint8_t *vizinhos = malloc((size_t)e->largura * e->altura);
+
+    for (uint32_t d = 0; d < dias; d++) {
+        for (int y = 0; y < e->altura; y++) {
+            for (int x = 0; x < e->largura; x++) {
+                size_t c = (size_t)y * e->largura + x;
+                antes[c] = epidemia_estado(e, x, y);
+                vizinhos[c] = vizinhos_infectados(e, x, y);
+            }
+        }
+        epidemia_avancar_dia(e);
+
+        for (int y = 0; y < e->altura; y++) {
+            for (int x = 0; x < e->largura; x++) {
+                size_t c = (size_t)y * e->largura + x;
+                EstadoCelula depois = epidemia_estado(e, x, y);
+                if (antes[c] == EPIDEMIA_SAUDAVEL) {
+                    expostas[vizinhos[c]]++;
+                    if (depois == EPIDEMIA_INFECTADA) {
+                        infectadas[vizinhos[c]]++;
+                        violacoes += vizinhos[c] == 0;       // Sem vizinho infectado
+                        violacoes += x > barreira;           // Atravessou a faixa tratada
+                    }
+                } else {
+                    violacoes += depois != antes[c];         // Infectadas e tratadas não mudam
+                }
+            }
+        }
+    }
+
+    printf("k  expostas     infectadas  taxa     esperada  desvio\n");
+    for (int k = 1; k <= 8; k++) {
+        if (expostas[k] == 0) continue;
+        double taxa = (double)infectadas[k] / expostas[k];
+        double esperada = e->prob_contagem[k] / 256.0;
+        double erro = sqrt(esperada * (1 - esperada) / expostas[k]);
+        double desvio = erro > 0 ? (taxa - esperada) / erro : 0;
+        printf("%d  %-11llu  %-10llu  %.4f   %.4f    %+.1f\n", k, (unsigned long long)expostas[k],
+               (unsigned long long)infectadas[k], taxa, esperada, desvio);
+        violacoes += fabs(desvio) > 5;
+    }
+    free(antes);
+    free(vizinhos);
+    return violacoes;
+}
+
+int main(int argc, char **argv) {
+    uint16_t largura = 1000, altura = 1000;
+    uint32_t chance = 26, focos = 100, dias = 60;
+    uint64_t semente = 1;
+    bool verificacao = false;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "l:a:p:f:d:s:v")) != -1) {
+        switch (opcao) {
+            case 'l': largura = (uint16_t)atoi(optarg); break;
+            case 'a': altura = (uint16_t)atoi(optarg); break;
+            case 'p': chance = (uint32_t)atoi(optarg); break;
+            case 'f': focos = (uint32_t)atoi(optarg); break;
+            case 'd': dias = (uint32_t)atoi(optarg); break;
+            case 's': semente = strtoull(optarg, NULL, 10); break;
+            case 'v': verificacao = true; break;
+            default:
+                fprintf(stderr, "Uso: %s [-l largura] [-a altura] [-p chance/256] [-f focos] "
+                                "[-d dias] [-s semente] [-v]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (chance > 255) chance = 255;
+    if (verificacao && largura < 4) {
+        fprintf(stderr, "verificacao exige largura >= 4 (faixa tratada no meio da grade)\n");
+        return 2;
+    }
+
+    size_t palavras = EPIDEMIA_PALAVRAS(largura, altura);
+    uint32_t *memoria = malloc(palavras * sizeof(uint32_t));
+    Epidemia e;
+    if (!memoria || !epidemia_iniciar(&e, largura, altura, memoria, palavras, (uint8_t)chance, semente)) {
+        fprintf(stderr, "grade invalida\n");
+        return 1;
+    }
+    printf("Grade %ux%u (%.1f KB), chance %u/256 por vizinho, %u focos\n",
+           largura, altura, palavras * 4 / 1024.0, chance, focos);
+
+    if (verificacao) {
+        // Focos só à esquerda de uma faixa tratada de 2 colunas, sorteados
+        // pelo gerador da grade para que -s reproduza a verificação
+        uint16_t barreira = largura / 2;
+        epidemia_tratar_bloco(&e, barreira, 0, barreira + 2, altura);
+        for (uint32_t i = 0; i < focos; i++) {
+            uint16_t x = (uint16_t)aleatorio_faixa(&e.rng, barreira);
+            epidemia_infectar(&e, x, (uint16_t)aleatorio_faixa(&e.rng, altura));
+        }
+        uint32_t violacoes = verificar(&e, dias, barreira + 1);
+        printf("Verificacao: %u dias, %u violacoes: %s\n", dias, violacoes, violacoes ? "FALHA" : "OK");
+        free(memoria);
+        return violacoes != 0;
+    }
+
+    epidemia_semear(&e, focos);
+    uint32_t total, tratadas;
+    epidemia_contar_bloco(&e, 0, 0, largura, altura, &total, &tratadas);
+
+    double soma = 0, pior = 0;
+    printf("dia  novas     infectadas  %%       ms\n");
+    for (uint32_t d = 1; d <= dias; d++) {
+        double inicio = agora_s();
+        uint32_t novas = epidemia_avancar_dia(&e);
+        double ms = (agora_s() - inicio) * 1e3;
+        soma += ms;
+        if (ms > pior) pior = ms;
+        total += novas;
+        if (d % 5 == 0 || d == dias) {
+            printf("%-4u %-9u %-11u %-7.2f %.2f\n", d, novas, total,
+                   100.0 * total / ((double)largura * altura), ms);
+        }
+    }
+    printf("%u dias: %.2f ms/dia em media (pior %.2f ms), %.1f Mcelulas/s\n",
+           dias, soma / dias, pior, (double)largura * altura * dias / (soma / 1e3) / 1e6);
+    free(memoria);
+    return 0;
+}
@@ -0,0 +1,360 @@
+/*
+* Treina uma árvore de decisão (CART, critério de Gini) a partir de amostras
+* rotuladas e a exporta como tabela NoArvore para utils/classificador.
+*
+* Uso: treinar_arvore <amostras.csv> [-n nome] [-p profundidade] [-m min_folha] [-b modelo.bin]
+*                     [-c modelo.txt]
+*
+* CSV: R,G,B,NIR,rotulo (rotulo 1 = infectada). Reflectâncias com ponto
+* decimal são lidas como 0.0-1.0; inteiras, na escala do ADC. Linhas que não
+* começam com número (cabeçalho, comentários) são ignoradas.
+*
+* O código C vai para a saída padrão; com -b também grava o blob binário
+* aceito por classificador_de_blob e, com -c, os comandos "arvore" do
+* console que gravam o mesmo blob na flash do firmware (colar na serial; o
+* modelo passa a valer a cada boot, sem recompilar).
+*/
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils/espectral.h"
+#include "utils/classificador.h"
+
+#define MAX_NOS 1024
+
+typedef struct {
+    int32_t atributo[NUM_ATRIBUTOS];
+    uint8_t rotulo;
+} Amostra;
+
+static const char *const NOMES_ATRIBUTOS[NUM_ATRIBUTOS] = {
+    "ATRIBUTO_R", "ATRIBUTO_G", "ATRIBUTO_B", "ATRIBUTO_NIR",
+    "ATRIBUTO_NDVI", "ATRIBUTO_GNDVI", "ATRIBUTO_NGRDI", "ATRIBUTO_SAVI", "ATRIBUTO_EVI",
+};
+
+static Amostra *amostras;
+static uint32_t num_amostras;
+
+static NoArvore nos[MAX_NOS];
+static uint16_t num_nos;
+static uint8_t profundidade_max = 6;
+static uint32_t min_folha = 5;
+
+/**********************************
+* LEITURA
+**********************************/
+
+static bool ler_csv(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+
+    uint32_t capacidade = 1024;
+    amostras = malloc(capacidade * sizeof(Amostra));
+    char linha[256];
+
+    while (fgets(linha, sizeof(linha), f)) {
+        const char *p = linha;
+        while (*p == ' ' || *p == '\t') p++;
+        if (!isdigit((unsigned char)*p) && *p != '.') continue;
+
+        double v[5];
+        if (sscanf(p, "%lf ,%lf ,%lf ,%lf ,%lf", &v[0], &v[1], &v[2], &v[3], &v[4]) != 5) {
+            fprintf(stderr, "linha ignorada: %s", linha);
+            continue;
+        }
+
+        Reflectancia r;
+        uint16_t *bandas[4] = {&r.R, &r.G, &r.B, &r.NIR};
+        bool decimal = strchr(p, '.') != NULL;
+        for (int b = 0; b < 4; b++) {
+            if (decimal) {
+                *bandas[b] = reflectancia_de_float((float)v[b]);
+            } else {
+                *bandas[b] = v[b] < 0 ? 0 : v[b] > 65535 ? 65535 : (uint16_t)v[b];
+            }
+        }
+
+        if (num_amostras == capacidade) {
+            capacidade *= 2;
+            amostras = realloc(amostras, capacidade * sizeof(Amostra));
+        }
+        Amostra *a = &amostras[num_amostras++];
+
+        // Mesmos valores que o firmware verá: índices do motor espectral em Q15
+        IndicesEspectrais indices = {0};
+        calcular_indices(&r, INDICES_TODOS, &indices);
+        a->atributo[ATRIBUTO_R] = r.R;
+        a->atributo[ATRIBUTO_G] = r.G;
+        a->atributo[ATRIBUTO_B] = r.B;
+        a->atributo[ATRIBUTO_NIR] = r.NIR;
+        memcpy(&a->atributo[ATRIBUTO_PRIMEIRO_INDICE], indices.valor, sizeof(indices.valor));
+        a->rotulo = v[4] != 0;
+    }
+
+    fclose(f);
+    return num_amostras > 0;
+}
+
+/**********************************
+* TREINAMENTO
+**********************************/
+
+static int atributo_ordenacao;
+
+static int comparar_amostras(const void *a, const void *b) {
+    int32_t va = amostras[*(const uint32_t *)a].atributo[atributo_ordenacao];
+    int32_t vb = amostras[*(const uint32_t *)b].atributo[atributo_ordenacao];
+    return (va > vb) - (va < vb);
+}
+
+// Gini ponderado (sem normalizar por n) de uma partição com p positivos em n
+static double gini(uint32_t p, uint32_t n) {
+    if (n == 0) return 0.0;
+    double f = (double)p / n;
+    return n * 2.0 * f * (1.0 - f);
+}
+
+static uint16_t emitir_folha(uint8_t classe) {
+    nos[num_nos] = (NoArvore){0, 0, NO_FOLHA, classe};
+    return num_nos++;
+}
+
+/*
+* Cresce a subárvore em pré-ordem sobre idx[0..n)
+* @param restante Número de nós ainda permitidos em um caminho (inclui a folha)
+* @return Índice do nó criado
+*/
+static uint16_t crescer(uint32_t *idx, uint32_t n, uint8_t restante) {
+    uint32_t positivos = 0;
+    for (uint32_t i = 0; i < n; i++) positivos += amostras[idx[i]].rotulo;
+    uint8_t maioria = positivos * 2 > n;
+
+    if (restante <= 1 || positivos == 0 || positivos == n ||
+        n < 2 * min_folha || num_nos + 3 > MAX_NOS) {
+        return emitir_folha(maioria);
+    }
+
+    // Melhor corte: valor < limiar vai para a esquerda
+    double melhor = gini(positivos, n);
+    int melhor_atributo = -1;
+    int32_t melhor_limiar = 0;
+
+    for (int a = 0; a < NUM_ATRIBUTOS; a++) {
+        atributo_ordenacao = a;
+        qsort(idx, n, sizeof(uint32_t), comparar_amostras);
+
+        uint32_t p_esq = 0;
+        for (uint32_t i = 1; i < n; i++) {
+            p_esq += amostras[idx[i - 1]].rotulo;
+            int32_t anterior = amostras[idx[i - 1]].atributo[a];
+            int32_t atual = amostras[idx[i]].atributo[a];
+            if (anterior == atual || i < min_folha || n - i < min_folha) continue;
+
+            double g = gini(p_esq, i) + gini(positivos - p_esq, n - i);
+            if (g < melhor - 1e-9) {
+                melhor = g;
+                melhor_atributo = a;
+                // Ponto médio entre os valores vizinhos generaliza melhor que o próprio valor
+                melhor_limiar = anterior + (atual - anterior + 1) / 2;
+            }
+        }
+    }
+
+    if (melhor_atributo < 0) {
+        return emitir_folha(maioria);
+    }
+
+    // Particiona idx em esquerda/direita
+    uint32_t n_esq = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (amostras[idx[i]].atributo[melhor_atributo] < melhor_limiar) {
+            uint32_t t = idx[i];
+            idx[i] = idx[n_esq];
+            idx[n_esq++] = t;
+        }
+    }
+
+    uint16_t no = num_nos++;
+    uint16_t esquerda = crescer(idx, n_esq, restante - 1);
+    uint16_t direita = crescer(idx + n_esq, n - n_esq, restante - 1);
+
+    // Corte inútil: duas folhas com a mesma classe viram uma folha só
+    if (nos[esquerda].atributo == NO_FOLHA && nos[direita].atributo == NO_FOLHA &&
+        nos[esquerda].classe == nos[direita].classe) {
+        num_nos = no;
+        return emitir_folha(nos[esquerda].classe);
+    }
+
+    nos[no] = (NoArvore){melhor_limiar, direita, (uint8_t)melhor_atributo, 0};
+    return no;
+}
+
+static uint8_t medir_profundidade(uint16_t i) {
+    if (nos[i].atributo == NO_FOLHA) return 1;
+    uint8_t e = medir_profundidade(i + 1);
+    uint8_t d = medir_profundidade(nos[i].direita);
+    return 1 + (e > d ? e : d);
+}
+
+/**********************************
+* EXPORTAÇÃO
+**********************************/
+
+static void emitir_c(FILE *f, const ModeloClassificador *m, const char *nome, double acuracia) {
+    char maiusculo[64];
+    size_t i;
+    for (i = 0; nome[i] && i < sizeof(maiusculo) - 1; i++) {
+        maiusculo[i] = (char)toupper((unsigned char)nome[i]);
+    }
+    maiusculo[i] = '\0';
+
+    fprintf(f, "// Gerado por tools/treinar_arvore: %u amostras, acuracia de treino %.2f%%\n",
+            num_amostras, acuracia * 100.0);
+    fprintf(f, "static const NoArvore NOS_%s[] = {\n", maiusculo);
+    for (uint16_t n = 0; n < m->num_nos; n++) {
+        const NoArvore *no = &m->nos[n];
+        if (no->atributo == NO_FOLHA) {
+            fprintf(f, "    /* %3u */ {0, 0, NO_FOLHA, %u},\n", n, no->classe);
+        } else {
+            fprintf(f, "    /* %3u */ {%ld, %u, %s, 0},\n", n, (long)no->limiar,
+                    no->direita, NOMES_ATRIBUTOS[no->atributo]);
+        }
+    }
+    fprintf(f, "};\n\n");
+    fprintf(f, "const ModeloClassificador MODELO_%s = {\n", maiusculo);
+    fprintf(f, "    .nome = \"%s\",\n", nome);
+    fprintf(f, "    .tipo = MODELO_ARVORE,\n");
+    fprintf(f, "    .indices_usados = 0x%02X,\n", m->indices_usados);
+    fprintf(f, "    .profundidade = %u,\n", m->profundidade);
+    fprintf(f, "    .num_nos = sizeof(NOS_%s) / sizeof(NOS_%s[0]),\n", maiusculo, maiusculo);
+    fprintf(f, "    .nos = NOS_%s,\n", maiusculo);
+    fprintf(f, "};\n");
+}
+
+#define BYTES_POR_COMANDO 32   // Bytes por comando "arvore" (64 dígitos hex cabem na linha do console)
+
+// Blob no formato de classificador_de_blob, em memória
+static size_t montar_blob(const ModeloClassificador *m, uint8_t **saida) {
+    CabecalhoBlobArvore cabecalho = {
+        .magico = BLOB_ARVORE_MAGICO,
+        .num_nos = m->num_nos,
+        .profundidade = m->profundidade,
+        .indices_usados = m->indices_usados,
+    };
+    size_t tamanho = sizeof(cabecalho) + (size_t)m->num_nos * sizeof(NoArvore);
+    uint8_t *blob = malloc(tamanho);
+    memcpy(blob, &cabecalho, sizeof(cabecalho));
+    memcpy(blob + sizeof(cabecalho), m->nos, (size_t)m->num_nos * sizeof(NoArvore));
+    *saida = blob;
+    return tamanho;
+}
+
+static bool emitir_blob(const char *caminho, const uint8_t *blob, size_t tamanho) {
+    FILE *f = fopen(caminho, "wb");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    fwrite(blob, 1, tamanho, f);
+    fclose(f);
+    return true;
+}
+
+// Comandos do console: arvore limpar, o blob em hex e arvore gravar
+static bool emitir_comandos(const char *caminho, const uint8_t *blob, size_t tamanho) {
+    FILE *f = fopen(caminho, "w");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    fprintf(f, "arvore limpar\n");
+    for (size_t i = 0; i < tamanho; i += BYTES_POR_COMANDO) {
+        fprintf(f, "arvore ");
+        for (size_t j = i; j < i + BYTES_POR_COMANDO && j < tamanho; j++) fprintf(f, "%02x", blob[j]);
+        fprintf(f, "\n");
+    }
+    fprintf(f, "arvore gravar\n");
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *entrada = NULL;
+    const char *nome = "arvore";
+    const char *blob = NULL, *comandos = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) nome = argv[++i];
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) profundidade_max = (uint8_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) min_folha = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) blob = argv[++i];
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) comandos = argv[++i];
+        else entrada = argv[i];
+    }
+    if (!entrada) {
+        fprintf(stderr, "uso: %s <amostras.csv> [-n nome] [-p profundidade] [-m min_folha] [-b modelo.bin] [-c modelo.txt]\n",
+                argv[0]);
+        return 1;
+    }
+    if (profundidade_max < 1 || profundidade_max > ARVORE_PROFUNDIDADE_MAX) {
+        fprintf(stderr, "profundidade deve estar entre 1 e %d\n", ARVORE_PROFUNDIDADE_MAX);
+        return 1;
+    }
+    if (min_folha < 1) min_folha = 1;
+
+    if (!ler_csv(entrada)) {
+        fprintf(stderr, "nenhuma amostra em %s\n", entrada);
+        return 1;
+    }
+
+    uint32_t *idx = malloc(num_amostras * sizeof(uint32_t));
+    for (uint32_t i = 0; i < num_amostras; i++) idx[i] = i;
+    crescer(idx, num_amostras, profundidade_max);
+    free(idx);
+
+    ModeloClassificador modelo = {
+        .nome = nome,
+        .tipo = MODELO_ARVORE,
+        .profundidade = medir_profundidade(0),
+        .num_nos = num_nos,
+        .nos = nos,
+    };
+    for (uint16_t i = 0; i < num_nos; i++) {
+        if (nos[i].atributo != NO_FOLHA && nos[i].atributo >= ATRIBUTO_PRIMEIRO_INDICE) {
+            modelo.indices_usados |= INDICE_BIT(nos[i].atributo - ATRIBUTO_PRIMEIRO_INDICE);
+        }
+    }
+    if (!classificador_validar(&modelo)) {
+        fprintf(stderr, "tabela gerada inconsistente\n");
+        return 1;
+    }
+
+    // Acurácia de treino com o mesmo avaliador do firmware
+    uint32_t acertos = 0;
+    for (uint32_t i = 0; i < num_amostras; i++) {
+        const Amostra *a = &amostras[i];
+        Reflectancia r = {(uint16_t)a->atributo[ATRIBUTO_R], (uint16_t)a->atributo[ATRIBUTO_G],
+                          (uint16_t)a->atributo[ATRIBUTO_B], (uint16_t)a->atributo[ATRIBUTO_NIR]};
+        IndicesEspectrais indices = {0};
+        calcular_indices(&r, modelo.indices_usados, &indices);
+        acertos += classificador_avaliar(&modelo, &r, &indices) == a->rotulo;
+    }
+    double acuracia = (double)acertos / num_amostras;
+
+    fprintf(stderr, "%u amostras, %u nos, profundidade %u, acuracia de treino %.2f%%\n",
+            num_amostras, modelo.num_nos, modelo.profundidade, acuracia * 100.0);
+
+    emitir_c(stdout, &modelo, nome, acuracia);
+    uint8_t *dados;
+    size_t tamanho = montar_blob(&modelo, &dados);
+    if ((blob && !emitir_blob(blob, dados, tamanho)) || (comandos && !emitir_comandos(comandos, dados, tamanho))) {
+        return 1;
+    }
+    free(dados);
+    free(amostras);
+    return 0;
+}
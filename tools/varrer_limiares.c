@@ -0,0 +1,844 @@
+/*
+* Varredura dos limiares de detecção (LimiaresDeteccao) sobre amostras
+* rotuladas: curvas ROC e precisão-revocação, melhor ponto de operação e
+* cabeçalho C com os limiares escolhidos.
+*
+* Uso: varrer_limiares <amostras.csv|amostras.bin> [-t threads] [-k f1|youden] [-m fpr_max]
+*                      [-N ini:fim:passo] [-G ini:fim:passo] [-R ini:fim:passo] [-V ini:fim:passo]
+*                      [-c curva.csv] [-H limiares.h] [-n nome] [-b amostras.bin]
+*
+* Amostras em CSV (R,G,B,NIR,rotulo, o formato de treinar_arvore e de
+* gerar_campo -o) ou no binário gravado com -b, que é mapeado em memória e
+* usado direto como estrutura de arrays, sem cópia:
+*   AMOSTRAS_MAGICO (u32), n (u32), R[n], G[n], B[n], NIR[n] (u16),
+*   rótulos em (n + 31) / 32 palavras u32 (bit i = amostra i infectada),
+*   tudo em little-endian.
+*
+* Grade: -N/-G em valores de NDVI/GNDVI (acima de 0, até 1), -R/-V em fração do
+* fundo de escala, convertidos como LIMIAR_R_VISIVEL (piso) e
+* LIMIAR_G_VISIVEL (teto). O padrão cobre os limiares de LIMIARES_PADRAO.
+*
+* Cada amostra passa uma única vez pelo cálculo dos índices do firmware e cai
+* em uma célula de um histograma 4D: em cada eixo, o primeiro passo da grade
+* a partir do qual o critério daquele eixo vale. Com as somas prefixadas do
+* histograma, os positivos de cada combinação de limiares saem de três
+* consultas, (NDVI e GNDVI) + (R e G) - (os quatro), sem passar de novo
+* pelas amostras. O histograma é montado em paralelo (um por thread,
+* somados no fim) e as combinações são avaliadas em paralelo.
+*
+* A curva (-c) é o envelope das combinações: para cada taxa de falsos
+* positivos, a maior revocação. O mesmo conjunto de pontos serve às duas
+* curvas, já que a precisão cresce com os verdadeiros e cai com os falsos
+* positivos. O melhor ponto maximiza F1 (-k f1), o índice de Youden
+* (-k youden) ou, com -m, a revocação com FPR até o máximo dado.
+*
+* Conferência: o ponto escolhido, LIMIARES_PADRAO (se estiver na grade) e
+* combinações sorteadas são reavaliados com detectar_doenca_lote sobre todas
+* as amostras, e as contagens têm de bater com as da varredura.
+*/
+#include <ctype.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "utils/aleatorio.h"
+#include "utils/deteccao.h"
+
+#define MAX_THREADS 256
+#define MAX_PASSOS 255                 // Limiares por eixo (faixas cabem em um byte)
+#define AMOSTRAS_MAGICO 0x31534D41u    // "AMS1" em little-endian
+#define CONFERENCIAS_SORTEADAS 4
+#define MAX_CELULAS (1u << 26)         // 512 MB de histograma por thread
+
+/**********************************
+* DADOS
+**********************************/
+
+typedef struct {
+    uint32_t n;
+    const uint16_t *R, *G, *B, *NIR;
+    const uint32_t *rotulos;           // Bit i = amostra i infectada
+} Amostras;
+
+typedef enum {
+    EIXO_NDVI,
+    EIXO_GNDVI,
+    EIXO_R,
+    EIXO_G,
+    NUM_EIXOS
+} IdEixo;
+
+// Limiares de um critério na ordem da varredura: o critério vale para o
+// passo k se e só se a faixa da amostra for <= k (faixa n = nunca vale)
+typedef struct {
+    const char *nome;
+    double inicio, fim, passo;
+    bool maior;                        // Critério valor > limiar (senão valor < limiar)
+    bool indice;                       // Limiares em Q15 (senão na escala do ADC)
+    uint32_t n;
+    int32_t limiar[MAX_PASSOS];
+    uint8_t *faixa;                    // Valor -> faixa (índices deslocados de Q15_UM)
+} Eixo;
+
+typedef struct {
+    uint32_t vp, fp;                   // Verdadeiros e falsos positivos
+    uint32_t combinacao;
+} Ponto;
+
+static Amostras amostras;
+static uint32_t positivos, negativos;
+static uint32_t num_threads;
+static bool mapeadas;                  // Amostras direto do binário mapeado
+
+static Eixo eixos[NUM_EIXOS] = {
+    [EIXO_NDVI]  = {"NDVI",  0.10, 0.70, 0.02, false, true},
+    [EIXO_GNDVI] = {"GNDVI", 0.10, 0.70, 0.02, false, true},
+    [EIXO_R]     = {"R",     0.40, 0.90, 0.02, true,  false},
+    [EIXO_G]     = {"G",     0.30, 0.80, 0.02, false, false},
+};
+
+static uint32_t *histograma[MAX_THREADS];   // Por célula: [saudáveis, infectadas]
+static uint32_t num_celulas;
+static uint32_t *vp_combinacao, *fp_combinacao;
+static uint32_t num_combinacoes;
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline bool rotulo(uint32_t i) {
+    return (amostras.rotulos[i / 32] >> (i % 32)) & 1;
+}
+
+static inline uint16_t saturar(uint16_t valor) {
+    return valor < LOTE_REFLECTANCIA_MAX ? valor : LOTE_REFLECTANCIA_MAX;
+}
+
+/**********************************
+* THREADS
+**********************************/
+
+typedef void (*Tarefa)(uint32_t parte, void *contexto);
+
+typedef struct {
+    Tarefa tarefa;
+    void *contexto;
+    uint32_t parte;
+} Parte;
+
+static void *executar_parte(void *arg) {
+    Parte *p = arg;
+    p->tarefa(p->parte, p->contexto);
+    return NULL;
+}
+
+// Roda a tarefa com partes 0..num_threads-1, a parte 0 na thread atual
+static void em_paralelo(Tarefa tarefa, void *contexto) {
+    pthread_t threads[MAX_THREADS];
+    Parte partes[MAX_THREADS];
+    for (uint32_t t = 1; t < num_threads; t++) {
+        partes[t] = (Parte){tarefa, contexto, t};
+        pthread_create(&threads[t], NULL, executar_parte, &partes[t]);
+    }
+    tarefa(0, contexto);
+    for (uint32_t t = 1; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+// Faixa de amostras da parte, em blocos de 32 (uma palavra de máscara)
+static void faixa_da_parte(uint32_t parte, uint32_t *inicio, uint32_t *fim) {
+    uint32_t palavras = (amostras.n + 31) / 32;
+    *inicio = (uint32_t)((uint64_t)palavras * parte / num_threads) * 32;
+    *fim = (uint32_t)((uint64_t)palavras * (parte + 1) / num_threads) * 32;
+    if (*fim > amostras.n) *fim = amostras.n;
+}
+
+/**********************************
+* LEITURA
+**********************************/
+
+typedef struct {
+    const char *texto;
+    size_t tamanho;
+    size_t limite[MAX_THREADS + 1];    // Partes começam no início de uma linha
+    uint32_t capacidade[MAX_THREADS];
+    uint32_t deslocamento[MAX_THREADS];
+    uint32_t lidas[MAX_THREADS];
+    uint32_t ignoradas[MAX_THREADS];
+    uint16_t *bandas[4];
+    uint8_t *rotulo;
+} LeituraCsv;
+
+/*
+* Lê um número com parte decimal opcional e avança *p
+* @param decimal Recebe true se o número tem ponto decimal
+*/
+static bool ler_numero(const char **p, const char *fim, double *valor, bool *decimal) {
+    const char *s = *p;
+    while (s < fim && (*s == ' ' || *s == '\t')) s++;
+    bool negativo = s < fim && *s == '-';
+    if (negativo) s++;
+    if (s >= fim || (!isdigit((unsigned char)*s) && *s != '.')) return false;
+
+    double v = 0;
+    while (s < fim && isdigit((unsigned char)*s)) v = v * 10 + (*s++ - '0');
+    if (s < fim && *s == '.') {
+        *decimal = true;
+        s++;
+        double fracao = 0, escala = 1;
+        while (s < fim && isdigit((unsigned char)*s)) {
+            fracao = fracao * 10 + (*s++ - '0');
+            escala *= 10;
+        }
+        v += fracao / escala;
+    }
+    while (s < fim && (*s == ' ' || *s == '\t')) s++;
+    *valor = negativo ? -v : v;
+    *p = s;
+    return true;
+}
+
+// Linhas da parte (cota superior da saída)
+static void contar_linhas(uint32_t parte, void *contexto) {
+    LeituraCsv *l = contexto;
+    const char *p = l->texto + l->limite[parte], *fim = l->texto + l->limite[parte + 1];
+    uint32_t linhas = 0;
+    while (p < fim && (p = memchr(p, '\n', fim - p)) != NULL) {
+        linhas++;
+        p++;
+    }
+    l->capacidade[parte] = linhas + 1;
+}
+
+/*
+* Converte as linhas da parte, como treinar_arvore: linhas que não começam
+* com número são ignoradas; reflectâncias com ponto decimal são lidas como
+* 0.0-1.0, inteiras na escala do ADC
+*/
+static void converter_linhas(uint32_t parte, void *contexto) {
+    LeituraCsv *l = contexto;
+    const char *p = l->texto + l->limite[parte], *fim = l->texto + l->limite[parte + 1];
+    uint32_t saida = l->deslocamento[parte];
+
+    while (p < fim) {
+        const char *fim_linha = memchr(p, '\n', fim - p);
+        if (!fim_linha) fim_linha = fim;
+        const char *s = p;
+        p = fim_linha + 1;
+
+        while (s < fim_linha && (*s == ' ' || *s == '\t')) s++;
+        if (s == fim_linha || *s == '\r') continue;
+        if (!isdigit((unsigned char)*s) && *s != '.') continue;
+
+        double v[5];
+        bool decimal = false, valida = true;
+        for (int c = 0; c < 5 && valida; c++) {
+            valida = ler_numero(&s, fim_linha, &v[c], &decimal);
+            if (valida && c < 4) valida = s < fim_linha && *s++ == ',';
+        }
+        if (!valida || (s < fim_linha && *s != '\r')) {
+            l->ignoradas[parte]++;
+            continue;
+        }
+
+        for (int b = 0; b < 4; b++) {
+            if (decimal) {
+                l->bandas[b][saida] = reflectancia_de_float((float)v[b]);
+            } else {
+                l->bandas[b][saida] = v[b] < 0 ? 0 : v[b] > 65535 ? 65535 : (uint16_t)v[b];
+            }
+        }
+        l->rotulo[saida] = v[4] != 0;
+        saida++;
+    }
+    l->lidas[parte] = saida - l->deslocamento[parte];
+}
+
+/*
+* Lê o CSV mapeado em paralelo: cada thread converte as linhas de um trecho
+* para a sua região da saída; depois as regiões são juntadas
+*/
+static bool ler_csv(const char *texto, size_t tamanho) {
+    static LeituraCsv l;
+    l.texto = texto;
+    l.tamanho = tamanho;
+    l.limite[0] = 0;
+    for (uint32_t t = 1; t < num_threads; t++) {
+        size_t pos = tamanho * t / num_threads;
+        const char *nl = pos > 0 ? memchr(texto + pos - 1, '\n', tamanho - pos + 1) : texto - 1;
+        pos = nl ? (size_t)(nl - texto) + 1 : tamanho;
+        l.limite[t] = pos > l.limite[t - 1] ? pos : l.limite[t - 1];
+    }
+    l.limite[num_threads] = tamanho;
+
+    em_paralelo(contar_linhas, &l);
+    uint64_t total = 0;
+    for (uint32_t t = 0; t < num_threads; t++) {
+        l.deslocamento[t] = (uint32_t)total;
+        total += l.capacidade[t];
+    }
+    if (total > UINT32_MAX - 32) {
+        fprintf(stderr, "amostras demais\n");
+        return false;
+    }
+    for (int b = 0; b < 4; b++) {
+        l.bandas[b] = malloc(total * sizeof(uint16_t));
+    }
+    l.rotulo = malloc(total);
+    if (!l.bandas[0] || !l.bandas[1] || !l.bandas[2] || !l.bandas[3] || !l.rotulo) {
+        fprintf(stderr, "memoria insuficiente\n");
+        return false;
+    }
+
+    em_paralelo(converter_linhas, &l);
+    uint32_t n = 0, ignoradas = 0;
+    for (uint32_t t = 0; t < num_threads; t++) {
+        for (int b = 0; b < 4; b++) {
+            memmove(&l.bandas[b][n], &l.bandas[b][l.deslocamento[t]], l.lidas[t] * sizeof(uint16_t));
+        }
+        memmove(&l.rotulo[n], &l.rotulo[l.deslocamento[t]], l.lidas[t]);
+        n += l.lidas[t];
+        ignoradas += l.ignoradas[t];
+    }
+    if (ignoradas) fprintf(stderr, "%u linhas ignoradas\n", ignoradas);
+
+    uint32_t *rotulos = calloc((n + 31) / 32 + 1, sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        rotulos[i / 32] |= (uint32_t)l.rotulo[i] << (i % 32);
+    }
+    free(l.rotulo);
+
+    amostras = (Amostras){n, l.bandas[0], l.bandas[1], l.bandas[2], l.bandas[3], rotulos};
+    return n > 0;
+}
+
+static bool ler_amostras(const char *caminho) {
+    int fd = open(caminho, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(caminho);
+        return false;
+    }
+    size_t tamanho = (size_t)st.st_size;
+    if (tamanho == 0) {
+        fprintf(stderr, "%s: arquivo vazio\n", caminho);
+        return false;
+    }
+    const uint8_t *mapa = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        perror(caminho);
+        return false;
+    }
+
+    uint32_t cabecalho[2];
+    if (tamanho >= sizeof(cabecalho)) memcpy(cabecalho, mapa, sizeof(cabecalho));
+    if (tamanho < sizeof(cabecalho) || cabecalho[0] != AMOSTRAS_MAGICO) {
+        madvise((void *)mapa, tamanho, MADV_SEQUENTIAL);
+        return ler_csv((const char *)mapa, tamanho);
+    }
+
+    uint32_t n = cabecalho[1];
+    size_t esperado = sizeof(cabecalho) + 4 * (size_t)n * sizeof(uint16_t) + (n + 31) / 32 * sizeof(uint32_t);
+    if (tamanho != esperado || n == 0) {
+        fprintf(stderr, "%s: binario truncado ou invalido\n", caminho);
+        return false;
+    }
+    const uint16_t *bandas = (const uint16_t *)(mapa + sizeof(cabecalho));
+    mapeadas = true;
+    amostras = (Amostras){n, bandas, bandas + n, bandas + 2 * (size_t)n, bandas + 3 * (size_t)n,
+                          (const uint32_t *)(bandas + 4 * (size_t)n)};
+    return true;
+}
+
+static bool gravar_binario(const char *caminho) {
+    FILE *f = fopen(caminho, "wb");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    uint32_t cabecalho[2] = {AMOSTRAS_MAGICO, amostras.n};
+    const uint16_t *bandas[4] = {amostras.R, amostras.G, amostras.B, amostras.NIR};
+    bool ok = fwrite(cabecalho, sizeof(cabecalho), 1, f) == 1;
+    for (int b = 0; b < 4 && ok; b++) {
+        ok = fwrite(bandas[b], sizeof(uint16_t), amostras.n, f) == amostras.n;
+    }
+    uint32_t palavras = (amostras.n + 31) / 32;
+    ok = ok && fwrite(amostras.rotulos, sizeof(uint32_t), palavras, f) == palavras;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) perror(caminho);
+    return ok;
+}
+
+/**********************************
+* GRADE
+**********************************/
+
+static bool ler_eixo(Eixo *e, const char *texto) {
+    return sscanf(texto, "%lf:%lf:%lf", &e->inicio, &e->fim, &e->passo) == 3;
+}
+
+static inline bool criterio(const Eixo *e, int32_t valor, uint32_t k) {
+    return e->maior ? valor > e->limiar[k] : valor < e->limiar[k];
+}
+
+/*
+* Limiares do eixo e tabela valor -> faixa. Critérios "maior que" são
+* varridos do maior para o menor limiar, para que em todos os eixos o
+* critério valha a partir da faixa da amostra.
+*/
+static bool montar_eixo(Eixo *e) {
+    if (e->passo <= 0 || e->fim < e->inicio) return false;
+    e->n = (uint32_t)floor((e->fim - e->inicio) / e->passo + 1e-9) + 1;
+    if (e->n > MAX_PASSOS) return false;
+
+    for (uint32_t k = 0; k < e->n; k++) {
+        double x = e->inicio + (e->maior ? e->n - 1 - k : k) * e->passo;
+        if (e->indice) {
+            e->limiar[k] = Q15(x);
+            if (e->limiar[k] <= 0 || e->limiar[k] > Q15_UM) return false;  // Exigido pelo processamento em lote
+        } else if (e->maior) {
+            e->limiar[k] = (int32_t)floor(x * REFLECTANCIA_MAX + 1e-9);
+        } else {
+            e->limiar[k] = (int32_t)ceil(x * REFLECTANCIA_MAX - 1e-9);
+        }
+    }
+
+    int32_t minimo = e->indice ? -Q15_UM : 0;
+    int32_t maximo = e->indice ? Q15_UM : LOTE_REFLECTANCIA_MAX;
+    e->faixa = malloc((size_t)(maximo - minimo + 1));
+    uint32_t k = 0;
+    if (e->maior) {
+        // Faixa cresce com o valor decrescente: percorre de cima para baixo
+        for (int32_t v = maximo; v >= minimo; v--) {
+            while (k < e->n && !criterio(e, v, k)) k++;
+            e->faixa[v - minimo] = (uint8_t)k;
+        }
+    } else {
+        for (int32_t v = minimo; v <= maximo; v++) {
+            while (k < e->n && !criterio(e, v, k)) k++;
+            e->faixa[v - minimo] = (uint8_t)k;
+        }
+    }
+    return true;
+}
+
+static LimiaresDeteccao limiares_da_combinacao(uint32_t c) {
+    uint32_t k[NUM_EIXOS];
+    for (int e = NUM_EIXOS - 1; e >= 0; e--) {
+        k[e] = c % eixos[e].n;
+        c /= eixos[e].n;
+    }
+    return (LimiaresDeteccao){
+        .ndvi = eixos[EIXO_NDVI].limiar[k[EIXO_NDVI]],
+        .gndvi = eixos[EIXO_GNDVI].limiar[k[EIXO_GNDVI]],
+        .r_visivel = (uint16_t)eixos[EIXO_R].limiar[k[EIXO_R]],
+        .g_visivel = (uint16_t)eixos[EIXO_G].limiar[k[EIXO_G]],
+    };
+}
+
+// Combinação com exatamente esses limiares, ou UINT32_MAX se fora da grade
+static uint32_t combinacao_dos_limiares(const LimiaresDeteccao *l) {
+    const int32_t valores[NUM_EIXOS] = {l->ndvi, l->gndvi, l->r_visivel, l->g_visivel};
+    uint32_t c = 0;
+    for (int e = 0; e < NUM_EIXOS; e++) {
+        uint32_t k = 0;
+        while (k < eixos[e].n && eixos[e].limiar[k] != valores[e]) k++;
+        if (k == eixos[e].n) return UINT32_MAX;
+        c = c * eixos[e].n + k;
+    }
+    return c;
+}
+
+/**********************************
+* VARREDURA
+**********************************/
+
+static inline uint32_t celula(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    return ((a * (eixos[EIXO_GNDVI].n + 1) + b) * (eixos[EIXO_R].n + 1) + c) * (eixos[EIXO_G].n + 1) + d;
+}
+
+// Índices do firmware de cada amostra da parte -> célula do histograma
+static void montar_histograma(uint32_t parte, void *contexto) {
+    uint32_t inicio, fim;
+    faixa_da_parte(parte, &inicio, &fim);
+    uint32_t *h = histograma[parte];
+    const uint8_t *f_ndvi = eixos[EIXO_NDVI].faixa + Q15_UM;
+    const uint8_t *f_gndvi = eixos[EIXO_GNDVI].faixa + Q15_UM;
+    const uint8_t *f_r = eixos[EIXO_R].faixa, *f_g = eixos[EIXO_G].faixa;
+
+    for (uint32_t i = inicio; i < fim; i++) {
+        // Saturação do lote, para que as faixas batam com detectar_doenca_lote
+        uint16_t r = saturar(amostras.R[i]), g = saturar(amostras.G[i]), nir = saturar(amostras.NIR[i]);
+        q15_t ndvi = indice_normalizado(nir, r);
+        q15_t gndvi = indice_normalizado(nir, g);
+        h[2 * celula(f_ndvi[ndvi], f_gndvi[gndvi], f_r[r], f_g[g]) + rotulo(i)]++;
+    }
+}
+
+// Histograma -> contagem das amostras com faixas <= (a, b, c, d), eixo a eixo
+static void somar_prefixos(uint32_t *h) {
+    uint32_t dim[NUM_EIXOS], passo[NUM_EIXOS];
+    for (int e = 0; e < NUM_EIXOS; e++) dim[e] = eixos[e].n + 1;
+    passo[NUM_EIXOS - 1] = 1;
+    for (int e = NUM_EIXOS - 2; e >= 0; e--) passo[e] = passo[e + 1] * dim[e + 1];
+
+    for (int e = 0; e < NUM_EIXOS; e++) {
+        for (uint32_t i = 0; i < num_celulas; i++) {
+            if ((i / passo[e]) % dim[e] == 0) continue;
+            h[2 * i] += h[2 * (i - passo[e])];
+            h[2 * i + 1] += h[2 * (i - passo[e]) + 1];
+        }
+    }
+}
+
+/*
+* Positivos de cada combinação: (NDVI e GNDVI) + (R e G) - (os quatro),
+* com n (faixa "nunca") nos eixos que não participam
+*/
+static void avaliar_combinacoes(uint32_t parte, void *contexto) {
+    const uint32_t *s = histograma[0];
+    uint32_t nn = eixos[EIXO_NDVI].n, ng = eixos[EIXO_GNDVI].n;
+    uint32_t nr = eixos[EIXO_R].n, nv = eixos[EIXO_G].n;
+
+    for (uint32_t a = parte; a < nn; a += num_threads) {
+        for (uint32_t b = 0; b < ng; b++) {
+            uint32_t indices = celula(a, b, nr, nv);
+            for (uint32_t c = 0; c < nr; c++) {
+                for (uint32_t d = 0; d < nv; d++) {
+                    uint32_t visivel = celula(nn, ng, c, d), ambos = celula(a, b, c, d);
+                    uint32_t comb = ((a * ng + b) * nr + c) * nv + d;
+                    fp_combinacao[comb] = s[2 * indices] + s[2 * visivel] - s[2 * ambos];
+                    vp_combinacao[comb] = s[2 * indices + 1] + s[2 * visivel + 1] - s[2 * ambos + 1];
+                }
+            }
+        }
+    }
+}
+
+/**********************************
+* CONFERÊNCIA
+**********************************/
+
+typedef struct {
+    LimiaresDeteccao limiares;
+    uint32_t *mascara;
+    uint64_t vp[MAX_THREADS], fp[MAX_THREADS];
+} Conferencia;
+
+static void conferir_parte(uint32_t parte, void *contexto) {
+    Conferencia *c = contexto;
+    uint32_t inicio, fim;
+    faixa_da_parte(parte, &inicio, &fim);
+    c->vp[parte] = c->fp[parte] = 0;
+    if (inicio >= fim) return;
+
+    detectar_doenca_lote(amostras.R + inicio, amostras.G + inicio, amostras.B + inicio,
+                         amostras.NIR + inicio, fim - inicio, &c->limiares, c->mascara + inicio / 32);
+    for (uint32_t w = inicio / 32; w < (fim + 31) / 32; w++) {
+        uint32_t validos = fim - w * 32 >= 32 ? UINT32_MAX : (1u << (fim - w * 32)) - 1;
+        uint32_t detectadas = c->mascara[w] & validos;
+        c->vp[parte] += __builtin_popcount(detectadas & amostras.rotulos[w]);
+        c->fp[parte] += __builtin_popcount(detectadas & ~amostras.rotulos[w]);
+    }
+}
+
+// Contagens de detectar_doenca_lote com os limiares, sobre todas as amostras
+static void contar_lote(const LimiaresDeteccao *limiares, uint32_t *mascara, uint32_t *vp, uint32_t *fp) {
+    static Conferencia c;
+    c.limiares = *limiares;
+    c.mascara = mascara;
+    em_paralelo(conferir_parte, &c);
+    *vp = *fp = 0;
+    for (uint32_t t = 0; t < num_threads; t++) {
+        *vp += (uint32_t)c.vp[t];
+        *fp += (uint32_t)c.fp[t];
+    }
+}
+
+/**********************************
+* RELATÓRIO
+**********************************/
+
+static double taxa(uint32_t a, uint32_t b) {
+    return b ? (double)a / b : 0;
+}
+
+static double f1(uint32_t vp, uint32_t fp) {
+    double denominador = 2.0 * vp + fp + (positivos - vp);
+    return denominador > 0 ? 2.0 * vp / denominador : 0;
+}
+
+static void imprimir_limiares(const char *rotulo_linha, const LimiaresDeteccao *l, uint32_t vp, uint32_t fp) {
+    printf("%-10s NDVI %.4f  GNDVI %.4f  R %5.1f%% (%4u)  G %5.1f%% (%4u) | TPR %.4f  FPR %.4f  precisao %.4f  F1 %.4f\n",
+           rotulo_linha, Q15_PARA_FLOAT(l->ndvi), Q15_PARA_FLOAT(l->gndvi),
+           100.0 * l->r_visivel / REFLECTANCIA_MAX, l->r_visivel,
+           100.0 * l->g_visivel / REFLECTANCIA_MAX, l->g_visivel,
+           taxa(vp, positivos), taxa(fp, negativos), taxa(vp, vp + fp), f1(vp, fp));
+}
+
+static int comparar_pontos(const void *a, const void *b) {
+    const Ponto *pa = a, *pb = b;
+    if (pa->fp != pb->fp) return pa->fp < pb->fp ? -1 : 1;
+    if (pa->vp != pb->vp) return pa->vp > pb->vp ? -1 : 1;
+    return pa->combinacao < pb->combinacao ? -1 : 1;
+}
+
+/*
+* Envelope das combinações: ordenadas por falsos positivos, ficam as que
+* aumentam os verdadeiros positivos
+* @return Pontos do envelope, no início de pontos
+*/
+static uint32_t envelope(Ponto *pontos) {
+    for (uint32_t c = 0; c < num_combinacoes; c++) {
+        pontos[c] = (Ponto){vp_combinacao[c], fp_combinacao[c], c};
+    }
+    qsort(pontos, num_combinacoes, sizeof(Ponto), comparar_pontos);
+
+    uint32_t n = 0;
+    for (uint32_t c = 0; c < num_combinacoes; c++) {
+        if (n == 0 ? pontos[c].vp > 0 : pontos[c].vp > pontos[n - 1].vp) {
+            pontos[n++] = pontos[c];
+        }
+    }
+    return n;
+}
+
+static bool gravar_curva(const char *caminho, const Ponto *pontos, uint32_t n) {
+    FILE *f = fopen(caminho, "w");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    fprintf(f, "fpr,tpr,precisao,f1,ndvi,gndvi,r_visivel,g_visivel\n");
+    for (uint32_t i = 0; i < n; i++) {
+        LimiaresDeteccao l = limiares_da_combinacao(pontos[i].combinacao);
+        fprintf(f, "%.6f,%.6f,%.6f,%.6f,%.4f,%.4f,%u,%u\n",
+                taxa(pontos[i].fp, negativos), taxa(pontos[i].vp, positivos),
+                taxa(pontos[i].vp, pontos[i].vp + pontos[i].fp), f1(pontos[i].vp, pontos[i].fp),
+                Q15_PARA_FLOAT(l.ndvi), Q15_PARA_FLOAT(l.gndvi), l.r_visivel, l.g_visivel);
+    }
+    return fclose(f) == 0;
+}
+
+static bool gravar_cabecalho(const char *caminho, const char *nome, const char *criterio_nome,
+                             const char *origem, const LimiaresDeteccao *l, uint32_t vp, uint32_t fp) {
+    FILE *f = fopen(caminho, "w");
+    if (!f) {
+        perror(caminho);
+        return false;
+    }
+    char maiusculo[64];
+    size_t i = 0;
+    for (; nome[i] && i < sizeof(maiusculo) - 1; i++) maiusculo[i] = (char)toupper((unsigned char)nome[i]);
+    maiusculo[i] = '\0';
+
+    fprintf(f, "// Gerado por tools/varrer_limiares: %u amostras (%u infectadas) de %s\n",
+            amostras.n, positivos, origem);
+    fprintf(f, "// Criterio %s: TPR %.4f, FPR %.4f, precisao %.4f, F1 %.4f\n", criterio_nome,
+            taxa(vp, positivos), taxa(fp, negativos), taxa(vp, vp + fp), f1(vp, fp));
+    fprintf(f, "#ifndef LIMIARES_%s_H\n#define LIMIARES_%s_H\n\n", maiusculo, maiusculo);
+    fprintf(f, "#include \"utils/deteccao.h\"\n\n");
+    fprintf(f, "#define LIMIAR_%s_NDVI      %-6ld // %.4f\n", maiusculo, (long)l->ndvi, Q15_PARA_FLOAT(l->ndvi));
+    fprintf(f, "#define LIMIAR_%s_GNDVI     %-6ld // %.4f\n", maiusculo, (long)l->gndvi, Q15_PARA_FLOAT(l->gndvi));
+    fprintf(f, "#define LIMIAR_%s_R_VISIVEL %-6u // R > %.1f%%\n", maiusculo, l->r_visivel,
+            100.0 * l->r_visivel / REFLECTANCIA_MAX);
+    fprintf(f, "#define LIMIAR_%s_G_VISIVEL %-6u // G < %.1f%%\n\n", maiusculo, l->g_visivel,
+            100.0 * l->g_visivel / REFLECTANCIA_MAX);
+    fprintf(f, "// Inicializador de LimiaresDeteccao (ex.: .limiares de um modelo MODELO_LIMIARES)\n");
+    fprintf(f, "#define LIMIARES_%s { \\\n", maiusculo);
+    fprintf(f, "    .ndvi = LIMIAR_%s_NDVI, \\\n", maiusculo);
+    fprintf(f, "    .gndvi = LIMIAR_%s_GNDVI, \\\n", maiusculo);
+    fprintf(f, "    .r_visivel = LIMIAR_%s_R_VISIVEL, \\\n", maiusculo);
+    fprintf(f, "    .g_visivel = LIMIAR_%s_G_VISIVEL, \\\n", maiusculo);
+    fprintf(f, "}\n\n#endif // LIMIARES_%s_H\n", maiusculo);
+    return fclose(f) == 0;
+}
+
+/**********************************
+* PRINCIPAL
+**********************************/
+
+int main(int argc, char **argv) {
+    const char *criterio_nome = "f1", *saida_curva = NULL, *saida_cabecalho = NULL;
+    const char *saida_binario = NULL, *nome = "varredura";
+    double fpr_max = -1;
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = nucleos > 0 ? (uint32_t)nucleos : 1;
+    bool grade_ok = true;
+
+    int opcao;
+    while ((opcao = getopt(argc, argv, "t:k:m:N:G:R:V:c:H:n:b:")) != -1) {
+        switch (opcao) {
+            case 't': num_threads = (uint32_t)atoi(optarg); break;
+            case 'k': criterio_nome = optarg; break;
+            case 'm': fpr_max = atof(optarg); break;
+            case 'N': grade_ok &= ler_eixo(&eixos[EIXO_NDVI], optarg); break;
+            case 'G': grade_ok &= ler_eixo(&eixos[EIXO_GNDVI], optarg); break;
+            case 'R': grade_ok &= ler_eixo(&eixos[EIXO_R], optarg); break;
+            case 'V': grade_ok &= ler_eixo(&eixos[EIXO_G], optarg); break;
+            case 'c': saida_curva = optarg; break;
+            case 'H': saida_cabecalho = optarg; break;
+            case 'n': nome = optarg; break;
+            case 'b': saida_binario = optarg; break;
+            default: optind = argc + 1; break;
+        }
+    }
+    bool youden = strcmp(criterio_nome, "youden") == 0;
+    if (optind != argc - 1 || (!youden && strcmp(criterio_nome, "f1") != 0)) {
+        fprintf(stderr, "Uso: %s <amostras.csv|amostras.bin> [-t threads] [-k f1|youden] [-m fpr_max]\n"
+                        "       [-N ini:fim:passo] [-G ini:fim:passo] [-R ini:fim:passo] [-V ini:fim:passo]\n"
+                        "       [-c curva.csv] [-H limiares.h] [-n nome] [-b amostras.bin]\n", argv[0]);
+        return 2;
+    }
+    if (fpr_max >= 0) criterio_nome = "fpr_max";
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > MAX_THREADS) num_threads = MAX_THREADS;
+    for (int e = 0; e < NUM_EIXOS && grade_ok; e++) grade_ok = montar_eixo(&eixos[e]);
+    if (!grade_ok) {
+        fprintf(stderr, "grade invalida (ate %d passos por eixo, NDVI/GNDVI em (0, 1])\n", MAX_PASSOS);
+        return 2;
+    }
+
+    // Leitura
+    const char *origem = argv[optind];
+    double t0 = agora_s();
+    if (!ler_amostras(origem)) return 1;
+    double t_leitura = agora_s() - t0;
+    for (uint32_t w = 0; w < (amostras.n + 31) / 32; w++) {
+        uint32_t validos = amostras.n - w * 32 >= 32 ? UINT32_MAX : (1u << (amostras.n - w * 32)) - 1;
+        positivos += __builtin_popcount(amostras.rotulos[w] & validos);
+    }
+    negativos = amostras.n - positivos;
+    if (mapeadas) {
+        printf("%u amostras (%u infectadas) mapeadas de %s\n", amostras.n, positivos, origem);
+    } else {
+        printf("%u amostras (%u infectadas) lidas em %.2f s com %u threads (%.1f M amostras/s)\n",
+               amostras.n, positivos, t_leitura, num_threads, amostras.n / t_leitura / 1e6);
+    }
+    if (saida_binario && gravar_binario(saida_binario)) printf("Binario gravado em %s\n", saida_binario);
+    if (positivos == 0 || negativos == 0) {
+        fprintf(stderr, "as amostras precisam ter os dois rotulos\n");
+        return 1;
+    }
+
+    // Histograma
+    uint64_t celulas = 1;
+    for (int e = 0; e < NUM_EIXOS; e++) celulas *= eixos[e].n + 1;
+    if (celulas > MAX_CELULAS) {
+        fprintf(stderr, "grade grande demais (%llu celulas, maximo %u)\n", (unsigned long long)celulas, MAX_CELULAS);
+        return 2;
+    }
+    num_celulas = (uint32_t)celulas;
+    num_combinacoes = 1;
+    for (int e = 0; e < NUM_EIXOS; e++) num_combinacoes *= eixos[e].n;
+    printf("Grade: NDVI %u x GNDVI %u x R %u x G %u = %u combinacoes, histograma de %.1f MB por thread\n",
+           eixos[EIXO_NDVI].n, eixos[EIXO_GNDVI].n, eixos[EIXO_R].n, eixos[EIXO_G].n,
+           num_combinacoes, num_celulas * 2.0 * sizeof(uint32_t) / (1 << 20));
+    for (uint32_t t = 0; t < num_threads; t++) {
+        histograma[t] = calloc((size_t)num_celulas * 2, sizeof(uint32_t));
+        if (!histograma[t]) {
+            fprintf(stderr, "memoria insuficiente\n");
+            return 1;
+        }
+    }
+    t0 = agora_s();
+    em_paralelo(montar_histograma, NULL);
+    for (uint32_t t = 1; t < num_threads; t++) {
+        for (uint32_t i = 0; i < num_celulas * 2; i++) histograma[0][i] += histograma[t][i];
+        free(histograma[t]);
+    }
+    double t_histograma = agora_s() - t0;
+
+    // Combinações
+    t0 = agora_s();
+    somar_prefixos(histograma[0]);
+    vp_combinacao = malloc(num_combinacoes * sizeof(uint32_t));
+    fp_combinacao = malloc(num_combinacoes * sizeof(uint32_t));
+    Ponto *pontos = malloc(num_combinacoes * sizeof(Ponto));
+    if (!vp_combinacao || !fp_combinacao || !pontos) {
+        fprintf(stderr, "memoria insuficiente\n");
+        return 1;
+    }
+    em_paralelo(avaliar_combinacoes, NULL);
+    double t_varredura = agora_s() - t0;
+    printf("Histograma em %.2f s (%.1f M amostras/s), %u combinacoes avaliadas em %.3f s\n",
+           t_histograma, amostras.n / t_histograma / 1e6, num_combinacoes, t_varredura);
+
+    // Envelope e melhor ponto (sempre no envelope: os três critérios crescem
+    // com os verdadeiros e caem com os falsos positivos)
+    uint32_t n_envelope = envelope(pontos);
+    double auc = 0, fpr_anterior = 0, tpr_anterior = 0;
+    int64_t melhor = -1;
+    double melhor_valor = -1;
+    for (uint32_t i = 0; i < n_envelope; i++) {
+        double fpr = taxa(pontos[i].fp, negativos), tpr = taxa(pontos[i].vp, positivos);
+        auc += (fpr - fpr_anterior) * tpr_anterior;
+        fpr_anterior = fpr;
+        tpr_anterior = tpr;
+
+        double valor = fpr_max >= 0 ? (fpr <= fpr_max ? tpr : -1) : youden ? tpr - fpr : f1(pontos[i].vp, pontos[i].fp);
+        if (valor > melhor_valor) {
+            melhor_valor = valor;
+            melhor = i;
+        }
+    }
+    auc += (1 - fpr_anterior) * tpr_anterior;
+    printf("Envelope: %u pontos, AUC ROC %.4f\n", n_envelope, auc);
+    if (saida_curva && gravar_curva(saida_curva, pontos, n_envelope)) {
+        printf("Curvas ROC/precisao-revocacao gravadas em %s\n", saida_curva);
+    }
+    if (melhor < 0) {
+        fprintf(stderr, "nenhuma combinacao atende ao criterio\n");
+        return 1;
+    }
+
+    // Conferência contra detectar_doenca_lote
+    uint32_t *mascara = malloc(((amostras.n + 31) / 32) * sizeof(uint32_t));
+    uint32_t conferir[2 + CONFERENCIAS_SORTEADAS], n_conferir = 0, divergencias = 0;
+    conferir[n_conferir++] = pontos[melhor].combinacao;
+    uint32_t padrao = combinacao_dos_limiares(&LIMIARES_PADRAO);
+    if (padrao != UINT32_MAX) conferir[n_conferir++] = padrao;
+    Aleatorio rng;
+    aleatorio_semear(&rng, amostras.n);
+    for (int i = 0; i < CONFERENCIAS_SORTEADAS; i++) {
+        conferir[n_conferir++] = aleatorio_faixa(&rng, num_combinacoes);
+    }
+
+    t0 = agora_s();
+    printf("\n");
+    for (uint32_t i = 0; i < n_conferir; i++) {
+        uint32_t c = conferir[i], vp, fp;
+        LimiaresDeteccao l = limiares_da_combinacao(c);
+        contar_lote(&l, mascara, &vp, &fp);
+        divergencias += vp != vp_combinacao[c] || fp != fp_combinacao[c];
+        if (i == 0) imprimir_limiares(criterio_nome, &l, vp, fp);
+        if (c == padrao && i == 1) imprimir_limiares("padrao", &l, vp, fp);
+    }
+    if (padrao == UINT32_MAX) {
+        uint32_t vp, fp;
+        contar_lote(&LIMIARES_PADRAO, mascara, &vp, &fp);
+        imprimir_limiares("padrao", &LIMIARES_PADRAO, vp, fp);
+    }
+    double t_conferencia = agora_s() - t0;
+    printf("\nConferencia com detectar_doenca_lote: %u combinacoes em %.2f s, %u divergencias: %s\n",
+           n_conferir, t_conferencia, divergencias, divergencias ? "FALHA" : "OK");
+
+    if (saida_cabecalho) {
+        LimiaresDeteccao l = limiares_da_combinacao(pontos[melhor].combinacao);
+        if (gravar_cabecalho(saida_cabecalho, nome, criterio_nome, origem, &l,
+                             pontos[melhor].vp, pontos[melhor].fp)) {
+            printf("Limiares gravados em %s\n", saida_cabecalho);
+        }
+    }
+    return divergencias != 0;
+}
@@ -0,0 +1,33 @@
+#include "aleatorio.h"
+
+/*
+* Inicializa o estado a partir de uma semente de 64 bits via splitmix64, que
+* espalha sementes próximas (0, 1, 2...) em estados sem correlação
+*/
+void aleatorio_semear(Aleatorio *a, uint64_t semente) {
+    for (int i = 0; i < 4; i++) {
+        semente += 0x9E3779B97F4A7C15ull;
+        uint64_t z = semente;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        a->s[i] = (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+    if ((a->s[0] | a->s[1] | a->s[2] | a->s[3]) == 0) {
+        a->s[0] = 1; // Estado todo zero é o único proibido
+    }
+}
+
+// Desvio padrão da soma de 4 uniformes de 16 bits: 65536 * sqrt(4/12)
+#define DESVIO_SOMA_4 37837
+
+/*
+* Ruído aproximadamente normal, em inteiros: soma de 4 uniformes
+* (Irwin-Hall), centrada e escalada. Limitado a +-3.46 desvios.
+* @param desvio Desvio padrão desejado (até 4095)
+*/
+int32_t aleatorio_gauss(Aleatorio *a, uint16_t desvio) {
+    uint32_t x = aleatorio_proximo(a);
+    uint32_t y = aleatorio_proximo(a);
+    int32_t soma = (int32_t)((x & 0xFFFF) + (x >> 16) + (y & 0xFFFF) + (y >> 16)) - 2 * 65536;
+    return soma * desvio / DESVIO_SOMA_4;
+}
@@ -0,0 +1,40 @@
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include <stdint.h>
+
+// Gerador pseudoaleatório xoshiro128** (Blackman e Vigna): 16 bytes de
+// estado, só operações de 32 bits (rápido no Cortex-M0+) e sequência
+// reproduzível a partir da semente, ao contrário de rand().
+typedef struct {
+    uint32_t s[4];
+} Aleatorio;
+
+void aleatorio_semear(Aleatorio *a, uint64_t semente);
+int32_t aleatorio_gauss(Aleatorio *a, uint16_t desvio);
+
+static inline uint32_t aleatorio_rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// Próximo valor de 32 bits
+static inline uint32_t aleatorio_proximo(Aleatorio *a) {
+    uint32_t *s = a->s;
+    uint32_t resultado = aleatorio_rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = aleatorio_rotl(s[3], 11);
+    return resultado;
+}
+
+// Inteiro em [0, n) por multiplicação (sem o viés nem a divisão de % n)
+static inline uint32_t aleatorio_faixa(Aleatorio *a, uint32_t n) {
+    return (uint32_t)(((uint64_t)aleatorio_proximo(a) * n) >> 32);
+}
+
+#endif // ALEATORIO_H
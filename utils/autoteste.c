@@ -0,0 +1,254 @@
+#include "autoteste.h"
+#include <stdio.h>
+#include <string.h>
+#include "utils/classificador.h"
+#include "utils/deteccao.h"
+
+#define PASSO_VARREDURA 32   // Passo do eixo livre nas varreduras de fronteira
+#define NIR_ALTO (3 * REFLECTANCIA_MAX)   // Mantém NDVI/GNDVI acima dos limiares
+
+/**********************************
+* VETORES
+**********************************/
+
+typedef struct {
+    uint16_t R, G, B, NIR;
+    bool esperado;
+} CasoDeteccao;
+
+static const CasoDeteccao CASOS[] = {
+    // Casos do antigo teste_deteccao
+    {REFLECTANCIA_PCT(70), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(30), REFLECTANCIA_PCT(60),  true},  // R alto, NIR baixo
+    {REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(70), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(95),  false}, // NIR alto
+    {REFLECTANCIA_PCT(68), REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(25), REFLECTANCIA_PCT(55),  true},  // NDVI abaixo do limiar
+    {REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(60), REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(120), false}, // NIR muito alto
+    {REFLECTANCIA_PCT(80), REFLECTANCIA_PCT(45), REFLECTANCIA_PCT(20), REFLECTANCIA_PCT(65),  true},  // R extremo
+    {REFLECTANCIA_PCT(30), REFLECTANCIA_PCT(70), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(85),  false}, // G alto
+    {REFLECTANCIA_PCT(60), REFLECTANCIA_PCT(30), REFLECTANCIA_PCT(35), REFLECTANCIA_PCT(55),  true},  // Ambos os índices abaixo
+    {REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(58), REFLECTANCIA_PCT(35), REFLECTANCIA_PCT(100), false}, // GNDVI limítrofe
+    {REFLECTANCIA_PCT(72), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(58),  true},  // Sintomas visíveis
+    {REFLECTANCIA_PCT(35), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(100), false}, // NIR alto
+
+    // Extremos
+    {0, 0, 0, 0, true},                                                          // Sem sinal: índices 0
+    {REFLECTANCIA_MAX, REFLECTANCIA_MAX, REFLECTANCIA_MAX, REFLECTANCIA_MAX, true}, // Saturado: índices 0
+    {0, 0, 0, REFLECTANCIA_MAX, false},                                          // Só NIR: índices ~1
+    {REFLECTANCIA_MAX, REFLECTANCIA_MAX, 0, 0, true},                            // Sem NIR: índices ~-1
+
+    // Ferrugem visível exatamente nos limiares (critérios estritos), índices altos
+    {LIMIAR_R_VISIVEL,     LIMIAR_G_VISIVEL - 1, 0, NIR_ALTO, false},
+    {LIMIAR_R_VISIVEL + 1, LIMIAR_G_VISIVEL - 1, 0, NIR_ALTO, true},
+    {LIMIAR_R_VISIVEL + 1, LIMIAR_G_VISIVEL,     0, NIR_ALTO, false},
+};
+
+// Limiares deslocados dos padrão, para exercitar o caminho ajustável
+static const ModeloClassificador MODELO_DESLOCADO = {
+    .nome = "autoteste",
+    .tipo = MODELO_LIMIARES,
+    .indices_usados = INDICE_BIT(INDICE_NDVI) | INDICE_BIT(INDICE_GNDVI),
+    .limiares = {
+        .ndvi = Q15(0.30),
+        .gndvi = Q15(0.50),
+        .r_visivel = REFLECTANCIA_PCT(50),
+        .g_visivel = REFLECTANCIA_PCT(70),
+    },
+};
+
+/**********************************
+* ORÁCULO
+**********************************/
+
+// Índice normalizado com divisão de 64 bits (truncada, como a do firmware)
+static q15_t indice_esperado(uint16_t a, uint16_t b) {
+    int64_t numerador = ((int64_t)a - b) * Q15_UM;
+    int64_t denominador = (int64_t)a + b + REFLECTANCIA_EPS;
+    return (q15_t)(numerador / denominador);
+}
+
+static bool criterios(const LimiaresDeteccao *l, uint16_t R, uint16_t G, q15_t ndvi, q15_t gndvi) {
+    bool indices = ndvi < l->ndvi && gndvi < l->gndvi;
+    bool visivel = R > l->r_visivel && G < l->g_visivel;
+    return indices || visivel;
+}
+
+/**********************************
+* VERIFICAÇÃO
+**********************************/
+
+typedef struct {
+    ResultadoAutoteste *res;
+    const LimiaresDeteccao *limiares;
+    bool padrao;                        // Limiares padrão: confere também a árvore
+
+    // Bloco pendente do lote
+    uint16_t R[32], G[32], B[32], NIR[32];
+    uint32_t esperado;
+    uint8_t n;
+} Execucao;
+
+static void registrar(ResultadoVerificacao *v, const Reflectancia *r, bool esperado, bool obtido) {
+    v->verificacoes++;
+    if (esperado == obtido) return;
+    if (v->falhas++ == 0) {
+        v->primeira_falha = *r;
+        v->esperado = esperado;
+        v->obtido = obtido;
+    }
+}
+
+static void esvaziar_lote(Execucao *ex) {
+    if (ex->n == 0) return;
+    uint32_t mascara;
+    detectar_doenca_lote(ex->R, ex->G, ex->B, ex->NIR, ex->n, ex->limiares, &mascara);
+    for (uint8_t i = 0; i < ex->n; i++) {
+        Reflectancia r = {ex->R[i], ex->G[i], ex->B[i], ex->NIR[i]};
+        registrar(&ex->res->verificacao[VERIFICACAO_LOTE], &r, (ex->esperado >> i) & 1, (mascara >> i) & 1);
+    }
+    ex->n = 0;
+    ex->esperado = 0;
+}
+
+/*
+* Confere um vetor em todos os caminhos
+* @param tabela Resultado escrito à mão, ou NULL para usar o oráculo
+* @return Resultado esperado
+*/
+static bool verificar(Execucao *ex, uint16_t R, uint16_t G, uint16_t B, uint16_t NIR, const bool *tabela) {
+    ResultadoAutoteste *res = ex->res;
+    Reflectancia r = {R, G, B, NIR};
+    q15_t ndvi = indice_esperado(NIR, R), gndvi = indice_esperado(NIR, G);
+    bool esperado = tabela ? *tabela : criterios(ex->limiares, R, G, ndvi, gndvi);
+    res->vetores++;
+    res->infectados += esperado;
+
+    registrar(&res->verificacao[VERIFICACAO_INDICES], &r, true,
+              calcular_ndvi(&r) == ndvi && calcular_gndvi(&r) == gndvi);
+    registrar(&res->verificacao[VERIFICACAO_DETECCAO], &r, esperado, detectar_doenca(R, G, B, NIR));
+    if (ex->padrao) {
+        IndicesEspectrais indices = {0};
+        calcular_indices(&r, INDICES_DETECCAO, &indices);
+        registrar(&res->verificacao[VERIFICACAO_ARVORE], &r, esperado,
+                  classificador_avaliar(&MODELO_ARVORE_REGRAS, &r, &indices));
+    }
+
+    ex->R[ex->n] = R;
+    ex->G[ex->n] = G;
+    ex->B[ex->n] = B;
+    ex->NIR[ex->n] = NIR;
+    ex->esperado |= (uint32_t)esperado << ex->n;
+    if (++ex->n == 32) esvaziar_lote(ex);
+    return esperado;
+}
+
+static uint16_t limitar(int32_t valor) {
+    return valor < 0 ? 0 : valor > REFLECTANCIA_MAX ? REFLECTANCIA_MAX : (uint16_t)valor;
+}
+
+/*
+* Varreduras de ±AUTOTESTE_VIZINHANCA códigos em torno de cada limiar, com
+* os outros critérios fixados para que o varrido decida
+*/
+static void varrer_fronteiras(Execucao *ex) {
+    const LimiaresDeteccao *l = ex->limiares;
+    const int v = AUTOTESTE_VIZINHANCA;
+
+    // NDVI: R em torno de NIR (1 - t) / (1 + t); G = NIR zera o GNDVI
+    for (int32_t nir = PASSO_VARREDURA; nir <= REFLECTANCIA_MAX; nir += PASSO_VARREDURA) {
+        int32_t centro = nir * (Q15_UM - l->ndvi) / (Q15_UM + l->ndvi);
+        for (int d = -v; d <= v; d++) verificar(ex, limitar(centro + d), (uint16_t)nir, 0, (uint16_t)nir, NULL);
+    }
+
+    // GNDVI: G em torno do limiar; R = NIR (até o limiar de vermelho) deixa o NDVI baixo
+    for (int32_t nir = PASSO_VARREDURA; nir <= REFLECTANCIA_MAX; nir += PASSO_VARREDURA) {
+        int32_t centro = nir * (Q15_UM - l->gndvi) / (Q15_UM + l->gndvi);
+        uint16_t R = nir < l->r_visivel ? (uint16_t)nir : l->r_visivel;
+        for (int d = -v; d <= v; d++) verificar(ex, R, limitar(centro + d), 0, (uint16_t)nir, NULL);
+    }
+
+    // Vermelho visível: G abaixo do limiar, índices altos
+    for (int32_t g = 0; g < l->g_visivel; g += PASSO_VARREDURA) {
+        for (int d = -v; d <= v; d++) verificar(ex, limitar(l->r_visivel + d), (uint16_t)g, 0, NIR_ALTO, NULL);
+    }
+
+    // Verde visível: R acima do limiar, índices altos
+    for (int32_t r = l->r_visivel + 1; r <= REFLECTANCIA_MAX; r += PASSO_VARREDURA) {
+        for (int d = -v; d <= v; d++) verificar(ex, (uint16_t)r, limitar(l->g_visivel + d), 0, NIR_ALTO, NULL);
+    }
+}
+
+// Grade regular em R, G e NIR, também contra a referência em ponto flutuante
+static void varrer_grade(Execucao *ex, uint16_t passo) {
+    for (uint32_t R = 0; R <= REFLECTANCIA_MAX; R += passo) {
+        for (uint32_t G = 0; G <= REFLECTANCIA_MAX; G += passo) {
+            for (uint32_t NIR = 0; NIR <= REFLECTANCIA_MAX; NIR += passo) {
+                bool esperado = verificar(ex, (uint16_t)R, (uint16_t)G, 0, (uint16_t)NIR, NULL);
+                bool ref = detectar_doenca_ref(reflectancia_para_float((uint16_t)R),
+                                               reflectancia_para_float((uint16_t)G), 0.0f,
+                                               reflectancia_para_float((uint16_t)NIR));
+                ex->res->grade_vetores++;
+                ex->res->divergencias_ref += ref != esperado;
+            }
+        }
+    }
+}
+
+/**********************************
+* EXECUÇÃO
+**********************************/
+
+/*
+* Roda tabela, varreduras e grade
+* @param passo_grade Passo da grade em códigos do ADC (0 = sem grade)
+* @return true se nenhuma verificação falhou
+*/
+bool autoteste_executar(ResultadoAutoteste *res, uint16_t passo_grade) {
+    static const ModeloClassificador *const MODELOS[] = {&MODELO_REGRAS, &MODELO_DESLOCADO};
+    memset(res, 0, sizeof(*res));
+    const ModeloClassificador *anterior = classificador_modelo_ativo();
+
+    for (uint8_t m = 0; m < sizeof(MODELOS) / sizeof(MODELOS[0]); m++) {
+        classificador_definir_modelo(MODELOS[m]);
+        Execucao ex = {.res = res, .limiares = &MODELOS[m]->limiares, .padrao = MODELOS[m] == &MODELO_REGRAS};
+
+        if (ex.padrao) {
+            for (uint8_t i = 0; i < sizeof(CASOS) / sizeof(CASOS[0]); i++) {
+                const CasoDeteccao *c = &CASOS[i];
+                verificar(&ex, c->R, c->G, c->B, c->NIR, &c->esperado);
+            }
+        }
+        varrer_fronteiras(&ex);
+        if (ex.padrao && passo_grade > 0) varrer_grade(&ex, passo_grade);
+        esvaziar_lote(&ex);
+    }
+
+    classificador_definir_modelo(anterior);
+    return autoteste_falhas(res) == 0;
+}
+
+/**********************************
+* RELATÓRIO
+**********************************/
+
+static const char *const NOMES_VERIFICACAO[NUM_VERIFICACOES] = {"indices", "deteccao", "lote", "arvore"};
+
+void autoteste_relatorio(const ResultadoAutoteste *res, uint64_t tempo_us) {
+    printf("Autoteste: %lu vetores (%lu infectados)\n",
+           (unsigned long)res->vetores, (unsigned long)res->infectados);
+    for (int v = 0; v < NUM_VERIFICACOES; v++) {
+        const ResultadoVerificacao *rv = &res->verificacao[v];
+        printf("  %-9s %8lu verificacoes %6lu falhas\n", NOMES_VERIFICACAO[v],
+               (unsigned long)rv->verificacoes, (unsigned long)rv->falhas);
+        if (rv->falhas > 0) {
+            const Reflectancia *r = &rv->primeira_falha;
+            printf("    primeira: R=%u G=%u B=%u NIR=%u esperado %d obtido %d\n",
+                   r->R, r->G, r->B, r->NIR, rv->esperado, rv->obtido);
+        }
+    }
+    printf("  ponto flutuante: %lu divergencias em %lu vetores da grade\n",
+           (unsigned long)res->divergencias_ref, (unsigned long)res->grade_vetores);
+
+    uint32_t falhas = autoteste_falhas(res);
+    uint64_t vazao = tempo_us ? (uint64_t)res->vetores * 1000000u / tempo_us : 0;
+    printf("Tempo: %lu us (%lu vetores/s): %s\n", (unsigned long)tempo_us, (unsigned long)vazao,
+           falhas ? "FALHA" : "OK");
+}
@@ -0,0 +1,67 @@
+#ifndef AUTOTESTE_H
+#define AUTOTESTE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/espectral.h"
+
+// Autoteste da detecção, sem interface: roda no firmware (comando autoteste)
+// e no host (tools/autoteste).
+//
+// Os vetores vêm de uma tabela de casos escritos à mão, de varreduras de
+// ±AUTOTESTE_VIZINHANCA códigos em torno de cada limiar (NDVI, GNDVI, R e G,
+// com os demais critérios fixados para que o varrido decida) e de uma grade
+// regular em R, G e NIR. As varreduras rodam para LIMIARES_PADRAO e para um
+// conjunto deslocado, ativado temporariamente como modelo de limiares.
+//
+// O resultado esperado vem de um oráculo independente: índices com divisão
+// de 64 bits e os critérios aplicados direto. Cada vetor confere:
+//   - calcular_ndvi/calcular_gndvi contra os índices do oráculo;
+//   - detectar_doenca (modelo ativo) contra o oráculo;
+//   - detectar_doenca_lote, em blocos de 32, contra o oráculo;
+//   - MODELO_ARVORE_REGRAS contra o oráculo, com os limiares padrão.
+// Na grade, o ponto fixo também deve concordar exatamente com a referência
+// em ponto flutuante (detectar_doenca_ref). As divergências são contadas à
+// parte, fora de autoteste_falhas; quem as exige é o harness do host
+// (tools/autoteste), que falha se houver alguma.
+
+#define AUTOTESTE_VIZINHANCA 8          // Códigos de cada lado do limiar
+#define AUTOTESTE_PASSO_GRADE 256       // Passo da grade no firmware (17^3 vetores)
+
+typedef enum {
+    VERIFICACAO_INDICES,
+    VERIFICACAO_DETECCAO,
+    VERIFICACAO_LOTE,
+    VERIFICACAO_ARVORE,
+    NUM_VERIFICACOES
+} TipoVerificacao;
+
+typedef struct {
+    uint32_t verificacoes;
+    uint32_t falhas;
+    Reflectancia primeira_falha;        // Válida se falhas > 0
+    bool esperado, obtido;              // Da primeira falha (VERIFICACAO_INDICES: índice igual ou não)
+} ResultadoVerificacao;
+
+typedef struct {
+    uint32_t vetores;                   // Vetores gerados (tabela, varreduras e grade)
+    uint32_t infectados;                // Vetores com resultado esperado positivo
+    ResultadoVerificacao verificacao[NUM_VERIFICACOES];
+    uint32_t grade_vetores;
+    uint32_t divergencias_ref;          // Grade: ponto fixo x ponto flutuante, deve ser 0 (exigido por tools/autoteste)
+} ResultadoAutoteste;
+
+// Roda todos os vetores; restaura o modelo ativo no fim
+// @return true se nenhuma verificação falhou
+bool autoteste_executar(ResultadoAutoteste *res, uint16_t passo_grade);
+
+// Resumo pela saída padrão; tempo_us é a duração medida pelo chamador
+void autoteste_relatorio(const ResultadoAutoteste *res, uint64_t tempo_us);
+
+static inline uint32_t autoteste_falhas(const ResultadoAutoteste *res) {
+    uint32_t total = 0;
+    for (int v = 0; v < NUM_VERIFICACOES; v++) total += res->verificacao[v].falhas;
+    return total;
+}
+
+#endif // AUTOTESTE_H
@@ -0,0 +1,158 @@
+#include "campo.h"
+#include <string.h>
+
+// Campo padrão: o mix do talhão de demonstração, com focos moderados
+const ParametrosCampo CAMPO_PADRAO = {
+    .semente = 2024,
+    .fileiras = 4,
+    .colunas = 25,
+    .folhas_min = 3,
+    .folhas_max = 8,
+    .pct_visivel = 15,
+    .pct_latente = 15,
+    .agrupamento = 50,
+    .ruido = REFLECTANCIA_PCT(3),
+};
+
+// Reflectância média de cada perfil (centro das faixas de gerar_planta)
+static const Reflectancia MEDIA_PERFIL[NUM_PERFIS] = {
+    [PERFIL_SAUDAVEL] = {REFLECTANCIA_PCT(35), REFLECTANCIA_PCT(65), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(105)},
+    [PERFIL_VISIVEL]  = {REFLECTANCIA_PCT(77), REFLECTANCIA_PCT(45), REFLECTANCIA_PCT(35), REFLECTANCIA_PCT(65)},
+    [PERFIL_LATENTE]  = {REFLECTANCIA_PCT(55), REFLECTANCIA_PCT(60), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(80)},
+};
+
+static inline bool bit_ler(const uint32_t *bits, int32_t i) {
+    return (bits[i >> 5] >> (i & 31)) & 1u;
+}
+
+static inline void bit_ligar(uint32_t *bits, int32_t i) {
+    bits[i >> 5] |= 1u << (i & 31);
+}
+
+/*
+* Banda com ruído, limitada à faixa representável no registro
+*/
+static uint16_t banda_com_ruido(Aleatorio *rng, int32_t media, uint16_t desvio) {
+    int32_t v = media + aleatorio_gauss(rng, desvio);
+    if (v < 0) return 0;
+    if (v > REFLECTANCIA_MAX) return REFLECTANCIA_MAX;
+    return (uint16_t)v;
+}
+
+/*
+* Prepara a geração de um campo
+* @return false se os parâmetros são inválidos
+*/
+bool campo_iniciar(GeradorCampo *g, const ParametrosCampo *par) {
+    if (par->colunas == 0 || par->colunas > CAMPO_MAX_COLUNAS || par->fileiras == 0 ||
+        par->folhas_min == 0 || par->folhas_min > par->folhas_max ||
+        par->folhas_max > PLANTA_MAX_FOLHAS || par->pct_visivel + par->pct_latente > 100 ||
+        par->agrupamento > 100) {
+        return false;
+    }
+    memset(g, 0, sizeof(*g));
+    g->par = *par;
+    aleatorio_semear(&g->rng, par->semente);
+    return true;
+}
+
+/*
+* Sorteia o perfil da próxima planta. Com agrupamento, a chance de infecção
+* mistura a taxa base com a fração de vizinhos já gerados infectados
+* (esquerda e as três de cima); como os vizinhos têm a mesma taxa base, a
+* proporção média do campo se mantém e só a distribuição espacial muda.
+*/
+static PerfilPlanta sortear_perfil(GeradorCampo *g) {
+    const ParametrosCampo *par = &g->par;
+    int32_t c = g->coluna;
+    uint32_t base = par->pct_visivel + par->pct_latente;   // %
+    uint32_t vizinhos = 0, infectados = 0;
+
+    if (c > 0) {
+        vizinhos++;
+        infectados += bit_ler(g->infectadas_atual, c - 1);
+    }
+    if (g->fileira > 0) {
+        for (int32_t d = -1; d <= 1; d++) {
+            if (c + d < 0 || c + d >= par->colunas) continue;
+            vizinhos++;
+            infectados += bit_ler(g->infectadas_acima, c + d);
+        }
+    }
+
+    // Probabilidade em 1/10000
+    uint32_t local = vizinhos ? infectados * 10000 / vizinhos : base * 100;
+    uint32_t chance = ((100 - par->agrupamento) * base * 100 + par->agrupamento * local) / 100;
+    if (aleatorio_faixa(&g->rng, 10000) >= chance) return PERFIL_SAUDAVEL;
+
+    bit_ligar(g->infectadas_atual, c);
+    return aleatorio_faixa(&g->rng, base) < par->pct_visivel ? PERFIL_VISIVEL : PERFIL_LATENTE;
+}
+
+/*
+* Gera a próxima planta em ordem de campo (fileira, coluna)
+* @return false quando o campo terminou
+*/
+bool campo_proxima_planta(GeradorCampo *g, PlantaGerada *saida) {
+    const ParametrosCampo *par = &g->par;
+    if (g->fileira >= par->fileiras) return false;
+
+    PerfilPlanta perfil = sortear_perfil(g);
+    saida->fileira = g->fileira;
+    saida->coluna = g->coluna;
+    saida->perfil = perfil;
+    saida->num_folhas = par->folhas_min + aleatorio_faixa(&g->rng, par->folhas_max - par->folhas_min + 1);
+    saida->infectada = perfil == PERFIL_VISIVEL;
+
+    // Variação da planta (comum às folhas) somada ao ruído de cada folha
+    const Reflectancia *m = &MEDIA_PERFIL[perfil];
+    int32_t R = m->R + aleatorio_gauss(&g->rng, par->ruido / 2);
+    int32_t G = m->G + aleatorio_gauss(&g->rng, par->ruido / 2);
+    int32_t B = m->B + aleatorio_gauss(&g->rng, par->ruido / 2);
+    int32_t NIR = m->NIR + aleatorio_gauss(&g->rng, par->ruido / 2);
+
+    for (uint8_t i = 0; i < saida->num_folhas; i++) {
+        EstadoFolha folha = {0};
+        folha_definir_reflectancia(&folha, (Reflectancia){
+            banda_com_ruido(&g->rng, R, par->ruido),
+            banda_com_ruido(&g->rng, G, par->ruido),
+            banda_com_ruido(&g->rng, B, par->ruido),
+            banda_com_ruido(&g->rng, NIR, par->ruido),
+        });
+        folha.visivel = perfil == PERFIL_VISIVEL;
+        folha.infectada = detectar_doenca_folha(&folha);
+        saida->folhas[i] = folha_compactar(&folha);
+    }
+
+    // Avança; no fim da fileira, a atual vira a de cima
+    if (++g->coluna == par->colunas) {
+        g->coluna = 0;
+        g->fileira++;
+        memcpy(g->infectadas_acima, g->infectadas_atual, sizeof(g->infectadas_acima));
+        memset(g->infectadas_atual, 0, sizeof(g->infectadas_atual));
+    }
+    return true;
+}
+
+/*
+* Substitui o conteúdo do registro por um campo sintético. Os ids seguem a
+* etiqueta de campo (fileira + 1) * 1000 + coluna + 1.
+* @return Plantas registradas (menos que o pedido se o registro encher)
+*/
+uint16_t campo_gerar(RegistroPlantas *reg, const ParametrosCampo *par) {
+    static GeradorCampo gerador;   // Estático: ~300 bytes fora da pilha
+    PlantaGerada gerada;
+
+    registro_limpar(reg);
+    if (!campo_iniciar(&gerador, par)) return 0;
+
+    while (campo_proxima_planta(&gerador, &gerada)) {
+        if (gerada.fileira >= REGISTRO_MAX_FILEIRAS) break;
+        uint16_t id = (gerada.fileira + 1) * 1000 + gerada.coluna + 1;
+        Planta *p = registro_adicionar(reg, id, gerada.fileira, gerada.coluna, gerada.num_folhas);
+        if (!p) break;
+        memcpy(registro_folhas(reg, p), gerada.folhas, gerada.num_folhas * sizeof(FolhaCompacta));
+        p->infectada = gerada.infectada;
+    }
+    return registro_total(reg);
+}
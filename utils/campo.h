@@ -0,0 +1,53 @@
+#ifndef CAMPO_H
+#define CAMPO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/aleatorio.h"
+#include "utils/plantas.h"
+#include "utils/registro.h"
+
+#define CAMPO_MAX_COLUNAS 1024   // Largura máxima de uma fileira gerada
+
+// Parâmetros de um talhão sintético. A mesma semente com os mesmos
+// parâmetros gera sempre o mesmo campo, bit a bit.
+typedef struct {
+    uint64_t semente;
+    uint16_t fileiras;
+    uint16_t colunas;
+    uint8_t folhas_min;          // Folhas por planta, sorteadas em [min, max]
+    uint8_t folhas_max;
+    uint8_t pct_visivel;         // Plantas com infecção visível (%)
+    uint8_t pct_latente;         // Plantas com infecção sem sintomas (%)
+    uint8_t agrupamento;         // 0 = infecções independentes, 100 = focos contíguos
+    uint16_t ruido;              // Desvio padrão por banda, escala do ADC
+} ParametrosCampo;
+
+extern const ParametrosCampo CAMPO_PADRAO;
+
+// Planta gerada, antes de entrar em um registro
+typedef struct {
+    uint16_t fileira;
+    uint16_t coluna;
+    uint8_t perfil;              // PerfilPlanta (a verdade de campo)
+    uint8_t num_folhas;
+    bool infectada;              // Como gerar_planta: só infecção visível marca a planta
+    FolhaCompacta folhas[PLANTA_MAX_FOLHAS];
+} PlantaGerada;
+
+// Geração em fluxo, fileira a fileira: não depende do tamanho do registro,
+// então campos maiores que a RAM podem ser gerados nas ferramentas de host.
+typedef struct {
+    ParametrosCampo par;
+    Aleatorio rng;
+    uint16_t fileira;
+    uint16_t coluna;
+    uint32_t infectadas_acima[CAMPO_MAX_COLUNAS / 32];  // Fileira anterior (bitset)
+    uint32_t infectadas_atual[CAMPO_MAX_COLUNAS / 32];
+} GeradorCampo;
+
+bool campo_iniciar(GeradorCampo *g, const ParametrosCampo *par);
+bool campo_proxima_planta(GeradorCampo *g, PlantaGerada *saida);
+uint16_t campo_gerar(RegistroPlantas *reg, const ParametrosCampo *par);
+
+#endif // CAMPO_H
@@ -0,0 +1,237 @@
+#include "classificador.h"
+#include <string.h>
+
+#define ARVORE_NOS_MAX 512   // Maior tabela aceita por classificador_validar
+
+/**********************************
+* MODELOS EMBUTIDOS
+**********************************/
+
+// Critérios originais: (NDVI < 0.4 e GNDVI < 0.35) ou (R > 65% e G < 55%)
+const ModeloClassificador MODELO_REGRAS = {
+    .nome = "regras",
+    .tipo = MODELO_LIMIARES,
+    .indices_usados = INDICE_BIT(INDICE_NDVI) | INDICE_BIT(INDICE_GNDVI),
+    .limiares = {
+        .ndvi = LIMIAR_NDVI,
+        .gndvi = LIMIAR_GNDVI,
+        .r_visivel = LIMIAR_R_VISIVEL,
+        .g_visivel = LIMIAR_G_VISIVEL,
+    },
+};
+
+// Os mesmos critérios expressos como árvore; serve de exemplo do formato.
+// O nó 3 (teste de ferrugem visível) é compartilhado pelos nós 0 e 1.
+static const NoArvore NOS_ARVORE_REGRAS[] = {
+    /* 0 */ {LIMIAR_NDVI,          3, ATRIBUTO_NDVI,  0},
+    /* 1 */ {LIMIAR_GNDVI,         3, ATRIBUTO_GNDVI, 0},
+    /* 2 */ {0,                    0, NO_FOLHA,       1},
+    /* 3 */ {LIMIAR_R_VISIVEL + 1, 5, ATRIBUTO_R,     0},
+    /* 4 */ {0,                    0, NO_FOLHA,       0},
+    /* 5 */ {LIMIAR_G_VISIVEL,     7, ATRIBUTO_G,     0},
+    /* 6 */ {0,                    0, NO_FOLHA,       1},
+    /* 7 */ {0,                    0, NO_FOLHA,       0},
+};
+
+const ModeloClassificador MODELO_ARVORE_REGRAS = {
+    .nome = "arvore_regras",
+    .tipo = MODELO_ARVORE,
+    .indices_usados = INDICE_BIT(INDICE_NDVI) | INDICE_BIT(INDICE_GNDVI),
+    .profundidade = 5,
+    .num_nos = sizeof(NOS_ARVORE_REGRAS) / sizeof(NOS_ARVORE_REGRAS[0]),
+    .nos = NOS_ARVORE_REGRAS,
+};
+
+// Modelos gerados por tools/treinar_arvore entram nesta lista
+const ModeloClassificador *const MODELOS_EMBUTIDOS[] = {
+    &MODELO_REGRAS,
+    &MODELO_ARVORE_REGRAS,
+};
+const uint8_t NUM_MODELOS_EMBUTIDOS = sizeof(MODELOS_EMBUTIDOS) / sizeof(MODELOS_EMBUTIDOS[0]);
+
+static const ModeloClassificador *modelo_ativo = &MODELO_REGRAS;
+
+/**********************************
+* AVALIAÇÃO
+**********************************/
+
+/*
+* Percorre a árvore; custo limitado a modelo->profundidade nós
+*/
+static bool avaliar_arvore(const ModeloClassificador *modelo,
+                           const Reflectancia *r, const IndicesEspectrais *indices) {
+    int32_t atributos[NUM_ATRIBUTOS];
+    atributos[ATRIBUTO_R] = r->R;
+    atributos[ATRIBUTO_G] = r->G;
+    atributos[ATRIBUTO_B] = r->B;
+    atributos[ATRIBUTO_NIR] = r->NIR;
+    memcpy(&atributos[ATRIBUTO_PRIMEIRO_INDICE], indices->valor, sizeof(indices->valor));
+
+    uint16_t i = 0;
+    for (uint8_t passo = 0; passo < modelo->profundidade; passo++) {
+        const NoArvore *no = &modelo->nos[i];
+        if (no->atributo == NO_FOLHA) {
+            return no->classe != 0;
+        }
+        i = atributos[no->atributo] < no->limiar ? i + 1 : no->direita;
+    }
+    return false; // Inalcançável em tabelas validadas
+}
+
+static bool avaliar_limiares(const LimiaresDeteccao *l,
+                             const Reflectancia *r, const IndicesEspectrais *indices) {
+    bool criterio_ndvi = indices->valor[INDICE_NDVI] < l->ndvi;
+    bool criterio_gndvi = indices->valor[INDICE_GNDVI] < l->gndvi;
+    bool criterio_visivel = (r->R > l->r_visivel) && (r->G < l->g_visivel);
+
+    return (criterio_ndvi && criterio_gndvi) || criterio_visivel;
+}
+
+/*
+* Classifica uma folha com o modelo informado
+* @param indices Deve conter pelo menos modelo->indices_usados
+* @return true se infectada
+*/
+bool classificador_avaliar(const ModeloClassificador *modelo,
+                           const Reflectancia *r, const IndicesEspectrais *indices) {
+    if (modelo->tipo == MODELO_ARVORE) {
+        return avaliar_arvore(modelo, r, indices);
+    }
+    return avaliar_limiares(&modelo->limiares, r, indices);
+}
+
+/*
+* Classificação em lote. Modelos de limiares usam o kernel vetorizável
+* detectar_doenca_lote; árvores são avaliadas folha a folha.
+*/
+void classificador_avaliar_lote(const ModeloClassificador *modelo,
+                                const uint16_t *R, const uint16_t *G,
+                                const uint16_t *B, const uint16_t *NIR,
+                                uint32_t n, uint32_t *mascara) {
+    if (modelo->tipo == MODELO_LIMIARES) {
+        detectar_doenca_lote(R, G, B, NIR, n, &modelo->limiares, mascara);
+        return;
+    }
+
+    for (uint32_t base = 0; base < n; base += 32) {
+        uint32_t palavra = 0;
+        uint32_t fim = (n - base) < 32 ? (n - base) : 32;
+        for (uint32_t j = 0; j < fim; j++) {
+            uint32_t i = base + j;
+            Reflectancia r = {R[i], G[i], B[i], NIR[i]};
+            IndicesEspectrais indices = {0};
+            calcular_indices(&r, modelo->indices_usados, &indices);
+            palavra |= (uint32_t)avaliar_arvore(modelo, &r, &indices) << j;
+        }
+        mascara[base / 32] = palavra;
+    }
+}
+
+/**********************************
+* MODELO ATIVO
+**********************************/
+
+/*
+* Troca o modelo usado por detectar_doenca
+* @return false se a tabela for inválida (o modelo anterior é mantido)
+*/
+bool classificador_definir_modelo(const ModeloClassificador *modelo) {
+    if (!classificador_validar(modelo)) {
+        return false;
+    }
+    modelo_ativo = modelo;
+    return true;
+}
+
+const ModeloClassificador *classificador_modelo_ativo(void) {
+    return modelo_ativo;
+}
+
+const ModeloClassificador *classificador_buscar(const char *nome) {
+    for (uint8_t i = 0; i < NUM_MODELOS_EMBUTIDOS; i++) {
+        if (strcmp(MODELOS_EMBUTIDOS[i]->nome, nome) == 0) {
+            return MODELOS_EMBUTIDOS[i];
+        }
+    }
+    return NULL;
+}
+
+/**********************************
+* VALIDAÇÃO E CARGA
+**********************************/
+
+/*
+* Verifica a consistência de um modelo antes de usá-lo: filhos dentro da
+* tabela e sempre à frente do pai (sem ciclos), atributos conhecidos,
+* índices declarados e profundidade real dentro do limite declarado
+*/
+bool classificador_validar(const ModeloClassificador *modelo) {
+    if (!modelo) return false;
+    if (modelo->tipo == MODELO_LIMIARES) {
+        // Índices normalizados ficam em [-1, 1]; o lote conta com T <= Q15_UM
+        const LimiaresDeteccao *l = &modelo->limiares;
+        return l->ndvi > 0 && l->ndvi <= Q15_UM && l->gndvi > 0 && l->gndvi <= Q15_UM;
+    }
+    if (modelo->tipo != MODELO_ARVORE || !modelo->nos) return false;
+    if (modelo->num_nos == 0 || modelo->num_nos > ARVORE_NOS_MAX) return false;
+    if (modelo->profundidade == 0 || modelo->profundidade > ARVORE_PROFUNDIDADE_MAX) return false;
+
+    // Profundidade de cada nó, calculada de trás para frente
+    static uint8_t profundidade[ARVORE_NOS_MAX];
+
+    for (int i = modelo->num_nos - 1; i >= 0; i--) {
+        const NoArvore *no = &modelo->nos[i];
+        if (no->atributo == NO_FOLHA) {
+            if (no->classe > 1) return false;
+            profundidade[i] = 1;
+            continue;
+        }
+        if (no->atributo >= NUM_ATRIBUTOS) return false;
+        if (i + 1 >= modelo->num_nos) return false;
+        if (no->direita <= i || no->direita >= modelo->num_nos) return false;
+        if (no->atributo >= ATRIBUTO_PRIMEIRO_INDICE &&
+            !(modelo->indices_usados & INDICE_BIT(no->atributo - ATRIBUTO_PRIMEIRO_INDICE))) {
+            return false;
+        }
+
+        uint8_t esquerda = profundidade[i + 1];
+        uint8_t direita = profundidade[no->direita];
+        profundidade[i] = 1 + (esquerda > direita ? esquerda : direita);
+    }
+    return profundidade[0] <= modelo->profundidade;
+}
+
+/*
+* Monta um modelo em árvore apontando diretamente para um blob binário,
+* sem cópia (o blob pode estar na flash, lido via XIP)
+* @param blob Dados alinhados a 4 bytes: CabecalhoBlobArvore seguido dos nós
+* @param nome Nome atribuído ao modelo
+* @param saida Modelo preenchido
+* @return true se o blob for válido
+*/
+bool classificador_de_blob(const uint8_t *blob, size_t tamanho, const char *nome,
+                           ModeloClassificador *saida) {
+    if (((uintptr_t)blob & 3) != 0 || tamanho < sizeof(CabecalhoBlobArvore)) {
+        return false;
+    }
+
+    const CabecalhoBlobArvore *cabecalho = (const CabecalhoBlobArvore *)blob;
+    size_t esperado = sizeof(CabecalhoBlobArvore) + (size_t)cabecalho->num_nos * sizeof(NoArvore);
+    if (cabecalho->magico != BLOB_ARVORE_MAGICO || tamanho < esperado) {
+        return false;
+    }
+
+    ModeloClassificador modelo = {
+        .nome = nome,
+        .tipo = MODELO_ARVORE,
+        .indices_usados = cabecalho->indices_usados,
+        .profundidade = cabecalho->profundidade,
+        .num_nos = cabecalho->num_nos,
+        .nos = (const NoArvore *)(blob + sizeof(CabecalhoBlobArvore)),
+    };
+    if (!classificador_validar(&modelo)) {
+        return false;
+    }
+    *saida = modelo;
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef CLASSIFICADOR_H
+#define CLASSIFICADOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils/espectral.h"
+#include "utils/deteccao.h"
+
+// Atributos que um nó de árvore pode testar
+typedef enum {
+    ATRIBUTO_R,       // Reflectâncias na escala do ADC
+    ATRIBUTO_G,
+    ATRIBUTO_B,
+    ATRIBUTO_NIR,
+    ATRIBUTO_NDVI,    // Índices em Q15 (mesma ordem de TipoIndice)
+    ATRIBUTO_GNDVI,
+    ATRIBUTO_NGRDI,
+    ATRIBUTO_SAVI,
+    ATRIBUTO_EVI,
+    NUM_ATRIBUTOS
+} AtributoClassificador;
+
+#define ATRIBUTO_PRIMEIRO_INDICE ATRIBUTO_NDVI
+#define NO_FOLHA 0xFF                // Valor de atributo que marca um nó folha
+#define ARVORE_PROFUNDIDADE_MAX 16   // Limite de nós visitados por avaliação
+
+// Nó de árvore de decisão (8 bytes), tabela plana em pré-ordem.
+// valor < limiar segue para o nó seguinte (i + 1); caso contrário, para "direita".
+// Filhos sempre têm índice maior que o pai, então subárvores podem ser compartilhadas.
+typedef struct {
+    int32_t limiar;
+    uint16_t direita;
+    uint8_t atributo;    // AtributoClassificador ou NO_FOLHA
+    uint8_t classe;      // Resultado (0 = saudável, 1 = infectada) quando folha
+} NoArvore;
+
+typedef enum {
+    MODELO_LIMIARES,     // Critérios originais com limiares ajustáveis
+    MODELO_ARVORE        // Árvore de decisão em tabela
+} TipoModelo;
+
+typedef struct {
+    const char *nome;
+    uint8_t tipo;                // TipoModelo
+    uint8_t indices_usados;      // Máscara de índices que a avaliação precisa
+    uint8_t profundidade;        // Maior número de nós em um caminho (MODELO_ARVORE)
+    uint16_t num_nos;
+    const NoArvore *nos;
+    LimiaresDeteccao limiares;   // Usado por MODELO_LIMIARES
+} ModeloClassificador;
+
+// Blob binário de um modelo em árvore (para tabelas gravadas na flash ou recebidas pela serial):
+// cabeçalho "ARV1", num_nos (u16), profundidade (u8), indices_usados (u8), seguido dos nós
+#define BLOB_ARVORE_MAGICO 0x31565241u  // "ARV1" em little-endian
+typedef struct {
+    uint32_t magico;
+    uint16_t num_nos;
+    uint8_t profundidade;
+    uint8_t indices_usados;
+} CabecalhoBlobArvore;
+
+// Modelos embutidos no firmware
+extern const ModeloClassificador MODELO_REGRAS;
+extern const ModeloClassificador MODELO_ARVORE_REGRAS;
+extern const ModeloClassificador *const MODELOS_EMBUTIDOS[];
+extern const uint8_t NUM_MODELOS_EMBUTIDOS;
+
+// Avaliação
+bool classificador_avaliar(const ModeloClassificador *modelo,
+                           const Reflectancia *r, const IndicesEspectrais *indices);
+void classificador_avaliar_lote(const ModeloClassificador *modelo,
+                                const uint16_t *R, const uint16_t *G,
+                                const uint16_t *B, const uint16_t *NIR,
+                                uint32_t n, uint32_t *mascara);
+
+// Modelo ativo
+bool classificador_definir_modelo(const ModeloClassificador *modelo);
+const ModeloClassificador *classificador_modelo_ativo(void);
+const ModeloClassificador *classificador_buscar(const char *nome);
+
+// Validação e carga de tabelas externas
+bool classificador_validar(const ModeloClassificador *modelo);
+bool classificador_de_blob(const uint8_t *blob, size_t tamanho, const char *nome,
+                           ModeloClassificador *saida);
+
+#endif // CLASSIFICADOR_H
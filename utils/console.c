@@ -0,0 +1,101 @@
+#include "console.h"
+#include <stdio.h>
+#include <string.h>
+#include "utils/rastreio.h"
+
+void console_iniciar(Console *c, const ComandoConsole *comandos, uint8_t num_comandos) {
+    c->comandos = comandos;
+    c->num_comandos = num_comandos;
+    c->tamanho = 0;
+    c->descartando = false;
+    c->executados = 0;
+    c->erros = 0;
+}
+
+/*
+* Separa a linha em palavras no próprio buffer
+* @return Número de palavras (no máximo CONSOLE_MAX_ARGS + 1, indicando excesso)
+*/
+static int separar_palavras(char *linha, char *argv[]) {
+    int argc = 0;
+    char *p = linha;
+    while (*p) {
+        while (*p == ' ' || *p == '\t') *p++ = '\0';
+        if (!*p) break;
+        if (argc == CONSOLE_MAX_ARGS) return argc + 1;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+    }
+    return argc;
+}
+
+/*
+* Busca o comando na tabela e o executa
+* @return true se o comando foi executado com sucesso
+*/
+static bool despachar(Console *c) {
+    char *argv[CONSOLE_MAX_ARGS];
+    int argc = separar_palavras(c->linha, argv);
+    if (argc == 0) return true; // Linha vazia: sem resposta
+    if (argc > CONSOLE_MAX_ARGS) {
+        printf("erro argumentos demais\n");
+        return false;
+    }
+
+    for (uint8_t i = 0; i < c->num_comandos; i++) {
+        const ComandoConsole *cmd = &c->comandos[i];
+        if (strcmp(cmd->nome, argv[0]) != 0) continue;
+
+        if (argc - 1 < cmd->min_args) {
+            printf("erro uso: %s %s\n", cmd->nome, cmd->uso);
+            return false;
+        }
+        bool ok = cmd->executar(argc, argv);
+        printf(ok ? "ok\n" : "erro\n");
+        return ok;
+    }
+    printf("erro comando desconhecido: %s\n", argv[0]);
+    return false;
+}
+
+/*
+* Entrega um caractere recebido. \r ou \n terminam a linha e a executam.
+* @return true se uma linha foi executada
+*/
+bool console_receber(Console *c, char caractere) {
+    if (caractere != '\r' && caractere != '\n') {
+        if (c->tamanho < CONSOLE_TAM_LINHA) {
+            c->linha[c->tamanho++] = caractere;
+        } else {
+            c->descartando = true;
+        }
+        return false;
+    }
+
+    if (c->tamanho == 0 && !c->descartando) return false; // \n de um \r\n, ou linha vazia
+
+    bool ok;
+    if (c->descartando) {
+        printf("erro linha com mais de %d caracteres\n", CONSOLE_TAM_LINHA);
+        ok = false;
+    } else {
+        c->linha[c->tamanho] = '\0';
+        RASTREIO_INICIO(PONTO_CONSOLE);
+        ok = despachar(c);
+        RASTREIO_FIM(PONTO_CONSOLE);
+    }
+    c->tamanho = 0;
+    c->descartando = false;
+    c->executados++;
+    if (!ok) c->erros++;
+    return true;
+}
+
+/*
+* Lista os comandos da tabela
+*/
+void console_ajuda(const Console *c) {
+    for (uint8_t i = 0; i < c->num_comandos; i++) {
+        printf("%-10s %s\n", c->comandos[i].nome, c->comandos[i].uso);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Limites do console
+#define CONSOLE_TAM_LINHA 80      // Caracteres por comando (sem o terminador)
+#define CONSOLE_MAX_ARGS 8        // Palavras por comando, incluindo o nome
+
+// Executa um comando; argv[0] é o nome. Retorna false em erro (o console
+// responde "erro"), depois de o handler explicar o motivo se quiser.
+typedef bool (*console_handler_t)(int argc, char *argv[]);
+
+// Entrada da tabela de comandos
+typedef struct {
+    const char *nome;
+    const char *uso;              // Argumentos, para a ajuda e erros de uso
+    uint8_t min_args;             // Argumentos obrigatórios (sem contar o nome)
+    console_handler_t executar;
+} ComandoConsole;
+
+// Console orientado a linhas: recebe um caractere por vez, sem bloquear nem
+// alocar, e ao fim de cada linha despacha pela tabela. Toda resposta termina
+// com uma linha "ok" ou "erro ...", para que scripts possam encadear comandos.
+typedef struct {
+    const ComandoConsole *comandos;
+    uint8_t num_comandos;
+    char linha[CONSOLE_TAM_LINHA + 1];
+    uint8_t tamanho;
+    bool descartando;             // Linha longa demais: ignora até o fim dela
+
+    uint32_t executados;          // Estatísticas
+    uint32_t erros;
+} Console;
+
+void console_iniciar(Console *c, const ComandoConsole *comandos, uint8_t num_comandos);
+bool console_receber(Console *c, char caractere);
+void console_ajuda(const Console *c);
+
+#endif // CONSOLE_H
@@ -0,0 +1,12 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+
+#define CRC16_INICIAL 0xFFFF
+
+// CRC-16/CCITT-FALSE (polinômio 0x1021). Encadeável: passe o resultado
+// anterior como crc para continuar o cálculo sobre outro trecho.
+uint16_t crc16_ccitt(uint16_t crc, const void *dados, uint32_t tamanho);
+
+#endif // CRC_H
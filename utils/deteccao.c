@@ -0,0 +1,145 @@
+#include "deteccao.h"
+#include "utils/classificador.h"
+
+const LimiaresDeteccao LIMIARES_PADRAO = {
+    .ndvi = LIMIAR_NDVI,
+    .gndvi = LIMIAR_GNDVI,
+    .r_visivel = LIMIAR_R_VISIVEL,
+    .g_visivel = LIMIAR_G_VISIVEL,
+};
+
+/*
+* Implementa o algoritmo principal de detecção de doenças em ponto fixo
+* @param R,G,B,NIR Reflectâncias na escala do ADC
+* @return true se detectada anomalia
+*/
+bool detectar_doenca(uint16_t R, uint16_t G, uint16_t B, uint16_t NIR) {
+    Reflectancia r = {R, G, B, NIR};
+    IndicesEspectrais indices = {0};
+
+    // Cálculo dos índices (Q15, divisor por hardware)
+    calcular_indices(&r, deteccao_indices_necessarios(), &indices);
+    return detectar_doenca_indices(&r, &indices);
+}
+
+/*
+* Índices que o modelo de classificação ativo precisa do motor espectral
+*/
+uint8_t deteccao_indices_necessarios(void) {
+    return classificador_modelo_ativo()->indices_usados;
+}
+
+/*
+* Aplica o modelo de classificação ativo sobre índices já calculados
+* @param r Reflectâncias na escala do ADC
+* @param indices Índices com pelo menos deteccao_indices_necessarios() válidos
+* @return true se detectada anomalia
+*
+* O modelo padrão (MODELO_REGRAS) aplica os critérios:
+* 1. NDVI < 0.4
+* 2. GNDVI < 0.35
+* 3. Vermelho alto (R > 65%) com Verde baixo (G < 55%)
+*/
+bool detectar_doenca_indices(const Reflectancia *r, const IndicesEspectrais *indices) {
+    return classificador_avaliar(classificador_modelo_ativo(), r, indices);
+}
+
+/*
+* Classifica até 32 folhas sem desvios condicionais.
+* ndvi < T equivale a (NIR - R) * 2^15 < T * (NIR + R + eps) para T > 0,
+* inclusive com o truncamento da divisão inteira; assim o resultado é
+* idêntico ao das regras de detectar_doenca (calcular_ndvi/calcular_gndvi e
+* os três critérios) com os limiares dados, sem nenhuma divisão. Só coincide
+* com detectar_doenca quando o modelo ativo é de limiares iguais a esses
+* (MODELO_REGRAS para LIMIARES_PADRAO); uma árvore ativa pode discordar.
+* Com reflectâncias saturadas em 14 bits e T <= Q15_UM
+* (classificador_validar) todos os produtos cabem em int32.
+*/
+static inline uint32_t classificar_bloco(const uint16_t *restrict R,
+                                         const uint16_t *restrict G,
+                                         const uint16_t *restrict NIR,
+                                         uint32_t n, const LimiaresDeteccao *limiares) {
+    const int32_t t_ndvi = limiares->ndvi;
+    const int32_t t_gndvi = limiares->gndvi;
+    const int32_t t_r = limiares->r_visivel;
+    const int32_t t_g = limiares->g_visivel;
+    uint8_t resultado[32];
+
+    for (uint32_t j = 0; j < n; j++) {
+        int32_t r = R[j] < LOTE_REFLECTANCIA_MAX ? R[j] : LOTE_REFLECTANCIA_MAX;
+        int32_t g = G[j] < LOTE_REFLECTANCIA_MAX ? G[j] : LOTE_REFLECTANCIA_MAX;
+        int32_t nir = NIR[j] < LOTE_REFLECTANCIA_MAX ? NIR[j] : LOTE_REFLECTANCIA_MAX;
+
+        int32_t c_ndvi = (nir - r) * Q15_UM < t_ndvi * (nir + r + REFLECTANCIA_EPS);
+        int32_t c_gndvi = (nir - g) * Q15_UM < t_gndvi * (nir + g + REFLECTANCIA_EPS);
+        int32_t c_visivel = (r > t_r) & (g < t_g);
+
+        resultado[j] = (uint8_t)((c_ndvi & c_gndvi) | c_visivel);
+    }
+
+    uint32_t palavra = 0;
+    for (uint32_t j = 0; j < n; j++) {
+        palavra |= (uint32_t)resultado[j] << j;
+    }
+    return palavra;
+}
+
+/*
+* Detecção em lote sobre arrays por banda
+* @param R,G,B,NIR Reflectâncias na escala do ADC (B não participa dos critérios)
+* @param n Número de folhas
+* @param limiares Limiares de decisão (NULL usa LIMIARES_PADRAO, não o modelo
+* ativo); para concordar com detectar_doenca, passe
+* classificador_modelo_ativo()->limiares com um modelo de limiares ativo
+* @param mascara Saída com (n + 31) / 32 palavras; bit i = folha i infectada
+*/
+void detectar_doenca_lote(const uint16_t *R, const uint16_t *G,
+                          const uint16_t *B, const uint16_t *NIR,
+                          uint32_t n, const LimiaresDeteccao *limiares,
+                          uint32_t *mascara) {
+    (void)B;
+    if (!limiares) limiares = &LIMIARES_PADRAO;
+
+    uint32_t base = 0;
+    // Blocos completos: contagem fixa permite vetorização total do laço
+    for (; base + 32 <= n; base += 32) {
+        mascara[base / 32] = classificar_bloco(R + base, G + base, NIR + base, 32, limiares);
+    }
+    // Restante
+    if (base < n) {
+        mascara[base / 32] = classificar_bloco(R + base, G + base, NIR + base, n - base, limiares);
+    }
+}
+
+/*
+* Versão original em ponto flutuante, mantida como referência para os
+* testes de equivalência do caminho em ponto fixo
+* @param R,G,B,NIR Valores de reflectância (0.0 a 1.0)
+* @return true se detectada anomalia
+*/
+bool detectar_doenca_ref(float R, float G, float B, float NIR) {
+
+    // 1. Cálculo dos índices
+    float ndvi = (NIR - R) / (NIR + R + 0.001f);
+    float gndvi = (NIR - G) / (NIR + G + 0.001f);
+
+    // 2. Limiares científicos
+    const float NDVI_SAUDAVEL = 0.4f;
+    const float GNDVI_SAUDAVEL = 0.35f;
+
+    // 3. Critérios de detecção
+    bool criterio_ndvi = ndvi < NDVI_SAUDAVEL;
+    bool criterio_gndvi = gndvi < GNDVI_SAUDAVEL;
+    bool criterio_visivel = (R > 0.65f) && (G < 0.55f);
+
+    // 4. Lógica de decisão
+    bool resultado = (criterio_ndvi && criterio_gndvi) || criterio_visivel;
+
+    /* 5. Simulação de erro
+    const float ERRO = 0.2f;
+    if((float)rand()/RAND_MAX < ERRO) {
+        return !resultado;
+    }
+    */
+    return resultado;
+}
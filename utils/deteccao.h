@@ -0,0 +1,52 @@
+#ifndef DETECCAO_H
+#define DETECCAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/espectral.h"
+
+// Limiares científicos em ponto fixo
+#define LIMIAR_NDVI      Q15(0.40)  // NDVI abaixo indica baixa atividade fotossintética
+#define LIMIAR_GNDVI     Q15(0.35)  // GNDVI abaixo indica baixa clorofila
+#define LIMIAR_R_VISIVEL 2661       // floor(0.65 * 4095): vermelho alto quando R > 65%
+#define LIMIAR_G_VISIVEL 2253       // ceil(0.55 * 4095): verde baixo quando G < 55%
+
+// Reflectâncias acima deste valor são saturadas no processamento em lote
+#define LOTE_REFLECTANCIA_MAX 16383
+
+// Conjunto de limiares usado pelo processamento em lote
+typedef struct {
+    q15_t ndvi;          // Critério NDVI: ndvi < limiar (0 < limiar <= Q15_UM)
+    q15_t gndvi;         // Critério GNDVI: gndvi < limiar (0 < limiar <= Q15_UM)
+    uint16_t r_visivel;  // Ferrugem visível: R > limiar ...
+    uint16_t g_visivel;  // ... e G < limiar
+} LimiaresDeteccao;
+
+extern const LimiaresDeteccao LIMIARES_PADRAO;
+
+// Índices exibidos nas telas de resultado (os usados pelos critérios originais)
+#define INDICES_DETECCAO (INDICE_BIT(INDICE_NDVI) | INDICE_BIT(INDICE_GNDVI))
+
+// Detecção em ponto fixo (reflectâncias na escala do ADC)
+bool detectar_doenca(uint16_t R, uint16_t G, uint16_t B, uint16_t NIR);
+
+// Índices que o modelo de classificação ativo precisa (ver utils/classificador.h)
+uint8_t deteccao_indices_necessarios(void);
+
+// Detecção a partir de índices já calculados (ex.: cache da folha)
+bool detectar_doenca_indices(const Reflectancia *r, const IndicesEspectrais *indices);
+
+// Detecção em lote sobre vetores separados por banda (estrutura de arrays).
+// O bit i de mascara[i / 32] recebe o resultado da folha i. Aplica as
+// regras com os limiares dados, não o modelo ativo: para concordar com
+// detectar_doenca, passe classificador_modelo_ativo()->limiares (modelo de
+// limiares) ou use classificador_avaliar_lote.
+void detectar_doenca_lote(const uint16_t *R, const uint16_t *G,
+                          const uint16_t *B, const uint16_t *NIR,
+                          uint32_t n, const LimiaresDeteccao *limiares,
+                          uint32_t *mascara);
+
+// Caminho de referência em ponto flutuante (reflectâncias em 0.0-1.0)
+bool detectar_doenca_ref(float R, float G, float B, float NIR);
+
+#endif // DETECCAO_H
@@ -0,0 +1,256 @@
+#include "epidemia.h"
+#include <string.h>
+
+/**********************************
+* CONFIGURAÇÃO
+**********************************/
+
+/*
+* Prepara uma grade sem infecções
+* @param memoria Pelo menos EPIDEMIA_PALAVRAS(largura, altura) palavras
+* @return false se a grade é vazia ou a memória não basta
+*/
+bool epidemia_iniciar(Epidemia *e, uint16_t largura, uint16_t altura,
+                      uint32_t *memoria, size_t palavras, uint8_t prob_transmissao, uint64_t semente) {
+    if (largura == 0 || altura == 0 || palavras < EPIDEMIA_PALAVRAS(largura, altura)) return false;
+
+    uint32_t tamanho = EPIDEMIA_PALAVRAS_LINHA(largura) * altura;
+    e->largura = largura;
+    e->altura = altura;
+    e->palavras_linha = EPIDEMIA_PALAVRAS_LINHA(largura);
+    e->infectadas = memoria;
+    e->tratadas = memoria + tamanho;
+    e->proximo = memoria + 2 * tamanho;
+    e->mascara_final = (largura % 32) ? (1u << (largura % 32)) - 1 : 0xFFFFFFFFu;
+    e->dia = 0;
+    memset(memoria, 0, 3 * tamanho * sizeof(uint32_t));
+    aleatorio_semear(&e->rng, semente);
+    epidemia_definir_probabilidade(e, prob_transmissao);
+    return true;
+}
+
+/*
+* Troca a chance de transmissão e recalcula a tabela por número de vizinhos
+*/
+void epidemia_definir_probabilidade(Epidemia *e, uint8_t prob_transmissao) {
+    // (1 - p)^k em Q16, sem ponto flutuante
+    uint32_t escapa = 1u << 16;
+    e->prob_transmissao = prob_transmissao;
+    e->prob_contagem[0] = 0;
+    for (int k = 1; k <= 8; k++) {
+        escapa = escapa * (256u - prob_transmissao) >> 8;
+        uint32_t p = ((1u << 16) - escapa + 128) >> 8;
+        e->prob_contagem[k] = p > 255 ? 255 : (uint8_t)p;
+    }
+}
+
+/*
+* Infecta células sorteadas (focos iniciais); tratadas não são afetadas
+*/
+void epidemia_semear(Epidemia *e, uint32_t focos) {
+    for (uint32_t i = 0; i < focos; i++) {
+        uint16_t x = (uint16_t)aleatorio_faixa(&e->rng, e->largura);
+        uint16_t y = (uint16_t)aleatorio_faixa(&e->rng, e->altura);
+        epidemia_infectar(e, x, y);
+    }
+}
+
+/*
+* Copia para a grade as plantas do registro, na posição (coluna, fileira):
+* infectada se alguma folha tem infecção (visível ou latente), tratada como
+* no registro. Plantas fora da grade são ignoradas.
+* @return Plantas copiadas
+*/
+uint32_t epidemia_carregar_registro(Epidemia *e, const RegistroPlantas *reg) {
+    uint32_t tamanho = (uint32_t)e->palavras_linha * e->altura;
+    memset(e->infectadas, 0, tamanho * sizeof(uint32_t));
+    memset(e->tratadas, 0, tamanho * sizeof(uint32_t));
+    e->dia = 0;
+
+    uint32_t copiadas = 0;
+    for (uint16_t i = 0; i < reg->num_plantas; i++) {
+        const Planta *p = &reg->plantas[i];
+        if (p->coluna >= e->largura || p->fileira >= e->altura) continue;
+
+        uint32_t indice = (uint32_t)p->fileira * e->palavras_linha + p->coluna / 32;
+        uint32_t bit = 1u << (p->coluna % 32);
+        if (p->tratada) {
+            e->tratadas[indice] |= bit;
+        } else {
+            bool infectada = p->infectada;
+            for (uint8_t f = 0; f < p->num_folhas && !infectada; f++) {
+                infectada = folha_compacta_infectada(reg->folhas[p->primeira_folha + f]);
+            }
+            if (infectada) e->infectadas[indice] |= bit;
+        }
+        copiadas++;
+    }
+    return copiadas;
+}
+
+/**********************************
+* CÉLULAS
+**********************************/
+
+EstadoCelula epidemia_estado(const Epidemia *e, uint16_t x, uint16_t y) {
+    if (x >= e->largura || y >= e->altura) return EPIDEMIA_SAUDAVEL;
+    uint32_t indice = (uint32_t)y * e->palavras_linha + x / 32;
+    uint32_t bit = 1u << (x % 32);
+    if (e->tratadas[indice] & bit) return EPIDEMIA_TRATADA;
+    return (e->infectadas[indice] & bit) ? EPIDEMIA_INFECTADA : EPIDEMIA_SAUDAVEL;
+}
+
+void epidemia_infectar(Epidemia *e, uint16_t x, uint16_t y) {
+    if (x >= e->largura || y >= e->altura) return;
+    uint32_t indice = (uint32_t)y * e->palavras_linha + x / 32;
+    uint32_t bit = 1u << (x % 32);
+    if (!(e->tratadas[indice] & bit)) e->infectadas[indice] |= bit;
+}
+
+// Bits das colunas [x0, x1) que caem na palavra i da linha
+static uint32_t mascara_faixa(uint16_t i, uint16_t x0, uint16_t x1) {
+    uint32_t inicio = (uint32_t)i * 32;
+    if (x1 <= inicio || x0 >= inicio + 32) return 0;
+    uint32_t mascara = 0xFFFFFFFFu;
+    if (x0 > inicio) mascara &= 0xFFFFFFFFu << (x0 - inicio);
+    if (x1 < inicio + 32) mascara &= (1u << (x1 - inicio)) - 1;
+    return mascara;
+}
+
+/*
+* Trata as plantas do retângulo [x0, x1) x [y0, y1): a infecção é
+* eliminada e a planta não pega nem transmite mais
+* @return Plantas tratadas agora (as já tratadas não contam)
+*/
+uint32_t epidemia_tratar_bloco(Epidemia *e, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    if (x1 > e->largura) x1 = e->largura;
+    if (y1 > e->altura) y1 = e->altura;
+    uint32_t tratadas = 0;
+    for (uint16_t y = y0; y < y1; y++) {
+        for (uint16_t i = x0 / 32; i < e->palavras_linha && i * 32u < x1; i++) {
+            uint32_t indice = (uint32_t)y * e->palavras_linha + i;
+            uint32_t mascara = mascara_faixa(i, x0, x1);
+            tratadas += __builtin_popcount(mascara & ~e->tratadas[indice]);
+            e->tratadas[indice] |= mascara;
+            e->infectadas[indice] &= ~mascara;
+        }
+    }
+    return tratadas;
+}
+
+/**********************************
+* SIMULAÇÃO
+**********************************/
+
+/*
+* Máscara em que cada bit vale 1 com probabilidade q / 256: percorrendo os
+* bits de q do menos para o mais significativo, um bit 1 faz OR com uma
+* palavra aleatória (p -> (1 + p) / 2) e um bit 0 faz AND (p -> p / 2)
+*/
+static uint32_t mascara_aleatoria(Aleatorio *rng, uint8_t q) {
+    if (q == 0) return 0;
+    uint32_t mascara = 0;
+    for (int b = __builtin_ctz(q); b < 8; b++) {
+        uint32_t r = aleatorio_proximo(rng);
+        mascara = ((q >> b) & 1) ? (mascara | r) : (mascara & r);
+    }
+    return mascara;
+}
+
+// Somador completo bit a bit: três entradas de peso 1 -> soma e vai-um
+#define SOMAR3(a, b, c, soma, vai) do { \
+        uint32_t _x = (a) ^ (b);         \
+        soma = _x ^ (c);                 \
+        vai = ((a) & (b)) | (_x & (c));  \
+    } while (0)
+
+// Vizinho a oeste (x - 1) e a leste (x + 1) de cada bit da palavra i
+static inline uint32_t oeste(const uint32_t *linha, uint16_t i) {
+    return (linha[i] << 1) | (i > 0 ? linha[i - 1] >> 31 : 0);
+}
+
+static inline uint32_t leste(const uint32_t *linha, uint16_t i, uint16_t n) {
+    return (linha[i] >> 1) | (i + 1 < n ? linha[i + 1] << 31 : 0);
+}
+
+/*
+* Avança um dia: cada planta suscetível com k vizinhos infectados é
+* infectada com probabilidade prob_contagem[k]
+* @return Novas infecções no dia
+*/
+uint32_t epidemia_avancar_dia(Epidemia *e) {
+    const uint16_t n = e->palavras_linha;
+    uint32_t novas = 0;
+
+    for (uint16_t y = 0; y < e->altura; y++) {
+        const uint32_t *atual = &e->infectadas[(uint32_t)y * n];
+        const uint32_t *cima = y > 0 ? atual - n : NULL;
+        const uint32_t *baixo = y + 1 < e->altura ? atual + n : NULL;
+        const uint32_t *tratadas = &e->tratadas[(uint32_t)y * n];
+        uint32_t *proximo = &e->proximo[(uint32_t)y * n];
+
+        for (uint16_t i = 0; i < n; i++) {
+            uint32_t v[8] = {
+                oeste(atual, i), leste(atual, i, n),
+                cima ? oeste(cima, i) : 0, cima ? cima[i] : 0, cima ? leste(cima, i, n) : 0,
+                baixo ? oeste(baixo, i) : 0, baixo ? baixo[i] : 0, baixo ? leste(baixo, i, n) : 0,
+            };
+            uint32_t suscetiveis = ~(atual[i] | tratadas[i]);
+            if (i + 1 == n) suscetiveis &= e->mascara_final;
+            uint32_t expostas = suscetiveis & (v[0] | v[1] | v[2] | v[3] | v[4] | v[5] | v[6] | v[7]);
+            if (expostas == 0) {
+                proximo[i] = atual[i];
+                continue;
+            }
+
+            // Contagem de vizinhos (0 a 8) em 4 planos de bits: b3 b2 b1 b0
+            uint32_t s1, c1, s2, c2, s3, c3, b0, c4, t, c5, b1, c6;
+            SOMAR3(v[0], v[1], v[2], s1, c1);
+            SOMAR3(v[3], v[4], v[5], s2, c2);
+            s3 = v[6] ^ v[7];
+            c3 = v[6] & v[7];
+            SOMAR3(s1, s2, s3, b0, c4);           // Peso 1
+            SOMAR3(c1, c2, c3, t, c5);            // Peso 2 (c5 tem peso 4)
+            b1 = t ^ c4;
+            c6 = t & c4;                          // Peso 4
+            uint32_t b2 = c5 ^ c6;
+            uint32_t b3 = c5 & c6;                // Peso 8
+
+            uint32_t infectadas = 0;
+            for (int k = 1; k <= 8; k++) {
+                uint32_t com_k = expostas & (k & 1 ? b0 : ~b0) & (k & 2 ? b1 : ~b1) &
+                                 (k & 4 ? b2 : ~b2) & (k & 8 ? b3 : ~b3);
+                if (com_k) infectadas |= com_k & mascara_aleatoria(&e->rng, e->prob_contagem[k]);
+            }
+            proximo[i] = atual[i] | infectadas;
+            novas += __builtin_popcount(infectadas);
+        }
+    }
+
+    uint32_t *anterior = e->infectadas;
+    e->infectadas = e->proximo;
+    e->proximo = anterior;
+    e->dia++;
+    return novas;
+}
+
+/*
+* Conta infectadas e tratadas no retângulo [x0, x1) x [y0, y1), para as
+* visões reduzidas da grade
+*/
+void epidemia_contar_bloco(const Epidemia *e, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1,
+                           uint32_t *infectadas, uint32_t *tratadas) {
+    if (x1 > e->largura) x1 = e->largura;
+    if (y1 > e->altura) y1 = e->altura;
+    uint32_t inf = 0, trat = 0;
+    for (uint16_t y = y0; y < y1; y++) {
+        for (uint16_t i = x0 / 32; i < e->palavras_linha && i * 32u < x1; i++) {
+            uint32_t indice = (uint32_t)y * e->palavras_linha + i;
+            uint32_t mascara = mascara_faixa(i, x0, x1);
+            inf += __builtin_popcount(e->infectadas[indice] & mascara);
+            trat += __builtin_popcount(e->tratadas[indice] & mascara);
+        }
+    }
+    *infectadas = inf;
+    *tratadas = trat;
+}
@@ -0,0 +1,66 @@
+#ifndef EPIDEMIA_H
+#define EPIDEMIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils/aleatorio.h"
+#include "utils/registro.h"
+
+// Simulação da propagação da infecção em uma grade de plantas, dia a dia.
+//
+// O estado fica em bitsets de 32 bits por linha da grade (bit j da palavra i
+// é a coluna 32 * i + j): plantas infectadas (inclusive latentes) e tratadas.
+// A cada dia, cada vizinho infectado (8 vizinhos) transmite a uma planta
+// suscetível com probabilidade prob_transmissao / 256; com k vizinhos
+// infectados, a chance é 1 - (1 - p)^k. Plantas tratadas não pegam nem
+// transmitem a infecção.
+//
+// O passo trata 32 plantas por vez: os 8 vizinhos de cada bit vêm de
+// deslocamentos das linhas de cima, atual e de baixo, a contagem de vizinhos
+// é feita com somadores bit a bit (bit-sliced) e o sorteio usa máscaras
+// aleatórias com a probabilidade de cada contagem. Palavras sem nenhum
+// vizinho infectado são puladas, então campos esparsos custam pouco.
+
+#define EPIDEMIA_PALAVRAS_LINHA(largura) (((uint32_t)(largura) + 31) / 32)
+// Memória necessária (em palavras de 32 bits) para uma grade
+#define EPIDEMIA_PALAVRAS(largura, altura) (3 * EPIDEMIA_PALAVRAS_LINHA(largura) * (uint32_t)(altura))
+
+typedef enum {
+    EPIDEMIA_SAUDAVEL,
+    EPIDEMIA_INFECTADA,
+    EPIDEMIA_TRATADA
+} EstadoCelula;
+
+typedef struct {
+    uint16_t largura;
+    uint16_t altura;
+    uint16_t palavras_linha;
+    uint32_t *infectadas;        // altura * palavras_linha
+    uint32_t *tratadas;
+    uint32_t *proximo;           // Dia seguinte em construção (troca com infectadas)
+    uint32_t mascara_final;      // Colunas válidas na última palavra da linha
+    uint8_t prob_transmissao;    // Chance por vizinho infectado por dia, em 1/256
+    uint8_t prob_contagem[9];    // 1 - (1 - p)^k para k vizinhos, em 1/256
+    Aleatorio rng;
+    uint32_t dia;
+} Epidemia;
+
+// Configuração (a memória é do chamador: EPIDEMIA_PALAVRAS(largura, altura))
+bool epidemia_iniciar(Epidemia *e, uint16_t largura, uint16_t altura,
+                      uint32_t *memoria, size_t palavras, uint8_t prob_transmissao, uint64_t semente);
+void epidemia_definir_probabilidade(Epidemia *e, uint8_t prob_transmissao);
+void epidemia_semear(Epidemia *e, uint32_t focos);
+uint32_t epidemia_carregar_registro(Epidemia *e, const RegistroPlantas *reg);
+
+// Células
+EstadoCelula epidemia_estado(const Epidemia *e, uint16_t x, uint16_t y);
+void epidemia_infectar(Epidemia *e, uint16_t x, uint16_t y);
+uint32_t epidemia_tratar_bloco(Epidemia *e, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+
+// Simulação e consulta
+uint32_t epidemia_avancar_dia(Epidemia *e);
+void epidemia_contar_bloco(const Epidemia *e, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1,
+                           uint32_t *infectadas, uint32_t *tratadas);
+
+#endif // EPIDEMIA_H
@@ -0,0 +1,83 @@
+#include "espectral.h"
+
+const char *const NOMES_INDICES[NUM_INDICES] = {
+    [INDICE_NDVI]  = "NDVI",
+    [INDICE_GNDVI] = "GNDVI",
+    [INDICE_NGRDI] = "NGRDI",
+    [INDICE_SAVI]  = "SAVI",
+    [INDICE_EVI]   = "EVI",
+};
+
+/*
+* Calcula um conjunto de índices espectrais em uma única passada
+* @param r Reflectâncias na escala do ADC (saturadas em 14 bits internamente)
+* @param mascara Índices desejados (INDICE_BIT(...)); os demais ficam intactos
+* @param saida Índices em Q15; saida->validos recebe os bits calculados
+*
+* As diferenças e somas entre bandas são calculadas uma vez e compartilhadas
+* entre os índices. Cada índice custa uma divisão (8 ciclos no divisor do
+* RP2040), então não há ganho em trocar divisões por recíprocos.
+*/
+void calcular_indices(const Reflectancia *r, uint8_t mascara, IndicesEspectrais *saida) {
+    const int32_t limite = 16383;
+    int32_t red = r->R < limite ? r->R : limite;
+    int32_t green = r->G < limite ? r->G : limite;
+    int32_t blue = r->B < limite ? r->B : limite;
+    int32_t nir = r->NIR < limite ? r->NIR : limite;
+
+    // Subexpressões compartilhadas
+    int32_t dif_nir_r = nir - red;
+    int32_t soma_nir_r = nir + red;
+
+    if (mascara & INDICE_BIT(INDICE_NDVI)) {
+        saida->valor[INDICE_NDVI] = DIVIDIR_S32(dif_nir_r * Q15_UM, soma_nir_r + REFLECTANCIA_EPS);
+    }
+    if (mascara & INDICE_BIT(INDICE_GNDVI)) {
+        saida->valor[INDICE_GNDVI] = DIVIDIR_S32((nir - green) * Q15_UM, nir + green + REFLECTANCIA_EPS);
+    }
+    if (mascara & INDICE_BIT(INDICE_NGRDI)) {
+        saida->valor[INDICE_NGRDI] = DIVIDIR_S32((green - red) * Q15_UM, green + red + REFLECTANCIA_EPS);
+    }
+    if (mascara & INDICE_BIT(INDICE_SAVI)) {
+        // 1.5 * 2^15 = 49152
+        saida->valor[INDICE_SAVI] = DIVIDIR_S32(dif_nir_r * 49152, soma_nir_r + SAVI_L);
+    }
+    if (mascara & INDICE_BIT(INDICE_EVI)) {
+        // (2NIR + 12R - 15B + 2L) / 2 mantém o fator 7.5 inteiro; 2.5 * 2^15 = 81920
+        int32_t denominador = (2 * nir + 12 * red - 15 * blue + 2 * EVI_L) / 2;
+        if (denominador < REFLECTANCIA_EPS) denominador = REFLECTANCIA_EPS;
+        int32_t evi = DIVIDIR_S32(dif_nir_r * 81920, denominador);
+        if (evi > EVI_LIMITE) evi = EVI_LIMITE;
+        if (evi < -EVI_LIMITE) evi = -EVI_LIMITE;
+        saida->valor[INDICE_EVI] = evi;
+    }
+
+    saida->validos |= mascara & INDICES_TODOS;
+}
+
+/*
+* Converte reflectância em ponto flutuante (1.0 = 100%) para a escala do ADC
+* @param valor Reflectância (valores negativos saturam em 0)
+* @return Reflectância na escala 0..REFLECTANCIA_MAX (até 65535)
+*/
+uint16_t reflectancia_de_float(float valor) {
+    float escalado = valor * REFLECTANCIA_MAX + 0.5f;
+    if (escalado <= 0.0f) return 0;
+    if (escalado >= 65535.0f) return 65535;
+    return (uint16_t)escalado;
+}
+
+/*
+* Converte reflectância na escala do ADC para ponto flutuante (1.0 = 100%)
+*/
+float reflectancia_para_float(uint16_t valor) {
+    return valor / (float)REFLECTANCIA_MAX;
+}
+
+/*
+* Percentual arredondado da reflectância (saturado em 255)
+*/
+uint8_t reflectancia_percentual(uint16_t valor) {
+    uint32_t pct = ((uint32_t)valor * 100 + REFLECTANCIA_MAX / 2) / REFLECTANCIA_MAX;
+    return pct > 255 ? 255 : (uint8_t)pct;
+}
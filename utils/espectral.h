@@ -0,0 +1,91 @@
+#ifndef ESPECTRAL_H
+#define ESPECTRAL_H
+
+#include <stdint.h>
+
+// Reflectâncias em escala nativa do ADC: 0 = 0%, REFLECTANCIA_MAX = 100%.
+// Valores acima de 100% (NIR muito alto) cabem em 16 bits.
+#define REFLECTANCIA_MAX 4095
+#define REFLECTANCIA_EPS 4    // 0.001 na escala do ADC (evita divisão por zero)
+
+// Converte um percentual inteiro para a escala do ADC
+#define REFLECTANCIA_PCT(p) ((uint16_t)(((p) * REFLECTANCIA_MAX + 50) / 100))
+
+// Ponto fixo Q15: 1.0 = 32768. Guardado em 32 bits para representar +1.0 exato.
+typedef int32_t q15_t;
+#define Q15_UM 32768
+#define Q15(x) ((q15_t)((x) * Q15_UM + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q15_PARA_FLOAT(q) ((float)(q) / Q15_UM)
+
+// Estrutura para armazenar reflectâncias
+typedef struct {
+    uint16_t R;    // Reflectância no vermelho
+    uint16_t G;    // Reflectância no verde
+    uint16_t B;    // Reflectância no azul
+    uint16_t NIR;  // Reflectância no infravermelho
+} Reflectancia;
+
+// Divisão inteira com sinal. No RP2040 (Cortex-M0+, sem FPU nem instrução de
+// divisão) usa o divisor por hardware do SIO, que resolve em 8 ciclos.
+#ifdef __arm__
+#include "hardware/divider.h"
+#define DIVIDIR_S32(a, b) hw_divider_s32_quotient_inlined((a), (b))
+#else
+#define DIVIDIR_S32(a, b) ((a) / (b))
+#endif
+
+/*
+* Índice de diferença normalizada (a - b) / (a + b + eps) em Q15
+* Entradas até 16 bits: (a - b) << 15 ainda cabe em int32.
+*/
+static inline q15_t indice_normalizado(uint16_t a, uint16_t b) {
+    int32_t numerador = ((int32_t)a - (int32_t)b) * Q15_UM;
+    int32_t denominador = (int32_t)a + (int32_t)b + REFLECTANCIA_EPS;
+    return DIVIDIR_S32(numerador, denominador);
+}
+
+// Índices de vegetação isolados
+static inline q15_t calcular_ndvi(const Reflectancia *r) {
+    return indice_normalizado(r->NIR, r->R);
+}
+
+static inline q15_t calcular_gndvi(const Reflectancia *r) {
+    return indice_normalizado(r->NIR, r->G);
+}
+
+// Índices calculados pelo motor espectral.
+// Para um novo índice: acrescente-o aqui, em NOMES_INDICES e em calcular_indices.
+typedef enum {
+    INDICE_NDVI,   // (NIR - R) / (NIR + R)
+    INDICE_GNDVI,  // (NIR - G) / (NIR + G)
+    INDICE_NGRDI,  // (G - R) / (G + R)
+    INDICE_SAVI,   // 1.5 (NIR - R) / (NIR + R + 0.5)
+    INDICE_EVI,    // 2.5 (NIR - R) / (NIR + 6R - 7.5B + 1)
+    NUM_INDICES
+} TipoIndice;
+
+#define INDICE_BIT(i) (1u << (i))
+#define INDICES_TODOS ((1u << NUM_INDICES) - 1)
+
+// Constantes dos índices ajustados, na escala do ADC
+#define SAVI_L (REFLECTANCIA_MAX / 2)  // L = 0.5
+#define EVI_L  REFLECTANCIA_MAX        // L = 1.0
+#define EVI_LIMITE (4 * Q15_UM)        // Saturação do EVI quando o denominador se aproxima de zero
+
+// Resultado do motor espectral (Q15), com a máscara dos índices já calculados
+typedef struct {
+    q15_t valor[NUM_INDICES];
+    uint8_t validos;
+} IndicesEspectrais;
+
+extern const char *const NOMES_INDICES[NUM_INDICES];
+
+// Motor espectral: calcula, em uma passada, os índices pedidos em mascara
+void calcular_indices(const Reflectancia *r, uint8_t mascara, IndicesEspectrais *saida);
+
+// Conversões
+uint16_t reflectancia_de_float(float valor);
+float reflectancia_para_float(uint16_t valor);
+uint8_t reflectancia_percentual(uint16_t valor);
+
+#endif // ESPECTRAL_H
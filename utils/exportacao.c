@@ -0,0 +1,130 @@
+#include "exportacao.h"
+#include <string.h>
+#include "utils/crc.h"
+#include "utils/plantas.h"
+
+/**********************************
+* COBS
+**********************************/
+
+/*
+* Codifica um bloco em COBS: cada 0x00 vira a distância até o próximo zero,
+* de modo que a saída não contém zeros
+* @param saida Pelo menos tamanho + tamanho/254 + 1 bytes
+* @return Bytes escritos
+*/
+size_t cobs_codificar(const uint8_t *entrada, size_t tamanho, uint8_t *saida) {
+    size_t codigo = 0;   // Posição do byte de código do grupo atual
+    size_t escrito = 1;
+    uint8_t distancia = 1;
+
+    for (size_t i = 0; i < tamanho; i++) {
+        if (entrada[i] != 0) {
+            saida[escrito++] = entrada[i];
+            distancia++;
+        }
+        if (entrada[i] == 0 || distancia == 0xFF) {
+            saida[codigo] = distancia;
+            codigo = escrito++;
+            distancia = 1;
+        }
+    }
+    saida[codigo] = distancia;
+    return escrito;
+}
+
+/*
+* Decodifica um bloco COBS (sem o delimitador)
+* @return Bytes decodificados, ou 0 se o bloco é inválido
+*/
+size_t cobs_decodificar(const uint8_t *entrada, size_t tamanho, uint8_t *saida) {
+    size_t lido = 0, escrito = 0;
+    while (lido < tamanho) {
+        uint8_t codigo = entrada[lido++];
+        if (codigo == 0 || lido + codigo - 1 > tamanho) return 0;
+        for (uint8_t i = 1; i < codigo; i++) saida[escrito++] = entrada[lido++];
+        if (codigo != 0xFF && lido < tamanho) saida[escrito++] = 0;
+    }
+    return escrito;
+}
+
+/**********************************
+* QUADROS
+**********************************/
+
+/*
+* Monta, codifica e envia um quadro
+* @param prefixo Byte opcional antes da carga (tipo do registro), ou -1
+*/
+static void enviar_quadro(Exportacao *e, uint8_t tipo, int prefixo,
+                          const void *carga, uint8_t tamanho) {
+    uint8_t bruto[QUADRO_MAX_BRUTO];
+    uint8_t codificado[QUADRO_MAX_COBS];
+    size_t n = 0;
+
+    bruto[n++] = tipo;
+    bruto[n++] = (uint8_t)e->sequencia;
+    bruto[n++] = (uint8_t)(e->sequencia >> 8);
+    if (prefixo >= 0) bruto[n++] = (uint8_t)prefixo;
+    memcpy(&bruto[n], carga, tamanho);
+    n += tamanho;
+    uint16_t crc = crc16_ccitt(CRC16_INICIAL, bruto, n);
+    bruto[n++] = (uint8_t)crc;
+    bruto[n++] = (uint8_t)(crc >> 8);
+
+    size_t m = cobs_codificar(bruto, n, codificado);
+    codificado[m++] = 0x00;
+    e->saida(e->ctx, codificado, (uint32_t)m);
+    e->sequencia++;
+}
+
+/*
+* Prepara a exportação do histórico. Nada é enviado aqui: o quadro de início
+* sai na primeira chamada a exportacao_continuar, depois de qualquer resposta
+* de texto pendente.
+* @param saida Destino dos bytes codificados
+*/
+void exportacao_iniciar(Exportacao *e, const FlashLog *log, exportacao_saida_t saida, void *ctx) {
+    e->log = log;
+    e->saida = saida;
+    e->ctx = ctx;
+    e->sequencia = 0;
+    e->registros = 0;
+    e->ativa = true;
+    flash_log_iniciar_leitura(log, &e->leitura);
+}
+
+/*
+* Envia os próximos registros do histórico; ao chegar ao fim envia o quadro
+* de encerramento
+* @param max_quadros Limite de quadros nesta chamada
+* @return true enquanto houver registros a enviar
+*/
+bool exportacao_continuar(Exportacao *e, uint32_t max_quadros) {
+    if (!e->ativa) return false;
+
+    if (e->sequencia == 0) {
+        // Delimitador avulso: o receptor descarta o texto recebido antes
+        const uint8_t delimitador = 0x00;
+        e->saida(e->ctx, &delimitador, 1);
+        const uint8_t inicio[] = {EXPORTACAO_VERSAO, sizeof(RegistroAnalise)};
+        enviar_quadro(e, QUADRO_INICIO, -1, inicio, sizeof(inicio));
+    }
+
+    for (uint32_t i = 0; i < max_quadros; i++) {
+        uint8_t tipo, tamanho;
+        const void *dados;
+        if (!flash_log_proximo(e->log, &e->leitura, &tipo, &dados, &tamanho)) {
+            uint8_t fim[4] = {
+                (uint8_t)e->registros, (uint8_t)(e->registros >> 8),
+                (uint8_t)(e->registros >> 16), (uint8_t)(e->registros >> 24),
+            };
+            enviar_quadro(e, QUADRO_FIM, -1, fim, sizeof(fim));
+            e->ativa = false;
+            return false;
+        }
+        enviar_quadro(e, QUADRO_REGISTRO, tipo, dados, tamanho);
+        e->registros++;
+    }
+    return true;
+}
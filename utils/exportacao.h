@@ -0,0 +1,54 @@
+#ifndef EXPORTACAO_H
+#define EXPORTACAO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils/flash_log.h"
+
+// Protocolo de exportação binária do histórico
+//
+// Cada quadro, antes da codificação, é:
+//   tipo (1) | sequencia (2, LE) | carga útil | CRC-16/CCITT de tudo antes (2, LE)
+// e vai pela serial codificado em COBS e terminado por 0x00. Como 0x00 nunca
+// aparece dentro de um quadro codificado, o receptor ressincroniza no próximo
+// delimitador após qualquer byte perdido; a sequência revela quadros perdidos.
+#define EXPORTACAO_VERSAO 1
+
+typedef enum {
+    QUADRO_INICIO = 1,    // Carga: versao (1), tamanho de RegistroAnalise (1)
+    QUADRO_REGISTRO = 2,  // Carga: tipo do registro no log (1) + dados do registro
+    QUADRO_FIM = 3        // Carga: registros enviados (4, LE)
+} TipoQuadro;
+
+#define QUADRO_MAX_CARGA (1 + FLASH_LOG_MAX_DADOS)
+#define QUADRO_MAX_BRUTO (3 + QUADRO_MAX_CARGA + 2)
+#define QUADRO_MAX_COBS (QUADRO_MAX_BRUTO + QUADRO_MAX_BRUTO / 254 + 2) // Com o delimitador
+
+// Saída dos bytes codificados (no firmware, a stdio sem tradução de CRLF)
+typedef void (*exportacao_saida_t)(void *ctx, const uint8_t *dados, uint32_t tamanho);
+
+// Exportação em andamento. O envio é feito aos poucos por exportacao_continuar,
+// para que o loop principal não pare durante uma transferência longa.
+typedef struct {
+    const FlashLog *log;
+    IteradorLog leitura;
+    exportacao_saida_t saida;
+    void *ctx;
+    uint16_t sequencia;        // Próximo número de quadro
+    uint32_t registros;        // Registros já enviados
+    bool ativa;
+} Exportacao;
+
+void exportacao_iniciar(Exportacao *e, const FlashLog *log, exportacao_saida_t saida, void *ctx);
+bool exportacao_continuar(Exportacao *e, uint32_t max_quadros);
+
+static inline bool exportacao_ativa(const Exportacao *e) {
+    return e->ativa;
+}
+
+// COBS (Consistent Overhead Byte Stuffing), sem o delimitador final
+size_t cobs_codificar(const uint8_t *entrada, size_t tamanho, uint8_t *saida);
+size_t cobs_decodificar(const uint8_t *entrada, size_t tamanho, uint8_t *saida);
+
+#endif // EXPORTACAO_H
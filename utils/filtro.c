@@ -0,0 +1,78 @@
+#include "filtro.h"
+
+/*
+* Mediana de três valores sem ordenação
+*/
+static inline uint16_t mediana3(uint16_t a, uint16_t b, uint16_t c) {
+    uint16_t menor = a < b ? a : b;
+    uint16_t maior = a < b ? b : a;
+    return c < menor ? menor : (c > maior ? maior : c);
+}
+
+/*
+* Configura o filtro
+* @param alfa_shift Suavização: alfa = 1/2^alfa_shift (0 desliga a EMA)
+* @param passo Variação mínima, na escala do ADC, para publicar um novo valor
+*/
+void filtro_iniciar(FiltroReflectancia *f, uint8_t alfa_shift, uint16_t passo) {
+    f->alfa_shift = alfa_shift;
+    f->passo = passo;
+    filtro_reiniciar(f, (Reflectancia){0, 0, 0, 0});
+}
+
+/*
+* Descarta o histórico e assume "valor" como estado estável
+*/
+void filtro_reiniciar(FiltroReflectancia *f, Reflectancia valor) {
+    const uint16_t bandas[4] = {valor.R, valor.G, valor.B, valor.NIR};
+    for (int b = 0; b < 4; b++) {
+        f->janela[b][0] = f->janela[b][1] = f->janela[b][2] = bandas[b];
+        f->media[b] = (int32_t)bandas[b] << FILTRO_FRACAO;
+    }
+    f->posicao = 0;
+    f->estavel = 0;
+    f->publicado = valor;
+}
+
+/*
+* Processa uma amostra
+* @return true se o valor publicado mudou (consumidor deve redesenhar/reavaliar)
+*/
+bool filtro_atualizar(FiltroReflectancia *f, Reflectancia amostra) {
+    const uint16_t bandas[4] = {amostra.R, amostra.G, amostra.B, amostra.NIR};
+    uint16_t *publicado[4] = {&f->publicado.R, &f->publicado.G, &f->publicado.B, &f->publicado.NIR};
+    uint16_t filtrado[4];
+    bool mudou = false, pendente = false, assentado = true;
+
+    for (int b = 0; b < 4; b++) {
+        uint16_t *janela = f->janela[b];
+        janela[f->posicao] = bandas[b];
+        int32_t alvo = (int32_t)mediana3(janela[0], janela[1], janela[2]) << FILTRO_FRACAO;
+
+        f->media[b] += (alvo - f->media[b]) >> f->alfa_shift;
+        filtrado[b] = (uint16_t)((f->media[b] + (1 << (FILTRO_FRACAO - 1))) >> FILTRO_FRACAO);
+
+        int32_t delta = (int32_t)filtrado[b] - *publicado[b];
+        if (delta >= f->passo || -delta >= f->passo) {
+            mudou = true;
+        }
+        pendente |= delta != 0;
+        assentado &= ((int32_t)filtrado[b] << FILTRO_FRACAO) == alvo;
+    }
+    f->posicao = f->posicao == 2 ? 0 : f->posicao + 1;
+
+    // Entrada parada por FILTRO_ASSENTAR amostras: publica o valor final exato,
+    // mesmo que a diferença seja menor que o passo
+    f->estavel = assentado ? (f->estavel < FILTRO_ASSENTAR ? f->estavel + 1 : FILTRO_ASSENTAR) : 0;
+    if (pendente && f->estavel == FILTRO_ASSENTAR) {
+        mudou = true;
+    }
+
+    // Publica todas as bandas juntas para manter a amostra coerente
+    if (mudou) {
+        for (int b = 0; b < 4; b++) {
+            *publicado[b] = filtrado[b];
+        }
+    }
+    return mudou;
+}
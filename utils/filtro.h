@@ -0,0 +1,37 @@
+#ifndef FILTRO_H
+#define FILTRO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/espectral.h"
+
+// Parâmetros padrão do filtro de reflectância
+#define FILTRO_ALFA_SHIFT 2                       // EMA com alfa = 1/2^2
+#define FILTRO_PASSO (REFLECTANCIA_MAX / 200)     // Variação mínima publicada: 0.5%
+#define FILTRO_FRACAO 8                           // Bits fracionários do acumulador
+#define FILTRO_ASSENTAR 8                         // Amostras estáveis para publicar o valor exato
+
+// Filtro em fluxo sobre amostras de reflectância: mediana de 3 (remove picos
+// isolados do ADC) seguida de média móvel exponencial. O valor publicado só
+// muda quando alguma banda se afasta mais de "passo" do último publicado, ou
+// quando a entrada para e a média assenta em um valor diferente.
+typedef struct {
+    uint16_t janela[4][3];     // Últimas 3 amostras por banda (R, G, B, NIR)
+    int32_t media[4];          // EMA em ponto fixo (FILTRO_FRACAO bits)
+    uint8_t posicao;           // Próxima posição da janela
+    uint8_t estavel;           // Amostras seguidas com a média assentada
+    uint8_t alfa_shift;
+    uint16_t passo;
+    Reflectancia publicado;    // Último valor entregue ao consumidor
+} FiltroReflectancia;
+
+void filtro_iniciar(FiltroReflectancia *f, uint8_t alfa_shift, uint16_t passo);
+void filtro_reiniciar(FiltroReflectancia *f, Reflectancia valor);
+bool filtro_atualizar(FiltroReflectancia *f, Reflectancia amostra);
+
+// Último valor publicado
+static inline Reflectancia filtro_valor(const FiltroReflectancia *f) {
+    return f->publicado;
+}
+
+#endif // FILTRO_H
@@ -0,0 +1,353 @@
+#include "flash_log.h"
+#include <string.h>
+#include "utils/crc.h"
+
+#define SEM_SETOR 0xFFFF
+#define ALINHAR4(n) (((n) + 3u) & ~3u)
+
+// Setor pré-apagado quando restam menos páginas livres que isto no setor atual
+#define PAGINAS_ANTES_DE_APAGAR 2
+
+static inline uint32_t endereco_pagina(uint16_t setor, uint16_t pagina) {
+    return (uint32_t)setor * FLASH_LOG_TAM_SETOR + (uint32_t)pagina * FLASH_LOG_TAM_PAGINA;
+}
+
+static uint16_t crc_registro(uint8_t tipo, uint8_t tamanho, const void *dados) {
+    uint8_t cabecalho[2] = {tamanho, tipo};
+    return crc16_ccitt(crc16_ccitt(CRC16_INICIAL, cabecalho, 2), dados, tamanho);
+}
+
+/**********************************
+* PÁGINAS E SETORES
+**********************************/
+
+/*
+* Prepara o buffer para a página atual; a primeira página do setor leva o cabeçalho
+*/
+static void iniciar_buffer(FlashLog *log) {
+    memset(log->buffer, 0xFF, sizeof(log->buffer));
+    log->ocupado = 0;
+    if (log->pagina_atual == 0) {
+        uint32_t sequencia = log->sequencia[log->setor_atual];
+        CabecalhoSetorLog cabecalho = {FLASH_LOG_MAGICO, sequencia, ~sequencia};
+        memcpy(log->buffer, &cabecalho, sizeof(cabecalho));
+        log->ocupado = sizeof(cabecalho);
+    }
+}
+
+static bool programar_pendente(FlashLog *log) {
+    if (!log->tem_pendente) return true;
+    log->tem_pendente = false;
+    log->programacoes++;
+    return log->flash->programar(log->flash->ctx, log->endereco_pendente,
+                                 log->pendente, FLASH_LOG_TAM_PAGINA);
+}
+
+static bool apagar_setor(FlashLog *log, uint16_t setor) {
+    log->sequencia[setor] = 0;
+    log->apagamentos++;
+    return log->flash->apagar(log->flash->ctx, (uint32_t)setor * FLASH_LOG_TAM_SETOR);
+}
+
+/*
+* Passa a escrever no setor seguinte, descartando o mais antigo do anel
+*/
+static bool abrir_proximo_setor(FlashLog *log) {
+    uint16_t proximo = (log->setor_atual + 1) % log->flash->num_setores;
+    uint32_t sequencia = log->sequencia[log->setor_atual] + 1;
+
+    if (log->proximo_apagado != proximo && !apagar_setor(log, proximo)) {
+        return false;
+    }
+    log->proximo_apagado = SEM_SETOR;
+    log->setor_atual = proximo;
+    log->pagina_atual = 0;
+    log->sequencia[proximo] = sequencia;
+    iniciar_buffer(log);
+    return true;
+}
+
+/*
+* Fecha a página em preenchimento: vira a página pendente (a anterior, se
+* ainda não gravada, é programada agora) e o buffer avança para a próxima
+*/
+static bool fechar_pagina(FlashLog *log) {
+    bool ok = programar_pendente(log);
+
+    memcpy(log->pendente, log->buffer, FLASH_LOG_TAM_PAGINA);
+    log->endereco_pendente = endereco_pagina(log->setor_atual, log->pagina_atual);
+    log->tem_pendente = true;
+
+    // Fim do setor: o próximo só é aberto (e apagado, se preciso) no próximo anexar
+    if (++log->pagina_atual < FLASH_LOG_PAGINAS_SETOR) {
+        iniciar_buffer(log);
+    } else {
+        log->ocupado = 0;
+    }
+    return ok;
+}
+
+static bool pagina_livre(FlashLog *log, uint16_t setor, uint16_t pagina) {
+    uint32_t pagina_lida[FLASH_LOG_TAM_PAGINA / 4];
+    if (!log->flash->ler(log->flash->ctx, endereco_pagina(setor, pagina), pagina_lida, sizeof(pagina_lida))) {
+        return false;
+    }
+    for (uint32_t i = 0; i < FLASH_LOG_TAM_PAGINA / 4; i++) {
+        if (pagina_lida[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+/**********************************
+* ABERTURA
+**********************************/
+
+/*
+* Reconstrói o índice a partir da flash: lê só o cabeçalho de cada setor e
+* faz uma busca binária pela primeira página livre do setor mais recente.
+* Uma página gravada pela metade (queda de energia) conta como usada, e os
+* registros com CRC inválido dela são ignorados na leitura.
+* @return false se a geometria for inválida ou a leitura falhar
+*/
+bool flash_log_abrir(FlashLog *log, const OperacoesFlash *flash) {
+    if (flash->num_setores < 2 || flash->num_setores > FLASH_LOG_MAX_SETORES) {
+        return false;
+    }
+
+    memset(log, 0, sizeof(*log));
+    log->flash = flash;
+    log->proximo_apagado = SEM_SETOR;
+
+    uint16_t atual = SEM_SETOR;
+    for (uint16_t s = 0; s < flash->num_setores; s++) {
+        CabecalhoSetorLog cabecalho;
+        if (!flash->ler(flash->ctx, endereco_pagina(s, 0), &cabecalho, sizeof(cabecalho))) {
+            return false;
+        }
+        bool valido = cabecalho.magico == FLASH_LOG_MAGICO &&
+                      cabecalho.sequencia == ~cabecalho.sequencia_inv &&
+                      cabecalho.sequencia != 0;
+        log->sequencia[s] = valido ? cabecalho.sequencia : 0;
+        if (valido && (atual == SEM_SETOR || cabecalho.sequencia > log->sequencia[atual])) {
+            atual = s;
+        }
+    }
+
+    if (atual == SEM_SETOR) {
+        // Log vazio: o primeiro anexar abre (e apaga) o setor 0
+        log->setor_atual = flash->num_setores - 1;
+        log->pagina_atual = FLASH_LOG_PAGINAS_SETOR;
+        return true;
+    }
+
+    // Páginas são gravadas em ordem: as usadas formam um prefixo do setor
+    uint16_t inicio = 1, fim = FLASH_LOG_PAGINAS_SETOR;
+    while (inicio < fim) {
+        uint16_t meio = inicio + (fim - inicio) / 2;
+        if (pagina_livre(log, atual, meio)) {
+            fim = meio;
+        } else {
+            inicio = meio + 1;
+        }
+    }
+
+    log->setor_atual = atual;
+    log->pagina_atual = inicio;
+    if (inicio < FLASH_LOG_PAGINAS_SETOR) {
+        iniciar_buffer(log);
+    }
+    return true;
+}
+
+/*
+* Apaga toda a região e abre um log vazio
+*/
+bool flash_log_formatar(FlashLog *log, const OperacoesFlash *flash) {
+    for (uint16_t s = 0; s < flash->num_setores; s++) {
+        if (!flash->apagar(flash->ctx, (uint32_t)s * FLASH_LOG_TAM_SETOR)) {
+            return false;
+        }
+    }
+    return flash_log_abrir(log, flash);
+}
+
+/**********************************
+* ESCRITA
+**********************************/
+
+/*
+* Acrescenta um registro. Só copia para o buffer em RAM, exceto quando uma
+* página completa ainda não foi programada por flash_log_processar.
+* @param tipo Tipo definido pela aplicação (0 a 0xFE)
+* @param tamanho Até FLASH_LOG_MAX_DADOS bytes
+* @return false se o registro for inválido ou a flash falhar
+*/
+bool flash_log_anexar(FlashLog *log, uint8_t tipo, const void *dados, uint8_t tamanho) {
+    if (tipo == 0xFF || tamanho > FLASH_LOG_MAX_DADOS) {
+        return false;
+    }
+
+    uint32_t necessario = sizeof(CabecalhoRegistroLog) + ALINHAR4(tamanho);
+    bool ok = true;
+
+    if (log->pagina_atual < FLASH_LOG_PAGINAS_SETOR && log->ocupado + necessario > FLASH_LOG_TAM_PAGINA) {
+        ok = fechar_pagina(log);
+    }
+    if (log->pagina_atual >= FLASH_LOG_PAGINAS_SETOR) {
+        ok = abrir_proximo_setor(log) && ok;
+    }
+
+    CabecalhoRegistroLog cabecalho = {tamanho, tipo, crc_registro(tipo, tamanho, dados)};
+    memcpy(&log->buffer[log->ocupado], &cabecalho, sizeof(cabecalho));
+    memcpy(&log->buffer[log->ocupado + sizeof(cabecalho)], dados, tamanho);
+    log->ocupado += necessario;
+    return ok;
+}
+
+/*
+* Trabalho adiado: programa a página pendente e, perto do fim do setor,
+* apaga antecipadamente o próximo. Chamar no loop principal, fora de
+* trechos sensíveis a latência (cada operação trava o XIP).
+*/
+bool flash_log_processar(FlashLog *log) {
+    bool ok = programar_pendente(log);
+
+    uint16_t proximo = (log->setor_atual + 1) % log->flash->num_setores;
+    if (log->proximo_apagado == SEM_SETOR &&
+        log->pagina_atual + PAGINAS_ANTES_DE_APAGAR >= FLASH_LOG_PAGINAS_SETOR &&
+        log->sequencia[log->setor_atual] != 0) {
+        ok = apagar_setor(log, proximo) && ok;
+        log->proximo_apagado = proximo;
+    }
+    return ok;
+}
+
+/*
+* Grava imediatamente tudo o que está em RAM (ex.: antes de desligar).
+* A página parcial é fechada; os próximos registros vão para a seguinte.
+*/
+bool flash_log_sincronizar(FlashLog *log) {
+    bool ok = true;
+    uint16_t vazio = log->pagina_atual == 0 ? sizeof(CabecalhoSetorLog) : 0;
+    if (log->pagina_atual < FLASH_LOG_PAGINAS_SETOR && log->ocupado > vazio) {
+        ok = fechar_pagina(log);
+    }
+    return programar_pendente(log) && ok;
+}
+
+/**********************************
+* LEITURA
+**********************************/
+
+/*
+* Próximo setor em ordem de sequência após o que o iterador está lendo.
+* Seguir a sequência (e não a posição no anel) mantém a ordem mesmo se o log
+* girar durante uma leitura longa.
+* @return false se não há setor mais recente
+*/
+static bool avancar_setor(const FlashLog *log, IteradorLog *it) {
+    uint32_t melhor = 0;
+    for (uint16_t s = 0; s < log->flash->num_setores; s++) {
+        uint32_t seq = log->sequencia[s];
+        if (seq > it->sequencia && (melhor == 0 || seq < melhor)) {
+            melhor = seq;
+            it->setor = s;
+        }
+    }
+    if (melhor == 0) return false;
+    it->sequencia = melhor;
+    it->pagina = 0;
+    return true;
+}
+
+/*
+* Copia a próxima página com registros para o iterador: da flash, do buffer
+* pendente ou, no setor atual, da página ainda em preenchimento
+* @return false no fim do log ou em erro de leitura
+*/
+static bool carregar_pagina(const FlashLog *log, IteradorLog *it) {
+    for (;;) {
+        bool atual = it->setor == log->setor_atual;
+        uint16_t paginas = FLASH_LOG_PAGINAS_SETOR;
+        if (atual && log->pagina_atual < FLASH_LOG_PAGINAS_SETOR) {
+            paginas = log->pagina_atual + 1; // Inclui a página do buffer
+        }
+        if (it->sequencia == 0 || it->pagina >= paginas) {
+            if (!avancar_setor(log, it)) return false;
+            continue;
+        }
+
+        uint16_t p = it->pagina++;
+        uint32_t endereco = endereco_pagina(it->setor, p);
+        if (atual && p == log->pagina_atual) {
+            memcpy(it->pagina_dados, log->buffer, FLASH_LOG_TAM_PAGINA);
+        } else if (log->tem_pendente && endereco == log->endereco_pendente) {
+            memcpy(it->pagina_dados, log->pendente, FLASH_LOG_TAM_PAGINA);
+        } else if (!log->flash->ler(log->flash->ctx, endereco, it->pagina_dados, FLASH_LOG_TAM_PAGINA)) {
+            return false;
+        }
+        it->pos = p == 0 ? sizeof(CabecalhoSetorLog) : 0;
+        return true;
+    }
+}
+
+/*
+* Posiciona um iterador no registro mais antigo do log
+*/
+void flash_log_iniciar_leitura(const FlashLog *log, IteradorLog *it) {
+    (void)log;
+    it->sequencia = 0;
+    it->setor = 0;
+    it->pagina = 0;
+    it->pos = FLASH_LOG_TAM_PAGINA; // Força a carga da primeira página
+}
+
+/*
+* Lê o próximo registro válido. dados aponta para a cópia da página dentro
+* do iterador e vale até a chamada seguinte. Registros anexados depois que a
+* página em preenchimento foi copiada só aparecem em uma nova leitura.
+* @param tipo, dados, tamanho Saídas
+* @return false no fim do log
+*/
+bool flash_log_proximo(const FlashLog *log, IteradorLog *it,
+                       uint8_t *tipo, const void **dados, uint8_t *tamanho) {
+    for (;;) {
+        if (it->pos + sizeof(CabecalhoRegistroLog) <= FLASH_LOG_TAM_PAGINA) {
+            CabecalhoRegistroLog cabecalho;
+            memcpy(&cabecalho, &it->pagina_dados[it->pos], sizeof(cabecalho));
+            const uint8_t *carga = &it->pagina_dados[it->pos + sizeof(cabecalho)];
+
+            if (cabecalho.tamanho != 0xFF &&
+                it->pos + sizeof(cabecalho) + cabecalho.tamanho <= FLASH_LOG_TAM_PAGINA &&
+                crc_registro(cabecalho.tipo, cabecalho.tamanho, carga) == cabecalho.crc) {
+                it->pos += sizeof(cabecalho) + ALINHAR4(cabecalho.tamanho);
+                *tipo = cabecalho.tipo;
+                *dados = carga;
+                *tamanho = cabecalho.tamanho;
+                return true;
+            }
+            // Fim da página (ou página interrompida: o restante não é confiável)
+            it->pos = FLASH_LOG_TAM_PAGINA;
+        }
+        if (!carregar_pagina(log, it)) return false;
+    }
+}
+
+/*
+* Percorre todos os registros, do mais antigo ao mais recente, incluindo os
+* que ainda estão nos buffers em RAM
+* @return Número de registros visitados
+*/
+uint32_t flash_log_percorrer(FlashLog *log, flash_log_visitante_t visitante, void *ctx) {
+    IteradorLog it;
+    uint32_t total = 0;
+    uint8_t tipo, tamanho;
+    const void *dados;
+
+    flash_log_iniciar_leitura(log, &it);
+    while (flash_log_proximo(log, &it, &tipo, &dados, &tamanho)) {
+        total++;
+        if (!visitante(ctx, tipo, dados, tamanho)) break;
+    }
+    return total;
+}
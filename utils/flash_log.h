@@ -0,0 +1,86 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Geometria usada pelo log (a do flash QSPI do RP2040)
+#define FLASH_LOG_TAM_SETOR 4096     // Menor unidade de apagamento
+#define FLASH_LOG_TAM_PAGINA 256     // Unidade de programação
+#define FLASH_LOG_PAGINAS_SETOR (FLASH_LOG_TAM_SETOR / FLASH_LOG_TAM_PAGINA)
+#define FLASH_LOG_MAX_SETORES 64
+
+// Maior carga útil de um registro (registros não atravessam páginas)
+#define FLASH_LOG_MAX_DADOS (FLASH_LOG_TAM_PAGINA - sizeof(CabecalhoSetorLog) - sizeof(CabecalhoRegistroLog))
+
+// Acesso ao meio físico. Endereços relativos ao início da região do log.
+// programar recebe sempre uma página inteira e alinhada; apagar, um setor.
+// Como em flash NOR, programar só leva bits de 1 para 0 e apagar volta tudo a 0xFF.
+typedef struct {
+    bool (*ler)(void *ctx, uint32_t deslocamento, void *dados, uint32_t tamanho);
+    bool (*programar)(void *ctx, uint32_t deslocamento, const void *dados, uint32_t tamanho);
+    bool (*apagar)(void *ctx, uint32_t deslocamento);
+    void *ctx;
+    uint16_t num_setores;        // Tamanho da região (até FLASH_LOG_MAX_SETORES)
+} OperacoesFlash;
+
+// Primeiros bytes da primeira página de cada setor em uso
+#define FLASH_LOG_MAGICO 0x474F4C46u  // "FLOG"
+typedef struct {
+    uint32_t magico;
+    uint32_t sequencia;          // Cresce a cada setor aberto; o maior é o setor atual
+    uint32_t sequencia_inv;      // ~sequencia: detecta cabeçalho gravado pela metade
+} CabecalhoSetorLog;
+
+// Cabeçalho de cada registro; a carga útil segue, alinhada a 4 bytes.
+// tamanho == 0xFF (flash apagada) marca o fim dos registros da página.
+typedef struct {
+    uint8_t tamanho;             // Bytes de carga útil
+    uint8_t tipo;                // Definido pela aplicação (0xFF reservado)
+    uint16_t crc;                // CRC-16/CCITT de tipo, tamanho e carga útil
+} CabecalhoRegistroLog;
+
+// Estado do log em RAM: índice de setores reconstruído na abertura e buffers de
+// página. anexar só copia para RAM; a programação da página completa fica para
+// flash_log_processar, chamado fora do caminho crítico (programar trava o XIP).
+typedef struct {
+    const OperacoesFlash *flash;
+    uint32_t sequencia[FLASH_LOG_MAX_SETORES];  // 0 = setor livre
+    uint16_t setor_atual;
+    uint16_t pagina_atual;                      // Página em preenchimento no setor atual
+    uint16_t proximo_apagado;                   // Setor seguinte já apagado (ou 0xFFFF)
+
+    uint8_t buffer[FLASH_LOG_TAM_PAGINA];       // Página em preenchimento
+    uint16_t ocupado;                           // Bytes usados em buffer
+    uint8_t pendente[FLASH_LOG_TAM_PAGINA];     // Página completa aguardando programação
+    uint32_t endereco_pendente;
+    bool tem_pendente;
+
+    uint32_t programacoes;                      // Estatísticas
+    uint32_t apagamentos;
+} FlashLog;
+
+// Leitura incremental: permite consumir o log aos poucos (ex.: exportação
+// entremeada com o loop principal) sem percorrer tudo de uma vez
+typedef struct {
+    uint32_t sequencia;                         // Setor em leitura (0 = nenhum ainda)
+    uint16_t setor;
+    uint16_t pagina;                            // Próxima página a carregar
+    uint16_t pos;                               // Próximo registro em pagina_dados
+    uint8_t pagina_dados[FLASH_LOG_TAM_PAGINA];
+} IteradorLog;
+
+// Percorre os registros do mais antigo ao mais recente; retornar false interrompe
+typedef bool (*flash_log_visitante_t)(void *ctx, uint8_t tipo, const void *dados, uint8_t tamanho);
+
+bool flash_log_abrir(FlashLog *log, const OperacoesFlash *flash);
+bool flash_log_formatar(FlashLog *log, const OperacoesFlash *flash);
+bool flash_log_anexar(FlashLog *log, uint8_t tipo, const void *dados, uint8_t tamanho);
+bool flash_log_processar(FlashLog *log);
+bool flash_log_sincronizar(FlashLog *log);
+uint32_t flash_log_percorrer(FlashLog *log, flash_log_visitante_t visitante, void *ctx);
+void flash_log_iniciar_leitura(const FlashLog *log, IteradorLog *it);
+bool flash_log_proximo(const FlashLog *log, IteradorLog *it,
+                       uint8_t *tipo, const void **dados, uint8_t *tamanho);
+
+#endif // FLASH_LOG_H
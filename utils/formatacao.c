@@ -0,0 +1,79 @@
+#include "formatacao.h"
+
+static const uint16_t POTENCIAS_10[FORMATACAO_MAX_CASAS + 1] = {1, 10, 100, 1000, 10000};
+
+void texto_iniciar(Texto *t, char *buf, size_t cap) {
+    t->buf = buf;
+    t->tam = 0;
+    t->cap = cap > UINT16_MAX ? UINT16_MAX : (uint16_t)cap;
+    if (t->cap) buf[0] = '\0';
+}
+
+void texto_car(Texto *t, char c) {
+    if (t->tam + 1 >= t->cap) return;
+    t->buf[t->tam++] = c;
+    t->buf[t->tam] = '\0';
+}
+
+void texto_str(Texto *t, const char *s) {
+    if (!t->cap) return;
+    while (*s && t->tam + 1 < t->cap) t->buf[t->tam++] = *s++;
+    t->buf[t->tam] = '\0';
+}
+
+/*
+* Dígitos de valor, com pelo menos min_digitos (zeros à esquerda)
+* Monta de trás para frente num buffer local: uma divisão por dígito, que no
+* RP2040 vai para o divisor por hardware.
+*/
+static void texto_digitos(Texto *t, uint32_t valor, uint8_t min_digitos) {
+    char digitos[10];                   // 4294967295
+    uint8_t n = 0;
+    do {
+        uint32_t q = valor / 10;
+        digitos[n++] = (char)('0' + (valor - q * 10));
+        valor = q;
+    } while (valor || n < min_digitos);
+    if (!t->cap) return;
+    while (n && t->tam + 1 < t->cap) t->buf[t->tam++] = digitos[--n];
+    t->buf[t->tam] = '\0';
+}
+
+void texto_natural(Texto *t, uint32_t valor) {
+    texto_digitos(t, valor, 1);
+}
+
+void texto_inteiro(Texto *t, int32_t valor) {
+    if (valor < 0) texto_car(t, '-');
+    texto_digitos(t, valor < 0 ? 0u - (uint32_t)valor : (uint32_t)valor, 1);
+}
+
+// Magnitude já escalada: parte inteira, ponto e casas com zeros à esquerda
+static void texto_fixo_magnitude(Texto *t, uint32_t magnitude, uint8_t casas) {
+    uint32_t escala = POTENCIAS_10[casas];
+    uint32_t inteira = magnitude / escala;
+    texto_digitos(t, inteira, 1);
+    if (casas) {
+        texto_car(t, '.');
+        texto_digitos(t, magnitude - inteira * escala, casas);
+    }
+}
+
+void texto_fixo(Texto *t, int32_t valor, uint8_t casas) {
+    if (casas > FORMATACAO_MAX_CASAS) casas = FORMATACAO_MAX_CASAS;
+    if (valor < 0) texto_car(t, '-');
+    texto_fixo_magnitude(t, valor < 0 ? 0u - (uint32_t)valor : (uint32_t)valor, casas);
+}
+
+void texto_q15(Texto *t, q15_t valor, uint8_t casas) {
+    if (casas > FORMATACAO_MAX_CASAS) casas = FORMATACAO_MAX_CASAS;
+    uint32_t abs = valor < 0 ? 0u - (uint32_t)valor : (uint32_t)valor;
+    uint32_t magnitude = (uint32_t)(((uint64_t)abs * POTENCIAS_10[casas] + Q15_UM / 2) >> 15);
+    if (valor < 0 && magnitude) texto_car(t, '-');  // Sem "-0.00"
+    texto_fixo_magnitude(t, magnitude, casas);
+}
+
+void texto_percentual(Texto *t, uint32_t valor) {
+    texto_digitos(t, valor, 1);
+    texto_car(t, '%');
+}
@@ -0,0 +1,39 @@
+#ifndef FORMATACAO_H
+#define FORMATACAO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "utils/espectral.h"
+
+// Números das telas sem printf: inteiros, ponto fixo com N casas e
+// percentuais escritos direto no buffer do chamador, sem varargs, locale
+// nem float. Cada função acrescenta ao texto; o que não couber é cortado e
+// o buffer fica sempre terminado em '\0'.
+
+#define FORMATACAO_MAX_CASAS 4
+
+typedef struct {
+    char *buf;
+    uint16_t tam;                       // Caracteres escritos, sem o '\0'
+    uint16_t cap;                       // Tamanho do buffer, com o '\0'
+} Texto;
+
+void texto_iniciar(Texto *t, char *buf, size_t cap);
+void texto_str(Texto *t, const char *s);
+void texto_car(Texto *t, char c);
+void texto_natural(Texto *t, uint32_t valor);
+void texto_inteiro(Texto *t, int32_t valor);
+
+/*
+* Ponto fixo decimal: valor em unidades de 10^-casas (53 com 2 casas = "0.53")
+* @param casas Até FORMATACAO_MAX_CASAS; 0 escreve só a parte inteira
+*/
+void texto_fixo(Texto *t, int32_t valor, uint8_t casas);
+
+// Q15 com casas decimais, arredondado (metade para longe do zero)
+void texto_q15(Texto *t, q15_t valor, uint8_t casas);
+
+// valor seguido de '%'
+void texto_percentual(Texto *t, uint32_t valor);
+
+#endif // FORMATACAO_H
@@ -0,0 +1,239 @@
+#include "gravacao.h"
+#include <string.h>
+
+// Marcadores dos registros
+#define REG_PASSOS 0x00      // 0nnnnnnn
+#define REG_BOTOES 0x80      // 10000mmm
+#define REG_JOYSTICK 0x90    // 1001xxxx
+#define REG_PERIODO 0xA0     // 1010cxxx
+#define REG_FIM 0xFF
+
+#define TAM_CABECALHO 3
+#define TAM_FIM 3
+#define MAX_PASSOS_REGISTRO 128
+
+// Pior caso de um passo: período (1 + varint de 5), duas leituras do joystick
+// (escaneamento lê de novo no tick), botões e o registro de passos
+#define MAX_BYTES_PASSO (6 + 2 * 4 + 1 + 1)
+
+static const uint8_t CABECALHO[TAM_CABECALHO] = {'G', 'E', GRAVACAO_VERSAO};
+
+/**********************************
+* GRAVAÇÃO
+**********************************/
+
+static void escrever(GravacaoEntradas *g, uint8_t byte) {
+    g->dados[g->tamanho++] = byte;
+}
+
+// Passos acumulados viram um registro antes de qualquer outro
+static void descarregar_passos(GravacaoEntradas *g) {
+    if (g->passos_pendentes) {
+        escrever(g, REG_PASSOS | (g->passos_pendentes - 1));
+        g->passos_pendentes = 0;
+    }
+}
+
+/*
+* Começa uma gravação nova, descartando a anterior
+*/
+void gravacao_iniciar(GravacaoEntradas *g) {
+    gravacao_limpar(g);
+    memcpy(g->dados, CABECALHO, TAM_CABECALHO);
+    g->tamanho = TAM_CABECALHO;
+    g->joy_x = g->joy_y = 0xFFFF;   // Fora da faixa do ADC: a primeira leitura é gravada
+    g->modo = GRAVACAO_GRAVANDO;
+}
+
+/*
+* Fecha um passo do loop na gravação
+* @param duracao_ms Tempo desde o fim do passo anterior
+* @return false se não cabe mais um passo: o chamador deve finalizar
+*/
+bool gravacao_terminar_passo(GravacaoEntradas *g, uint32_t duracao_ms) {
+    if (g->modo != GRAVACAO_GRAVANDO) return false;
+
+    if (duracao_ms != g->periodo_ms) {
+        descarregar_passos(g);
+        // 3 bits no marcador, depois 7 bits por byte; bit alto = continua
+        uint32_t v = duracao_ms;
+        escrever(g, REG_PERIODO | (v & 0x07) | (v > 0x07 ? 0x08 : 0));
+        v >>= 3;
+        while (v) {
+            escrever(g, (v & 0x7F) | (v > 0x7F ? 0x80 : 0));
+            v >>= 7;
+        }
+        g->periodo_ms = duracao_ms;
+    }
+
+    if (++g->passos_pendentes == MAX_PASSOS_REGISTRO) {
+        descarregar_passos(g);
+    }
+    g->passos++;
+    g->tempo_ms += duracao_ms;
+    return g->tamanho + MAX_BYTES_PASSO + TAM_FIM <= GRAVACAO_TAM_MAX;
+}
+
+/*
+* Encerra a gravação com o resumo do estado final, que a reprodução confere
+*/
+void gravacao_finalizar(GravacaoEntradas *g, uint16_t resumo) {
+    if (g->modo != GRAVACAO_GRAVANDO) return;
+    descarregar_passos(g);
+    escrever(g, REG_FIM);
+    escrever(g, (uint8_t)resumo);
+    escrever(g, (uint8_t)(resumo >> 8));
+    g->resumo = resumo;
+    g->modo = GRAVACAO_PARADA;
+}
+
+/**********************************
+* REPRODUÇÃO
+**********************************/
+
+/*
+* Os dados formam uma gravação completa, com pelo menos um passo?
+*/
+bool gravacao_valida(const GravacaoEntradas *g) {
+    return g->modo != GRAVACAO_GRAVANDO && g->tamanho > TAM_CABECALHO + TAM_FIM &&
+           memcmp(g->dados, CABECALHO, TAM_CABECALHO) == 0 &&
+           g->dados[g->tamanho - TAM_FIM] == REG_FIM;
+}
+
+/*
+* Começa a reproduzir os dados carregados
+* @return false se não há uma gravação completa e válida
+*/
+bool gravacao_reproduzir(GravacaoEntradas *g) {
+    if (!gravacao_valida(g)) return false;
+    g->pos = TAM_CABECALHO;
+    g->passos_pendentes = 0;
+    g->joy_x = g->joy_y = 0;
+    g->periodo_ms = 0;
+    g->passos = 0;
+    g->tempo_ms = 0;
+    g->resumo = g->dados[g->tamanho - 2] | (g->dados[g->tamanho - 1] << 8);
+    g->modo = GRAVACAO_REPRODUZINDO;
+    return true;
+}
+
+// Próximo registro é do tipo dado? Só no começo de um passo ainda não lido
+static bool proximo_e(const GravacaoEntradas *g, uint8_t mascara, uint8_t marcador) {
+    return g->passos_pendentes == 0 && g->pos < g->tamanho &&
+           g->dados[g->pos] != REG_FIM && (g->dados[g->pos] & mascara) == marcador;
+}
+
+/*
+* Fecha um passo do loop na reprodução
+* @return false quando este foi o último passo gravado (ou os dados estão
+*         corrompidos); o modo volta a GRAVACAO_PARADA
+*/
+bool gravacao_avancar_passo(GravacaoEntradas *g) {
+    if (g->modo != GRAVACAO_REPRODUZINDO) return false;
+
+    if (g->passos_pendentes == 0) {
+        // Durações dos passos, depois o registro de passos
+        while (proximo_e(g, 0xF0, REG_PERIODO)) {
+            uint8_t marcador = g->dados[g->pos++];
+            uint32_t v = marcador & 0x07;
+            uint8_t deslocamento = 3;
+            bool continua = marcador & 0x08;
+            while (continua && g->pos < g->tamanho && deslocamento < 32) {
+                uint8_t byte = g->dados[g->pos++];
+                v |= (uint32_t)(byte & 0x7F) << deslocamento;
+                deslocamento += 7;
+                continua = byte & 0x80;
+            }
+            g->periodo_ms = v;
+        }
+        if (!proximo_e(g, 0x80, REG_PASSOS)) {
+            g->modo = GRAVACAO_PARADA;
+            return false;
+        }
+        g->passos_pendentes = (g->dados[g->pos++] & 0x7F) + 1;
+    }
+
+    g->passos_pendentes--;
+    g->passos++;
+    g->tempo_ms += g->periodo_ms;
+
+    // A gravação termina logo depois do último passo
+    if (g->passos_pendentes == 0 && g->pos < g->tamanho && g->dados[g->pos] == REG_FIM) {
+        g->modo = GRAVACAO_PARADA;
+        return false;
+    }
+    return true;
+}
+
+/**********************************
+* ENTRADAS
+**********************************/
+
+/*
+* Leitura do joystick (após a zona morta). Gravando, registra quando muda;
+* reproduzindo, substitui pelos valores gravados.
+*/
+void gravacao_joystick(GravacaoEntradas *g, uint16_t *x, uint16_t *y) {
+    if (g->modo == GRAVACAO_GRAVANDO) {
+        if (*x == g->joy_x && *y == g->joy_y) return;
+        descarregar_passos(g);
+        escrever(g, REG_JOYSTICK | ((*x >> 8) & 0x0F));
+        escrever(g, (uint8_t)*x);
+        escrever(g, (uint8_t)(*y >> 8));
+        escrever(g, (uint8_t)*y);
+        g->joy_x = *x;
+        g->joy_y = *y;
+    } else if (g->modo == GRAVACAO_REPRODUZINDO) {
+        if (proximo_e(g, 0xF0, REG_JOYSTICK) && g->pos + 4 <= g->tamanho) {
+            const uint8_t *r = &g->dados[g->pos];
+            g->joy_x = ((r[0] & 0x0F) << 8) | r[1];
+            g->joy_y = ((r[2] & 0x0F) << 8) | r[3];
+            g->pos += 4;
+        }
+        *x = g->joy_x;
+        *y = g->joy_y;
+    }
+}
+
+/*
+* Botões consumidos pelo loop no passo atual
+*/
+void gravacao_botoes(GravacaoEntradas *g, uint8_t *mascara) {
+    if (g->modo == GRAVACAO_GRAVANDO) {
+        if (*mascara == 0) return;
+        descarregar_passos(g);
+        escrever(g, REG_BOTOES | (*mascara & 0x07));
+    } else if (g->modo == GRAVACAO_REPRODUZINDO) {
+        *mascara = 0;
+        if (proximo_e(g, 0xF8, REG_BOTOES)) {
+            *mascara = g->dados[g->pos++] & 0x07;
+        }
+    }
+}
+
+/**********************************
+* CARGA E DESCARGA
+**********************************/
+
+void gravacao_limpar(GravacaoEntradas *g) {
+    g->tamanho = 0;
+    g->pos = 0;
+    g->modo = GRAVACAO_PARADA;
+    g->passos_pendentes = 0;
+    g->joy_x = g->joy_y = 0;
+    g->periodo_ms = 0;
+    g->passos = 0;
+    g->tempo_ms = 0;
+    g->resumo = 0;
+}
+
+/*
+* Acrescenta bytes de uma gravação recebida de fora
+* @return false se não cabe
+*/
+bool gravacao_acrescentar(GravacaoEntradas *g, const uint8_t *dados, uint16_t tamanho) {
+    if (g->modo != GRAVACAO_PARADA || tamanho > GRAVACAO_TAM_MAX - g->tamanho) return false;
+    memcpy(&g->dados[g->tamanho], dados, tamanho);
+    g->tamanho += tamanho;
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef GRAVACAO_H
+#define GRAVACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Gravação e reprodução das entradas do usuário (joystick e botões), para
+// reproduzir relatos de campo e servir de teste de regressão e benchmark
+// dos fluxos da interface.
+//
+// A gravação segue a ordem em que o loop principal consome as entradas, não
+// o relógio: na reprodução, cada leitura do joystick e cada verificação dos
+// botões recebe exatamente o que recebeu na gravação, no mesmo passo do loop.
+// Assim a FSM percorre os mesmos estados mesmo reproduzindo sem as esperas.
+//
+// Formato (bytes), depois do cabeçalho 'G' 'E' versão:
+//   0nnnnnnn           n + 1 passos do loop sem entradas novas
+//   10000mmm           botões consumidos no passo (bit 0 A, 1 B, 2 joystick)
+//   1001xxxx xx yy yy  nova leitura do joystick: x e y de 12 bits (x alto primeiro)
+//   1010cxxx [varint]  duração dos passos seguintes em ms: 3 bits baixos aqui e,
+//                      se c, mais 7 bits por byte (bit 7 = continua)
+//   11111111 rr rr     fim, com o resumo do estado final (LE)
+#define GRAVACAO_TAM_MAX 4096
+#define GRAVACAO_VERSAO 1
+
+// Bits da máscara de botões
+#define GRAVACAO_BOTAO_A (1u << 0)
+#define GRAVACAO_BOTAO_B (1u << 1)
+#define GRAVACAO_BOTAO_JOYSTICK (1u << 2)
+
+typedef enum {
+    GRAVACAO_PARADA,
+    GRAVACAO_GRAVANDO,
+    GRAVACAO_REPRODUZINDO
+} ModoGravacao;
+
+typedef struct {
+    uint8_t dados[GRAVACAO_TAM_MAX];
+    uint16_t tamanho;            // Bytes válidos em dados
+    uint16_t pos;                // Próximo byte a ler na reprodução
+    ModoGravacao modo;
+
+    uint8_t passos_pendentes;    // Gravação: passos ainda não escritos
+                                 // Reprodução: passos restantes do registro atual
+    uint16_t joy_x, joy_y;       // Última leitura gravada ou reproduzida
+    uint32_t periodo_ms;         // Duração atual dos passos
+    uint32_t passos;             // Passos gravados ou reproduzidos
+    uint32_t tempo_ms;           // Soma das durações dos passos
+    uint16_t resumo;             // Resumo do estado final (depois do fim)
+} GravacaoEntradas;
+
+// Gravação
+void gravacao_iniciar(GravacaoEntradas *g);
+bool gravacao_terminar_passo(GravacaoEntradas *g, uint32_t duracao_ms);
+void gravacao_finalizar(GravacaoEntradas *g, uint16_t resumo);
+
+// Reprodução
+bool gravacao_valida(const GravacaoEntradas *g);
+bool gravacao_reproduzir(GravacaoEntradas *g);
+bool gravacao_avancar_passo(GravacaoEntradas *g);
+
+// Entradas: gravam o valor lido ou o substituem pelo gravado
+void gravacao_joystick(GravacaoEntradas *g, uint16_t *x, uint16_t *y);
+void gravacao_botoes(GravacaoEntradas *g, uint8_t *mascara);
+
+// Carga e descarga dos dados (ex.: pelo console)
+void gravacao_limpar(GravacaoEntradas *g);
+bool gravacao_acrescentar(GravacaoEntradas *g, const uint8_t *dados, uint16_t tamanho);
+
+#endif // GRAVACAO_H
@@ -0,0 +1,185 @@
+#include "maquina_estados.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "utils/rastreio.h"
+
+/*
+* Inicializa a máquina de estados a partir das tabelas de estados e transições
+* @param fsm Instância a ser inicializada
+* @param estados Tabela de estados, indexada pelo identificador do estado
+* @param transicoes Tabela de transições (origem, evento) -> destino
+* @param inicial Estado ativado ao final da inicialização
+*/
+void fsm_init(MaquinaEstados *fsm,
+              const DefEstado *estados, uint8_t num_estados,
+              const Transicao *transicoes, uint8_t num_transicoes,
+              fsm_estado_t inicial) {
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->estados = estados;
+    fsm->num_estados = num_estados;
+    fsm->transicoes = transicoes;
+
+    // Monta o mapa (estado, evento) -> transição para busca em O(1)
+    memset(fsm->mapa, FSM_SEM_TRANSICAO, sizeof(fsm->mapa));
+    for (uint8_t i = 0; i < num_transicoes; i++) {
+        const Transicao *t = &transicoes[i];
+        if (t->origem < FSM_MAX_ESTADOS && t->evento < FSM_MAX_EVENTOS) {
+            fsm->mapa[t->origem][t->evento] = i;
+        }
+    }
+
+    fsm->atual = inicial;
+    fsm->entrada_us = time_us_64();
+    fsm->metricas[inicial].entradas = 1;
+    if (estados[inicial].entrar) {
+        estados[inicial].entrar();
+    }
+}
+
+/*
+* Enfileira um evento para ser processado no próximo passo
+* @return false se a fila estiver cheia (evento descartado)
+*/
+bool fsm_postar(MaquinaEstados *fsm, fsm_evento_t evento) {
+    if (fsm->fila_tamanho >= FSM_TAM_FILA) {
+        fsm->eventos_perdidos++;
+        return false;
+    }
+    uint8_t pos = (fsm->fila_inicio + fsm->fila_tamanho) % FSM_TAM_FILA;
+    fsm->fila[pos] = evento;
+    fsm->fila_tamanho++;
+    return true;
+}
+
+/*
+* Executa a transição associada ao evento no estado atual, se existir
+*/
+static void fsm_despachar(MaquinaEstados *fsm, fsm_evento_t evento) {
+    if (evento >= FSM_MAX_EVENTOS) {
+        fsm->eventos_ignorados++;
+        return;
+    }
+
+    uint8_t indice = fsm->mapa[fsm->atual][evento];
+    if (indice == FSM_SEM_TRANSICAO) {
+        fsm->eventos_ignorados++;
+        return;
+    }
+
+    const Transicao *t = &fsm->transicoes[indice];
+
+    // Transição interna: apenas a ação, sem trocar de estado
+    if (t->destino == FSM_INTERNA) {
+        if (t->acao) t->acao();
+        return;
+    }
+
+    RASTREIO_ESCOPO(PONTO_FSM_TRANSICAO);
+    uint64_t inicio = time_us_64();
+    const DefEstado *origem = &fsm->estados[fsm->atual];
+    const DefEstado *destino = &fsm->estados[t->destino];
+
+    if (origem->sair) origem->sair();
+    fsm->metricas[fsm->atual].tempo_total_us += inicio - fsm->entrada_us;
+
+    if (t->acao) t->acao();
+
+    fsm->atual = t->destino;
+    fsm->total_transicoes++;
+    fsm->metricas[t->destino].entradas++;
+    if (destino->entrar) destino->entrar();
+
+    // Latência da transição: sair + ação + entrar
+    uint64_t fim = time_us_64();
+    uint32_t latencia = (uint32_t)(fim - inicio);
+    if (latencia > fsm->metricas[t->destino].pior_transicao_us) {
+        fsm->metricas[t->destino].pior_transicao_us = latencia;
+    }
+    fsm->entrada_us = fim;
+}
+
+/*
+* Processa todos os eventos pendentes, na ordem em que foram postados.
+* Eventos postados pelos próprios handlers entram no fim da fila.
+*/
+void fsm_processar_eventos(MaquinaEstados *fsm) {
+    while (fsm->fila_tamanho > 0) {
+        fsm_evento_t evento = fsm->fila[fsm->fila_inicio];
+        fsm->fila_inicio = (fsm->fila_inicio + 1) % FSM_TAM_FILA;
+        fsm->fila_tamanho--;
+        fsm_despachar(fsm, evento);
+    }
+}
+
+/*
+* Executa o tick do estado atual e registra sua duração
+*/
+void fsm_tick(MaquinaEstados *fsm) {
+    const DefEstado *estado = &fsm->estados[fsm->atual];
+    MetricasEstado *m = &fsm->metricas[fsm->atual];
+
+    m->ticks++;
+    if (!estado->tick) return;
+
+    uint64_t inicio = time_us_64();
+    RASTREIO_INICIO(PONTO_FSM_TICK);
+    estado->tick();
+    RASTREIO_FIM(PONTO_FSM_TICK);
+    uint32_t duracao = (uint32_t)(time_us_64() - inicio);
+    if (duracao > m->pior_tick_us) {
+        m->pior_tick_us = duracao;
+    }
+}
+
+fsm_estado_t fsm_estado_atual(const MaquinaEstados *fsm) {
+    return fsm->atual;
+}
+
+uint16_t fsm_periodo_atual(const MaquinaEstados *fsm) {
+    return fsm->estados[fsm->atual].periodo_ms;
+}
+
+const MetricasEstado *fsm_metricas(const MaquinaEstados *fsm, fsm_estado_t estado) {
+    return &fsm->metricas[estado];
+}
+
+/*
+* Zera a instrumentação sem alterar o estado atual
+*/
+void fsm_zerar_metricas(MaquinaEstados *fsm) {
+    memset(fsm->metricas, 0, sizeof(fsm->metricas));
+    fsm->total_transicoes = 0;
+    fsm->eventos_ignorados = 0;
+    fsm->eventos_perdidos = 0;
+    fsm->entrada_us = time_us_64();
+}
+
+/*
+* Imprime pela serial o tempo em cada estado, contagens e piores latências
+*/
+void fsm_imprimir_metricas(const MaquinaEstados *fsm) {
+    uint64_t agora = time_us_64();
+
+    printf("FSM: %lu transicoes, %lu eventos ignorados, %lu perdidos\n",
+           (unsigned long)fsm->total_transicoes,
+           (unsigned long)fsm->eventos_ignorados,
+           (unsigned long)fsm->eventos_perdidos);
+    printf("%-24s %8s %10s %10s %12s %12s\n",
+           "estado", "entradas", "ticks", "tempo_ms", "pior_tick_us", "pior_trans_us");
+
+    for (uint8_t i = 0; i < fsm->num_estados; i++) {
+        const MetricasEstado *m = &fsm->metricas[i];
+        uint64_t tempo = m->tempo_total_us;
+        if (i == fsm->atual) {
+            tempo += agora - fsm->entrada_us; // Inclui a permanência em curso
+        }
+        printf("%-24s %8lu %10lu %10lu %12lu %12lu\n",
+               fsm->estados[i].nome,
+               (unsigned long)m->entradas,
+               (unsigned long)m->ticks,
+               (unsigned long)(tempo / 1000),
+               (unsigned long)m->pior_tick_us,
+               (unsigned long)m->pior_transicao_us);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef MAQUINA_ESTADOS_H
+#define MAQUINA_ESTADOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Limites da máquina de estados
+#define FSM_MAX_ESTADOS 16
+#define FSM_MAX_EVENTOS 16
+#define FSM_TAM_FILA 8        // Eventos pendentes aguardando processamento
+
+// Destino especial: executa apenas a ação da transição, sem sair/entrar no estado
+#define FSM_INTERNA 0xFE
+#define FSM_SEM_TRANSICAO 0xFF
+
+typedef uint8_t fsm_estado_t;
+typedef uint8_t fsm_evento_t;
+typedef void (*fsm_handler_t)(void);
+
+// Definição de um estado (qualquer handler pode ser NULL)
+typedef struct {
+    const char *nome;          // Nome usado nos relatórios
+    fsm_handler_t entrar;      // Executado ao entrar no estado
+    fsm_handler_t sair;        // Executado ao sair do estado
+    fsm_handler_t tick;        // Executado a cada passo do loop principal
+    uint16_t periodo_ms;       // Espera entre ticks (0 = loop livre)
+} DefEstado;
+
+// Transição disparada por evento: (origem, evento) -> destino, com ação opcional
+typedef struct {
+    fsm_estado_t origem;
+    fsm_evento_t evento;
+    fsm_estado_t destino;      // FSM_INTERNA para ação sem troca de estado
+    fsm_handler_t acao;        // Executada entre sair() da origem e entrar() do destino
+} Transicao;
+
+// Instrumentação acumulada por estado
+typedef struct {
+    uint32_t entradas;           // Vezes que o estado foi ativado
+    uint32_t ticks;              // Ticks executados
+    uint64_t tempo_total_us;     // Tempo total permanecido no estado
+    uint32_t pior_tick_us;       // Maior duração de um tick
+    uint32_t pior_transicao_us;  // Maior latência de uma transição que entrou neste estado
+} MetricasEstado;
+
+typedef struct {
+    const DefEstado *estados;
+    uint8_t num_estados;
+    const Transicao *transicoes;
+    uint8_t mapa[FSM_MAX_ESTADOS][FSM_MAX_EVENTOS]; // Índice da transição por (estado, evento)
+
+    fsm_estado_t atual;
+    uint64_t entrada_us;         // Instante em que o estado atual foi ativado
+
+    // Fila circular de eventos pendentes
+    fsm_evento_t fila[FSM_TAM_FILA];
+    uint8_t fila_inicio;
+    uint8_t fila_tamanho;
+
+    // Instrumentação
+    MetricasEstado metricas[FSM_MAX_ESTADOS];
+    uint32_t total_transicoes;
+    uint32_t eventos_ignorados;  // Eventos sem transição no estado atual
+    uint32_t eventos_perdidos;   // Eventos descartados por fila cheia
+} MaquinaEstados;
+
+// Inicialização (executa entrar() do estado inicial)
+void fsm_init(MaquinaEstados *fsm,
+              const DefEstado *estados, uint8_t num_estados,
+              const Transicao *transicoes, uint8_t num_transicoes,
+              fsm_estado_t inicial);
+
+// Eventos
+bool fsm_postar(MaquinaEstados *fsm, fsm_evento_t evento);
+void fsm_processar_eventos(MaquinaEstados *fsm);
+
+// Execução
+void fsm_tick(MaquinaEstados *fsm);
+fsm_estado_t fsm_estado_atual(const MaquinaEstados *fsm);
+uint16_t fsm_periodo_atual(const MaquinaEstados *fsm);
+
+// Instrumentação
+const MetricasEstado *fsm_metricas(const MaquinaEstados *fsm, fsm_estado_t estado);
+void fsm_zerar_metricas(MaquinaEstados *fsm);
+void fsm_imprimir_metricas(const MaquinaEstados *fsm);
+
+#endif // MAQUINA_ESTADOS_H
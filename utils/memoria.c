@@ -0,0 +1,79 @@
+#include "memoria.h"
+#include <stdio.h>
+
+#ifdef __arm__
+#include <malloc.h>
+#include "hardware/regs/addressmap.h"
+
+// Símbolos do linker script do pico-sdk (memmap_default.ld)
+extern uint32_t __scratch_x_end__, __scratch_y_end__;
+extern uint32_t __StackOneTop, __StackTop;
+extern char __data_start__, __data_end__, __bss_start__, __bss_end__, __end__, __HeapLimit;
+
+void memoria_pintar_pilhas(void) {
+    uint32_t *sp;
+    __asm volatile("mov %0, sp" : "=r"(sp));
+
+    // Núcleo 0: da base do banco até um pouco abaixo do quadro atual
+    for (uint32_t *p = &__scratch_y_end__; p < sp - MEMORIA_FOLGA_PILHA / 4; p++) *p = MEMORIA_PADRAO_PILHA;
+    // Núcleo 1: o banco inteiro (ainda não lançado)
+    for (uint32_t *p = &__scratch_x_end__; p < &__StackOneTop; p++) *p = MEMORIA_PADRAO_PILHA;
+}
+
+static UsoPilha medir_pilha(const uint32_t *base, const uint32_t *topo) {
+    const uint32_t *p = base;
+    while (p < topo && *p == MEMORIA_PADRAO_PILHA) p++;
+    return (UsoPilha){
+        .capacidade = (uint32_t)(topo - base) * 4,
+        .usado_max = (uint32_t)(topo - p) * 4,
+        .estourou = *base != MEMORIA_PADRAO_PILHA,
+    };
+}
+
+bool memoria_medir(UsoMemoria *uso) {
+    struct mallinfo heap = mallinfo();  // arena: bytes já tirados do sistema pelo malloc
+    uso->ram_total = (uint32_t)(&__HeapLimit - (char *)SRAM_BASE);
+    uso->dados = (uint32_t)(&__data_end__ - &__data_start__);
+    uso->bss = (uint32_t)(&__bss_end__ - &__bss_start__);
+    uso->heap_usado = (uint32_t)heap.arena;
+    uso->heap_livre = (uint32_t)(&__HeapLimit - &__end__) - uso->heap_usado;
+    uso->pilha[0] = medir_pilha(&__scratch_y_end__, &__StackTop);
+    uso->pilha[1] = medir_pilha(&__scratch_x_end__, &__StackOneTop);
+    return true;
+}
+
+#else
+
+// Host: o simulador não tem o mapa de memória do RP2040
+void memoria_pintar_pilhas(void) {}
+
+bool memoria_medir(UsoMemoria *uso) {
+    return false;
+}
+
+#endif
+
+static unsigned long pct(uint32_t parte, uint32_t total) {
+    return total ? (unsigned long)((uint64_t)parte * 100 / total) : 0;
+}
+
+void memoria_relatorio(void) {
+    UsoMemoria uso;
+    if (!memoria_medir(&uso)) {
+        printf("memoria: disponivel so no RP2040\n");
+        return;
+    }
+    printf("ram principal=%lu bytes: dados=%lu bss=%lu heap=%lu livre=%lu (%lu%%)\n",
+           (unsigned long)uso.ram_total, (unsigned long)uso.dados, (unsigned long)uso.bss,
+           (unsigned long)uso.heap_usado, (unsigned long)uso.heap_livre, pct(uso.heap_livre, uso.ram_total));
+    for (int n = 0; n < 2; n++) {
+        const UsoPilha *p = &uso.pilha[n];
+        if (p->usado_max == 0) {
+            printf("pilha nucleo %d: sem uso (%lu bytes)\n", n, (unsigned long)p->capacidade);
+            continue;
+        }
+        printf("pilha nucleo %d: max=%lu de %lu bytes (%lu%%)%s\n", n, (unsigned long)p->usado_max,
+               (unsigned long)p->capacidade, pct(p->usado_max, p->capacidade),
+               p->estourou ? " ESTOURO" : "");
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Orçamento de RAM em execução (RP2040): dados estáticos, heap e o pico de
+// uso das pilhas dos dois núcleos.
+//
+// As pilhas ficam nos bancos SCRATCH_Y (núcleo 0) e SCRATCH_X (núcleo 1),
+// acima do código/dados que o linker põe nesses bancos. memoria_pintar_pilhas
+// preenche a parte livre com MEMORIA_PADRAO_PILHA no boot; a marca d'água é o
+// endereço mais baixo que perdeu o padrão. O núcleo 1 não é usado pelo
+// firmware hoje: a pilha dele aparece intacta até alguém lançá-lo.
+//
+// O uso por módulo, em tempo de compilação, vem do mapa do linker
+// (relatorio_ram.cmake, rodado após cada build do firmware).
+
+#define MEMORIA_PADRAO_PILHA 0xDEADBEEFu
+#define MEMORIA_FOLGA_PILHA 64          // Bytes abaixo do sp atual que não são pintados
+
+typedef struct {
+    uint32_t capacidade;                // Bytes do banco disponíveis para a pilha
+    uint32_t usado_max;                 // Marca d'água
+    bool estourou;                      // Padrão perdido na base do banco
+} UsoPilha;
+
+typedef struct {
+    uint32_t ram_total;                 // RAM principal (sem os bancos SCRATCH)
+    uint32_t dados, bss;                // .data (inclui código em RAM) e .bss
+    uint32_t heap_usado, heap_livre;    // Arena do malloc (stdio) e o que resta até o fim da RAM
+    UsoPilha pilha[2];
+} UsoMemoria;
+
+// Chamar cedo no boot, no núcleo 0, antes de lançar o núcleo 1
+void memoria_pintar_pilhas(void);
+
+// @return false no host (sem o mapa de memória do RP2040)
+bool memoria_medir(UsoMemoria *uso);
+
+void memoria_relatorio(void);
+
+#endif // MEMORIA_H
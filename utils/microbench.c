@@ -0,0 +1,274 @@
+#include "microbench.h"
+#include <stdio.h>
+#include <string.h>
+#include "lib/neopixel.h"
+#include "lib/ssd1306.h"
+#include "utils/aleatorio.h"
+#include "utils/deteccao.h"
+#include "utils/espectral.h"
+#include "utils/formatacao.h"
+#include "utils/plantas.h"
+
+// Consome os resultados para o compilador não eliminar as chamadas
+static volatile uint32_t sumidouro;
+
+// Quadro próprio: os casos de desenho não tocam a tela em uso
+static ssd1306_t quadro;
+
+/**********************************
+* CASOS
+**********************************/
+
+static void bench_pixel(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        ssd1306_pixel(&quadro, i & (WIDTH - 1), (i >> 7) & (HEIGHT - 1), (i >> 13) & 1);
+    }
+}
+
+static void bench_fill_apagar(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_fill(&quadro, false);
+}
+
+static void bench_fill_preencher(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_fill(&quadro, true);
+}
+
+static void bench_string_curta(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_draw_string(&quadro, "NDVI:0.53", 0, 32);
+}
+
+static void bench_string_linha(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_draw_string(&quadro, "FIL 12 COL 34 OK", 0, 0);
+}
+
+static void bench_string_especiais(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_draw_string(&quadro, "R:70% $12 >1/5", 0, 16);
+}
+
+static void bench_string_acentos(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_draw_string(&quadro, "SAUDÁVEL JÁ", 0, 24);
+}
+
+static void bench_string_compacta(uint32_t n) {
+    ssd1306_set_font(&quadro, &font_5x7);
+    for (uint32_t i = 0; i < n; i++) ssd1306_draw_string(&quadro, "PLANO 1/3 F12C34 87%", 0, 40);
+    ssd1306_set_font(&quadro, &font_8x8);
+}
+
+static void bench_rect_8x8(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_rect(&quadro, 28, i & 0x7F & ~7u, 8, 8, true, false);
+}
+
+static void bench_rect_contorno(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_rect(&quadro, 0, 0, WIDTH, HEIGHT, true, false);
+}
+
+static void bench_rect_cheio(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ssd1306_rect(&quadro, 0, 0, WIDTH, HEIGHT, i & 1, true);
+}
+
+static void bench_set_led(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint j = 0; j < LED_COUNT; j++) npSetLED(j, (uint8_t)i, (uint8_t)j, 0x20);
+    }
+}
+
+static void bench_np_write(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) npWrite();
+}
+
+static void bench_get_index(uint32_t n) {
+    int x = 0, y = 0;
+    uint32_t soma = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        soma += getIndex(x, y);
+        if (++x == 5) {
+            x = 0;
+            if (++y == 5) y = 0;
+        }
+    }
+    sumidouro = soma;
+}
+
+static void detectar(uint32_t n, uint16_t R, uint16_t G, uint16_t B, uint16_t NIR) {
+    uint32_t positivos = 0;
+    for (uint32_t i = 0; i < n; i++) positivos += detectar_doenca(R + (i & 3), G, B, NIR - (i & 3));
+    sumidouro = positivos;
+}
+
+static void bench_detectar_saudavel(uint32_t n) {
+    detectar(n, REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(70), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(95));
+}
+
+static void bench_detectar_infectada(uint32_t n) {
+    detectar(n, REFLECTANCIA_PCT(72), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(58));
+}
+
+static void bench_detectar_limiar(uint32_t n) {
+    detectar(n, REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(58), REFLECTANCIA_PCT(35), REFLECTANCIA_PCT(100));
+}
+
+// Planta com FOLHAS_POR_PLANTA folhas, como as do talhão inicial
+static void gerar(uint32_t n, int perfil) {
+    Planta p = {.num_folhas = FOLHAS_POR_PLANTA};
+    FolhaCompacta folhas[PLANTA_MAX_FOLHAS];
+    Aleatorio rng;
+    aleatorio_semear(&rng, 0x5EED);
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        gerar_planta(&p, folhas, perfil, &rng);
+        total += p.num_folhas;
+    }
+    sumidouro = total;
+}
+
+static void bench_gerar_saudavel(uint32_t n) { gerar(n, PERFIL_SAUDAVEL); }
+static void bench_gerar_visivel(uint32_t n) { gerar(n, PERFIL_VISIVEL); }
+static void bench_gerar_latente(uint32_t n) { gerar(n, PERFIL_LATENTE); }
+
+// Mesmos formatos de exibir_resultado_analise. Sem PRINTF_FLOAT o printf do
+// firmware não formata %f e o caso de float fica de fora
+#if !defined(PICO_PRINTF_SUPPORT_FLOAT) || PICO_PRINTF_SUPPORT_FLOAT
+static void bench_snprintf_float(uint32_t n) {
+    char buffer[24];
+    uint32_t tamanho = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        tamanho += snprintf(buffer, sizeof(buffer), "NDVI:%.2f", Q15_PARA_FLOAT((int32_t)(i & 0xFFFF) - 0x8000));
+    }
+    sumidouro = tamanho;
+}
+#endif
+
+static void bench_snprintf_inteiro(uint32_t n) {
+    char buffer[24];
+    uint32_t tamanho = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        tamanho += snprintf(buffer, sizeof(buffer), "R:%u%% G:%u%%", (unsigned)(i % 101), (unsigned)(i & 63));
+    }
+    sumidouro = tamanho;
+}
+
+// Os mesmos textos com utils/formatacao
+static void bench_texto_q15(uint32_t n) {
+    char buffer[24];
+    uint32_t tamanho = 0;
+    Texto t;
+    for (uint32_t i = 0; i < n; i++) {
+        texto_iniciar(&t, buffer, sizeof(buffer));
+        texto_str(&t, "NDVI:");
+        texto_q15(&t, (int32_t)(i & 0xFFFF) - 0x8000, 2);
+        tamanho += t.tam;
+    }
+    sumidouro = tamanho;
+}
+
+static void bench_texto_inteiro(uint32_t n) {
+    char buffer[24];
+    uint32_t tamanho = 0;
+    Texto t;
+    for (uint32_t i = 0; i < n; i++) {
+        texto_iniciar(&t, buffer, sizeof(buffer));
+        texto_str(&t, "R:");
+        texto_percentual(&t, i % 101);
+        texto_str(&t, " G:");
+        texto_percentual(&t, i & 63);
+        tamanho += t.tam;
+    }
+    sumidouro = tamanho;
+}
+
+typedef struct {
+    const char *nome;
+    const char *entrada;
+    void (*executar)(uint32_t n);
+} CasoMicrobench;
+
+static const CasoMicrobench CASOS[] = {
+    {"ssd1306_pixel",       "varredura",       bench_pixel},
+    {"ssd1306_fill",        "apagar",          bench_fill_apagar},
+    {"ssd1306_fill",        "preencher",       bench_fill_preencher},
+    {"ssd1306_draw_string", "curta_9",         bench_string_curta},
+    {"ssd1306_draw_string", "linha_16",        bench_string_linha},
+    {"ssd1306_draw_string", "especiais_14",    bench_string_especiais},
+    {"ssd1306_draw_string", "acentos_11",      bench_string_acentos},
+    {"ssd1306_draw_string", "compacta_21",     bench_string_compacta},
+    {"ssd1306_rect",        "contorno_8x8",    bench_rect_8x8},
+    {"ssd1306_rect",        "contorno_tela",   bench_rect_contorno},
+    {"ssd1306_rect",        "cheio_tela",      bench_rect_cheio},
+    {"npSetLED",            "quadro_25",       bench_set_led},
+    {"npWrite",             "quadro_25",       bench_np_write},
+    {"getIndex",            "varredura_5x5",   bench_get_index},
+    {"detectar_doenca",     "saudavel",        bench_detectar_saudavel},
+    {"detectar_doenca",     "infectada",       bench_detectar_infectada},
+    {"detectar_doenca",     "limiar_gndvi",    bench_detectar_limiar},
+    {"gerar_planta",        "saudavel_5",      bench_gerar_saudavel},
+    {"gerar_planta",        "visivel_5",       bench_gerar_visivel},
+    {"gerar_planta",        "latente_5",       bench_gerar_latente},
+#if !defined(PICO_PRINTF_SUPPORT_FLOAT) || PICO_PRINTF_SUPPORT_FLOAT
+    {"snprintf",            "ndvi_float",      bench_snprintf_float},
+#endif
+    {"snprintf",            "reflectancia_int", bench_snprintf_inteiro},
+    {"texto_q15",           "ndvi_2casas",     bench_texto_q15},
+    {"texto_percentual",    "reflectancia_int", bench_texto_inteiro},
+};
+#define NUM_CASOS (sizeof(CASOS) / sizeof(CASOS[0]))
+
+/**********************************
+* MEDIÇÃO
+**********************************/
+
+static uint64_t medir(const CasoMicrobench *c, uint32_t n, RelogioMicrobench relogio) {
+    uint64_t inicio = relogio();
+    c->executar(n);
+    return relogio() - inicio;
+}
+
+/*
+* Dobra as iterações até a medição passar do alvo e fica com a menor de
+* MICROBENCH_REPETICOES medições com essa contagem
+* @param iteracoes Iterações da medição (saída)
+* @return Duração da menor medição (us)
+*/
+static uint64_t medir_caso(const CasoMicrobench *c, uint32_t alvo_us, RelogioMicrobench relogio,
+                           uint32_t *iteracoes) {
+    uint32_t n = 1;
+    uint64_t tempo;
+    while ((tempo = medir(c, n, relogio)) < alvo_us && n < MICROBENCH_MAX_ITERACOES) n *= 2;
+    for (int r = 1; r < MICROBENCH_REPETICOES; r++) {
+        uint64_t t = medir(c, n, relogio);
+        if (t < tempo) tempo = t;
+    }
+    *iteracoes = n;
+    return tempo;
+}
+
+uint32_t microbench_executar(const char *filtro, uint32_t alvo_us, RelogioMicrobench relogio,
+                             const char *plataforma, uint32_t hz) {
+    if (!quadro.bufsize) ssd1306_init(&quadro, WIDTH, HEIGHT, false, endereco, NULL);
+    size_t tamanho_filtro = filtro ? strlen(filtro) : 0;
+
+    // Os casos da matriz sobrescrevem o buffer de LEDs; restaura no fim
+    npLED_t salvos[LED_COUNT];
+    memcpy(salvos, leds, sizeof(salvos));
+
+    printf("microbench v%u plataforma=%s hz=%lu alvo_us=%lu\n", MICROBENCH_VERSAO, plataforma,
+           (unsigned long)hz, (unsigned long)alvo_us);
+    printf("caso,entrada,iteracoes,total_us,ns_por_chamada\n");
+    uint32_t medidos = 0;
+    for (uint32_t i = 0; i < NUM_CASOS; i++) {
+        const CasoMicrobench *c = &CASOS[i];
+        if (tamanho_filtro && strncmp(c->nome, filtro, tamanho_filtro) != 0) continue;
+
+        uint32_t n;
+        uint64_t tempo = medir_caso(c, alvo_us, relogio, &n);
+        uint64_t centesimos_ns = tempo * 100000u / n;
+        printf("%s,%s,%lu,%lu,%lu.%02u\n", c->nome, c->entrada, (unsigned long)n, (unsigned long)tempo,
+               (unsigned long)(centesimos_ns / 100), (unsigned)(centesimos_ns % 100));
+        medidos++;
+    }
+    printf("fim microbench\n");
+
+    memcpy(leds, salvos, sizeof(salvos));
+    npWrite();
+    return medidos;
+}
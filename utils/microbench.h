@@ -0,0 +1,34 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <stdint.h>
+
+// Microbenchmarks das primitivas quentes da interface e da lógica: desenho no
+// OLED (em um quadro próprio, sem enviar pelo I2C), empacotamento da matriz
+// de LEDs, detecção, geração de plantas e a formatação das telas. Roda no
+// firmware (comando microbench, timer de 1 us) e no host (host/microbench,
+// sobre o HAL simulado, com o relógio do sistema).
+//
+// Cada caso chama a primitiva em laço, dobrando as iterações até passar de
+// alvo_us, e fica com a menor de MICROBENCH_REPETICOES medições. A saída é
+// CSV entre um cabeçalho e um rodapé, para comparar revisões:
+//   microbench v1 plataforma=<nome> hz=<clock> alvo_us=<alvo>
+//   caso,entrada,iteracoes,total_us,ns_por_chamada
+//   ssd1306_pixel,varredura,...
+//   fim microbench
+
+#define MICROBENCH_VERSAO 1
+#define MICROBENCH_ALVO_US 10000        // Por medição; ~1 s para todos os casos
+#define MICROBENCH_REPETICOES 3
+#define MICROBENCH_MAX_ITERACOES (1u << 24)   // Limite com relógio parado (simulador)
+
+// Relógio em microssegundos (time_us_64 no firmware)
+typedef uint64_t (*RelogioMicrobench)(void);
+
+// Roda os casos cujo nome começa com filtro (NULL ou "" roda todos)
+// @param hz Clock da CPU para o cabeçalho (0 se desconhecido)
+// @return Número de casos medidos
+uint32_t microbench_executar(const char *filtro, uint32_t alvo_us, RelogioMicrobench relogio,
+                             const char *plataforma, uint32_t hz);
+
+#endif // MICROBENCH_H
@@ -0,0 +1,302 @@
+#include "planejador.h"
+
+/**********************************
+* RISCO E BENEFÍCIO
+**********************************/
+
+/*
+* Risco próprio da planta a partir das folhas: a fração de folhas infectadas
+* e, como indício mais fraco (metade do peso), a menor margem dos índices
+* acima dos limiares entre as folhas sadias
+*/
+static uint16_t calcular_risco(const Planejador *pl, const Planta *p) {
+    if (p->tratada) return 0;
+    if (p->infectada) return Q15_UM;
+
+    const FolhaCompacta *folhas = &pl->reg->folhas[p->primeira_folha];
+    uint32_t infectadas = 0;
+    q15_t menor_margem = PLANEJADOR_MARGEM_REF;
+    for (uint8_t i = 0; i < p->num_folhas; i++) {
+        if (folha_compacta_infectada(folhas[i])) {
+            infectadas++;
+            continue;
+        }
+        q15_t margem_ndvi = folha_compacta_ndvi(folhas[i]) - pl->limiares.ndvi;
+        q15_t margem_gndvi = folha_compacta_gndvi(folhas[i]) - pl->limiares.gndvi;
+        q15_t margem = margem_ndvi < margem_gndvi ? margem_ndvi : margem_gndvi;
+        if (margem < menor_margem) menor_margem = margem;
+    }
+    if (menor_margem < 0) menor_margem = 0;
+
+    uint32_t fracao = infectadas * Q15_UM / p->num_folhas;
+    uint32_t indicio = (uint32_t)(PLANEJADOR_MARGEM_REF - menor_margem) * (Q15_UM / 2) / PLANEJADOR_MARGEM_REF;
+    return (uint16_t)(fracao + ((Q15_UM - fracao) * indicio >> 15));
+}
+
+/*
+* Vizinhos da planta no talhão (até 8: fileiras adjacentes e a própria,
+* colunas adjacentes)
+* @return Número de vizinhos escritos em saida
+*/
+static uint8_t vizinhos(const Planejador *pl, uint16_t posicao, uint16_t saida[8]) {
+    const Planta *p = &pl->reg->plantas[posicao];
+    uint8_t n = 0;
+    for (int df = -1; df <= 1; df++) {
+        int fileira = p->fileira + df;
+        if (fileira < 0 || fileira >= pl->reg->num_fileiras) continue;
+        for (int dc = -1; dc <= 1; dc++) {
+            int coluna = p->coluna + dc;
+            if ((df == 0 && dc == 0) || coluna < 0) continue;
+            uint16_t v = registro_posicao_em(pl->reg, (uint8_t)fileira, (uint16_t)coluna);
+            if (v != REGISTRO_NENHUMA) saida[n++] = v;
+        }
+    }
+    return n;
+}
+
+static inline bool no_plano(const Planejador *pl, uint16_t posicao) {
+    return (pl->no_plano[posicao / 32] >> (posicao % 32)) & 1u;
+}
+
+/*
+* Proteção esperada ao tratar a planta: chance de ela estar ou ficar
+* infectada mais o contágio evitado nos vizinhos suscetíveis. Vizinhos já
+* escolhidos no plano em montagem contam como tratados.
+*/
+static uint32_t calcular_beneficio(const Planejador *pl, uint16_t posicao) {
+    if (pl->reg->plantas[posicao].tratada) return 0;
+
+    uint16_t viz[8];
+    uint8_t n = vizinhos(pl, posicao, viz);
+    uint32_t infectados = 0, suscetiveis = 0;    // Plantas esperadas, Q15
+    for (uint8_t i = 0; i < n; i++) {
+        if (no_plano(pl, viz[i])) continue;      // Risco zero e fora dos suscetíveis
+        uint32_t r = pl->risco[viz[i]];
+        infectados += r;
+        if (!pl->reg->plantas[viz[i]].tratada) suscetiveis += Q15_UM - r;
+    }
+
+    uint32_t risco = pl->risco[posicao];
+    uint32_t exposicao = infectados * PLANEJADOR_TRANSMISSAO >> 15;
+    if (exposicao > Q15_UM) exposicao = Q15_UM;
+    uint32_t chance = risco + ((Q15_UM - risco) * exposicao >> 15);
+    uint32_t contagio = risco * (suscetiveis * PLANEJADOR_TRANSMISSAO >> 15) >> 15;
+    return chance + contagio;
+}
+
+/**********************************
+* HEAP
+**********************************/
+
+// Ordem do heap: maior benefício primeiro; empate, ordem de campo
+static inline bool antes(const Planejador *pl, uint16_t a, uint16_t b) {
+    return pl->beneficio[a] > pl->beneficio[b] || (pl->beneficio[a] == pl->beneficio[b] && a < b);
+}
+
+static inline void colocar(Planejador *pl, uint16_t i, uint16_t posicao) {
+    pl->heap[i] = posicao;
+    pl->indice_heap[posicao] = i;
+}
+
+static void subir(Planejador *pl, uint16_t i) {
+    uint16_t posicao = pl->heap[i];
+    while (i > 0) {
+        uint16_t pai = (i - 1) / 2;
+        if (!antes(pl, posicao, pl->heap[pai])) break;
+        colocar(pl, i, pl->heap[pai]);
+        i = pai;
+    }
+    colocar(pl, i, posicao);
+}
+
+static void descer(Planejador *pl, uint16_t i) {
+    uint16_t posicao = pl->heap[i];
+    for (;;) {
+        uint32_t filho = 2u * i + 1;
+        if (filho >= pl->tamanho) break;
+        if (filho + 1 < pl->tamanho && antes(pl, pl->heap[filho + 1], pl->heap[filho])) filho++;
+        if (!antes(pl, pl->heap[filho], posicao)) break;
+        colocar(pl, i, pl->heap[filho]);
+        i = (uint16_t)filho;
+    }
+    colocar(pl, i, posicao);
+}
+
+// Novo benefício de uma planta já no heap
+static void reposicionar(Planejador *pl, uint16_t posicao, uint32_t beneficio) {
+    uint32_t anterior = pl->beneficio[posicao];
+    if (beneficio == anterior) return;
+    pl->beneficio[posicao] = beneficio;
+    if (beneficio > anterior) {
+        subir(pl, pl->indice_heap[posicao]);
+    } else {
+        descer(pl, pl->indice_heap[posicao]);
+    }
+}
+
+/**********************************
+* PLANEJAMENTO
+**********************************/
+
+/*
+* Calcula riscos e benefícios de todo o talhão e monta o heap
+* @param limiares Limiares de referência para as margens dos índices
+*/
+void planejador_iniciar(Planejador *pl, RegistroPlantas *reg, const LimiaresDeteccao *limiares) {
+    pl->reg = reg;
+    pl->limiares = *limiares;
+    pl->tamanho = registro_total(reg);
+    pl->atualizacoes = 0;
+    for (uint16_t i = 0; i < sizeof(pl->no_plano) / sizeof(pl->no_plano[0]); i++) {
+        pl->no_plano[i] = 0;
+    }
+
+    for (uint16_t i = 0; i < pl->tamanho; i++) {
+        pl->risco[i] = calcular_risco(pl, &reg->plantas[i]);
+    }
+    for (uint16_t i = 0; i < pl->tamanho; i++) {
+        pl->beneficio[i] = calcular_beneficio(pl, i);
+        colocar(pl, i, i);
+    }
+    for (uint16_t i = pl->tamanho / 2; i-- > 0;) {
+        descer(pl, i);
+    }
+}
+
+/*
+* Recalcula o risco da planta e o benefício dela e dos vizinhos
+* @param posicao Planta analisada ou tratada (ordem de campo)
+*/
+void planejador_atualizar(Planejador *pl, uint16_t posicao) {
+    if (posicao >= pl->tamanho) return;
+    pl->atualizacoes++;
+
+    pl->risco[posicao] = calcular_risco(pl, &pl->reg->plantas[posicao]);
+    reposicionar(pl, posicao, calcular_beneficio(pl, posicao));
+
+    // Risco e tratamento da planta entram na exposição e no contágio dos vizinhos
+    uint16_t viz[8];
+    uint8_t n = vizinhos(pl, posicao, viz);
+    for (uint8_t i = 0; i < n; i++) {
+        reposicionar(pl, viz[i], calcular_beneficio(pl, viz[i]));
+    }
+}
+
+// Fronteira da extração: heap de índices do heap principal
+static void fronteira_inserir(Planejador *pl, uint16_t *n, uint16_t indice) {
+    uint16_t i = (*n)++;
+    while (i > 0) {
+        uint16_t pai = (i - 1) / 2;
+        if (!antes(pl, pl->heap[indice], pl->heap[pl->fronteira[pai]])) break;
+        pl->fronteira[i] = pl->fronteira[pai];
+        i = pai;
+    }
+    pl->fronteira[i] = indice;
+}
+
+static uint16_t fronteira_remover(Planejador *pl, uint16_t *n) {
+    uint16_t topo = pl->fronteira[0];
+    uint16_t ultimo = pl->fronteira[--(*n)];
+    uint16_t i = 0;
+    for (;;) {
+        uint32_t filho = 2u * i + 1;
+        if (filho >= *n) break;
+        if (filho + 1 < *n && antes(pl, pl->heap[pl->fronteira[filho + 1]], pl->heap[pl->fronteira[filho]])) filho++;
+        if (!antes(pl, pl->heap[pl->fronteira[filho]], pl->heap[ultimo])) break;
+        pl->fronteira[i] = pl->fronteira[filho];
+        i = (uint16_t)filho;
+    }
+    pl->fronteira[i] = ultimo;
+    return topo;
+}
+
+// Fila das revistas: heap de posições pelo ganho recalculado, mesma ordem do heap principal
+static inline bool antes_revista(const Planejador *pl, uint16_t a, uint16_t b) {
+    return pl->ganho[a] > pl->ganho[b] || (pl->ganho[a] == pl->ganho[b] && a < b);
+}
+
+static void revistas_inserir(Planejador *pl, uint16_t *n, uint16_t posicao) {
+    uint16_t i = (*n)++;
+    while (i > 0) {
+        uint16_t pai = (i - 1) / 2;
+        if (!antes_revista(pl, posicao, pl->revistas[pai])) break;
+        pl->revistas[i] = pl->revistas[pai];
+        i = pai;
+    }
+    pl->revistas[i] = posicao;
+}
+
+static uint16_t revistas_remover(Planejador *pl, uint16_t *n) {
+    uint16_t topo = pl->revistas[0];
+    uint16_t ultimo = pl->revistas[--(*n)];
+    uint16_t i = 0;
+    for (;;) {
+        uint32_t filho = 2u * i + 1;
+        if (filho >= *n) break;
+        if (filho + 1 < *n && antes_revista(pl, pl->revistas[filho + 1], pl->revistas[filho])) filho++;
+        if (!antes_revista(pl, pl->revistas[filho], ultimo)) break;
+        pl->revistas[i] = pl->revistas[filho];
+        i = (uint16_t)filho;
+    }
+    pl->revistas[i] = ultimo;
+    return topo;
+}
+
+/*
+* Plano de tratamento dentro do orçamento, escolha gulosa sem alterar o heap:
+* a cada passo, a planta de maior ganho dadas as já escolhidas (vizinhas
+* escolhidas contam como tratadas). O topo vem da fronteira do heap principal
+* (benefício sem o plano, limite superior do ganho) ou das revistas; se o
+* ganho recalculado for menor que a chave, a planta volta às revistas.
+* Plantas sem ganho (tratadas) não entram.
+* @param custo Custo do tratamento de uma planta
+* @param saida Posições das plantas em ordem de escolha (até max)
+* @param protecao Soma dos ganhos do plano (Q15), se não for NULL
+* @return Plantas no plano
+*/
+uint16_t planejador_plano(Planejador *pl, uint32_t orcamento, uint32_t custo,
+                          uint16_t *saida, uint16_t max, uint32_t *protecao) {
+    uint32_t limite = custo ? orcamento / custo : pl->tamanho;
+    if (limite > max) limite = max;
+
+    uint16_t n = 0, na_fronteira = 0, nas_revistas = 0;
+    uint32_t total = 0;
+    if (pl->tamanho > 0) fronteira_inserir(pl, &na_fronteira, 0);
+    while (n < limite && (na_fronteira > 0 || nas_revistas > 0)) {
+        uint16_t posicao;
+        uint32_t chave;
+        bool da_fronteira = nas_revistas == 0;
+        if (na_fronteira > 0 && !da_fronteira) {
+            uint16_t a = pl->heap[pl->fronteira[0]], b = pl->revistas[0];
+            da_fronteira = pl->beneficio[a] > pl->ganho[b] || (pl->beneficio[a] == pl->ganho[b] && a < b);
+        }
+        if (da_fronteira) {
+            uint16_t indice = fronteira_remover(pl, &na_fronteira);
+            posicao = pl->heap[indice];
+            chave = pl->beneficio[posicao];
+            uint32_t filho = 2u * indice + 1;
+            if (filho < pl->tamanho) fronteira_inserir(pl, &na_fronteira, (uint16_t)filho);
+            if (filho + 1 < pl->tamanho) fronteira_inserir(pl, &na_fronteira, (uint16_t)(filho + 1));
+        } else {
+            posicao = revistas_remover(pl, &nas_revistas);
+            chave = pl->ganho[posicao];
+        }
+        if (chave == 0) break;    // Maior chave restante: nenhuma outra tem ganho
+
+        uint32_t ganho = calcular_beneficio(pl, posicao);
+        pl->ganho[posicao] = ganho;
+        if (ganho != chave) {
+            if (ganho > 0) revistas_inserir(pl, &nas_revistas, posicao);
+            continue;
+        }
+        saida[n++] = posicao;
+        total += ganho;
+        pl->no_plano[posicao / 32] |= 1u << (posicao % 32);
+    }
+
+    for (uint16_t i = 0; i < n; i++) {
+        pl->no_plano[saida[i] / 32] &= ~(1u << (saida[i] % 32));
+    }
+    if (protecao) *protecao = total;
+    return n;
+}
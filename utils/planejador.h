@@ -0,0 +1,77 @@
+#ifndef PLANEJADOR_H
+#define PLANEJADOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/deteccao.h"
+#include "utils/registro.h"
+
+// Planejamento de tratamentos com orçamento de fungicida.
+//
+// Cada planta tem um risco próprio (Q15), estimado das suas folhas: fração de
+// folhas infectadas e, nas demais, a proximidade de NDVI/GNDVI dos limiares.
+// O benefício de tratá-la (proteção esperada, em plantas, Q15) soma:
+//   - a chance de ela estar ou ficar infectada: risco próprio combinado com a
+//     exposição aos vizinhos (8 vizinhos no talhão, PLANEJADOR_TRANSMISSAO por
+//     vizinho infectado esperado);
+//   - o contágio evitado: risco próprio vezes a chance de transmitir a cada
+//     vizinho suscetível não tratado.
+// Plantas tratadas têm benefício zero.
+//
+// As plantas ficam em um max-heap indexado por benefício. Uma análise ou um
+// tratamento muda o risco de uma planta e, portanto, o benefício dela e dos
+// vizinhos: só essas 9 entradas são recalculadas e reposicionadas no heap,
+// em O(log n) cada, sem reordenar o talhão.
+//
+// O plano (k = orçamento / custo plantas) é uma escolha gulosa, não o ótimo:
+// vizinhas disputam o mesmo contágio evitado, e tratar uma planta zera o risco
+// dela na exposição das vizinhas e as tira dos suscetíveis. A cada passo entra
+// a planta de maior ganho dado o que já foi escolhido. Como uma escolha só
+// reduz o ganho das vizinhas, o benefício do heap é um limite superior: a
+// planta retirada do topo só é recalculada (8 vizinhos) e, se o ganho caiu,
+// volta a uma fila de revistas com a chave nova. Sem alterar o heap, em
+// O(k log n).
+
+#define PLANEJADOR_MAX REGISTRO_MAX_PLANTAS
+#define PLANEJADOR_MARGEM_REF Q15(0.25)   // Margem acima do limiar a partir da qual o índice não indica risco
+#define PLANEJADOR_TRANSMISSAO Q15(0.10)  // Chance de contágio por vizinho infectado
+
+typedef struct {
+    RegistroPlantas *reg;
+    LimiaresDeteccao limiares;                 // Limiares usados nas margens dos índices
+    uint16_t risco[PLANEJADOR_MAX];            // Risco próprio por posição (Q15)
+    uint32_t beneficio[PLANEJADOR_MAX];        // Chave do heap (Q15)
+    uint16_t heap[PLANEJADOR_MAX];             // Posições das plantas, maior benefício na raiz
+    uint16_t indice_heap[PLANEJADOR_MAX];      // Onde cada posição está no heap
+    uint16_t fronteira[PLANEJADOR_MAX];        // Trabalho de planejador_plano
+    uint16_t revistas[PLANEJADOR_MAX];         // Trabalho de planejador_plano: plantas com ganho recalculado
+    uint32_t ganho[PLANEJADOR_MAX];            // Ganho recalculado; das plantas do último plano, o ganho de cada uma
+    uint32_t no_plano[(PLANEJADOR_MAX + 31) / 32];  // Escolhidas durante planejador_plano (vazio fora dele)
+    uint16_t tamanho;
+    uint32_t atualizacoes;                     // Chamadas de planejador_atualizar
+} Planejador;
+
+// Construção (O(n)): depois de carregar ou trocar o talhão, ou os limiares
+void planejador_iniciar(Planejador *pl, RegistroPlantas *reg, const LimiaresDeteccao *limiares);
+
+// Uma planta foi analisada ou tratada
+void planejador_atualizar(Planejador *pl, uint16_t posicao);
+
+// Plano: posições em ordem de escolha, até o orçamento
+uint16_t planejador_plano(Planejador *pl, uint32_t orcamento, uint32_t custo,
+                          uint16_t *saida, uint16_t max, uint32_t *protecao);
+
+static inline uint16_t planejador_risco(const Planejador *pl, uint16_t posicao) {
+    return pl->risco[posicao];
+}
+
+static inline uint32_t planejador_beneficio(const Planejador *pl, uint16_t posicao) {
+    return pl->beneficio[posicao];
+}
+
+// Ganho de uma planta do último plano, dadas as escolhidas antes dela
+static inline uint32_t planejador_ganho(const Planejador *pl, uint16_t posicao) {
+    return pl->ganho[posicao];
+}
+
+#endif // PLANEJADOR_H
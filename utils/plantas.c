@@ -0,0 +1,191 @@
+#include "plantas.h"
+#include <string.h>
+#include "utils/deteccao.h"
+
+/**********************************
+* FOLHAS
+**********************************/
+
+/*
+* Atualiza a reflectância da folha, invalidando o cache de índices
+* somente se o valor realmente mudou
+*/
+void folha_definir_reflectancia(EstadoFolha *folha, Reflectancia r) {
+    if (memcmp(&folha->reflectancia, &r, sizeof(r)) != 0) {
+        folha->reflectancia = r;
+        folha->indices.validos = 0;
+    }
+}
+
+/*
+* Retorna os índices da folha, calculando apenas os que faltam no cache
+* @param mascara Índices necessários (INDICE_BIT(...))
+*/
+const IndicesEspectrais *folha_indices(EstadoFolha *folha, uint8_t mascara) {
+    uint8_t faltando = mascara & ~folha->indices.validos;
+    if (faltando) {
+        calcular_indices(&folha->reflectancia, faltando, &folha->indices);
+    }
+    return &folha->indices;
+}
+
+/*
+* Detecção de doença usando o cache de índices da folha
+*/
+bool detectar_doenca_folha(EstadoFolha *folha) {
+    return detectar_doenca_indices(&folha->reflectancia,
+                                   folha_indices(folha, deteccao_indices_necessarios()));
+}
+
+/**********************************
+* REGISTRO COMPACTO
+**********************************/
+
+_Static_assert(sizeof(FolhaCompacta) == 8, "FolhaCompacta deve ter 8 bytes");
+
+#define MASCARA_BANDA ((1u << FOLHA_BITS_BANDA) - 1)
+#define MASCARA_INDICE ((1u << FOLHA_BITS_INDICE) - 1)
+
+// Índice Q15 (-1.0 a 1.0) para 0..127, arredondado
+static uint64_t quantizar_indice(q15_t valor) {
+    if (valor < -Q15_UM) valor = -Q15_UM;
+    if (valor > Q15_UM) valor = Q15_UM;
+    return ((uint32_t)(valor + Q15_UM) * MASCARA_INDICE + Q15_UM) / (2 * Q15_UM);
+}
+
+static q15_t restaurar_indice(uint32_t q) {
+    return (q15_t)((q * 2 * Q15_UM + MASCARA_INDICE / 2) / MASCARA_INDICE) - Q15_UM;
+}
+
+static uint64_t compactar_banda(uint16_t valor) {
+    return valor > REFLECTANCIA_MAX ? REFLECTANCIA_MAX : valor;
+}
+
+/*
+* Compacta uma folha em 8 bytes. NIR acima de 100% satura em REFLECTANCIA_MAX;
+* NDVI e GNDVI são calculados (se preciso) a partir dos valores completos.
+*/
+FolhaCompacta folha_compactar(EstadoFolha *folha) {
+    const Reflectancia *r = &folha->reflectancia;
+    const IndicesEspectrais *indices = folha_indices(folha, INDICES_DETECCAO);
+
+    FolhaCompacta c = compactar_banda(r->R)
+                    | compactar_banda(r->G) << 12
+                    | compactar_banda(r->B) << 24
+                    | compactar_banda(r->NIR) << 36
+                    | quantizar_indice(indices->valor[INDICE_NDVI]) << FOLHA_POS_NDVI
+                    | quantizar_indice(indices->valor[INDICE_GNDVI]) << FOLHA_POS_GNDVI;
+    if (folha->visivel) c |= FOLHA_BIT_VISIVEL;
+    if (folha->infectada) c |= FOLHA_BIT_INFECTADA;
+    return c;
+}
+
+/*
+* Restaura a forma de trabalho de uma folha. O cache de índices começa vazio:
+* os índices exatos são recalculados sob demanda a partir das reflectâncias.
+*/
+void folha_descompactar(FolhaCompacta c, EstadoFolha *folha) {
+    folha->reflectancia.R = c & MASCARA_BANDA;
+    folha->reflectancia.G = (c >> 12) & MASCARA_BANDA;
+    folha->reflectancia.B = (c >> 24) & MASCARA_BANDA;
+    folha->reflectancia.NIR = (c >> 36) & MASCARA_BANDA;
+    folha->indices.validos = 0;
+    folha->visivel = folha_compacta_visivel(c);
+    folha->infectada = folha_compacta_infectada(c);
+}
+
+/*
+* Índices aproximados guardados no registro (erro máximo de 1/127),
+* úteis para listagens sem descompactar a folha
+*/
+q15_t folha_compacta_ndvi(FolhaCompacta c) {
+    return restaurar_indice((c >> FOLHA_POS_NDVI) & MASCARA_INDICE);
+}
+
+q15_t folha_compacta_gndvi(FolhaCompacta c) {
+    return restaurar_indice((c >> FOLHA_POS_GNDVI) & MASCARA_INDICE);
+}
+
+/**********************************
+* PLANTAS
+**********************************/
+
+/*
+* Gera as folhas de uma planta com características específicas
+* @param p Planta já registrada (id, posição e num_folhas definidos)
+* @param folhas Folhas da planta no pool (p->num_folhas posições)
+* @param tipo Perfil da planta (PerfilPlanta)
+* @param rng Gerador pseudoaleatório (mesma semente, mesmas folhas)
+*/
+void gerar_planta(Planta *p, FolhaCompacta *folhas, int tipo, Aleatorio *rng) {
+    p->infectada = false;
+    p->tratada = false;
+
+    for (int i = 0; i < p->num_folhas; i++) {
+        uint16_t R, G, B, NIR;
+        bool visivel_doente = false;
+
+        // Configuração baseada no tipo de planta
+        switch (tipo) {
+            case PERFIL_SAUDAVEL:
+            default:
+                // Garante que os valores vão gerar um NDVI e GNDVI sempre acima do limiar saudável
+                R = REFLECTANCIA_PCT(aleatorio_faixa(rng, 10) + 30);  // Mantém baixo para um NDVI alto
+                G = REFLECTANCIA_PCT(aleatorio_faixa(rng, 10) + 60);  // Mantém alto para um GNDVI alto
+                B = REFLECTANCIA_PCT(aleatorio_faixa(rng, 20) + 40);
+                NIR = REFLECTANCIA_PCT(aleatorio_faixa(rng, 20) + 95);  // Mantém bem alto para NDVI/GNDVI saudáveis
+                break;
+
+            case PERFIL_VISIVEL:
+                R = REFLECTANCIA_PCT(70 + aleatorio_faixa(rng, 15));
+                G = REFLECTANCIA_PCT(40 + aleatorio_faixa(rng, 10));
+                B = REFLECTANCIA_PCT(30 + aleatorio_faixa(rng, 10));
+                NIR = REFLECTANCIA_PCT(60 + aleatorio_faixa(rng, 10));
+                visivel_doente = true; // Marca infecção visível
+                break;
+
+            case PERFIL_LATENTE:
+                R = REFLECTANCIA_PCT(50 + aleatorio_faixa(rng, 10));
+                G = REFLECTANCIA_PCT(55 + aleatorio_faixa(rng, 10));
+                B = REFLECTANCIA_PCT(45 + aleatorio_faixa(rng, 10));
+                NIR = REFLECTANCIA_PCT(70 + aleatorio_faixa(rng, 20));
+                break;
+        }
+
+        // Configuração da folha
+        EstadoFolha folha = {0};
+        folha_definir_reflectancia(&folha, (Reflectancia){R, G, B, NIR});
+        folha.visivel = visivel_doente;
+
+        // Verifica infecção com a função existente (preenche o cache de índices)
+        folha.infectada = detectar_doenca_folha(&folha);
+        folhas[i] = folha_compactar(&folha);
+
+        // Se houver uma folha visivelmente doente, a planta toda é marcada como infectada
+        if (visivel_doente) {
+            p->infectada = true;
+        }
+    }
+}
+
+/*
+* Aplica tratamento fungicida na planta
+* @param p Ponteiro para a planta a ser tratada
+* @param folhas Folhas da planta no pool
+*/
+void tratar_planta(Planta *p, FolhaCompacta *folhas) {
+    // Valores de referência saudáveis
+    const Reflectancia saudavel = {
+        REFLECTANCIA_PCT(40), REFLECTANCIA_PCT(70), REFLECTANCIA_PCT(50), REFLECTANCIA_PCT(95)
+    };
+
+    EstadoFolha folha = {0};
+    folha_definir_reflectancia(&folha, saudavel);
+    FolhaCompacta tratada = folha_compactar(&folha);
+
+    for (int i = 0; i < p->num_folhas; i++) {
+        folhas[i] = tratada;
+    }
+    p->infectada = false;
+    p->tratada = true;
+}
@@ -0,0 +1,97 @@
+#ifndef PLANTAS_H
+#define PLANTAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/espectral.h"
+#include "utils/aleatorio.h"
+
+#define FOLHAS_POR_PLANTA 5    // Folhas exibidas por página na matriz de LEDs
+#define PLANTA_MAX_FOLHAS 32   // Limite de folhas de uma planta
+
+// Estado de uma folha individual
+typedef struct {
+    Reflectancia reflectancia; // Valores espectrais (escala do ADC)
+    IndicesEspectrais indices; // Cache dos índices, invalidado quando a reflectância muda
+    bool visivel;              // Infecção visível a olho nu
+    bool infectada;            // Status de infecção
+} EstadoFolha;
+
+// Registro compacto de folha (8 bytes), usado para armazenar plantas em massa.
+// EstadoFolha é a forma de trabalho: descompacte, processe e compacte de volta.
+//   bits  0-11  R    (escala do ADC, saturado em REFLECTANCIA_MAX)
+//   bits 12-23  G
+//   bits 24-35  B
+//   bits 36-47  NIR
+//   bits 48-54  NDVI  quantizado em 7 bits (-1.0 a 1.0, passo 2/127)
+//   bits 55-61  GNDVI quantizado em 7 bits
+//   bit  62     visível
+//   bit  63     infectada
+typedef uint64_t FolhaCompacta;
+
+#define FOLHA_BITS_BANDA 12
+#define FOLHA_BITS_INDICE 7
+#define FOLHA_POS_NDVI 48
+#define FOLHA_POS_GNDVI 55
+#define FOLHA_BIT_VISIVEL (1ull << 62)
+#define FOLHA_BIT_INFECTADA (1ull << 63)
+
+// Registro de uma planta (10 bytes). As folhas ficam em um pool compartilhado
+// (ver utils/registro.h), a partir de primeira_folha.
+typedef struct {
+    uint16_t id;               // Identificador único
+    uint16_t coluna;           // Posição na fileira
+    uint16_t primeira_folha;   // Índice da primeira folha no pool
+    uint8_t fileira;           // Fileira do talhão
+    uint8_t num_folhas;        // Número de folhas (1 a PLANTA_MAX_FOLHAS)
+    bool infectada;            // Status geral de infecção
+    bool tratada;              // Status de tratamento
+} Planta;
+
+// Resultado de uma análise, como gravado no histórico em flash (16 bytes)
+#define LOG_TIPO_ANALISE 1
+typedef enum {
+    ORIGEM_ANALISE,      // Folha de uma planta do registro
+    ORIGEM_CALIBRACAO    // Amostra ajustada no modo escaneamento
+} OrigemAnalise;
+
+typedef struct {
+    FolhaCompacta folha;       // Reflectâncias, índices e resultado
+    uint32_t tempo_ms;         // Instante da análise desde o boot
+    uint16_t id_planta;        // 0 para amostras de calibração
+    uint8_t indice_folha;
+    uint8_t origem;            // OrigemAnalise
+} RegistroAnalise;
+
+// Folhas
+void folha_definir_reflectancia(EstadoFolha *folha, Reflectancia r);
+const IndicesEspectrais *folha_indices(EstadoFolha *folha, uint8_t mascara);
+bool detectar_doenca_folha(EstadoFolha *folha);
+
+// Registro compacto
+FolhaCompacta folha_compactar(EstadoFolha *folha);
+void folha_descompactar(FolhaCompacta c, EstadoFolha *folha);
+q15_t folha_compacta_ndvi(FolhaCompacta c);
+q15_t folha_compacta_gndvi(FolhaCompacta c);
+
+static inline bool folha_compacta_visivel(FolhaCompacta c) {
+    return (c & FOLHA_BIT_VISIVEL) != 0;
+}
+
+static inline bool folha_compacta_infectada(FolhaCompacta c) {
+    return (c & FOLHA_BIT_INFECTADA) != 0;
+}
+
+// Perfis de planta usados na geração de dados
+typedef enum {
+    PERFIL_SAUDAVEL,
+    PERFIL_VISIVEL,      // Infectada com sintomas visíveis
+    PERFIL_LATENTE,      // Infectada sem sintomas visíveis
+    NUM_PERFIS
+} PerfilPlanta;
+
+// Plantas
+void gerar_planta(Planta *p, FolhaCompacta *folhas, int tipo, Aleatorio *rng);
+void tratar_planta(Planta *p, FolhaCompacta *folhas);
+
+#endif // PLANTAS_H
@@ -0,0 +1,81 @@
+#include "rastreio.h"
+#include <stdio.h>
+#include "hardware/clocks.h"
+
+#ifdef RASTREIO
+BufferRastreio rastreio_buffers[RASTREIO_NUCLEOS];
+#endif
+volatile bool rastreio_ativo = true;
+
+const char *const NOMES_PONTOS[NUM_PONTOS] = {
+    [PONTO_PASSO]          = "passo",
+    [PONTO_ESPERA]         = "espera",
+    [PONTO_FSM_TICK]       = "fsm_tick",
+    [PONTO_FSM_TRANSICAO]  = "fsm_transicao",
+    [PONTO_CONSOLE]        = "console",
+    [PONTO_HISTORICO]      = "historico",
+    [PONTO_OLED]           = "oled",
+    [PONTO_NEOPIXEL]       = "neopixel",
+    [PONTO_BUZZER]         = "buzzer",
+    [PONTO_ANIMACAO]       = "animacao",
+    [PONTO_TELA_RESULTADO] = "tela_resultado",
+};
+
+/*
+* Configura o SysTick do núcleo atual como contador livre de 24 bits no
+* clock do processador, sem interrupção
+*/
+void rastreio_iniciar(void) {
+#ifdef __arm__
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0xFFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;           // CLKSOURCE = processador, ENABLE
+#endif
+    rastreio_limpar();
+}
+
+void rastreio_limpar(void) {
+#ifdef RASTREIO
+    uint32_t estado = save_and_disable_interrupts();
+    for (int n = 0; n < RASTREIO_NUCLEOS; n++) rastreio_buffers[n].escritos = 0;
+    restore_interrupts(estado);
+#endif
+}
+
+/*
+* Formato (lido por tools/decodificar_rastreio; outras linhas são ignoradas):
+*   rastreio v<versao> hz=<clock> eventos=<por nucleo> ciclos=<0|1>
+*   ponto <id> <nome>                    (um por ponto)
+*   nucleo <n> escritos=<total> perdidos=<sobrescritos>
+*   ev <tempo_us> <palavra>              (hexadecimal, do mais antigo ao mais novo)
+*   fim rastreio
+* A gravação fica pausada durante o despejo.
+*/
+void rastreio_despejar(void) {
+#ifdef RASTREIO
+    bool ativo = rastreio_ativo;
+    rastreio_ativo = false;
+
+    printf("rastreio v%d hz=%lu eventos=%d ciclos=%d\n", RASTREIO_VERSAO,
+           (unsigned long)clock_get_hz(clk_sys), RASTREIO_EVENTOS, RASTREIO_TEM_CICLOS);
+    for (int p = 0; p < NUM_PONTOS; p++) {
+        printf("ponto %d %s\n", p, NOMES_PONTOS[p]);
+    }
+    for (int n = 0; n < RASTREIO_NUCLEOS; n++) {
+        const BufferRastreio *b = &rastreio_buffers[n];
+        uint32_t escritos = b->escritos;
+        uint32_t inicio = escritos > RASTREIO_EVENTOS ? escritos - RASTREIO_EVENTOS : 0;
+        printf("nucleo %d escritos=%lu perdidos=%lu\n", n, (unsigned long)escritos, (unsigned long)inicio);
+        for (uint32_t k = inicio; k < escritos; k++) {
+            const EventoRastreio *e = &b->eventos[k & (RASTREIO_EVENTOS - 1)];
+            printf("ev %08lx %08lx\n", (unsigned long)e->tempo_us, (unsigned long)e->palavra);
+        }
+    }
+    printf("fim rastreio\n");
+
+    rastreio_ativo = ativo;
+#else
+    printf("rastreio desativado (compilar com -DRASTREIO=ON)\n");
+#endif
+}
@@ -0,0 +1,114 @@
+#ifndef RASTREIO_H
+#define RASTREIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Rastreamento dos trechos quentes do loop (compilado só com -DRASTREIO=ON).
+//
+// Cada ponto grava um evento de 8 bytes no buffer circular do próprio núcleo:
+// instante do timer de 1 MHz e, na segunda palavra, o contador SysTick
+// (ciclos, 24 bits, decrescente), o ponto, o núcleo e se é início ou fim do
+// trecho. Um buffer por núcleo dispensa trava entre núcleos; contra as
+// interrupções do próprio núcleo bastam as poucas instruções com PRIMASK.
+// O buffer guarda os últimos RASTREIO_EVENTOS eventos (gravador de voo).
+//
+// O comando rastreio do console despeja os buffers em texto; o
+// tools/decodificar_rastreio monta histogramas de latência por trecho e uma
+// linha do tempo. Sem RASTREIO, os macros não geram código.
+
+#ifndef RASTREIO_EVENTOS
+#define RASTREIO_EVENTOS 512         // Por núcleo, potência de 2
+#endif
+#define RASTREIO_NUCLEOS 2
+#define RASTREIO_VERSAO 1
+
+#ifdef __arm__
+#include "hardware/structs/systick.h"
+#define RASTREIO_CICLOS() (systick_hw->cvr & 0xFFFFFFu)
+#define RASTREIO_TEM_CICLOS 1
+#else
+#define RASTREIO_CICLOS() 0u         // Simulador: só o relógio virtual
+#define RASTREIO_TEM_CICLOS 0
+#endif
+
+// Pontos instrumentados (até 64)
+typedef enum {
+    PONTO_PASSO,                     // sistema_passo: uma volta do loop
+    PONTO_ESPERA,                    // aguardar_proximo_tick: console e espera até o tick
+    PONTO_FSM_TICK,                  // fsm_tick
+    PONTO_FSM_TRANSICAO,             // fsm_despachar: sair + ação + entrar
+    PONTO_CONSOLE,                   // Execução de uma linha do console
+    PONTO_HISTORICO,                 // flash_log_processar (apagar/programar flash)
+    PONTO_OLED,                      // ssd1306_send_data (I2C)
+    PONTO_NEOPIXEL,                  // npWrite (PIO + reset)
+    PONTO_BUZZER,                    // Melodias bloqueantes do buzzer
+    PONTO_ANIMACAO,                  // animacao_analise
+    PONTO_TELA_RESULTADO,            // exibir_resultado_analise (formatação em float)
+    NUM_PONTOS
+} PontoRastreio;
+
+typedef struct {
+    uint32_t tempo_us;
+    uint32_t palavra;                // Ciclos (bits 0-23), ponto (24-29), núcleo (30), fim (31)
+} EventoRastreio;
+
+typedef struct {
+    EventoRastreio eventos[RASTREIO_EVENTOS];
+    uint32_t escritos;               // Total gravado desde a última limpeza
+} BufferRastreio;
+
+extern BufferRastreio rastreio_buffers[RASTREIO_NUCLEOS];
+extern volatile bool rastreio_ativo;
+extern const char *const NOMES_PONTOS[NUM_PONTOS];
+
+// Liga o SysTick como contador livre de ciclos e limpa os buffers
+void rastreio_iniciar(void);
+void rastreio_limpar(void);
+
+// Despeja cabeçalho, nomes dos pontos e eventos (do mais antigo ao mais novo)
+void rastreio_despejar(void);
+
+#ifdef RASTREIO
+
+static inline void rastreio_gravar(uint8_t ponto, bool fim) {
+    if (!rastreio_ativo) return;
+    uint32_t nucleo = get_core_num();
+    BufferRastreio *b = &rastreio_buffers[nucleo];
+    uint32_t estado = save_and_disable_interrupts();
+    EventoRastreio *e = &b->eventos[b->escritos++ & (RASTREIO_EVENTOS - 1)];
+    e->tempo_us = time_us_32();
+    e->palavra = RASTREIO_CICLOS() | (uint32_t)ponto << 24 | nucleo << 30 | (uint32_t)fim << 31;
+    restore_interrupts(estado);
+}
+
+static inline uint8_t rastreio_abrir(uint8_t ponto) {
+    rastreio_gravar(ponto, false);
+    return ponto;
+}
+
+static inline void rastreio_fechar(uint8_t *ponto) {
+    rastreio_gravar(*ponto, true);
+}
+
+#define RASTREIO_CONCATENAR_(a, b) a##b
+#define RASTREIO_CONCATENAR(a, b) RASTREIO_CONCATENAR_(a, b)
+
+#define RASTREIO_INICIO(ponto) rastreio_gravar((ponto), false)
+#define RASTREIO_FIM(ponto) rastreio_gravar((ponto), true)
+// Trecho até o fim do bloco atual (inclusive em return antecipado)
+#define RASTREIO_ESCOPO(ponto) \
+    uint8_t RASTREIO_CONCATENAR(rastreio_escopo_, __LINE__) \
+        __attribute__((cleanup(rastreio_fechar))) = rastreio_abrir(ponto)
+
+#else
+
+#define RASTREIO_INICIO(ponto) ((void)0)
+#define RASTREIO_FIM(ponto) ((void)0)
+#define RASTREIO_ESCOPO(ponto) ((void)0)
+
+#endif // RASTREIO
+
+#endif // RASTREIO_H
@@ -0,0 +1,148 @@
+#include "registro.h"
+#include <string.h>
+
+_Static_assert((REGISTRO_TAM_HASH & (REGISTRO_TAM_HASH - 1)) == 0, "REGISTRO_TAM_HASH deve ser potência de 2");
+_Static_assert(REGISTRO_TAM_HASH >= 2 * REGISTRO_MAX_PLANTAS, "tabela de ids muito cheia");
+
+/*
+* Hash multiplicativo (Fibonacci) do id
+*/
+static inline uint32_t hash_id(uint16_t id) {
+    return ((uint32_t)id * 2654435761u) >> 16 & (REGISTRO_TAM_HASH - 1);
+}
+
+/*
+* Primeira posição em [inicio, fim) com coluna >= "coluna" (fileira ordenada)
+*/
+static uint16_t limite_inferior(const RegistroPlantas *reg, uint16_t inicio, uint16_t fim, uint16_t coluna) {
+    while (inicio < fim) {
+        uint16_t meio = inicio + (fim - inicio) / 2;
+        if (reg->plantas[meio].coluna < coluna) {
+            inicio = meio + 1;
+        } else {
+            fim = meio;
+        }
+    }
+    return inicio;
+}
+
+/**********************************
+* GESTÃO
+**********************************/
+
+void registro_limpar(RegistroPlantas *reg) {
+    reg->num_plantas = 0;
+    reg->num_folhas = 0;
+    reg->num_fileiras = 0;
+    reg->inicio_fileira[0] = 0;
+    memset(reg->hash_id, 0xFF, sizeof(reg->hash_id));
+}
+
+/*
+* Acrescenta uma planta ao registro, reservando suas folhas no pool
+* @param id Identificador único
+* @param fileira,coluna Posição no talhão; deve vir depois da última planta
+*        em ordem de campo (fileira crescente, coluna crescente na fileira)
+* @param num_folhas Número de folhas (1 a PLANTA_MAX_FOLHAS)
+* @return Planta registrada (folhas zeradas), ou NULL se a posição estiver
+*         fora de ordem, o id repetido ou algum pool esgotado
+*/
+Planta *registro_adicionar(RegistroPlantas *reg, uint16_t id, uint8_t fileira,
+                           uint16_t coluna, uint8_t num_folhas) {
+    if (num_folhas == 0 || num_folhas > PLANTA_MAX_FOLHAS) return NULL;
+    if (fileira >= REGISTRO_MAX_FILEIRAS) return NULL;
+    if (reg->num_plantas >= REGISTRO_MAX_PLANTAS) return NULL;
+    if (reg->num_folhas + num_folhas > REGISTRO_MAX_FOLHAS) return NULL;
+
+    if (reg->num_plantas > 0) {
+        const Planta *ultima = &reg->plantas[reg->num_plantas - 1];
+        bool em_ordem = fileira > ultima->fileira ||
+                        (fileira == ultima->fileira && coluna > ultima->coluna);
+        if (!em_ordem) return NULL;
+    }
+
+    // Tabela de ids
+    uint32_t h = hash_id(id);
+    while (reg->hash_id[h] != REGISTRO_NENHUMA) {
+        if (reg->plantas[reg->hash_id[h]].id == id) return NULL;
+        h = (h + 1) & (REGISTRO_TAM_HASH - 1);
+    }
+
+    uint16_t posicao = reg->num_plantas++;
+    reg->hash_id[h] = posicao;
+
+    // Fileiras novas (vazias no meio ficam com início = fim)
+    while (reg->num_fileiras <= fileira) {
+        reg->inicio_fileira[reg->num_fileiras++] = posicao;
+    }
+    reg->inicio_fileira[reg->num_fileiras] = reg->num_plantas;
+
+    Planta *p = &reg->plantas[posicao];
+    memset(p, 0, sizeof(*p));
+    p->id = id;
+    p->fileira = fileira;
+    p->coluna = coluna;
+    p->num_folhas = num_folhas;
+    p->primeira_folha = reg->num_folhas;
+
+    memset(&reg->folhas[reg->num_folhas], 0, num_folhas * sizeof(FolhaCompacta));
+    reg->num_folhas += num_folhas;
+    return p;
+}
+
+/**********************************
+* CONSULTA
+**********************************/
+
+/*
+* Busca por id em O(1) (esperado)
+*/
+Planta *registro_buscar_id(RegistroPlantas *reg, uint16_t id) {
+    for (uint32_t h = hash_id(id); reg->hash_id[h] != REGISTRO_NENHUMA; h = (h + 1) & (REGISTRO_TAM_HASH - 1)) {
+        Planta *p = &reg->plantas[reg->hash_id[h]];
+        if (p->id == id) return p;
+    }
+    return NULL;
+}
+
+/*
+* Posição da planta em (fileira, coluna), ou REGISTRO_NENHUMA
+*/
+uint16_t registro_posicao_em(const RegistroPlantas *reg, uint8_t fileira, uint16_t coluna) {
+    if (fileira >= reg->num_fileiras) return REGISTRO_NENHUMA;
+
+    uint16_t fim = reg->inicio_fileira[fileira + 1];
+    uint16_t i = limite_inferior(reg, reg->inicio_fileira[fileira], fim, coluna);
+    return (i < fim && reg->plantas[i].coluna == coluna) ? i : REGISTRO_NENHUMA;
+}
+
+/*
+* Navegação entre fileiras: planta de coluna mais próxima na fileira
+* não vazia seguinte (delta > 0) ou anterior (delta < 0), com volta
+* @return Nova posição (a própria posição se só houver uma fileira)
+*/
+uint16_t registro_mover_fileira(const RegistroPlantas *reg, uint16_t posicao, int delta) {
+    if (posicao >= reg->num_plantas || delta == 0) return posicao;
+
+    const Planta *atual = &reg->plantas[posicao];
+    int passo = delta > 0 ? 1 : -1;
+    int fileira = atual->fileira;
+
+    // Próxima fileira não vazia na direção pedida
+    for (int tentativas = 0; tentativas < reg->num_fileiras; tentativas++) {
+        fileira = (fileira + passo + reg->num_fileiras) % reg->num_fileiras;
+        if (reg->inicio_fileira[fileira] < reg->inicio_fileira[fileira + 1]) break;
+    }
+    if (fileira == atual->fileira) return posicao;
+
+    uint16_t inicio = reg->inicio_fileira[fileira];
+    uint16_t fim = reg->inicio_fileira[fileira + 1];
+    uint16_t i = limite_inferior(reg, inicio, fim, atual->coluna);
+
+    // Escolhe o vizinho de coluna mais próxima
+    if (i == fim) return fim - 1;
+    if (i > inicio && atual->coluna - reg->plantas[i - 1].coluna < reg->plantas[i].coluna - atual->coluna) {
+        return i - 1;
+    }
+    return i;
+}
@@ -0,0 +1,69 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "utils/plantas.h"
+
+// Capacidade do registro (pools estáticos, sem heap). Ferramentas de host
+// podem compilar com capacidades maiores (posições e folhas cabem em 16 bits).
+#ifndef REGISTRO_MAX_PLANTAS
+#define REGISTRO_MAX_PLANTAS 1024
+#define REGISTRO_MAX_FOLHAS 4096
+#define REGISTRO_TAM_HASH 2048            // Potência de 2, pelo menos 2x REGISTRO_MAX_PLANTAS
+#endif
+#define REGISTRO_MAX_FILEIRAS 64
+#define REGISTRO_NENHUMA 0xFFFF           // Posição inválida
+
+// Registro de plantas do talhão. As plantas ficam em ordem de campo
+// (fileira, coluna) em um pool contíguo; as folhas de cada planta ocupam um
+// trecho contíguo do pool de folhas, alocado sequencialmente. Como o campo é
+// escaneado fileira a fileira, só há inserção no final e nunca fragmentação.
+typedef struct {
+    Planta plantas[REGISTRO_MAX_PLANTAS];
+    FolhaCompacta folhas[REGISTRO_MAX_FOLHAS];
+    uint16_t hash_id[REGISTRO_TAM_HASH];                 // Posição por id (endereçamento aberto)
+    uint16_t inicio_fileira[REGISTRO_MAX_FILEIRAS + 1];  // Primeira posição de cada fileira
+    uint16_t num_plantas;
+    uint16_t num_folhas;
+    uint8_t num_fileiras;                                // Fileiras com pelo menos uma planta
+} RegistroPlantas;
+
+// Gestão
+void registro_limpar(RegistroPlantas *reg);
+Planta *registro_adicionar(RegistroPlantas *reg, uint16_t id, uint8_t fileira,
+                           uint16_t coluna, uint8_t num_folhas);
+
+// Consulta
+Planta *registro_buscar_id(RegistroPlantas *reg, uint16_t id);
+uint16_t registro_posicao_em(const RegistroPlantas *reg, uint8_t fileira, uint16_t coluna);
+uint16_t registro_mover_fileira(const RegistroPlantas *reg, uint16_t posicao, int delta);
+
+// Planta na posição (ordem de campo), ou NULL
+static inline Planta *registro_planta(RegistroPlantas *reg, uint16_t posicao) {
+    return posicao < reg->num_plantas ? &reg->plantas[posicao] : NULL;
+}
+
+static inline uint16_t registro_total(const RegistroPlantas *reg) {
+    return reg->num_plantas;
+}
+
+// Posição de uma planta do registro
+static inline uint16_t registro_posicao(const RegistroPlantas *reg, const Planta *p) {
+    return (uint16_t)(p - reg->plantas);
+}
+
+// Folhas de uma planta no pool
+static inline FolhaCompacta *registro_folhas(RegistroPlantas *reg, const Planta *p) {
+    return &reg->folhas[p->primeira_folha];
+}
+
+// Posição seguinte/anterior em ordem de campo, com volta
+static inline uint16_t registro_avancar(const RegistroPlantas *reg, uint16_t posicao, int delta) {
+    if (reg->num_plantas == 0) return REGISTRO_NENHUMA;
+    int32_t n = reg->num_plantas;
+    return (uint16_t)((((int32_t)posicao + delta) % n + n) % n);
+}
+
+#endif // REGISTRO_H